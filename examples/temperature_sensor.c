@@ -4,6 +4,7 @@
  */
 
 #include "phymuti.h"
+#include "temperature_sensor_regs.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -24,13 +25,7 @@ typedef struct {
 #define TEMP_SENSOR_CMD_ENABLE_ALARM  4  /* 使能报警 */
 #define TEMP_SENSOR_CMD_DISABLE_ALARM 5  /* 禁用报警 */
 
-/* 温度传感器内存区域 */
-#define TEMP_SENSOR_REG_BASE    0x1000
-#define TEMP_SENSOR_REG_CURRENT 0x1000  /* 当前温度寄存器 */
-#define TEMP_SENSOR_REG_MIN     0x1004  /* 最低温度寄存器 */
-#define TEMP_SENSOR_REG_MAX     0x1008  /* 最高温度寄存器 */
-#define TEMP_SENSOR_REG_CTRL    0x100C  /* 控制寄存器 */
-#define TEMP_SENSOR_REG_SIZE    16      /* 寄存器区域大小 */
+/* 温度传感器寄存器定义由 temperature_sensor.regmap 生成，见 temperature_sensor_regs.h */
 
 /* 温度报警回调函数 */
 static int temperature_alarm_callback(const monitor_context_t *context, void *user_data) {
@@ -270,16 +265,25 @@ int main(void) {
         return 1;
     }
     
-    /* 写入初始温度 */
-    float temp = 25.0f;
-    uint32_t temp_value = *(uint32_t*)&temp;
-    ret = memory_write_word(region, TEMP_SENSOR_REG_CURRENT, temp_value);
+    /* 寄存器恢复为复位值（初始温度25.0度） */
+    ret = temp_sensor_regs_reset(region);
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "寄存器复位失败: %s\n", phymuti_error_string(ret));
+        phymuti_cleanup();
+        return 1;
+    }
+    
+    /* 使能报警 */
+    ret = temp_sensor_set_ctrl_alarm_en(region, 1);
     if (ret != PHYMUTI_SUCCESS) {
-        fprintf(stderr, "写入初始温度失败: %s\n", phymuti_error_string(ret));
+        fprintf(stderr, "使能报警失败: %s\n", phymuti_error_string(ret));
         phymuti_cleanup();
         return 1;
     }
     
+    float temp = 25.0f;
+    uint32_t temp_value;
+    
     /* 添加监视点 */
     monitor_id_t wp_id = monitor_add_watchpoint(region, TEMP_SENSOR_REG_CURRENT, 
                                               sizeof(uint32_t), WATCHPOINT_WRITE, 0);
@@ -375,7 +379,7 @@ int main(void) {
         printf("设置温度为 %.1f°C\n", temp);
         
         /* 写入新温度 */
-        ret = memory_write_word(region, TEMP_SENSOR_REG_CURRENT, temp_value);
+        ret = temp_sensor_write_current(region, temp_value);
         if (ret != PHYMUTI_SUCCESS) {
             fprintf(stderr, "写入温度失败: %s\n", phymuti_error_string(ret));
             break;
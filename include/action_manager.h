@@ -6,6 +6,7 @@
 #ifndef ACTION_MANAGER_H
 #define ACTION_MANAGER_H
 
+#include <stdio.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
@@ -22,11 +23,56 @@ typedef enum {
     ACTION_TYPE_CALLBACK,  /* 回调函数 */
     ACTION_TYPE_SCRIPT,    /* 脚本 */
     ACTION_TYPE_COMMAND,   /* 命令 */
+    ACTION_TYPE_BATCH_CALLBACK,  /* 批量回调函数 */
+    ACTION_TYPE_PLUGIN,    /* 共享库插件 */
 } action_type_t;
 
+/* 动作优先级，监视器一次分发中按优先级从高到低执行触发的动作 */
+typedef enum {
+    ACTION_PRIORITY_LOW,     /* 低优先级，如日志 */
+    ACTION_PRIORITY_NORMAL,  /* 普通优先级（默认） */
+    ACTION_PRIORITY_HIGH,    /* 高优先级，如安全保护，不受速率限制 */
+} action_priority_t;
+
+/* 令牌桶速率限制 */
+typedef struct {
+    uint32_t rate;    /* 每秒补充的令牌数，0表示不限制 */
+    uint32_t burst;   /* 桶容量，即允许的突发次数，0表示与rate相同 */
+} action_rate_limit_t;
+
+/* 速率限制统计信息 */
+typedef struct {
+    uint64_t executed;   /* 已执行的上下文数 */
+    uint64_t throttled;  /* 超过速率限制被丢弃的上下文数 */
+} action_rate_stats_t;
+
+/* 延迟直方图：小于ACTION_LATENCY_SUB_BUCKETS纳秒的每个值一个桶，
+   之后每个2的幂区间均分为ACTION_LATENCY_SUB_BUCKETS个桶，相对误差不超过12.5%，
+   最后一个桶收纳约2.4小时以上的执行 */
+#define ACTION_LATENCY_SUB_BUCKETS 8
+#define ACTION_LATENCY_BUCKETS     328
+
+/* 动作执行延迟统计 */
+typedef struct {
+    uint64_t invocations;   /* 执行次数（不含被限流丢弃的） */
+    uint64_t failures;      /* 返回错误的次数 */
+    uint64_t total_ns;      /* 总耗时（纳秒） */
+    uint64_t max_ns;        /* 最长一次的耗时（纳秒） */
+    uint64_t buckets[ACTION_LATENCY_BUCKETS];  /* 各延迟桶的次数 */
+} action_latency_stats_t;
+
+/* 异步执行的动作句柄 */
+typedef struct action_future_struct action_future_t;
+
+/* 无限等待 */
+#define ACTION_WAIT_FOREVER UINT32_MAX
+
 /* 动作回调函数类型 */
 typedef int (*action_callback_t)(const monitor_context_t *context, void *user_data);
 
+/* 批量动作回调函数类型，contexts为连续的count个上下文 */
+typedef int (*action_batch_callback_t)(const monitor_context_t *contexts, size_t count, void *user_data);
+
 /**
  * @brief 初始化动作管理器
  * 
@@ -50,6 +96,18 @@ int action_manager_cleanup(void);
  */
 action_id_t action_create_callback(action_callback_t callback, void *user_data);
 
+/**
+ * @brief 创建批量回调函数动作
+ * 
+ * 监视器把一次分发中（延迟模式下为监视线程处理的一轮日志中）触发同一动作的
+ * 所有上下文按触发顺序放入连续数组，只调用一次回调。单独执行时count为1。
+ * 
+ * @param callback 批量回调函数
+ * @param user_data 用户数据
+ * @return action_id_t 成功返回动作ID，失败返回ACTION_INVALID_ID
+ */
+action_id_t action_create_batch_callback(action_batch_callback_t callback, void *user_data);
+
 /**
  * @brief 创建脚本动作
  * 
@@ -66,6 +124,31 @@ action_id_t action_create_script(const char *script_path);
  */
 action_id_t action_create_command(const char *command);
 
+/**
+ * @brief 创建插件动作
+ * 
+ * 用dlopen()加载共享库并调用其ACTION_PLUGIN_ENTRY入口函数（见action_plugin.h），
+ * 接口版本不一致或init()失败时卸载共享库并返回ACTION_INVALID_ID。
+ * 批量执行时优先调用插件的execute_batch()。需要失败原因时使用action_load_plugin()。
+ * 
+ * @param path 共享库路径（按dlopen()的规则查找）
+ * @param args 传给插件init()的参数字符串，可以为NULL
+ * @return action_id_t 成功返回动作ID，失败返回ACTION_INVALID_ID
+ */
+action_id_t action_create_plugin(const char *path, const char *args);
+
+/**
+ * @brief 加载插件并创建插件动作，失败时以错误码说明原因
+ * 
+ * @param path 共享库路径（按dlopen()的规则查找）
+ * @param args 传给插件init()的参数字符串，可以为NULL
+ * @param id 成功时返回动作ID
+ * @return int 成功返回0；共享库无法加载返回PHYMUTI_ERROR_IO，
+ *         没有入口函数返回PHYMUTI_ERROR_NOT_FOUND，接口版本不匹配返回
+ *         PHYMUTI_ERROR_NOT_SUPPORTED，init()失败返回PHYMUTI_ERROR_ACTION_EXECUTE_FAILED
+ */
+int action_load_plugin(const char *path, const char *args, action_id_t *id);
+
 /**
  * @brief 销毁动作
  * 
@@ -83,6 +166,146 @@ int action_destroy(action_id_t id);
  */
 int action_execute(action_id_t id, const monitor_context_t *context);
 
+/**
+ * @brief 对一组上下文执行动作
+ * 
+ * 批量回调动作只调用一次回调，提供了execute_batch()的插件动作只调用一次该函数，
+ * 其他类型的动作按顺序对每个上下文执行一次。
+ * 
+ * @param id 动作ID
+ * @param contexts 监视点上下文数组
+ * @param count 上下文数量
+ * @return int 成功返回0，失败返回错误码（其他类型的动作返回第一个错误）
+ */
+int action_execute_batch(action_id_t id, const monitor_context_t *contexts, size_t count);
+
+/**
+ * @brief 提交动作异步执行
+ * 
+ * 动作由动作管理器的工作线程执行，调用者通过返回的句柄等待、查询或取消。
+ * 脚本和命令动作在独立的进程组中运行，超过timeout_ms或被取消时整个进程组被终止，
+ * 结果为PHYMUTI_ERROR_ACTION_TIMEOUT或PHYMUTI_ERROR_ACTION_CANCELLED；
+ * 回调和插件动作在进程内执行，无法中断，timeout_ms对它们无效。
+ * 句柄用完后必须调用action_future_destroy()释放。
+ * 
+ * @param id 动作ID
+ * @param context 监视点上下文（复制到句柄中）
+ * @param timeout_ms 脚本和命令动作的最长运行时间（毫秒），0表示不限制
+ * @return action_future_t* 成功返回句柄，失败返回NULL
+ */
+action_future_t* action_submit(action_id_t id, const monitor_context_t *context, uint32_t timeout_ms);
+
+/**
+ * @brief 等待异步执行的动作完成
+ * 
+ * @param future 句柄
+ * @param timeout_ms 最长等待时间（毫秒），ACTION_WAIT_FOREVER表示一直等待
+ * @param result 完成时返回动作的执行结果，可以为NULL
+ * @return int 已完成返回0，等待超时返回PHYMUTI_ERROR_TIMEOUT，失败返回错误码
+ */
+int action_future_wait(action_future_t *future, uint32_t timeout_ms, int *result);
+
+/**
+ * @brief 查询异步执行的动作是否完成，不等待
+ * 
+ * @param future 句柄
+ * @param done 返回是否已完成
+ * @param result 完成时返回动作的执行结果，可以为NULL
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_future_poll(action_future_t *future, bool *done, int *result);
+
+/**
+ * @brief 取消异步执行的动作
+ * 
+ * 尚未开始的动作不再执行；正在运行的脚本和命令动作被终止。
+ * 
+ * @param future 句柄
+ * @return int 成功取消返回0，已完成或正在进程内执行无法取消时返回PHYMUTI_ERROR_BUSY
+ */
+int action_future_cancel(action_future_t *future);
+
+/**
+ * @brief 释放句柄，动作尚未完成时先尝试取消
+ * 
+ * @param future 句柄
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_future_destroy(action_future_t *future);
+
+/**
+ * @brief 设置动作优先级
+ * 
+ * 监视器一次分发（延迟模式下为一轮日志）触发多个动作时先执行优先级高的动作。
+ * 高优先级动作总是执行，不受速率限制。
+ * 
+ * @param id 动作ID
+ * @param priority 优先级
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_set_priority(action_id_t id, action_priority_t priority);
+
+/**
+ * @brief 获取动作优先级
+ * 
+ * @param id 动作ID
+ * @param priority 优先级指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_get_priority(action_id_t id, action_priority_t *priority);
+
+/**
+ * @brief 设置动作的令牌桶速率限制
+ * 
+ * 每个上下文消耗一个令牌，令牌按rate每秒匀速补充，最多积累burst个；
+ * 没有令牌时丢弃该上下文并计入throttled，action_execute()返回
+ * PHYMUTI_ERROR_ACTION_THROTTLED。批量执行时只把有令牌的前若干个上下文交给动作。
+ * 设置后桶是满的。
+ * 
+ * @param id 动作ID
+ * @param limit 速率限制，为NULL时取消限制
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_set_rate_limit(action_id_t id, const action_rate_limit_t *limit);
+
+/**
+ * @brief 获取动作的速率限制统计信息
+ * 
+ * @param id 动作ID
+ * @param stats 统计信息指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_get_rate_stats(action_id_t id, action_rate_stats_t *stats);
+
+/**
+ * @brief 获取动作的执行延迟统计
+ * 
+ * 每次执行（批量动作每批一次）记录到执行线程自己的分片，读取时合并所有分片。
+ * 耗时从查找动作开始到动作返回为止，包括脚本和命令的子进程运行时间。
+ * 
+ * @param id 动作ID
+ * @param stats 统计信息指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_get_latency_stats(action_id_t id, action_latency_stats_t *stats);
+
+/**
+ * @brief 由延迟直方图估计百分位延迟
+ * 
+ * @param stats 延迟统计
+ * @param percentile 百分位（0到100）
+ * @return uint64_t 该百分位所在桶的上界（不超过max_ns），没有记录时返回0
+ */
+uint64_t action_latency_percentile(const action_latency_stats_t *stats, double percentile);
+
+/**
+ * @brief 以文本形式输出所有动作的执行延迟，按99百分位从高到低排列
+ * 
+ * @param out 输出文件
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_dump_latency_stats(FILE *out);
+
 /**
  * @brief 获取动作类型
  * 
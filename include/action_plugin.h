@@ -0,0 +1,51 @@
+/**
+ * @file action_plugin.h
+ * @brief 动作插件接口头文件
+ *
+ * 插件是一个共享库，导出名为ACTION_PLUGIN_ENTRY的入口函数，返回描述插件的
+ * action_plugin_t。action_create_plugin()用dlopen()加载共享库，检查接口版本后
+ * 调用init()创建插件状态；动作执行时直接调用execute()/execute_batch()，
+ * 销毁动作时调用teardown()并卸载共享库。
+ *
+ * 插件只通过监视点上下文与模拟器交互，编译时只需要本头文件，不需要链接PhyMuTi库。
+ * 多个访问线程可能同时执行同一个插件动作，execute()和execute_batch()必须可重入。
+ */
+
+#ifndef ACTION_PLUGIN_H
+#define ACTION_PLUGIN_H
+
+#include <stddef.h>
+#include "monitor.h"
+
+/* 插件接口版本，结构体布局或函数语义变化时加一 */
+#define ACTION_PLUGIN_ABI_VERSION 1
+
+/* 插件入口函数名 */
+#define ACTION_PLUGIN_ENTRY "phymuti_action_plugin"
+
+/* 插件描述 */
+typedef struct {
+    unsigned abi_version;   /* 编译插件时的ACTION_PLUGIN_ABI_VERSION */
+    const char *name;       /* 插件名称 */
+
+    /**
+     * 创建插件状态（可选）
+     * args为action_create_plugin()传入的参数字符串（可能为NULL），
+     * 返回0表示成功，否则动作创建失败且不会调用teardown()
+     */
+    int (*init)(const char *args, void **state);
+
+    /* 对一个上下文执行动作（必需），返回0表示成功 */
+    int (*execute)(void *state, const monitor_context_t *context);
+
+    /* 对一组连续的上下文执行动作（可选），未提供时逐个调用execute() */
+    int (*execute_batch)(void *state, const monitor_context_t *contexts, size_t count);
+
+    /* 释放插件状态（可选） */
+    void (*teardown)(void *state);
+} action_plugin_t;
+
+/* 插件入口函数类型 */
+typedef const action_plugin_t *(*action_plugin_entry_t)(void);
+
+#endif /* ACTION_PLUGIN_H */
@@ -0,0 +1,135 @@
+/**
+ * @file checkpoint.h
+ * @brief 检查点模块头文件
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "memory_manager.h"
+
+/* 检查点文件魔数和版本 */
+#define CHECKPOINT_FILE_MAGIC   "PHYCKPT"
+#define CHECKPOINT_FILE_VERSION 1
+
+/* 父检查点路径最大长度 */
+#define CHECKPOINT_PATH_MAX 256
+
+/* 名称最大长度 */
+#define CHECKPOINT_NAME_MAX 64
+
+/* 检查点类型 */
+typedef enum {
+    CHECKPOINT_FULL,         /* 完整检查点，保存全部内容 */
+    CHECKPOINT_INCREMENTAL   /* 增量检查点，只保存相对父检查点变化的页和设备状态 */
+} checkpoint_kind_t;
+
+/* 内存区域数据编码 */
+typedef enum {
+    CHECKPOINT_REGION_RAW,   /* 原始数据，在文件中按MEMORY_PAGE_SIZE对齐 */
+    CHECKPOINT_REGION_DELTA  /* 变化页列表，每页为与父检查点的异或结果的游程编码 */
+} checkpoint_region_encoding_t;
+
+/* 检查点文件头 */
+typedef struct {
+    char magic[8];                          /* 魔数，CHECKPOINT_FILE_MAGIC */
+    uint32_t version;                       /* 文件格式版本 */
+    uint32_t kind;                          /* 检查点类型（checkpoint_kind_t） */
+    uint64_t id;                            /* 检查点ID */
+    uint64_t parent_id;                     /* 父检查点ID，完整检查点为0 */
+    uint32_t region_count;                  /* 内存区域数 */
+    uint32_t device_count;                  /* 设备数 */
+    uint32_t depth;                         /* 距完整检查点的增量层数 */
+    uint32_t reserved;                      /* 保留 */
+    char parent_path[CHECKPOINT_PATH_MAX];  /* 父检查点路径 */
+} checkpoint_file_header_t;
+
+/* 内存区域表项，紧跟在文件头之后 */
+typedef struct {
+    uint32_t id;                            /* 内存区域ID */
+    uint32_t flags;                         /* 内存区域标志 */
+    uint32_t encoding;                      /* 数据编码（checkpoint_region_encoding_t） */
+    uint32_t page_records;                  /* 增量编码的页记录数 */
+    uint64_t base_addr;                     /* 基地址 */
+    uint64_t size;                          /* 大小（字节） */
+    uint64_t data_offset;                   /* 数据在文件中的偏移 */
+    uint64_t data_length;                   /* 数据长度 */
+    char name[CHECKPOINT_NAME_MAX];         /* 内存区域名称 */
+} checkpoint_region_entry_t;
+
+/* 增量编码的页记录头，其后为编码数据 */
+typedef struct {
+    uint32_t page;                          /* 页号 */
+    uint32_t length;                        /* 编码数据长度 */
+} checkpoint_page_record_t;
+
+/* 设备表项，紧跟在内存区域表之后 */
+typedef struct {
+    char name[CHECKPOINT_NAME_MAX];         /* 设备名称 */
+    uint32_t present;                       /* 1：本文件保存了状态；0：与父检查点相同 */
+    uint32_t reserved;                      /* 保留 */
+    uint64_t data_offset;                   /* 状态在文件中的偏移 */
+    uint64_t data_length;                   /* 状态长度 */
+} checkpoint_device_entry_t;
+
+/**
+ * @brief 清理检查点模块资源
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+int checkpoint_cleanup(void);
+
+/**
+ * @brief 保存完整检查点
+ *
+ * 保存所有内存区域内容和所有设备的save_state状态，并作为之后增量检查点的父检查点。
+ * 模块保留一份区域内容的副本用于计算增量。应在没有其他线程写入时调用。
+ *
+ * @param path 检查点文件路径
+ * @return int 成功返回0，失败返回错误码
+ */
+int checkpoint_save(const char *path);
+
+/**
+ * @brief 保存增量检查点
+ *
+ * 只保存自上一个检查点（保存或恢复的）以来变化的页和设备状态。
+ * 页内容以与父检查点的异或结果做游程编码，未变化的字节几乎不占空间。
+ * 保存失败后必须先保存完整检查点或恢复检查点，才能继续保存增量检查点。
+ *
+ * @param path 检查点文件路径
+ * @return int 成功返回0，没有父检查点时返回PHYMUTI_ERROR_CHECKPOINT_NO_PARENT
+ */
+int checkpoint_save_incremental(const char *path);
+
+/**
+ * @brief 恢复检查点
+ *
+ * 沿父检查点链从完整检查点开始依次应用增量，然后写入内存区域
+ * （按ID匹配，基地址和大小必须相同）并调用设备的load_state（按名称匹配）。
+ * 恢复不触发监视点。恢复后的检查点成为之后增量检查点的父检查点。
+ * 恢复前先处理完延迟监视日志。私有区域可能原地替换为检查点文件的映射，
+ * 恢复期间的并发访问不会崩溃，但可能读到恢复前的内容，写入也可能丢失，
+ * 需要一致的状态时应在恢复前停止访问。
+ *
+ * @param path 检查点文件路径
+ * @return int 成功返回0，失败返回错误码
+ */
+int checkpoint_restore(const char *path);
+
+/**
+ * @brief 压缩检查点链
+ *
+ * 把以path结尾的检查点链合并为一个等价的完整检查点，之后可删除链中的旧文件。
+ * 不影响当前模拟系统。
+ *
+ * @param path 检查点文件路径
+ * @param out_path 输出的完整检查点路径
+ * @return int 成功返回0，失败返回错误码
+ */
+int checkpoint_compact(const char *path, const char *out_path);
+
+#endif /* CHECKPOINT_H */
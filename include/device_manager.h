@@ -40,6 +40,9 @@ typedef struct {
     int (*ioctl)(device_handle_t device, int cmd, void *arg);
 } device_ops_t;
 
+/* 设备访问函数类型，返回非0时停止遍历 */
+typedef int (*device_visit_fn_t)(device_handle_t device, void *user_data);
+
 /**
  * @brief 初始化设备管理器
  * 
@@ -98,6 +101,15 @@ int device_destroy(device_handle_t device);
  */
 device_handle_t device_find_by_name(const char *name);
 
+/**
+ * @brief 遍历所有设备
+ * 
+ * @param visit 访问函数，返回非0时停止遍历
+ * @param user_data 用户数据
+ * @return int 成功返回0，访问函数返回非0时返回该值，失败返回错误码
+ */
+int device_foreach(device_visit_fn_t visit, void *user_data);
+
 /**
  * @brief 重置设备
  * 
@@ -116,6 +128,18 @@ int device_reset(device_handle_t device);
  */
 int device_save_state(device_handle_t device, void *buffer, size_t *size);
 
+/**
+ * @brief 保存设备状态到新分配的缓冲区
+ * 
+ * 先以空缓冲区查询所需大小，再分配缓冲区保存。
+ * 
+ * @param device 设备句柄
+ * @param buffer 返回状态缓冲区，由调用者free()
+ * @param size 返回状态大小
+ * @return int 成功返回0，设备不支持保存状态时返回PHYMUTI_ERROR_NOT_SUPPORTED
+ */
+int device_save_state_alloc(device_handle_t device, void **buffer, size_t *size);
+
 /**
  * @brief 加载设备状态
  * 
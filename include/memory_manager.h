@@ -29,6 +29,74 @@ typedef enum {
 /* 内存区域结构体 */
 typedef struct memory_region_struct memory_region_t;
 
+/* 无效的内存区域ID */
+#define MEMORY_REGION_INVALID_ID 0
+
+/* 区域监视状态（由监视器维护） */
+#define MEMORY_WATCH_ACTIVE    (1 << 0)  /* 区域上有启用的监视点 */
+#define MEMORY_WATCH_OLD_VALUE (1 << 1)  /* 有写监视点需要写入前的值 */
+
+/* 内容哈希和脏页跟踪的页大小（字节） */
+#define MEMORY_PAGE_SIZE 4096
+
+/* 内存区域访问函数类型，返回非0时停止遍历 */
+typedef int (*memory_region_visit_fn_t)(memory_region_t *region, void *user_data);
+
+/* 共享内存对象的魔数和版本 */
+#define MEMORY_SHARED_MAGIC   "PHYSHMEM"
+#define MEMORY_SHARED_VERSION 1
+
+/* 共享内存对象中数据相对对象起始的偏移（页对齐） */
+#define MEMORY_SHARED_DATA_OFFSET 4096
+
+/* 共享内存对象头部，位于对象起始处 */
+typedef struct {
+    char magic[8];       /* 魔数，MEMORY_SHARED_MAGIC */
+    uint32_t version;    /* 格式版本 */
+    uint32_t flags;      /* 内存区域标志 */
+    uint64_t base_addr;  /* 基地址 */
+    uint64_t size;       /* 数据大小（字节） */
+    uint32_t sequence;   /* 写序列号，奇数表示正在写入，见memory_write_begin() */
+    uint32_t reserved;   /* 保留 */
+    char name[64];       /* 内存区域名称 */
+} memory_shared_header_t;
+
+/* 其他进程中的只读映射视图 */
+typedef struct {
+    const memory_shared_header_t *header;  /* 对象头部 */
+    const uint8_t *data;                   /* 区域数据，data[addr - base_addr] */
+    uint64_t base_addr;                    /* 基地址 */
+    size_t size;                           /* 数据大小（字节） */
+    void *map;                             /* 映射起始地址 */
+    size_t map_size;                       /* 映射大小 */
+} memory_shared_view_t;
+
+/* 访问热图的统计粒度（字节，一个缓存行） */
+#define MEMORY_HEATMAP_LINE_SIZE 64
+
+/* 热图导出文件的魔数和版本 */
+#define MEMORY_HEATMAP_MAGIC   "PHYHEAT"
+#define MEMORY_HEATMAP_VERSION 1
+
+/* 热图中一行的计数 */
+typedef struct {
+    uint64_t reads;   /* 读次数 */
+    uint64_t writes;  /* 写次数 */
+} memory_heatmap_line_t;
+
+/* 热图导出文件头部，其后依次是line_count个memory_heatmap_line_t（本机字节序） */
+typedef struct {
+    char magic[8];        /* 魔数，MEMORY_HEATMAP_MAGIC */
+    uint32_t version;     /* 格式版本 */
+    uint32_t line_size;   /* 行大小（字节），MEMORY_HEATMAP_LINE_SIZE */
+    uint32_t region_id;   /* 内存区域ID */
+    uint32_t reserved;    /* 保留 */
+    uint64_t base_addr;   /* 基地址 */
+    uint64_t size;        /* 区域大小（字节） */
+    uint64_t line_count;  /* 行数 */
+    char name[64];        /* 内存区域名称 */
+} memory_heatmap_header_t;
+
 /**
  * @brief 初始化内存管理器
  * 
@@ -56,6 +124,26 @@ int memory_manager_cleanup(void);
 memory_region_t* memory_region_create(device_handle_t device, const char *name, 
                                      uint64_t base_addr, size_t size, uint32_t flags);
 
+/**
+ * @brief 创建以共享内存为后备存储的内存区域
+ * 
+ * 区域数据存放在POSIX共享内存对象中，其他本地进程可通过
+ * memory_shared_map()按名称只读映射，直接读取实时内容而无需拷贝或进程间通信。
+ * 读取方式与memory_region_create()创建的区域完全相同。
+ * 对象在区域销毁时删除。
+ * 
+ * @param device 关联的设备句柄
+ * @param name 内存区域名称
+ * @param base_addr 基地址
+ * @param size 大小（字节）
+ * @param flags 标志
+ * @param shm_name 共享内存对象名称（如"/phymuti_ram"，开头的'/'可省略），已存在时失败
+ * @return memory_region_t* 成功返回内存区域指针，失败返回NULL
+ */
+memory_region_t* memory_region_create_shared(device_handle_t device, const char *name, 
+                                             uint64_t base_addr, size_t size, uint32_t flags,
+                                             const char *shm_name);
+
 /**
  * @brief 销毁内存区域
  * 
@@ -73,6 +161,49 @@ int memory_region_destroy(memory_region_t *region);
  */
 memory_region_t* memory_region_find(device_handle_t device, const char *name);
 
+/**
+ * @brief 通过ID查找内存区域
+ * 
+ * 内存区域ID在memory_manager_init()之后按创建顺序从1开始分配，
+ * 以相同顺序重建的模拟系统得到相同的ID。
+ * 
+ * @param id 内存区域ID
+ * @return memory_region_t* 成功返回内存区域指针，失败返回NULL
+ */
+memory_region_t* memory_region_find_by_id(uint32_t id);
+
+/**
+ * @brief 遍历所有内存区域
+ * 
+ * 遍历期间持有内存区域链表的锁，访问函数中不能创建、销毁或查找内存区域。
+ * 
+ * @param visit 访问函数，返回非0时停止遍历
+ * @param user_data 用户数据
+ * @return int 成功返回0，访问函数返回非0时返回该值，失败返回错误码
+ */
+int memory_region_foreach(memory_region_visit_fn_t visit, void *user_data);
+
+/**
+ * @brief 计算内存区域内容的哈希
+ * 
+ * 64位非加密哈希，相同内容在任何机器上得到相同结果。每页的哈希被缓存，
+ * 写入使所在页的缓存失效，再次计算时只处理写过的页。
+ * 计算时不应有其他线程并发写入该区域，否则结果不确定。
+ * 
+ * @param region 内存区域指针
+ * @param hash 返回哈希值
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_hash(memory_region_t *region, uint64_t *hash);
+
+/**
+ * @brief 获取内存区域ID
+ * 
+ * @param region 内存区域指针
+ * @return uint32_t 内存区域ID
+ */
+uint32_t memory_region_get_id(const memory_region_t *region);
+
 /**
  * @brief 获取内存区域名称
  * 
@@ -105,6 +236,25 @@ size_t memory_region_get_size(const memory_region_t *region);
  */
 uint32_t memory_region_get_flags(const memory_region_t *region);
 
+/**
+ * @brief 获取内存区域的监视状态
+ * 
+ * 访问路径用它跳过没有监视点的区域，不加锁。
+ * 
+ * @param region 内存区域指针
+ * @return uint32_t MEMORY_WATCH_*标志
+ */
+uint32_t memory_region_get_watch_flags(const memory_region_t *region);
+
+/**
+ * @brief 设置内存区域的监视状态（供监视器使用）
+ * 
+ * @param region 内存区域指针
+ * @param flags MEMORY_WATCH_*标志
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_set_watch_flags(memory_region_t *region, uint32_t flags);
+
 /**
  * @brief 获取内存区域关联的设备
  * 
@@ -113,6 +263,225 @@ uint32_t memory_region_get_flags(const memory_region_t *region);
  */
 device_handle_t memory_region_get_device(const memory_region_t *region);
 
+/**
+ * @brief 获取内存区域的共享内存对象名称
+ * 
+ * @param region 内存区域指针
+ * @return const char* 共享内存对象名称，区域未共享时返回NULL
+ */
+const char* memory_region_get_shared_name(const memory_region_t *region);
+
+/**
+ * @brief 以只读方式映射导出的内存区域
+ * 
+ * 供其他进程（如外部监控面板、测试程序）使用，不需要初始化PhyMuTi系统。
+ * 映射后的数据随模拟器写入实时变化，不经过监视器。
+ * 
+ * @param shm_name 共享内存对象名称
+ * @param view 映射视图
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_shared_map(const char *shm_name, memory_shared_view_t *view);
+
+/**
+ * @brief 解除导出内存区域的映射
+ * 
+ * @param view 映射视图
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_shared_unmap(memory_shared_view_t *view);
+
+/**
+ * @brief 在共享内存映射视图上读取一致的快照
+ * 
+ * 与memory_read_snapshot()相同的无锁重试读取，供其他进程使用。
+ * 
+ * @param view 映射视图
+ * @param addr 地址
+ * @param buffer 缓冲区
+ * @param size 大小（字节）
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_shared_read_snapshot(const memory_shared_view_t *view, uint64_t addr,
+                                void *buffer, size_t size);
+
+/**
+ * @brief 用同一字节填充内存块
+ * 
+ * 直接写入区域存储，不经过中间缓冲区，监视器收到一次块写入通知（值为填充字节）。
+ * 
+ * @param region 内存区域指针
+ * @param addr 起始地址
+ * @param value 填充字节
+ * @param size 大小（字节）
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_fill(memory_region_t *region, uint64_t addr, uint8_t value, size_t size);
+
+/**
+ * @brief 将内存块与期望内容比较
+ * 
+ * 直接比较区域存储与expected，使用向量指令（运行时按CPU选择）。
+ * 
+ * @param region 内存区域指针
+ * @param addr 起始地址
+ * @param expected 期望内容
+ * @param size 大小（字节）
+ * @param equal 返回是否完全相同
+ * @param diff_addr 返回第一个不同字节的地址，可为NULL，相同时不修改
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_compare(memory_region_t *region, uint64_t addr, const void *expected, size_t size,
+                   bool *equal, uint64_t *diff_addr);
+
+/**
+ * @brief 在内存范围内查找字节序列
+ * 
+ * @param region 内存区域指针
+ * @param addr 搜索起始地址
+ * @param size 搜索范围大小（字节）
+ * @param pattern 字节序列
+ * @param pattern_len 字节序列长度
+ * @param found_addr 返回第一次出现的地址
+ * @return int 成功返回0，未找到返回PHYMUTI_ERROR_NOT_FOUND，失败返回错误码
+ */
+int memory_find_pattern(memory_region_t *region, uint64_t addr, size_t size,
+                        const void *pattern, size_t pattern_len, uint64_t *found_addr);
+
+/**
+ * @brief 开始一组需要整体可见的写入
+ * 
+ * 递增区域的写序列号（变为奇数），之后的写入在memory_write_end()之前
+ * 对memory_read_snapshot()不可见为部分结果。写者不等待任何读者。
+ * 同一区域同一时刻只能有一个写者处于begin/end之间，不可嵌套。
+ * 
+ * @param region 内存区域指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_write_begin(memory_region_t *region);
+
+/**
+ * @brief 结束一组写入，使其对快照读取者整体可见
+ * 
+ * @param region 内存区域指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_write_end(memory_region_t *region);
+
+/**
+ * @brief 无锁读取内存块的一致快照
+ * 
+ * 读取期间若有写者处于memory_write_begin()/memory_write_end()之间，
+ * 则重试，保证读到的多个寄存器来自同一次完整更新。
+ * 不在begin/end之间的单独写入不受保护。
+ * 
+ * @param region 内存区域指针
+ * @param addr 地址
+ * @param buffer 缓冲区
+ * @param size 大小（字节）
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_read_snapshot(memory_region_t *region, uint64_t addr, void *buffer, size_t size);
+
+/*
+ * 以下函数供检查点等需要整体保存和恢复区域内容的模块使用，
+ * 直接访问区域存储，不检查访问权限，也不通知监视器。
+ */
+
+/**
+ * @brief 获取内存区域数据的只读指针
+ * 
+ * @param region 内存区域指针
+ * @return const uint8_t* 数据指针，data[addr - base_addr]
+ */
+const uint8_t* memory_region_data(const memory_region_t *region);
+
+/**
+ * @brief 取出并清除检查点脏页位图
+ * 
+ * 返回自上次调用以来被写过的页（MEMORY_PAGE_SIZE），新建区域的所有页都视为脏页。
+ * 
+ * @param region 内存区域指针
+ * @param bitmap 返回位图，至少(页数 + 63) / 64个元素
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_take_dirty_pages(memory_region_t *region, uint64_t *bitmap);
+
+/**
+ * @brief 开启内存区域的访问热图，清除之前的计数
+ * 
+ * 开启后memory_read_*、memory_write_*及块操作按MEMORY_HEATMAP_LINE_SIZE字节一行
+ * 精确统计读写次数（块访问在涉及的每一行各计一次），计数用relaxed原子操作更新；
+ * 未开启的区域在访问路径上只多一次原子读取。计数数组在首次开启时分配，
+ * 关闭后保留，直到内存区域销毁。
+ * 
+ * @param region 内存区域指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_enable_heatmap(memory_region_t *region);
+
+/**
+ * @brief 关闭内存区域的访问热图，计数保留以便读取和导出
+ * 
+ * @param region 内存区域指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_disable_heatmap(memory_region_t *region);
+
+/**
+ * @brief 读取内存区域的访问热图
+ * 
+ * 开启期间也可以调用，各行计数分别读取，不是同一时刻的快照。
+ * 
+ * @param region 内存区域指针
+ * @param lines 输出数组，第i个元素对应基地址起第i行，为NULL时只返回行数
+ * @param max_lines 数组容量
+ * @param count 返回区域的总行数
+ * @return int 成功返回0，从未开启过热图返回PHYMUTI_ERROR_NOT_FOUND，失败返回错误码
+ */
+int memory_region_get_heatmap(memory_region_t *region, memory_heatmap_line_t *lines,
+                              size_t max_lines, size_t *count);
+
+/**
+ * @brief 将内存区域的访问热图导出为二进制文件
+ * 
+ * 文件格式为memory_heatmap_header_t加各行计数。
+ * 
+ * @param region 内存区域指针
+ * @param path 文件路径
+ * @return int 成功返回0，从未开启过热图返回PHYMUTI_ERROR_NOT_FOUND，失败返回错误码
+ */
+int memory_region_dump_heatmap(memory_region_t *region, const char *path);
+
+/**
+ * @brief 直接装入内存区域数据
+ * 
+ * 写入期间持有区域的写序列号（见memory_write_begin()），并使相关页的哈希失效。
+ * 
+ * @param region 内存区域指针
+ * @param offset 相对基地址的偏移
+ * @param data 数据
+ * @param size 大小（字节）
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_load(memory_region_t *region, size_t offset, const void *data, size_t size);
+
+/**
+ * @brief 把内存区域内容替换为文件的私有映射
+ * 
+ * 区域内容变为文件从offset开始的数据，页在首次访问时才从文件读入，
+ * 写入采用写时复制，不影响文件。映射期间文件不能被截断或原地修改。
+ * 只支持私有区域，offset必须按系统页对齐。新映射原子地替换原地址上的旧映射，
+ * memory_region_data()返回的指针不变；调用期间并发的访问读到旧内容或新内容，
+ * 写入可能丢失，但不会访问未映射的内存。
+ * 
+ * @param region 内存区域指针
+ * @param fd 以可读方式打开的文件描述符，调用后可关闭
+ * @param offset 区域内容在文件中的偏移
+ * @return int 成功返回0，共享区域或offset未对齐返回PHYMUTI_ERROR_NOT_SUPPORTED
+ */
+int memory_region_map_file(memory_region_t *region, int fd, uint64_t offset);
+
 /**
  * @brief 读取内存字节
  * 
@@ -25,6 +25,96 @@ typedef enum {
     WATCHPOINT_VALUE_WRITE = 4, /* 特定值写入监视点 */
 } watchpoint_type_t;
 
+/* 监视点值谓词类型 */
+typedef enum {
+    WATCHPOINT_PRED_NONE = 0,      /* 不过滤 */
+    WATCHPOINT_PRED_MASK_EQ,       /* (值 & mask) == (operand & mask) */
+    WATCHPOINT_PRED_RANGE_U,       /* lo.u <= 值 <= hi.u（无符号） */
+    WATCHPOINT_PRED_RANGE_S,       /* lo.s <= 值 <= hi.s（按访问大小符号扩展） */
+    WATCHPOINT_PRED_RANGE_F,       /* lo.f <= 值 <= hi.f（4字节为float，8字节为double） */
+    WATCHPOINT_PRED_BITS_SET,      /* mask中有位由0变为1（仅写入） */
+    WATCHPOINT_PRED_BITS_CLEARED,  /* mask中有位由1变为0（仅写入） */
+    WATCHPOINT_PRED_CHANGED,       /* mask中有位与写入前不同（仅写入） */
+} watchpoint_predicate_kind_t;
+
+/* 监视点值谓词 */
+typedef struct {
+    watchpoint_predicate_kind_t kind;  /* 谓词类型 */
+    uint64_t mask;                     /* 参与比较的位，为0时表示访问宽度内的全部位 */
+    uint64_t operand;                  /* WATCHPOINT_PRED_MASK_EQ的比较值 */
+    union {
+        uint64_t u;
+        int64_t s;
+        double f;
+    } lo, hi;                          /* 范围谓词的闭区间 */
+    bool negate;                       /* 结果取反，如“不在范围内” */
+} watchpoint_predicate_t;
+
+/* 监视点触发方式 */
+typedef enum {
+    WATCHPOINT_TRIGGER_ALWAYS = 0,  /* 每次命中都执行动作 */
+    WATCHPOINT_TRIGGER_EVERY_NTH,   /* 每第count次命中执行一次 */
+    WATCHPOINT_TRIGGER_THRESHOLD,   /* window_ns纳秒的时间窗口内命中数达到count时执行一次 */
+} watchpoint_trigger_mode_t;
+
+/* 监视点触发设置 */
+typedef struct {
+    watchpoint_trigger_mode_t mode;  /* 触发方式 */
+    uint64_t count;                  /* EVERY_NTH的N，THRESHOLD的阈值 */
+    uint64_t window_ns;              /* THRESHOLD的时间窗口（纳秒，单调时钟） */
+} watchpoint_trigger_t;
+
+/* 合并触发使用的时钟 */
+typedef enum {
+    MONITOR_CLOCK_REAL = 0,     /* 真实时间（单调时钟） */
+    MONITOR_CLOCK_SIMULATED,    /* 模拟时间，由monitor_set_simulated_time()推进 */
+} monitor_clock_t;
+
+/* 监视点触发合并方式 */
+typedef enum {
+    WATCHPOINT_COALESCE_NONE = 0,  /* 不合并 */
+    WATCHPOINT_COALESCE_LEADING,   /* 前沿：窗口内只执行第一次，窗口从该次开始 */
+    WATCHPOINT_COALESCE_TRAILING,  /* 后沿：窗口内的触发合并为一次，窗口结束后以最后一次的上下文执行 */
+    WATCHPOINT_COALESCE_BOTH,      /* 前沿立即执行，窗口内还有触发时在窗口结束后以最后一次的上下文再执行一次 */
+    WATCHPOINT_COALESCE_MAX_RATE,  /* 每个窗口最多执行max_events次，其余丢弃 */
+} watchpoint_coalesce_mode_t;
+
+/* 监视点触发合并设置 */
+typedef struct {
+    watchpoint_coalesce_mode_t mode;  /* 合并方式 */
+    uint64_t window_ns;               /* 窗口长度（纳秒） */
+    uint32_t max_events;              /* MAX_RATE每个窗口最多执行的次数 */
+    monitor_clock_t clock;            /* 窗口使用的时钟 */
+} watchpoint_coalesce_t;
+
+/* 监视点计数器 */
+typedef struct {
+    monitor_id_t id;   /* 监视点ID */
+    uint64_t hits;     /* 命中次数（地址、类型和值谓词都匹配） */
+    uint64_t fired;    /* 执行动作的次数 */
+} monitor_counter_t;
+
+/* 延迟监视配置 */
+typedef struct {
+    size_t log_entries;          /* 每线程访问日志容量（条） */
+    uint32_t batch_size;         /* 监视线程每批匹配的条数 */
+    uint32_t max_latency_us;     /* 监视线程的处理间隔（微秒），即通知的最大延迟 */
+} monitor_deferred_config_t;
+
+/* 默认配置 */
+#define MONITOR_DEFAULT_LOG_ENTRIES    16384
+#define MONITOR_DEFAULT_BATCH_SIZE     256
+#define MONITOR_DEFAULT_MAX_LATENCY_US 1000
+
+/* 延迟监视统计信息 */
+typedef struct {
+    uint64_t logged;      /* 写入访问日志的条数 */
+    uint64_t dispatched;  /* 已匹配监视点的条数 */
+    uint64_t batches;     /* 监视线程处理的批数 */
+    uint64_t stalls;      /* 日志已满、访问线程等待监视线程的次数 */
+    uint32_t threads;     /* 使用访问日志的线程数 */
+} monitor_deferred_stats_t;
+
 /* 监视点上下文 */
 typedef struct {
     memory_region_t *region;  /* 内存区域 */
@@ -32,6 +122,8 @@ typedef struct {
     uint32_t size;            /* 大小 */
     uint64_t value;           /* 值 */
     memory_access_type_t access_type;  /* 访问类型 */
+    uint64_t old_value;       /* 写入前的值，has_old_value为true时有效 */
+    bool has_old_value;       /* 是否捕获了写入前的值 */
 } monitor_context_t;
 
 /**
@@ -51,6 +143,11 @@ int monitor_cleanup(void);
 /**
  * @brief 添加监视点
  * 
+ * 监视范围可以是任意长度（如整个描述符环或FIFO），与范围重叠的访问都会触发。
+ * 监视点按区间树索引，每次访问的匹配开销为O((匹配数 + 1) * log n)，
+ * n为同一区域的监视点数，宽范围的监视点不会使其他访问变慢。
+ * 添加时复制并重建整个索引，开销为O(n)，适合在配置阶段而不是访问路径上调用。
+ * 
  * @param region 内存区域
  * @param addr 地址
  * @param size 大小（字节）
@@ -61,9 +158,137 @@ int monitor_cleanup(void);
 monitor_id_t monitor_add_watchpoint(memory_region_t *region, uint64_t addr, 
                                    uint32_t size, watchpoint_type_t type, uint64_t wpvalue);
 
+/**
+ * @brief 设置监视点的值谓词
+ * 
+ * 谓词在监视器内部求值，不满足的访问不会执行任何绑定的动作。
+ * 只对1、2、4、8字节的访问求值，块访问不满足任何谓词；
+ * 位变化和值变化谓词需要写入前的值，只对写入求值。
+ * 
+ * @param id 监视点ID
+ * @param predicate 谓词，为NULL时清除
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_set_predicate(monitor_id_t id, const watchpoint_predicate_t *predicate);
+
+/**
+ * @brief 设置是否为监视点捕获写入前的值
+ * 
+ * 启用后覆盖该监视点的1、2、4、8字节写入会在写入前读取原值，
+ * 并通过monitor_context_t的old_value传给动作。
+ * 区域上没有需要原值的监视点时，写入不读取原值。
+ * 
+ * @param id 监视点ID
+ * @param enable 是否启用
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_set_capture_old_value(monitor_id_t id, bool enable);
+
+/**
+ * @brief 设置监视点的触发方式
+ * 
+ * 命中始终计入计数器，只有满足触发方式时才执行绑定的动作。
+ * 设置后EVERY_NTH和THRESHOLD从零开始计数。
+ * 
+ * @param id 监视点ID
+ * @param trigger 触发设置，为NULL时恢复为每次命中都执行
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_set_trigger(monitor_id_t id, const watchpoint_trigger_t *trigger);
+
+/**
+ * @brief 设置监视点的触发合并方式
+ * 
+ * 合并在monitor_notify_memory_access()中、动作排队之前进行，
+ * 轮询寄存器等高频触发只执行少量动作。后沿合并的触发在窗口结束后的下一次触发、
+ * monitor_flush_coalesced()或phymuti_process_events()时执行。
+ * 
+ * @param id 监视点ID
+ * @param coalesce 合并设置，为NULL时不合并；未执行的后沿触发被丢弃
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_set_coalesce(monitor_id_t id, const watchpoint_coalesce_t *coalesce);
+
+/**
+ * @brief 执行窗口已结束的后沿合并触发
+ * 
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_flush_coalesced(void);
+
+/**
+ * @brief 切换同步或延迟监视模式
+ * 
+ * 延迟模式下，内存访问只把(区域, 地址, 大小, 值, 类型)追加到本线程的无锁访问日志，
+ * 由监视线程按批匹配监视点并执行动作，动作在监视线程中执行。
+ * 一轮日志匹配完后按动作合批执行，批量回调动作每轮只调用一次。
+ * 访问不会丢失：日志已满时访问线程等待监视线程处理。
+ * 同一线程的访问按原顺序匹配，不同线程之间不保证顺序。
+ * 只有区域上有启用的监视点时才记录日志。不能在动作中调用。
+ * 
+ * @param config 延迟监视配置，为NULL时切换回同步模式并处理完剩余日志
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_set_deferred(const monitor_deferred_config_t *config);
+
+/**
+ * @brief 立即处理所有访问日志
+ * 
+ * 返回时调用前记录的访问都已匹配，相应的动作都已执行。同步模式下直接返回。
+ * 
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_drain_deferred(void);
+
+/**
+ * @brief 获取延迟监视统计信息
+ * 
+ * 同步模式下返回上一次延迟监视结束时的统计信息。
+ * 
+ * @param stats 统计信息
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_get_deferred_stats(monitor_deferred_stats_t *stats);
+
+/**
+ * @brief 设置模拟时间
+ * 
+ * @param time_ns 模拟时间（纳秒），应单调不减
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_set_simulated_time(uint64_t time_ns);
+
+/**
+ * @brief 获取模拟时间
+ * 
+ * @return uint64_t 模拟时间（纳秒）
+ */
+uint64_t monitor_get_simulated_time(void);
+
+/**
+ * @brief 一次读取所有监视点的计数器
+ * 
+ * 没有绑定动作的监视点也计数，可以直接用作访问计数器。
+ * 
+ * @param counters 输出数组，可以为NULL
+ * @param capacity 数组容量
+ * @param count 返回监视点总数，可能大于capacity
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_get_counters(monitor_counter_t *counters, size_t capacity, size_t *count);
+
+/**
+ * @brief 把所有监视点的计数器清零
+ * 
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_reset_counters(void);
+
 /**
  * @brief 删除监视点
  * 
+ * 与添加相同，删除时复制并重建整个索引，开销为O(n)。
+ * 
  * @param id 监视点ID
  * @return int 成功返回0，失败返回错误码
  */
@@ -130,4 +355,29 @@ int monitor_notify_memory_access(memory_region_t *region, uint64_t addr,
                                 uint32_t size, uint64_t value, 
                                 memory_access_type_t access_type);
 
+/**
+ * @brief 内存区域销毁时删除其上的监视点
+ * 
+ * 监视点本身保留，但不再匹配任何访问，monitor_get_watchpoint_info()返回的区域为NULL。
+ * 
+ * @param region 内存区域
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_forget_region(memory_region_t *region);
+
+/**
+ * @brief 通知内存写入（带写入前的值）
+ * 
+ * 与monitor_notify_memory_access()相同，但提供写入前的值，供位变化和值变化谓词使用。
+ * 
+ * @param region 内存区域
+ * @param addr 地址
+ * @param size 大小（字节）
+ * @param old_value 写入前的值
+ * @param value 写入的值
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_notify_memory_write(memory_region_t *region, uint64_t addr, 
+                               uint32_t size, uint64_t old_value, uint64_t value);
+
 #endif /* MONITOR_H */ 
\ No newline at end of file
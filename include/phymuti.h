@@ -22,6 +22,10 @@
 #include "monitor.h"
 #include "action_manager.h"
 #include "rule_engine.h"
+#include "trace.h"
+#include "trace_replay.h"
+#include "checkpoint.h"
+#include "profile.h"
 
 /**
  * @brief 初始化PhyMuTi系统
@@ -44,6 +48,18 @@ int phymuti_process_events(void);
  */
 int phymuti_cleanup(void);
 
+/**
+ * @brief 计算整个模拟系统的状态指纹
+ * 
+ * 合并所有内存区域的内容哈希（见memory_region_hash()）和所有设备
+ * save_state保存的状态，两次运行的指纹相同即可认为到达了相同的状态，
+ * 无需导出全部内存。结果与区域和设备的创建顺序无关。
+ * 
+ * @param fingerprint 返回指纹
+ * @return int 成功返回0，失败返回错误码
+ */
+int phymuti_state_fingerprint(uint64_t *fingerprint);
+
 /**
  * @brief 获取PhyMuTi版本信息
  * 
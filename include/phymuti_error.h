@@ -47,12 +47,29 @@
 #define PHYMUTI_ERROR_ACTION_NOT_FOUND         -400  /* 动作未找到 */
 #define PHYMUTI_ERROR_ACTION_EXECUTE_FAILED    -401  /* 动作执行失败 */
 #define PHYMUTI_ERROR_ACTION_INVALID_TYPE      -402  /* 无效的动作类型 */
+#define PHYMUTI_ERROR_ACTION_THROTTLED         -403  /* 动作超过速率限制被丢弃 */
+#define PHYMUTI_ERROR_ACTION_TIMEOUT           -404  /* 动作执行超时被终止 */
+#define PHYMUTI_ERROR_ACTION_CANCELLED         -405  /* 动作已取消 */
 
 /* 规则引擎错误码 */
 #define PHYMUTI_ERROR_RULE_NOT_FOUND           -500  /* 规则未找到 */
 #define PHYMUTI_ERROR_RULE_CONDITION_FAILED    -501  /* 规则条件评估失败 */
 #define PHYMUTI_ERROR_RULE_ACTION_FAILED       -502  /* 规则动作执行失败 */
 
+/* 跟踪模块错误码 */
+#define PHYMUTI_ERROR_TRACE_ACTIVE             -600  /* 跟踪已在进行 */
+#define PHYMUTI_ERROR_TRACE_NOT_ACTIVE         -601  /* 跟踪未开始 */
+#define PHYMUTI_ERROR_TRACE_FORMAT             -602  /* 跟踪文件格式错误 */
+
+/* 检查点模块错误码 */
+#define PHYMUTI_ERROR_CHECKPOINT_FORMAT        -700  /* 检查点文件格式错误 */
+#define PHYMUTI_ERROR_CHECKPOINT_NO_PARENT     -701  /* 没有可作为父检查点的检查点 */
+#define PHYMUTI_ERROR_CHECKPOINT_MISMATCH      -702  /* 检查点与当前模拟系统不匹配 */
+
+/* 采样分析模块错误码 */
+#define PHYMUTI_ERROR_PROFILE_ACTIVE           -800  /* 采样已在进行 */
+#define PHYMUTI_ERROR_PROFILE_NOT_ACTIVE       -801  /* 采样未开始 */
+
 /**
  * @brief 获取错误码对应的错误信息
  * 
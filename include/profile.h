@@ -0,0 +1,116 @@
+/**
+ * @file profile.h
+ * @brief 内存访问采样分析模块头文件
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "memory_manager.h"
+
+/* 采样配置 */
+typedef struct {
+    uint32_t sample_period;      /* 平均每多少次访问采样一次 */
+    uint32_t region_slots;       /* 每个区域直方图的地址槽数 */
+} profile_config_t;
+
+/* 默认配置 */
+#define PROFILE_DEFAULT_SAMPLE_PERIOD 1024
+#define PROFILE_DEFAULT_REGION_SLOTS  4096
+
+/* 区域名称的最大长度（含结尾的0） */
+#define PROFILE_NAME_MAX 64
+
+/* 热点地址 */
+typedef struct {
+    uint32_t region_id;                  /* 内存区域ID */
+    char region_name[PROFILE_NAME_MAX];  /* 内存区域名称 */
+    uint64_t address;                    /* 地址 */
+    uint64_t read_samples;               /* 采样到的读次数 */
+    uint64_t write_samples;              /* 采样到的写次数 */
+    uint64_t estimated_accesses;         /* 估计的访问次数（采样数乘以采样周期） */
+} profile_entry_t;
+
+/* 采样统计信息 */
+typedef struct {
+    uint64_t samples;   /* 采样数 */
+    uint64_t dropped;   /* 直方图已满而未计入的采样数 */
+    uint32_t regions;   /* 有采样的区域数 */
+} profile_stats_t;
+
+/**
+ * @brief 清理采样分析模块资源（正在采样时先停止采样）
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+int profile_cleanup(void);
+
+/**
+ * @brief 开始采样，清除上一次采样的结果
+ *
+ * 之后经过monitor_notify_memory_access()的访问由各线程自己的计数器
+ * 按平均每sample_period次采样一次（间隔随机，避免与循环同步），
+ * 采样按地址计入所在区域的无锁直方图，不需要启用任何监视点。
+ *
+ * @param config 采样配置，为NULL时使用默认配置
+ * @return int 成功返回0，失败返回错误码
+ */
+int profile_start(const profile_config_t *config);
+
+/**
+ * @brief 停止采样，结果保留到下一次开始采样或清理
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+int profile_stop(void);
+
+/**
+ * @brief 查询是否正在采样
+ *
+ * @return bool 正在采样返回true
+ */
+bool profile_is_active(void);
+
+/**
+ * @brief 获取采样次数最多的k个地址
+ *
+ * 采样期间和停止后都可以调用。
+ *
+ * @param entries 输出数组，按采样次数从多到少排列
+ * @param k 数组容量
+ * @param count 返回实际输出的个数
+ * @return int 成功返回0，失败返回错误码
+ */
+int profile_get_top(profile_entry_t *entries, size_t k, size_t *count);
+
+/**
+ * @brief 以文本形式输出采样次数最多的k个地址
+ *
+ * @param out 输出文件
+ * @param k 输出的个数
+ * @return int 成功返回0，失败返回错误码
+ */
+int profile_dump_top(FILE *out, size_t k);
+
+/**
+ * @brief 获取采样统计信息
+ *
+ * @param stats 统计信息指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int profile_get_stats(profile_stats_t *stats);
+
+/**
+ * @brief 对一次内存访问计数，到达采样间隔时记录（由监视器调用）
+ *
+ * @param region 内存区域
+ * @param addr 地址
+ * @param access_type 访问类型
+ */
+void profile_record_access(memory_region_t *region, uint64_t addr, memory_access_type_t access_type);
+
+#endif /* PROFILE_H */
@@ -0,0 +1,110 @@
+/**
+ * @file trace.h
+ * @brief 内存访问跟踪模块头文件
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "memory_manager.h"
+
+/* 跟踪文件魔数和版本 */
+#define TRACE_FILE_MAGIC   "PHYTRACE"
+#define TRACE_FILE_VERSION 1
+
+/* 跟踪文件头 */
+typedef struct {
+    char magic[8];            /* 魔数，TRACE_FILE_MAGIC */
+    uint32_t version;         /* 文件格式版本 */
+    uint32_t record_size;     /* 单条记录大小（字节） */
+    uint64_t start_realtime;  /* 开始跟踪时的墙上时间（纳秒，CLOCK_REALTIME） */
+} trace_file_header_t;
+
+/* 跟踪记录（固定大小） */
+typedef struct {
+    uint64_t timestamp;       /* 相对跟踪开始的时间（纳秒） */
+    uint64_t address;         /* 地址 */
+    uint64_t value;           /* 值 */
+    uint32_t region_id;       /* 内存区域ID */
+    uint32_t size;            /* 大小（字节） */
+    uint16_t thread_id;       /* 记录线程编号，同一线程的记录在文件中保持先后顺序 */
+    uint8_t access_type;      /* 访问类型（memory_access_type_t） */
+    uint8_t reserved[5];      /* 保留 */
+} trace_record_t;
+
+/* 跟踪配置 */
+typedef struct {
+    size_t buffer_records;       /* 每线程环形缓冲区容量（记录数） */
+    uint32_t flush_interval_us;  /* 后台写入线程的刷新间隔（微秒） */
+} trace_config_t;
+
+/* 默认配置 */
+#define TRACE_DEFAULT_BUFFER_RECORDS    65536
+#define TRACE_DEFAULT_FLUSH_INTERVAL_US 1000
+
+/* 跟踪统计信息 */
+typedef struct {
+    uint64_t recorded;  /* 已写入环形缓冲区的记录数 */
+    uint64_t dropped;   /* 缓冲区已满而丢弃的记录数 */
+    uint64_t written;   /* 已写入文件的记录数 */
+    uint32_t threads;   /* 参与记录的线程数 */
+} trace_stats_t;
+
+/**
+ * @brief 清理跟踪模块资源（正在记录时先停止记录）
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+int trace_cleanup(void);
+
+/**
+ * @brief 开始记录内存访问
+ *
+ * 之后经过monitor_notify_memory_access()的每次访问都被写入调用线程的
+ * 无锁环形缓冲区，由后台线程批量写入文件。缓冲区满时丢弃记录并计数，
+ * 访问线程不会被阻塞。
+ *
+ * @param path 跟踪文件路径
+ * @param config 跟踪配置，为NULL时使用默认配置
+ * @return int 成功返回0，失败返回错误码
+ */
+int trace_start(const char *path, const trace_config_t *config);
+
+/**
+ * @brief 停止记录，写出所有缓冲区中的记录并关闭文件
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+int trace_stop(void);
+
+/**
+ * @brief 查询是否正在记录
+ *
+ * @return bool 正在记录返回true
+ */
+bool trace_is_active(void);
+
+/**
+ * @brief 获取跟踪统计信息
+ *
+ * @param stats 统计信息指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int trace_get_stats(trace_stats_t *stats);
+
+/**
+ * @brief 记录一次内存访问（由监视器调用）
+ *
+ * @param region 内存区域
+ * @param addr 地址
+ * @param size 大小（字节）
+ * @param value 值
+ * @param access_type 访问类型
+ */
+void trace_record_access(memory_region_t *region, uint64_t addr, uint32_t size,
+                         uint64_t value, memory_access_type_t access_type);
+
+#endif /* TRACE_H */
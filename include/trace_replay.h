@@ -0,0 +1,60 @@
+/**
+ * @file trace_replay.h
+ * @brief 访问跟踪回放模块头文件
+ */
+
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "memory_manager.h"
+#include "trace.h"
+
+/* 回放节奏 */
+typedef enum {
+    TRACE_REPLAY_MAX_SPEED,  /* 尽可能快地回放 */
+    TRACE_REPLAY_PACED,      /* 按记录的时间戳回放 */
+} trace_replay_pacing_t;
+
+/* 内存区域解析函数类型：将跟踪中的区域ID映射到当前模拟系统中的内存区域 */
+typedef memory_region_t* (*trace_region_resolver_t)(uint32_t region_id, void *user_data);
+
+/* 回放配置 */
+typedef struct {
+    trace_replay_pacing_t pacing;      /* 回放节奏 */
+    double speed;                      /* 按时间戳回放时的倍速，<=0时视为1.0 */
+    uint32_t threads;                  /* 回放线程数，<=1时单线程按文件顺序回放 */
+    trace_region_resolver_t resolver;  /* 区域解析函数，为NULL时使用memory_region_find_by_id() */
+    void *resolver_data;               /* 区域解析函数的用户数据 */
+} trace_replay_config_t;
+
+/* 回放统计信息 */
+typedef struct {
+    uint64_t records;        /* 跟踪文件中的记录数 */
+    uint64_t replayed;       /* 成功回放的访问数 */
+    uint64_t skipped;        /* 因区域不存在或访问类型不支持而跳过的记录数 */
+    uint64_t failed;         /* 回放时访问返回错误的次数 */
+    uint64_t elapsed_ns;     /* 回放耗时（纳秒，不含加载和准备） */
+    double accesses_per_sec; /* 吞吐量（次/秒） */
+} trace_replay_stats_t;
+
+/**
+ * @brief 回放跟踪文件
+ *
+ * 按记录重新发起memory_read_*和memory_write_*访问，经过完整的
+ * 监视器、动作和规则处理流程。多线程回放时，记录按其线程编号分配到
+ * 回放线程，同一记录线程的访问在同一回放线程中按原顺序执行。
+ *
+ * 跟踪文件不包含块访问的数据内容，块写入以全零数据回放。
+ *
+ * @param path 跟踪文件路径
+ * @param config 回放配置，为NULL时单线程全速回放
+ * @param stats 回放统计信息，可为NULL
+ * @return int 成功返回0，失败返回错误码
+ */
+int trace_replay_file(const char *path, const trace_replay_config_t *config,
+                      trace_replay_stats_t *stats);
+
+#endif /* TRACE_REPLAY_H */
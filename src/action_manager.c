@@ -4,12 +4,49 @@
  */
 
 #include "action_manager.h"
+#include "action_plugin.h"
 #include "phymuti_error.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
 #include <pthread.h>
+#include <dlfcn.h>
+
+/* 已加载的插件，动作和正在执行的调用各持有一个引用，最后一个引用释放时卸载 */
+typedef struct {
+    _Atomic int refs;                /* 引用数 */
+    void *handle;                    /* dlopen()返回的句柄 */
+    const action_plugin_t *plugin;   /* 插件描述 */
+    void *state;                     /* 插件状态 */
+} plugin_instance_t;
+
+/* 延迟统计的分片数，线程按注册顺序轮流使用 */
+#define LATENCY_SHARDS 16
+
+/* 缓存行大小 */
+#define LATENCY_CACHE_LINE 64
+
+/* 延迟统计分片，只由使用它的线程写入 */
+typedef struct {
+    _Alignas(LATENCY_CACHE_LINE) _Atomic uint64_t invocations;  /* 执行次数 */
+    _Atomic uint64_t failures;                                  /* 失败次数 */
+    _Atomic uint64_t total_ns;                                  /* 总耗时 */
+    _Atomic uint64_t max_ns;                                    /* 最长耗时 */
+    _Atomic uint64_t buckets[ACTION_LATENCY_BUCKETS];           /* 延迟直方图 */
+} latency_shard_t;
+
+/* 动作的延迟统计，动作和正在记录的执行各持有一个引用，动作销毁后仍可完成记录 */
+typedef struct {
+    _Atomic int refs;                                /* 引用数 */
+    _Atomic(latency_shard_t *) shards[LATENCY_SHARDS];  /* 按需分配的分片 */
+} action_latency_t;
 
 /* 动作结构体 */
 typedef struct action_struct {
@@ -19,14 +56,26 @@ typedef struct action_struct {
         struct {
             action_callback_t callback;  /* 回调函数 */
         } callback_data;
+        struct {
+            action_batch_callback_t callback;  /* 批量回调函数 */
+        } batch_data;
         struct {
             char *path;                  /* 脚本路径 */
         } script_data;
         struct {
             char *command;               /* 命令字符串 */
         } command_data;
+        struct {
+            plugin_instance_t *instance; /* 已加载的插件 */
+        } plugin_data;
     } data;
     void *user_data;             /* 用户数据 */
+    action_priority_t priority;  /* 优先级 */
+    action_rate_limit_t limit;   /* 速率限制 */
+    double tokens;               /* 桶中剩余的令牌 */
+    uint64_t refill_ns;          /* 上次补充令牌的时间 */
+    action_rate_stats_t rate_stats;  /* 速率限制统计 */
+    action_latency_t *latency;   /* 延迟统计，第一次执行时分配 */
     struct action_struct *next;  /* 下一个动作 */
 } action_t;
 
@@ -40,6 +89,9 @@ static action_id_t next_action_id = 1;
 static pthread_mutex_t action_mutex;
 static pthread_mutexattr_t action_mutex_attr;
 
+static void future_shutdown(void);
+static void latency_release(action_latency_t *latency);
+
 /**
  * @brief 初始化动作管理器
  * 
@@ -73,6 +125,43 @@ int action_manager_init(void) {
     return PHYMUTI_SUCCESS;
 }
 
+/**
+ * @brief 取得插件并增加一个引用（调用者持有动作锁）
+ * 
+ * @param action 插件动作
+ * @return plugin_instance_t* 插件
+ */
+static plugin_instance_t* plugin_acquire(action_t *action) {
+    plugin_instance_t *instance = action->data.plugin_data.instance;
+    atomic_fetch_add_explicit(&instance->refs, 1, memory_order_relaxed);
+    return instance;
+}
+
+/**
+ * @brief 释放插件的一个引用，最后一个引用释放插件状态并卸载共享库
+ * 
+ * @param instance 插件，可以为NULL
+ */
+static void plugin_release(plugin_instance_t *instance) {
+    if (!instance || atomic_fetch_sub_explicit(&instance->refs, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+    if (instance->plugin->teardown) {
+        instance->plugin->teardown(instance->state);
+    }
+    dlclose(instance->handle);
+    free(instance);
+}
+
+/**
+ * @brief 释放动作持有的插件引用，正在执行的调用结束后才真正卸载
+ * 
+ * @param action 插件动作
+ */
+static void unload_plugin(action_t *action) {
+    plugin_release(action->data.plugin_data.instance);
+}
+
 /**
  * @brief 清理动作管理器资源
  * 
@@ -81,6 +170,9 @@ int action_manager_init(void) {
 int action_manager_cleanup(void) {
     int ret;
     
+    /* 先停止异步执行的工作线程，它们可能还在使用动作 */
+    future_shutdown();
+    
     /* 清理所有动作 */
     ret = pthread_mutex_lock(&action_mutex);
     if (ret != 0) {
@@ -98,9 +190,12 @@ int action_manager_cleanup(void) {
             free(action->data.script_data.path);
         } else if (action->type == ACTION_TYPE_COMMAND) {
             free(action->data.command_data.command);
+        } else if (action->type == ACTION_TYPE_PLUGIN) {
+            unload_plugin(action);
         }
         
         /* 释放动作结构体 */
+        latency_release(action->latency);
         free(action);
         
         action = next_action;
@@ -184,6 +279,220 @@ static action_t* find_action_locked(action_id_t id) {
     return NULL;
 }
 
+/**
+ * @brief 获取单调时间（纳秒）
+ * 
+ * @return uint64_t 当前时间
+ */
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 初始化动作的优先级、速率限制和延迟统计
+ * 
+ * @param action 动作
+ */
+static void init_action_state(action_t *action) {
+    action->priority = ACTION_PRIORITY_NORMAL;
+    action->limit.rate = 0;
+    action->limit.burst = 0;
+    action->tokens = 0;
+    action->refill_ns = 0;
+    action->rate_stats.executed = 0;
+    action->rate_stats.throttled = 0;
+    action->latency = NULL;
+}
+
+/* 线程使用的延迟统计分片，UINT32_MAX表示尚未分配 */
+static __thread uint32_t tl_latency_shard = UINT32_MAX;
+static _Atomic uint32_t next_latency_shard = 0;
+
+/**
+ * @brief 获取延迟对应的直方图桶
+ * 
+ * @param ns 延迟（纳秒）
+ * @return size_t 桶序号
+ */
+static size_t latency_bucket(uint64_t ns) {
+    if (ns < ACTION_LATENCY_SUB_BUCKETS) {
+        return (size_t)ns;
+    }
+    
+    /* 最高位决定2的幂区间，其后3位决定子桶 */
+    unsigned msb = 63 - (unsigned)__builtin_clzll(ns);
+    size_t index = (size_t)(msb - 2) * ACTION_LATENCY_SUB_BUCKETS + ((ns >> (msb - 3)) & (ACTION_LATENCY_SUB_BUCKETS - 1));
+    return index < ACTION_LATENCY_BUCKETS ? index : ACTION_LATENCY_BUCKETS - 1;
+}
+
+/**
+ * @brief 获取直方图桶的上界
+ * 
+ * @param index 桶序号
+ * @return uint64_t 桶内的最大延迟（纳秒）
+ */
+static uint64_t latency_bucket_upper(size_t index) {
+    if (index < ACTION_LATENCY_SUB_BUCKETS) {
+        return index;
+    }
+    
+    unsigned shift = (unsigned)(index / ACTION_LATENCY_SUB_BUCKETS) - 1;
+    uint64_t sub = index % ACTION_LATENCY_SUB_BUCKETS;
+    return ((ACTION_LATENCY_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+/**
+ * @brief 取得动作的延迟统计并增加一个引用（调用者持有动作锁）
+ * 
+ * @param action 动作
+ * @return action_latency_t* 延迟统计，内存不足时返回NULL（不记录本次执行）
+ */
+static action_latency_t* latency_acquire(action_t *action) {
+    if (!action->latency) {
+        action->latency = (action_latency_t *)calloc(1, sizeof(action_latency_t));
+        if (!action->latency) {
+            return NULL;
+        }
+        atomic_init(&action->latency->refs, 1);
+    }
+    atomic_fetch_add_explicit(&action->latency->refs, 1, memory_order_relaxed);
+    return action->latency;
+}
+
+/**
+ * @brief 释放延迟统计的一个引用，最后一个引用释放所有分片
+ * 
+ * @param latency 延迟统计，可以为NULL
+ */
+static void latency_release(action_latency_t *latency) {
+    if (!latency || atomic_fetch_sub_explicit(&latency->refs, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+    for (int i = 0; i < LATENCY_SHARDS; i++) {
+        free(atomic_load_explicit(&latency->shards[i], memory_order_relaxed));
+    }
+    free(latency);
+}
+
+/**
+ * @brief 把一次执行记录到本线程的分片
+ * 
+ * @param latency 延迟统计
+ * @param ns 耗时（纳秒）
+ * @param result 执行结果
+ */
+static void latency_record(action_latency_t *latency, uint64_t ns, int result) {
+    if (tl_latency_shard == UINT32_MAX) {
+        tl_latency_shard = atomic_fetch_add_explicit(&next_latency_shard, 1, memory_order_relaxed) % LATENCY_SHARDS;
+    }
+    
+    latency_shard_t *shard = atomic_load_explicit(&latency->shards[tl_latency_shard], memory_order_acquire);
+    if (!shard) {
+        latency_shard_t *fresh = (latency_shard_t *)aligned_alloc(LATENCY_CACHE_LINE, sizeof(latency_shard_t));
+        if (!fresh) {
+            return;
+        }
+        memset(fresh, 0, sizeof(latency_shard_t));
+        if (atomic_compare_exchange_strong_explicit(&latency->shards[tl_latency_shard], &shard, fresh,
+                                                    memory_order_acq_rel, memory_order_acquire)) {
+            shard = fresh;
+        } else {
+            free(fresh);
+        }
+    }
+    
+    /* 线程多于分片数时几个线程共用分片，计数都是原子操作 */
+    atomic_fetch_add_explicit(&shard->invocations, 1, memory_order_relaxed);
+    if (result != PHYMUTI_SUCCESS) {
+        atomic_fetch_add_explicit(&shard->failures, 1, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&shard->total_ns, ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&shard->buckets[latency_bucket(ns)], 1, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&shard->max_ns, memory_order_relaxed);
+    while (ns > max && !atomic_compare_exchange_weak_explicit(&shard->max_ns, &max, ns,
+                                                             memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief 合并动作所有分片的延迟统计（调用者持有动作锁）
+ * 
+ * @param action 动作
+ * @param stats 输出的统计信息
+ */
+static void latency_merge(const action_t *action, action_latency_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (!action->latency) {
+        return;
+    }
+    
+    for (int i = 0; i < LATENCY_SHARDS; i++) {
+        latency_shard_t *shard = atomic_load_explicit(&action->latency->shards[i], memory_order_acquire);
+        if (!shard) {
+            continue;
+        }
+        stats->invocations += atomic_load_explicit(&shard->invocations, memory_order_relaxed);
+        stats->failures += atomic_load_explicit(&shard->failures, memory_order_relaxed);
+        stats->total_ns += atomic_load_explicit(&shard->total_ns, memory_order_relaxed);
+        uint64_t max = atomic_load_explicit(&shard->max_ns, memory_order_relaxed);
+        if (max > stats->max_ns) {
+            stats->max_ns = max;
+        }
+        for (size_t b = 0; b < ACTION_LATENCY_BUCKETS; b++) {
+            stats->buckets[b] += atomic_load_explicit(&shard->buckets[b], memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief 从令牌桶中为count个上下文取令牌（调用者持有动作锁）
+ * 
+ * @param action 动作
+ * @param count 上下文数量
+ * @return size_t 可以执行的上下文数量，其余的计为被丢弃
+ */
+static size_t take_tokens(action_t *action, size_t count) {
+    size_t allowed = count;
+    
+    if (action->limit.rate != 0 && action->priority != ACTION_PRIORITY_HIGH) {
+        uint64_t now = monotonic_ns();
+        action->tokens += (double)(now - action->refill_ns) * action->limit.rate / 1e9;
+        if (action->tokens > action->limit.burst) {
+            action->tokens = action->limit.burst;
+        }
+        action->refill_ns = now;
+        
+        if ((double)allowed > action->tokens) {
+            allowed = (size_t)action->tokens;
+        }
+        action->tokens -= (double)allowed;
+    }
+    
+    action->rate_stats.executed += allowed;
+    action->rate_stats.throttled += count - allowed;
+    return allowed;
+}
+
+/**
+ * @brief 构建脚本动作的命令行：脚本路径后跟地址、大小、值和访问类型
+ * 
+ * @param action 脚本动作
+ * @param context 监视点上下文
+ * @param cmd 输出缓冲区
+ * @param size 缓冲区大小
+ */
+static void format_script_command(const action_t *action, const monitor_context_t *context,
+                                  char *cmd, size_t size) {
+    snprintf(cmd, size, "%s %lu %u %lu %d",
+            action->data.script_data.path,
+            context->address,
+            context->size,
+            context->value,
+            (int)context->access_type);
+}
+
 /**
  * @brief 创建回调函数类型的动作
  * 
@@ -219,6 +528,7 @@ action_id_t action_create_callback(action_callback_t callback, void *user_data)
     action->type = ACTION_TYPE_CALLBACK;
     action->data.callback_data.callback = callback;
     action->user_data = user_data;
+    init_action_state(action);
     
     /* 添加到动作链表 */
     action->next = action_list;
@@ -233,6 +543,52 @@ action_id_t action_create_callback(action_callback_t callback, void *user_data)
     return id;
 }
 
+/**
+ * @brief 创建批量回调函数动作
+ * 
+ * @param callback 批量回调函数
+ * @param user_data 用户数据
+ * @return action_id_t 成功返回动作ID，失败返回ACTION_INVALID_ID
+ */
+action_id_t action_create_batch_callback(action_batch_callback_t callback, void *user_data) {
+    int ret;
+    
+    if (!callback) {
+        return ACTION_INVALID_ID;
+    }
+    
+    /* 创建新的动作 */
+    action_t *action = (action_t *)malloc(sizeof(action_t));
+    if (!action) {
+        return ACTION_INVALID_ID;
+    }
+    
+    /* 初始化动作并添加到链表 */
+    ret = pthread_mutex_lock(&action_mutex);
+    if (ret != 0) {
+        free(action);
+        return ACTION_INVALID_ID;
+    }
+    
+    action_id_t id = next_action_id++;
+    action->id = id;
+    action->type = ACTION_TYPE_BATCH_CALLBACK;
+    action->data.batch_data.callback = callback;
+    action->user_data = user_data;
+    init_action_state(action);
+    
+    /* 添加到动作链表 */
+    action->next = action_list;
+    action_list = action;
+    
+    ret = pthread_mutex_unlock(&action_mutex);
+    if (ret != 0) {
+        /* 解锁失败，但动作已创建，返回ID */
+    }
+    
+    return id;
+}
+
 /**
  * @brief 创建脚本动作
  * 
@@ -271,6 +627,7 @@ action_id_t action_create_script(const char *script_path) {
     action->type = ACTION_TYPE_SCRIPT;
     action->data.script_data.path = path_copy;
     action->user_data = NULL;
+    init_action_state(action);
     
     /* 添加到动作链表 */
     action->next = action_list;
@@ -323,6 +680,7 @@ action_id_t action_create_command(const char *command) {
     action->type = ACTION_TYPE_COMMAND;
     action->data.command_data.command = command_copy;
     action->user_data = NULL;
+    init_action_state(action);
     
     /* 添加到动作链表 */
     action->next = action_list;
@@ -337,6 +695,105 @@ action_id_t action_create_command(const char *command) {
     return action->id;
 }
 
+/**
+ * @brief 加载插件并创建插件动作
+ * 
+ * @param path 共享库路径
+ * @param args 传给插件init()的参数字符串，可以为NULL
+ * @param id 成功时返回动作ID
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_load_plugin(const char *path, const char *args, action_id_t *id) {
+    int ret;
+    
+    if (!path || !id) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 加载共享库，立即解析全部符号以便尽早发现缺失的依赖 */
+    void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        return PHYMUTI_ERROR_IO;
+    }
+    
+    action_plugin_entry_t entry;
+    *(void **)&entry = dlsym(handle, ACTION_PLUGIN_ENTRY);
+    const action_plugin_t *plugin = entry ? entry() : NULL;
+    if (!plugin) {
+        dlclose(handle);
+        return PHYMUTI_ERROR_NOT_FOUND;
+    }
+    if (plugin->abi_version != ACTION_PLUGIN_ABI_VERSION || !plugin->execute) {
+        dlclose(handle);
+        return PHYMUTI_ERROR_NOT_SUPPORTED;
+    }
+    
+    void *state = NULL;
+    if (plugin->init && plugin->init(args, &state) != 0) {
+        dlclose(handle);
+        return PHYMUTI_ERROR_ACTION_EXECUTE_FAILED;
+    }
+    
+    /* 创建新的动作 */
+    action_t *action = (action_t *)malloc(sizeof(action_t));
+    plugin_instance_t *instance = (plugin_instance_t *)malloc(sizeof(plugin_instance_t));
+    if (!action || !instance) {
+        if (plugin->teardown) {
+            plugin->teardown(state);
+        }
+        dlclose(handle);
+        free(instance);
+        free(action);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    atomic_init(&instance->refs, 1);
+    instance->handle = handle;
+    instance->plugin = plugin;
+    instance->state = state;
+    action->type = ACTION_TYPE_PLUGIN;
+    action->data.plugin_data.instance = instance;
+    action->user_data = NULL;
+    init_action_state(action);
+    
+    /* 初始化动作并添加到链表 */
+    ret = pthread_mutex_lock(&action_mutex);
+    if (ret != 0) {
+        unload_plugin(action);
+        free(action);
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    action->id = next_action_id++;
+    *id = action->id;
+    
+    /* 添加到动作链表 */
+    action->next = action_list;
+    action_list = action;
+    
+    ret = pthread_mutex_unlock(&action_mutex);
+    if (ret != 0) {
+        /* 解锁失败，但动作已创建，返回ID */
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 创建插件动作
+ * 
+ * @param path 共享库路径
+ * @param args 传给插件init()的参数字符串，可以为NULL
+ * @return action_id_t 成功返回动作ID，失败返回ACTION_INVALID_ID
+ */
+action_id_t action_create_plugin(const char *path, const char *args) {
+    action_id_t id;
+    
+    if (action_load_plugin(path, args, &id) != PHYMUTI_SUCCESS) {
+        return ACTION_INVALID_ID;
+    }
+    return id;
+}
+
 /**
  * @brief 销毁动作
  * 
@@ -382,11 +839,16 @@ int action_destroy(action_id_t id) {
                     }
                     break;
                     
+                case ACTION_TYPE_PLUGIN:
+                    unload_plugin(action);
+                    break;
+                    
                 default:
                     break;
             }
             
-            /* 释放动作 */
+            /* 释放动作，正在执行的调用仍持有延迟统计的引用 */
+            latency_release(action->latency);
             free(action);
             
             ret = pthread_mutex_unlock(&action_mutex);
@@ -408,19 +870,16 @@ int action_destroy(action_id_t id) {
 }
 
 /**
- * @brief 执行动作
+ * @brief 执行动作，不记录延迟
  * 
  * @param id 动作ID
  * @param context 监视点上下文
+ * @param latency 动作确实执行时返回其延迟统计的引用，由调用者记录后释放
  * @return int 成功返回0，失败返回错误码
  */
-int action_execute(action_id_t id, const monitor_context_t *context) {
+static int execute_one(action_id_t id, const monitor_context_t *context, action_latency_t **latency) {
     int ret;
     
-    if (id == ACTION_INVALID_ID || !context) {
-        return PHYMUTI_ERROR_INVALID_PARAM;
-    }
-    
     /* 查找动作 */
     ret = pthread_mutex_lock(&action_mutex);
     if (ret != 0) {
@@ -436,18 +895,30 @@ int action_execute(action_id_t id, const monitor_context_t *context) {
         return PHYMUTI_ERROR_ACTION_NOT_FOUND;
     }
     
+    /* 超过速率限制时丢弃 */
+    if (take_tokens(action, 1) == 0) {
+        ret = pthread_mutex_unlock(&action_mutex);
+        if (ret != 0) {
+            return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+        }
+        return PHYMUTI_ERROR_ACTION_THROTTLED;
+    }
+    *latency = latency_acquire(action);
+    
     /* 根据类型执行动作 */
     int result = PHYMUTI_SUCCESS;
     
     switch (action->type) {
         case ACTION_TYPE_CALLBACK:
             if (action->data.callback_data.callback) {
-                /* 回调可能需要调用管理器其他函数, 所以在执行前解锁 */
+                /* 回调可能需要调用管理器其他函数, 所以在执行前解锁；解锁后动作可能被销毁，先复制 */
+                action_callback_t callback = action->data.callback_data.callback;
+                void *user_data = action->user_data;
                 ret = pthread_mutex_unlock(&action_mutex);
                 if (ret != 0) {
                     return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
                 }
-                result = action->data.callback_data.callback(context, action->user_data);
+                result = callback(context, user_data);
                 /* 再次加锁以保持一致性 */
                 ret = pthread_mutex_lock(&action_mutex);
                 if (ret != 0) {
@@ -460,12 +931,7 @@ int action_execute(action_id_t id, const monitor_context_t *context) {
             if (action->data.script_data.path) {
                 /* 构建命令行 */
                 char cmd[1024];
-                snprintf(cmd, sizeof(cmd), "%s %lu %u %lu %d",
-                        action->data.script_data.path,
-                        context->address,
-                        context->size,
-                        context->value,
-                        (int)context->access_type);
+                format_script_command(action, context, cmd, sizeof(cmd));
                 
                 /* 执行脚本 - 先解锁再执行外部命令 */
                 ret = pthread_mutex_unlock(&action_mutex);
@@ -503,6 +969,39 @@ int action_execute(action_id_t id, const monitor_context_t *context) {
             }
             break;
             
+        case ACTION_TYPE_BATCH_CALLBACK: {
+            /* 单独执行时作为只有一个上下文的批次；解锁后动作可能被销毁，先复制 */
+            action_batch_callback_t callback = action->data.batch_data.callback;
+            void *user_data = action->user_data;
+            ret = pthread_mutex_unlock(&action_mutex);
+            if (ret != 0) {
+                return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+            }
+            result = callback(context, 1, user_data);
+            ret = pthread_mutex_lock(&action_mutex);
+            if (ret != 0) {
+                return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+            }
+            break;
+        }
+            
+        case ACTION_TYPE_PLUGIN: {
+            /* 直接调用插件函数，与回调一样在锁外执行；持有引用防止执行期间被卸载 */
+            plugin_instance_t *instance = plugin_acquire(action);
+            ret = pthread_mutex_unlock(&action_mutex);
+            if (ret != 0) {
+                plugin_release(instance);
+                return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+            }
+            result = instance->plugin->execute(instance->state, context);
+            plugin_release(instance);
+            ret = pthread_mutex_lock(&action_mutex);
+            if (ret != 0) {
+                return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+            }
+            break;
+        }
+            
         default:
             result = PHYMUTI_ERROR_ACTION_INVALID_TYPE;
             break;
@@ -516,20 +1015,45 @@ int action_execute(action_id_t id, const monitor_context_t *context) {
 }
 
 /**
- * @brief 获取动作类型
+ * @brief 执行动作
  * 
  * @param id 动作ID
- * @param type 类型指针
+ * @param context 监视点上下文
  * @return int 成功返回0，失败返回错误码
  */
-int action_get_type(action_id_t id, action_type_t *type) {
+int action_execute(action_id_t id, const monitor_context_t *context) {
+    action_latency_t *latency = NULL;
+    
+    if (id == ACTION_INVALID_ID || !context) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    uint64_t start = monotonic_ns();
+    int result = execute_one(id, context, &latency);
+    if (latency) {
+        latency_record(latency, monotonic_ns() - start, result);
+        latency_release(latency);
+    }
+    return result;
+}
+
+/**
+ * @brief 对一组上下文执行动作
+ * 
+ * @param id 动作ID
+ * @param contexts 监视点上下文数组
+ * @param count 上下文数量
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_execute_batch(action_id_t id, const monitor_context_t *contexts, size_t count) {
     int ret;
     
-    if (id == ACTION_INVALID_ID || !type) {
+    if (id == ACTION_INVALID_ID || !contexts || count == 0) {
         return PHYMUTI_ERROR_INVALID_PARAM;
     }
     
     /* 查找动作 */
+    uint64_t start = monotonic_ns();
     ret = pthread_mutex_lock(&action_mutex);
     if (ret != 0) {
         return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
@@ -544,10 +1068,382 @@ int action_get_type(action_id_t id, action_type_t *type) {
         return PHYMUTI_ERROR_ACTION_NOT_FOUND;
     }
     
-    *type = action->type;
+    action_type_t type = action->type;
+    action_batch_callback_t callback = action->data.batch_data.callback;
+    void *user_data = action->user_data;
+    const action_plugin_t *plugin = NULL;
+    if (type == ACTION_TYPE_PLUGIN) {
+        plugin = action->data.plugin_data.instance->plugin;
+    }
     
-    ret = pthread_mutex_unlock(&action_mutex);
-    if (ret != 0) {
+    /* 一次处理整批的动作按批取令牌，只执行有令牌的前若干个上下文 */
+    bool whole_batch = type == ACTION_TYPE_BATCH_CALLBACK || (plugin && plugin->execute_batch);
+    action_latency_t *latency = NULL;
+    plugin_instance_t *instance = NULL;
+    if (whole_batch) {
+        count = take_tokens(action, count);
+        if (count > 0) {
+            latency = latency_acquire(action);
+            if (plugin) {
+                instance = plugin_acquire(action);
+            }
+        }
+    }
+    
+    ret = pthread_mutex_unlock(&action_mutex);
+    if (ret != 0) {
+        plugin_release(instance);
+        latency_release(latency);
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    if (whole_batch) {
+        if (count == 0) {
+            return PHYMUTI_ERROR_ACTION_THROTTLED;
+        }
+        
+        /* 整批作为一次执行记录延迟 */
+        int result = instance ? plugin->execute_batch(instance->state, contexts, count)
+                              : callback(contexts, count, user_data);
+        plugin_release(instance);
+        if (latency) {
+            latency_record(latency, monotonic_ns() - start, result);
+            latency_release(latency);
+        }
+        return result;
+    }
+    
+    /* 其他类型的动作逐个执行 */
+    int result = PHYMUTI_SUCCESS;
+    for (size_t i = 0; i < count; i++) {
+        ret = action_execute(id, &contexts[i]);
+        if (ret != PHYMUTI_SUCCESS && result == PHYMUTI_SUCCESS) {
+            result = ret;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 设置动作优先级
+ * 
+ * @param id 动作ID
+ * @param priority 优先级
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_set_priority(action_id_t id, action_priority_t priority) {
+    int ret;
+    
+    if (id == ACTION_INVALID_ID || priority < ACTION_PRIORITY_LOW || priority > ACTION_PRIORITY_HIGH) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    ret = pthread_mutex_lock(&action_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    action_t *action = find_action_locked(id);
+    if (action) {
+        action->priority = priority;
+    }
+    
+    ret = pthread_mutex_unlock(&action_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    return action ? PHYMUTI_SUCCESS : PHYMUTI_ERROR_ACTION_NOT_FOUND;
+}
+
+/**
+ * @brief 获取动作优先级
+ * 
+ * @param id 动作ID
+ * @param priority 优先级指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_get_priority(action_id_t id, action_priority_t *priority) {
+    int ret;
+    
+    if (id == ACTION_INVALID_ID || !priority) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    ret = pthread_mutex_lock(&action_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    action_t *action = find_action_locked(id);
+    if (action) {
+        *priority = action->priority;
+    }
+    
+    ret = pthread_mutex_unlock(&action_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    return action ? PHYMUTI_SUCCESS : PHYMUTI_ERROR_ACTION_NOT_FOUND;
+}
+
+/**
+ * @brief 设置动作的令牌桶速率限制
+ * 
+ * @param id 动作ID
+ * @param limit 速率限制，为NULL时取消限制
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_set_rate_limit(action_id_t id, const action_rate_limit_t *limit) {
+    int ret;
+    
+    if (id == ACTION_INVALID_ID) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    ret = pthread_mutex_lock(&action_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    action_t *action = find_action_locked(id);
+    if (action) {
+        action->limit.rate = limit ? limit->rate : 0;
+        action->limit.burst = limit ? (limit->burst ? limit->burst : limit->rate) : 0;
+        action->tokens = action->limit.burst;
+        action->refill_ns = monotonic_ns();
+    }
+    
+    ret = pthread_mutex_unlock(&action_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    return action ? PHYMUTI_SUCCESS : PHYMUTI_ERROR_ACTION_NOT_FOUND;
+}
+
+/**
+ * @brief 获取动作的速率限制统计信息
+ * 
+ * @param id 动作ID
+ * @param stats 统计信息指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_get_rate_stats(action_id_t id, action_rate_stats_t *stats) {
+    int ret;
+    
+    if (id == ACTION_INVALID_ID || !stats) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    ret = pthread_mutex_lock(&action_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    action_t *action = find_action_locked(id);
+    if (action) {
+        *stats = action->rate_stats;
+    }
+    
+    ret = pthread_mutex_unlock(&action_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    return action ? PHYMUTI_SUCCESS : PHYMUTI_ERROR_ACTION_NOT_FOUND;
+}
+
+/**
+ * @brief 获取动作的执行延迟统计
+ * 
+ * @param id 动作ID
+ * @param stats 统计信息指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_get_latency_stats(action_id_t id, action_latency_stats_t *stats) {
+    int ret;
+    
+    if (id == ACTION_INVALID_ID || !stats) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    ret = pthread_mutex_lock(&action_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    action_t *action = find_action_locked(id);
+    if (action) {
+        latency_merge(action, stats);
+    }
+    
+    ret = pthread_mutex_unlock(&action_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    return action ? PHYMUTI_SUCCESS : PHYMUTI_ERROR_ACTION_NOT_FOUND;
+}
+
+/**
+ * @brief 由延迟直方图估计百分位延迟
+ * 
+ * @param stats 延迟统计
+ * @param percentile 百分位（0到100）
+ * @return uint64_t 该百分位所在桶的上界（不超过max_ns），没有记录时返回0
+ */
+uint64_t action_latency_percentile(const action_latency_stats_t *stats, double percentile) {
+    if (!stats || stats->invocations == 0) {
+        return 0;
+    }
+    
+    uint64_t total = 0;
+    for (size_t b = 0; b < ACTION_LATENCY_BUCKETS; b++) {
+        total += stats->buckets[b];
+    }
+    
+    /* 第rank次（从1开始）执行所在的桶 */
+    double target = percentile / 100.0 * (double)total;
+    uint64_t rank = target < 1.0 ? 1 : (uint64_t)target;
+    if ((double)rank < target) {
+        rank++;
+    }
+    
+    uint64_t seen = 0;
+    for (size_t b = 0; b < ACTION_LATENCY_BUCKETS; b++) {
+        seen += stats->buckets[b];
+        if (seen >= rank) {
+            uint64_t upper = latency_bucket_upper(b);
+            return upper < stats->max_ns ? upper : stats->max_ns;
+        }
+    }
+    return stats->max_ns;
+}
+
+/* 输出延迟统计时每个动作的摘要 */
+typedef struct {
+    action_id_t id;
+    action_type_t type;
+    uint64_t invocations;
+    uint64_t failures;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+} latency_summary_t;
+
+/* 按99百分位从高到低排序 */
+static int compare_latency_summary(const void *a, const void *b) {
+    const latency_summary_t *x = (const latency_summary_t *)a;
+    const latency_summary_t *y = (const latency_summary_t *)b;
+    if (x->p99_ns != y->p99_ns) {
+        return x->p99_ns < y->p99_ns ? 1 : -1;
+    }
+    return x->id < y->id ? -1 : (x->id > y->id);
+}
+
+/**
+ * @brief 以文本形式输出所有动作的执行延迟，按99百分位从高到低排列
+ * 
+ * @param out 输出文件
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_dump_latency_stats(FILE *out) {
+    int ret;
+    
+    if (!out) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    action_latency_stats_t *stats = (action_latency_stats_t *)malloc(sizeof(action_latency_stats_t));
+    if (!stats) {
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    ret = pthread_mutex_lock(&action_mutex);
+    if (ret != 0) {
+        free(stats);
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    size_t count = 0;
+    for (action_t *action = action_list; action; action = action->next) {
+        count++;
+    }
+    latency_summary_t *summaries = (latency_summary_t *)malloc((count ? count : 1) * sizeof(latency_summary_t));
+    if (!summaries) {
+        pthread_mutex_unlock(&action_mutex);
+        free(stats);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    size_t n = 0;
+    for (action_t *action = action_list; action; action = action->next) {
+        latency_merge(action, stats);
+        latency_summary_t *summary = &summaries[n++];
+        summary->id = action->id;
+        summary->type = action->type;
+        summary->invocations = stats->invocations;
+        summary->failures = stats->failures;
+        summary->mean_ns = stats->invocations ? stats->total_ns / stats->invocations : 0;
+        summary->p50_ns = action_latency_percentile(stats, 50.0);
+        summary->p99_ns = action_latency_percentile(stats, 99.0);
+        summary->max_ns = stats->max_ns;
+    }
+    
+    ret = pthread_mutex_unlock(&action_mutex);
+    free(stats);
+    if (ret != 0) {
+        free(summaries);
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    qsort(summaries, n, sizeof(latency_summary_t), compare_latency_summary);
+    
+    fprintf(out, "%-6s %-4s %12s %10s %12s %12s %12s %12s\n",
+            "动作", "类型", "执行次数", "失败", "平均(ns)", "P50(ns)", "P99(ns)", "最长(ns)");
+    for (size_t i = 0; i < n; i++) {
+        fprintf(out, "%-6u %-4d %12llu %10llu %12llu %12llu %12llu %12llu\n",
+                summaries[i].id, (int)summaries[i].type,
+                (unsigned long long)summaries[i].invocations, (unsigned long long)summaries[i].failures,
+                (unsigned long long)summaries[i].mean_ns, (unsigned long long)summaries[i].p50_ns,
+                (unsigned long long)summaries[i].p99_ns, (unsigned long long)summaries[i].max_ns);
+    }
+    
+    free(summaries);
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 获取动作类型
+ * 
+ * @param id 动作ID
+ * @param type 类型指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_get_type(action_id_t id, action_type_t *type) {
+    int ret;
+    
+    if (id == ACTION_INVALID_ID || !type) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 查找动作 */
+    ret = pthread_mutex_lock(&action_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    action_t *action = find_action_locked(id);
+    if (!action) {
+        ret = pthread_mutex_unlock(&action_mutex);
+        if (ret != 0) {
+            return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+        }
+        return PHYMUTI_ERROR_ACTION_NOT_FOUND;
+    }
+    
+    *type = action->type;
+    
+    ret = pthread_mutex_unlock(&action_mutex);
+    if (ret != 0) {
         return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
     }
     return PHYMUTI_SUCCESS;
@@ -627,4 +1523,421 @@ int action_get_user_data(action_id_t id, void **user_data) {
         return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
     }
     return PHYMUTI_SUCCESS;
-} 
\ No newline at end of file
+} 
+
+/* 异步执行的工作线程数 */
+#define FUTURE_WORKERS 4
+
+/* 等待外部进程退出时的最长轮询间隔（纳秒） */
+#define FUTURE_POLL_MAX_NS 1000000
+
+/* 异步执行的动作句柄 */
+struct action_future_struct {
+    action_id_t action_id;          /* 动作ID */
+    monitor_context_t context;      /* 监视点上下文 */
+    uint32_t timeout_ms;            /* 外部进程的最长运行时间，0表示不限制 */
+    bool running;                   /* 是否已被工作线程取出 */
+    bool done;                      /* 是否已完成 */
+    bool cancel_requested;          /* 是否请求取消 */
+    bool in_process;                /* 是否正在进程内执行（无法中断） */
+    int result;                     /* 执行结果 */
+    int refs;                       /* 引用数：调用者一个，排队或执行中一个 */
+    struct action_future_struct *next;  /* 队列中的下一个句柄 */
+};
+
+/* 句柄队列、工作线程及其互斥锁；互斥锁和条件变量在清理后仍然可用 */
+static pthread_mutex_t future_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t future_queue_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t future_done_cond;
+static pthread_once_t future_once = PTHREAD_ONCE_INIT;
+static action_future_t *future_head = NULL;
+static action_future_t *future_tail = NULL;
+static pthread_t future_threads[FUTURE_WORKERS];
+static int future_thread_count = 0;
+static bool future_stopping = false;
+
+extern char **environ;
+
+/* 完成条件变量使用单调时钟，等待不受系统时间调整影响 */
+static void future_init_once(void) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&future_done_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/**
+ * @brief 释放一个引用，最后一个引用释放句柄（调用者持有future_mutex）
+ * 
+ * @param future 句柄
+ */
+static void future_release_locked(action_future_t *future) {
+    if (--future->refs == 0) {
+        free(future);
+    }
+}
+
+/**
+ * @brief 标记句柄完成并唤醒等待者（调用者持有future_mutex）
+ * 
+ * @param future 句柄
+ * @param result 执行结果
+ */
+static void future_complete_locked(action_future_t *future, int result) {
+    future->done = true;
+    future->result = result;
+    pthread_cond_broadcast(&future_done_cond);
+}
+
+/**
+ * @brief 在独立的进程组中运行外部命令，超时或被取消时终止整个进程组
+ * 
+ * @param future 句柄
+ * @param command 命令字符串
+ * @return int 成功返回0，失败返回错误码
+ */
+static int future_run_command(action_future_t *future, const char *command) {
+    posix_spawnattr_t attr;
+    pid_t pid;
+    char *argv[] = { "sh", "-c", (char *)command, NULL };
+    
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attr, 0);
+    int ret = posix_spawn(&pid, "/bin/sh", NULL, &attr, argv, environ);
+    posix_spawnattr_destroy(&attr);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_ACTION_EXECUTE_FAILED;
+    }
+    
+    uint64_t deadline = future->timeout_ms ? monotonic_ns() + (uint64_t)future->timeout_ms * 1000000ULL : 0;
+    uint64_t interval = 10000;
+    int status = 0;
+    
+    /* 轮询子进程，间隔逐渐加长；只由本线程发送信号和回收，避免误杀复用的进程号 */
+    while (true) {
+        pid_t waited = waitpid(pid, &status, WNOHANG);
+        if (waited == pid) {
+            break;
+        }
+        if (waited < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            /* 无法取得退出状态（如SIGCHLD被忽略时子进程已被自动回收） */
+            return PHYMUTI_ERROR_ACTION_EXECUTE_FAILED;
+        }
+        
+        pthread_mutex_lock(&future_mutex);
+        bool cancel = future->cancel_requested || future_stopping;
+        pthread_mutex_unlock(&future_mutex);
+        
+        int result = PHYMUTI_SUCCESS;
+        if (cancel) {
+            result = PHYMUTI_ERROR_ACTION_CANCELLED;
+        } else if (deadline && monotonic_ns() >= deadline) {
+            result = PHYMUTI_ERROR_ACTION_TIMEOUT;
+        }
+        if (result != PHYMUTI_SUCCESS) {
+            /* 终止整个进程组并回收子进程，被信号打断时重试 */
+            kill(-pid, SIGKILL);
+            while (waitpid(pid, &status, 0) != pid && errno == EINTR) {
+            }
+            return result;
+        }
+        
+        struct timespec ts = { 0, (long)interval };
+        nanosleep(&ts, NULL);
+        if (interval < FUTURE_POLL_MAX_NS) {
+            interval *= 2;
+        }
+    }
+    
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return PHYMUTI_ERROR_ACTION_EXECUTE_FAILED;
+    }
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 执行一个句柄中的动作
+ * 
+ * @param future 句柄
+ * @return int 执行结果
+ */
+static int future_run(action_future_t *future) {
+    char *command = NULL;
+    char cmd[1024];
+    
+    /* 脚本和命令动作复制命令行后在锁外运行，其他动作按同步方式执行 */
+    uint64_t start = monotonic_ns();
+    pthread_mutex_lock(&action_mutex);
+    action_t *action = find_action_locked(future->action_id);
+    if (!action) {
+        pthread_mutex_unlock(&action_mutex);
+        return PHYMUTI_ERROR_ACTION_NOT_FOUND;
+    }
+    if (action->type == ACTION_TYPE_SCRIPT || action->type == ACTION_TYPE_COMMAND) {
+        if (take_tokens(action, 1) == 0) {
+            pthread_mutex_unlock(&action_mutex);
+            return PHYMUTI_ERROR_ACTION_THROTTLED;
+        }
+        if (action->type == ACTION_TYPE_SCRIPT) {
+            format_script_command(action, &future->context, cmd, sizeof(cmd));
+            command = strdup(cmd);
+        } else {
+            command = strdup(action->data.command_data.command);
+        }
+        action_latency_t *latency = latency_acquire(action);
+        pthread_mutex_unlock(&action_mutex);
+        
+        int result = command ? future_run_command(future, command) : PHYMUTI_ERROR_OUT_OF_MEMORY;
+        free(command);
+        if (latency) {
+            latency_record(latency, monotonic_ns() - start, result);
+            latency_release(latency);
+        }
+        return result;
+    }
+    pthread_mutex_unlock(&action_mutex);
+    
+    /* 进程内执行开始后不能再取消 */
+    pthread_mutex_lock(&future_mutex);
+    bool cancelled = future->cancel_requested;
+    future->in_process = !cancelled;
+    pthread_mutex_unlock(&future_mutex);
+    if (cancelled) {
+        return PHYMUTI_ERROR_ACTION_CANCELLED;
+    }
+    return action_execute(future->action_id, &future->context);
+}
+
+/* 工作线程：依次取出句柄执行，停止时处理完正在执行的句柄后退出 */
+static void* future_worker(void *arg) {
+    (void)arg;
+    
+    pthread_mutex_lock(&future_mutex);
+    while (true) {
+        while (!future_head && !future_stopping) {
+            pthread_cond_wait(&future_queue_cond, &future_mutex);
+        }
+        if (!future_head) {
+            break;
+        }
+        
+        action_future_t *future = future_head;
+        future_head = future->next;
+        if (!future_head) {
+            future_tail = NULL;
+        }
+        future->running = true;
+        pthread_mutex_unlock(&future_mutex);
+        
+        int result = future_run(future);
+        
+        pthread_mutex_lock(&future_mutex);
+        future_complete_locked(future, result);
+        future_release_locked(future);
+    }
+    pthread_mutex_unlock(&future_mutex);
+    
+    return NULL;
+}
+
+/**
+ * @brief 停止工作线程，取消排队中的句柄，终止正在运行的外部进程
+ */
+static void future_shutdown(void) {
+    pthread_mutex_lock(&future_mutex);
+    future_stopping = true;
+    while (future_head) {
+        action_future_t *future = future_head;
+        future_head = future->next;
+        future_complete_locked(future, PHYMUTI_ERROR_ACTION_CANCELLED);
+        future_release_locked(future);
+    }
+    future_tail = NULL;
+    int count = future_thread_count;
+    future_thread_count = 0;
+    pthread_cond_broadcast(&future_queue_cond);
+    pthread_mutex_unlock(&future_mutex);
+    
+    for (int i = 0; i < count; i++) {
+        pthread_join(future_threads[i], NULL);
+    }
+    
+    pthread_mutex_lock(&future_mutex);
+    future_stopping = false;
+    pthread_mutex_unlock(&future_mutex);
+}
+
+/**
+ * @brief 提交动作异步执行
+ * 
+ * @param id 动作ID
+ * @param context 监视点上下文
+ * @param timeout_ms 脚本和命令动作的最长运行时间（毫秒），0表示不限制
+ * @return action_future_t* 成功返回句柄，失败返回NULL
+ */
+action_future_t* action_submit(action_id_t id, const monitor_context_t *context, uint32_t timeout_ms) {
+    if (id == ACTION_INVALID_ID || !context) {
+        return NULL;
+    }
+    
+    pthread_once(&future_once, future_init_once);
+    
+    action_future_t *future = (action_future_t *)calloc(1, sizeof(action_future_t));
+    if (!future) {
+        return NULL;
+    }
+    future->action_id = id;
+    future->context = *context;
+    future->timeout_ms = timeout_ms;
+    future->refs = 2;
+    
+    pthread_mutex_lock(&future_mutex);
+    
+    /* 第一次提交时启动工作线程 */
+    while (future_thread_count < FUTURE_WORKERS &&
+           pthread_create(&future_threads[future_thread_count], NULL, future_worker, NULL) == 0) {
+        future_thread_count++;
+    }
+    if (future_thread_count == 0) {
+        pthread_mutex_unlock(&future_mutex);
+        free(future);
+        return NULL;
+    }
+    
+    if (future_tail) {
+        future_tail->next = future;
+    } else {
+        future_head = future;
+    }
+    future_tail = future;
+    pthread_cond_signal(&future_queue_cond);
+    
+    pthread_mutex_unlock(&future_mutex);
+    return future;
+}
+
+/**
+ * @brief 等待异步执行的动作完成
+ * 
+ * @param future 句柄
+ * @param timeout_ms 最长等待时间（毫秒），ACTION_WAIT_FOREVER表示一直等待
+ * @param result 完成时返回动作的执行结果，可以为NULL
+ * @return int 已完成返回0，等待超时返回PHYMUTI_ERROR_TIMEOUT，失败返回错误码
+ */
+int action_future_wait(action_future_t *future, uint32_t timeout_ms, int *result) {
+    if (!future) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    
+    pthread_mutex_lock(&future_mutex);
+    while (!future->done) {
+        if (timeout_ms == ACTION_WAIT_FOREVER) {
+            pthread_cond_wait(&future_done_cond, &future_mutex);
+        } else if (pthread_cond_timedwait(&future_done_cond, &future_mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    bool done = future->done;
+    if (done && result) {
+        *result = future->result;
+    }
+    pthread_mutex_unlock(&future_mutex);
+    
+    return done ? PHYMUTI_SUCCESS : PHYMUTI_ERROR_TIMEOUT;
+}
+
+/**
+ * @brief 查询异步执行的动作是否完成，不等待
+ * 
+ * @param future 句柄
+ * @param done 返回是否已完成
+ * @param result 完成时返回动作的执行结果，可以为NULL
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_future_poll(action_future_t *future, bool *done, int *result) {
+    if (!future || !done) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    pthread_mutex_lock(&future_mutex);
+    *done = future->done;
+    if (future->done && result) {
+        *result = future->result;
+    }
+    pthread_mutex_unlock(&future_mutex);
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 取消异步执行的动作
+ * 
+ * @param future 句柄
+ * @return int 成功取消返回0，已完成或正在进程内执行无法取消时返回PHYMUTI_ERROR_BUSY
+ */
+int action_future_cancel(action_future_t *future) {
+    int ret = PHYMUTI_SUCCESS;
+    
+    if (!future) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    pthread_mutex_lock(&future_mutex);
+    if (future->done || future->in_process) {
+        ret = PHYMUTI_ERROR_BUSY;
+    } else if (!future->running) {
+        /* 从队列中摘除，直接完成 */
+        action_future_t **link = &future_head;
+        action_future_t *prev = NULL;
+        while (*link != future) {
+            prev = *link;
+            link = &(*link)->next;
+        }
+        *link = future->next;
+        if (future_tail == future) {
+            future_tail = prev;
+        }
+        future_complete_locked(future, PHYMUTI_ERROR_ACTION_CANCELLED);
+        future_release_locked(future);
+    } else {
+        /* 正在运行的外部进程由工作线程终止 */
+        future->cancel_requested = true;
+    }
+    pthread_mutex_unlock(&future_mutex);
+    
+    return ret;
+}
+
+/**
+ * @brief 释放句柄，动作尚未完成时先尝试取消
+ * 
+ * @param future 句柄
+ * @return int 成功返回0，失败返回错误码
+ */
+int action_future_destroy(action_future_t *future) {
+    if (!future) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    action_future_cancel(future);
+    
+    pthread_mutex_lock(&future_mutex);
+    future_release_locked(future);
+    pthread_mutex_unlock(&future_mutex);
+    
+    return PHYMUTI_SUCCESS;
+}
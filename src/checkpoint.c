@@ -0,0 +1,1363 @@
+/**
+ * @file checkpoint.c
+ * @brief 检查点模块实现
+ */
+
+#include "checkpoint.h"
+#include "device_manager.h"
+#include "monitor.h"
+#include "phymuti_error.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* 上一个检查点时的区域内容副本，用于计算增量 */
+typedef struct checkpoint_shadow {
+    uint32_t id;                     /* 内存区域ID */
+    uint64_t base_addr;              /* 基地址 */
+    size_t size;                     /* 大小（字节） */
+    uint8_t *data;                   /* 内容副本 */
+    size_t map_size;                 /* 副本为检查点文件的私有映射时的映射大小，为0时由malloc分配 */
+    struct checkpoint_shadow *next;
+} checkpoint_shadow_t;
+
+/* 上一个检查点时的设备状态副本 */
+typedef struct checkpoint_device_shadow {
+    char name[CHECKPOINT_NAME_MAX];  /* 设备名称 */
+    uint8_t *state;                  /* 状态副本 */
+    size_t size;                     /* 状态大小 */
+    struct checkpoint_device_shadow *next;
+} checkpoint_device_shadow_t;
+
+/* 内存中的检查点内容（沿父链合并后的结果） */
+typedef struct {
+    checkpoint_region_entry_t entry; /* 区域信息 */
+    uint8_t *data;                   /* 区域内容 */
+    size_t map_size;                 /* 内容为检查点文件的私有映射时的映射大小，为0时由malloc分配 */
+    int fd;                          /* 内容映射自的检查点文件，未映射时为-1 */
+    uint64_t file_offset;            /* 原始数据在该文件中的偏移 */
+    uint64_t *patched;               /* 映射后被增量修改过的页位图，没有修改时为NULL */
+} checkpoint_region_image_t;
+
+typedef struct {
+    char name[CHECKPOINT_NAME_MAX];  /* 设备名称 */
+    uint8_t *state;                  /* 设备状态 */
+    size_t size;                     /* 状态大小 */
+} checkpoint_device_image_t;
+
+typedef struct {
+    checkpoint_region_image_t *regions;
+    size_t region_count;
+    checkpoint_device_image_t *devices;
+    size_t device_count;
+    uint64_t id;                     /* 最后应用的检查点ID */
+    uint32_t depth;                  /* 最后应用的检查点层数 */
+} checkpoint_image_t;
+
+/* 待写出的内存区域 */
+typedef struct {
+    checkpoint_region_entry_t entry;
+    const uint8_t *data;             /* 原始数据或增量记录 */
+    uint8_t *owned;                  /* 需要释放的增量记录缓冲区 */
+} checkpoint_region_out_t;
+
+/* 待写出的设备 */
+typedef struct {
+    checkpoint_device_entry_t entry;
+    const uint8_t *state;
+} checkpoint_device_out_t;
+
+/* 映射的检查点文件 */
+typedef struct {
+    int fd;
+    void *map;
+    size_t size;
+    const checkpoint_file_header_t *header;
+    const checkpoint_region_entry_t *regions;
+    const checkpoint_device_entry_t *devices;
+} checkpoint_file_t;
+
+/* 收集到的设备状态 */
+typedef struct {
+    char name[CHECKPOINT_NAME_MAX];
+    uint8_t *state;
+    size_t size;
+} checkpoint_device_state_t;
+
+typedef struct {
+    checkpoint_device_state_t *items;
+    size_t count;
+    size_t capacity;
+} checkpoint_device_list_t;
+
+/* 收集到的内存区域 */
+typedef struct {
+    memory_region_t **items;
+    size_t count;
+    size_t capacity;
+} checkpoint_region_list_t;
+
+/* 增量检查点的父检查点状态 */
+static checkpoint_shadow_t *shadow_list = NULL;
+static checkpoint_device_shadow_t *device_shadow_list = NULL;
+static bool have_parent = false;
+static char parent_path[CHECKPOINT_PATH_MAX];
+static uint64_t parent_id = 0;
+static uint32_t parent_depth = 0;
+static uint64_t last_checkpoint_id = 0;
+
+/* 检查点模块的互斥锁 */
+static pthread_mutex_t checkpoint_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief 生成新的检查点ID
+ */
+static uint64_t new_checkpoint_id(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t id = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    if (id <= last_checkpoint_id) {
+        id = last_checkpoint_id + 1;
+    }
+    last_checkpoint_id = id;
+    return id;
+}
+
+/**
+ * @brief 复制名称，超长时截断
+ */
+static void copy_name(char *dst, const char *src) {
+    memset(dst, 0, CHECKPOINT_NAME_MAX);
+    if (src) {
+        strncpy(dst, src, CHECKPOINT_NAME_MAX - 1);
+    }
+}
+
+/**
+ * @brief 释放区域内容（malloc分配或文件映射）
+ */
+static void free_region_data(uint8_t *data, size_t map_size) {
+    if (map_size > 0) {
+        munmap(data, map_size);
+    } else {
+        free(data);
+    }
+}
+
+/**
+ * @brief 释放父检查点状态
+ */
+static void free_session(void) {
+    while (shadow_list) {
+        checkpoint_shadow_t *next = shadow_list->next;
+        free_region_data(shadow_list->data, shadow_list->map_size);
+        free(shadow_list);
+        shadow_list = next;
+    }
+
+    while (device_shadow_list) {
+        checkpoint_device_shadow_t *next = device_shadow_list->next;
+        free(device_shadow_list->state);
+        free(device_shadow_list);
+        device_shadow_list = next;
+    }
+
+    have_parent = false;
+    parent_id = 0;
+    parent_depth = 0;
+    parent_path[0] = '\0';
+}
+
+/**
+ * @brief 查找区域的内容副本
+ */
+static checkpoint_shadow_t* find_shadow(uint32_t id, uint64_t base_addr, size_t size) {
+    for (checkpoint_shadow_t *s = shadow_list; s; s = s->next) {
+        if (s->id == id && s->base_addr == base_addr && s->size == size) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 释放内存中的检查点内容
+ */
+static void free_image(checkpoint_image_t *image) {
+    for (size_t i = 0; i < image->region_count; i++) {
+        free_region_data(image->regions[i].data, image->regions[i].map_size);
+        if (image->regions[i].fd >= 0) {
+            close(image->regions[i].fd);
+        }
+        free(image->regions[i].patched);
+    }
+    for (size_t i = 0; i < image->device_count; i++) {
+        free(image->devices[i].state);
+    }
+    free(image->regions);
+    free(image->devices);
+    memset(image, 0, sizeof(*image));
+}
+
+/**
+ * @brief 收集内存区域（遍历时持有链表锁，只记录指针）
+ */
+static int collect_region(memory_region_t *region, void *user_data) {
+    checkpoint_region_list_t *list = (checkpoint_region_list_t *)user_data;
+
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 16;
+        memory_region_t **items = (memory_region_t **)realloc(list->items, capacity * sizeof(memory_region_t *));
+        if (!items) {
+            return PHYMUTI_ERROR_OUT_OF_MEMORY;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+
+    list->items[list->count++] = region;
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 收集设备状态，不支持保存状态的设备不参与检查点
+ */
+static int collect_device(device_handle_t device, void *user_data) {
+    checkpoint_device_list_t *list = (checkpoint_device_list_t *)user_data;
+    void *state = NULL;
+    size_t size = 0;
+
+    int ret = device_save_state_alloc(device, &state, &size);
+    if (ret == PHYMUTI_ERROR_NOT_SUPPORTED) {
+        return PHYMUTI_SUCCESS;
+    }
+    if (ret != PHYMUTI_SUCCESS) {
+        return ret;
+    }
+
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 8;
+        checkpoint_device_state_t *items = (checkpoint_device_state_t *)realloc(
+            list->items, capacity * sizeof(checkpoint_device_state_t));
+        if (!items) {
+            free(state);
+            return PHYMUTI_ERROR_OUT_OF_MEMORY;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+
+    checkpoint_device_state_t *item = &list->items[list->count++];
+    copy_name(item->name, device_get_name(device));
+    item->state = (uint8_t *)state;
+    item->size = size;
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 释放收集到的设备状态
+ */
+static void free_device_list(checkpoint_device_list_t *list) {
+    for (size_t i = 0; i < list->count; i++) {
+        free(list->items[i].state);
+    }
+    free(list->items);
+}
+
+/**
+ * @brief 收集当前的内存区域和设备状态
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+static int collect_state(checkpoint_region_list_t *regions, checkpoint_device_list_t *devices) {
+    memset(regions, 0, sizeof(*regions));
+    memset(devices, 0, sizeof(*devices));
+
+    int ret = memory_region_foreach(collect_region, regions);
+    if (ret == PHYMUTI_SUCCESS) {
+        ret = device_foreach(collect_device, devices);
+    }
+
+    if (ret != PHYMUTI_SUCCESS) {
+        free(regions->items);
+        free_device_list(devices);
+    }
+    return ret;
+}
+
+/**
+ * @brief 写入LEB128编码的无符号整数
+ */
+static size_t put_varint(uint8_t *out, size_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+/**
+ * @brief 读取LEB128编码的无符号整数
+ *
+ * @return size_t 读取的字节数，数据不完整时返回0
+ */
+static size_t get_varint(const uint8_t *in, size_t avail, size_t *value) {
+    size_t result = 0;
+    for (size_t n = 0; n < avail && n < 10; n++) {
+        result |= (size_t)(in[n] & 0x7f) << (7 * n);
+        if (!(in[n] & 0x80)) {
+            *value = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+/* 字面量中允许夹带的最长相同字节数，更长时结束字面量 */
+#define CHECKPOINT_RLE_MIN_RUN 4
+
+/* 一页编码后的最大长度 */
+#define CHECKPOINT_RLE_MAX (MEMORY_PAGE_SIZE * 2 + 32)
+
+/**
+ * @brief 对一页做异或游程编码
+ *
+ * 编码为若干(相同字节数, 字面量字节数, 异或字面量)三元组，
+ * 末尾的相同字节不编码。
+ *
+ * @param cur 当前内容
+ * @param old 父检查点内容
+ * @param len 页长度
+ * @param out 输出缓冲区，至少CHECKPOINT_RLE_MAX字节
+ * @return size_t 编码长度，内容相同时为0
+ */
+static size_t encode_page(const uint8_t *cur, const uint8_t *old, size_t len, uint8_t *out) {
+    size_t pos = 0, o = 0;
+
+    while (pos < len) {
+        size_t zeros = 0;
+        while (pos + zeros < len && cur[pos + zeros] == old[pos + zeros]) {
+            zeros++;
+        }
+        pos += zeros;
+        if (pos == len) {
+            break;
+        }
+
+        /* 字面量一直延伸到足够长的相同字节段之前 */
+        size_t lit = 0;
+        while (pos + lit < len) {
+            if (cur[pos + lit] != old[pos + lit]) {
+                lit++;
+                continue;
+            }
+            size_t same = 0;
+            while (pos + lit + same < len && cur[pos + lit + same] == old[pos + lit + same]) {
+                same++;
+            }
+            if (same >= CHECKPOINT_RLE_MIN_RUN || pos + lit + same == len) {
+                break;
+            }
+            lit += same;
+        }
+
+        o += put_varint(out + o, zeros);
+        o += put_varint(out + o, lit);
+        for (size_t i = 0; i < lit; i++) {
+            out[o++] = cur[pos + i] ^ old[pos + i];
+        }
+        pos += lit;
+    }
+
+    return o;
+}
+
+/**
+ * @brief 把一页的异或游程编码应用到父检查点内容上
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+static int decode_page(uint8_t *page, size_t len, const uint8_t *in, size_t in_len) {
+    size_t pos = 0, i = 0;
+
+    while (i < in_len) {
+        size_t zeros, lit, n;
+
+        n = get_varint(in + i, in_len - i, &zeros);
+        if (n == 0) {
+            return PHYMUTI_ERROR_CHECKPOINT_FORMAT;
+        }
+        i += n;
+        n = get_varint(in + i, in_len - i, &lit);
+        if (n == 0) {
+            return PHYMUTI_ERROR_CHECKPOINT_FORMAT;
+        }
+        i += n;
+
+        if (zeros > len - pos || lit > len - pos - zeros || lit > in_len - i) {
+            return PHYMUTI_ERROR_CHECKPOINT_FORMAT;
+        }
+        pos += zeros;
+        for (size_t k = 0; k < lit; k++) {
+            page[pos + k] ^= in[i + k];
+        }
+        pos += lit;
+        i += lit;
+    }
+
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 写入指定数量的零字节
+ */
+static int write_padding(FILE *fp, size_t count) {
+    static const uint8_t zeros[256];
+    while (count > 0) {
+        size_t n = count < sizeof(zeros) ? count : sizeof(zeros);
+        if (fwrite(zeros, 1, n, fp) != n) {
+            return PHYMUTI_ERROR_IO;
+        }
+        count -= n;
+    }
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 写出检查点文件
+ *
+ * 先写入临时文件再改名，失败时不会留下不完整的检查点。
+ * 原始数据按MEMORY_PAGE_SIZE对齐，恢复时可直接映射。
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+static int write_checkpoint(const char *path, checkpoint_file_header_t *header,
+                            checkpoint_region_out_t *regions, size_t region_count,
+                            checkpoint_device_out_t *devices, size_t device_count) {
+    char tmp_path[CHECKPOINT_PATH_MAX + 8];
+    int ret = PHYMUTI_SUCCESS;
+
+    if (strlen(path) >= CHECKPOINT_PATH_MAX) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    /* 先确定所有数据的偏移 */
+    uint64_t offset = sizeof(checkpoint_file_header_t) +
+                      region_count * sizeof(checkpoint_region_entry_t) +
+                      device_count * sizeof(checkpoint_device_entry_t);
+    for (size_t i = 0; i < region_count; i++) {
+        if (regions[i].entry.encoding == CHECKPOINT_REGION_RAW) {
+            offset = (offset + MEMORY_PAGE_SIZE - 1) / MEMORY_PAGE_SIZE * MEMORY_PAGE_SIZE;
+        }
+        regions[i].entry.data_offset = offset;
+        offset += regions[i].entry.data_length;
+    }
+    for (size_t i = 0; i < device_count; i++) {
+        devices[i].entry.data_offset = offset;
+        offset += devices[i].entry.data_length;
+    }
+
+    header->region_count = (uint32_t)region_count;
+    header->device_count = (uint32_t)device_count;
+
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        return PHYMUTI_ERROR_IO;
+    }
+
+    uint64_t written = 0;
+    if (fwrite(header, sizeof(*header), 1, fp) != 1) {
+        ret = PHYMUTI_ERROR_IO;
+    }
+    written += sizeof(*header);
+    for (size_t i = 0; ret == PHYMUTI_SUCCESS && i < region_count; i++) {
+        if (fwrite(&regions[i].entry, sizeof(regions[i].entry), 1, fp) != 1) {
+            ret = PHYMUTI_ERROR_IO;
+        }
+        written += sizeof(regions[i].entry);
+    }
+    for (size_t i = 0; ret == PHYMUTI_SUCCESS && i < device_count; i++) {
+        if (fwrite(&devices[i].entry, sizeof(devices[i].entry), 1, fp) != 1) {
+            ret = PHYMUTI_ERROR_IO;
+        }
+        written += sizeof(devices[i].entry);
+    }
+
+    for (size_t i = 0; ret == PHYMUTI_SUCCESS && i < region_count; i++) {
+        ret = write_padding(fp, (size_t)(regions[i].entry.data_offset - written));
+        if (ret == PHYMUTI_SUCCESS && regions[i].entry.data_length > 0 &&
+            fwrite(regions[i].data, 1, regions[i].entry.data_length, fp) != regions[i].entry.data_length) {
+            ret = PHYMUTI_ERROR_IO;
+        }
+        written = regions[i].entry.data_offset + regions[i].entry.data_length;
+    }
+    for (size_t i = 0; ret == PHYMUTI_SUCCESS && i < device_count; i++) {
+        if (devices[i].entry.data_length > 0 &&
+            fwrite(devices[i].state, 1, devices[i].entry.data_length, fp) != devices[i].entry.data_length) {
+            ret = PHYMUTI_ERROR_IO;
+        }
+    }
+
+    if (fclose(fp) != 0 && ret == PHYMUTI_SUCCESS) {
+        ret = PHYMUTI_ERROR_IO;
+    }
+
+    if (ret == PHYMUTI_SUCCESS && rename(tmp_path, path) != 0) {
+        ret = PHYMUTI_ERROR_IO;
+    }
+    if (ret != PHYMUTI_SUCCESS) {
+        remove(tmp_path);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief 解除检查点文件映射
+ */
+static void close_checkpoint(checkpoint_file_t *file) {
+    if (file->map) {
+        munmap(file->map, file->size);
+    }
+    if (file->fd >= 0) {
+        close(file->fd);
+    }
+    memset(file, 0, sizeof(*file));
+    file->fd = -1;
+}
+
+/**
+ * @brief 映射并校验检查点文件
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+static int open_checkpoint(const char *path, checkpoint_file_t *file) {
+    struct stat st;
+
+    memset(file, 0, sizeof(*file));
+    file->fd = -1;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return PHYMUTI_ERROR_IO;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(checkpoint_file_header_t)) {
+        close(fd);
+        return PHYMUTI_ERROR_CHECKPOINT_FORMAT;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return PHYMUTI_ERROR_IO;
+    }
+
+    /* 保留文件描述符，原始区域数据可按需单独映射 */
+    file->fd = fd;
+    file->map = map;
+    file->size = (size_t)st.st_size;
+    file->header = (const checkpoint_file_header_t *)map;
+
+    const checkpoint_file_header_t *h = file->header;
+    uint64_t table_end = sizeof(*h) +
+                         (uint64_t)h->region_count * sizeof(checkpoint_region_entry_t) +
+                         (uint64_t)h->device_count * sizeof(checkpoint_device_entry_t);
+    if (memcmp(h->magic, CHECKPOINT_FILE_MAGIC, sizeof(CHECKPOINT_FILE_MAGIC)) != 0 ||
+        h->version != CHECKPOINT_FILE_VERSION ||
+        (h->kind != CHECKPOINT_FULL && h->kind != CHECKPOINT_INCREMENTAL) ||
+        table_end > file->size ||
+        memchr(h->parent_path, '\0', sizeof(h->parent_path)) == NULL) {
+        close_checkpoint(file);
+        return PHYMUTI_ERROR_CHECKPOINT_FORMAT;
+    }
+
+    file->regions = (const checkpoint_region_entry_t *)(h + 1);
+    file->devices = (const checkpoint_device_entry_t *)(file->regions + h->region_count);
+
+    /* 所有数据都必须在文件范围内 */
+    for (uint32_t i = 0; i < h->region_count; i++) {
+        const checkpoint_region_entry_t *e = &file->regions[i];
+        if (e->data_offset > file->size || e->data_length > file->size - e->data_offset ||
+            (e->encoding == CHECKPOINT_REGION_RAW && e->data_length != e->size) ||
+            (e->encoding != CHECKPOINT_REGION_RAW && e->encoding != CHECKPOINT_REGION_DELTA)) {
+            close_checkpoint(file);
+            return PHYMUTI_ERROR_CHECKPOINT_FORMAT;
+        }
+    }
+    for (uint32_t i = 0; i < h->device_count; i++) {
+        const checkpoint_device_entry_t *e = &file->devices[i];
+        if (e->data_offset > file->size || e->data_length > file->size - e->data_offset) {
+            close_checkpoint(file);
+            return PHYMUTI_ERROR_CHECKPOINT_FORMAT;
+        }
+    }
+
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 确定父检查点的实际路径
+ *
+ * 先按记录的路径查找，找不到时在子检查点所在目录中按文件名查找，
+ * 这样整个检查点目录移动后仍可恢复。
+ */
+static int resolve_parent(const char *child, const char *parent, char *out, size_t out_size) {
+    if (access(parent, R_OK) == 0) {
+        snprintf(out, out_size, "%s", parent);
+        return PHYMUTI_SUCCESS;
+    }
+
+    const char *slash = strrchr(child, '/');
+    const char *base = strrchr(parent, '/');
+    base = base ? base + 1 : parent;
+    if (slash) {
+        snprintf(out, out_size, "%.*s/%s", (int)(slash - child), child, base);
+    } else {
+        snprintf(out, out_size, "%s", base);
+    }
+
+    return access(out, R_OK) == 0 ? PHYMUTI_SUCCESS : PHYMUTI_ERROR_CHECKPOINT_NO_PARENT;
+}
+
+/**
+ * @brief 取得原始区域数据
+ *
+ * 数据偏移按系统页对齐时把文件私有映射为可写内存，页在首次访问时才读入，
+ * 应用增量只复制被修改的页；否则复制到堆上。
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+static int map_region_data(const checkpoint_file_t *file, checkpoint_region_image_t *r) {
+    const checkpoint_region_entry_t *e = &r->entry;
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    if (e->size > 0 && e->data_offset % page_size == 0) {
+        size_t map_size = (e->size + page_size - 1) / page_size * page_size;
+        void *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file->fd, (off_t)e->data_offset);
+        if (map != MAP_FAILED) {
+            r->fd = dup(file->fd);
+            if (r->fd >= 0) {
+                r->data = (uint8_t *)map;
+                r->map_size = map_size;
+                r->file_offset = e->data_offset;
+                return PHYMUTI_SUCCESS;
+            }
+            munmap(map, map_size);
+        }
+    }
+
+    r->data = (uint8_t *)malloc(e->size ? e->size : 1);
+    if (!r->data) {
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    memcpy(r->data, (const uint8_t *)file->map + e->data_offset, e->size);
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 把一个检查点文件应用到内存中的检查点内容上
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+static int apply_checkpoint(checkpoint_image_t *image, const checkpoint_file_t *file) {
+    const checkpoint_file_header_t *h = file->header;
+    const uint8_t *base = (const uint8_t *)file->map;
+    int ret = PHYMUTI_SUCCESS;
+
+    checkpoint_image_t next = { 0 };
+    next.regions = (checkpoint_region_image_t *)calloc(h->region_count + 1, sizeof(checkpoint_region_image_t));
+    next.devices = (checkpoint_device_image_t *)calloc(h->device_count + 1, sizeof(checkpoint_device_image_t));
+    if (!next.regions || !next.devices) {
+        free_image(&next);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+
+    for (uint32_t i = 0; ret == PHYMUTI_SUCCESS && i < h->region_count; i++) {
+        const checkpoint_region_entry_t *e = &file->regions[i];
+        checkpoint_region_image_t *r = &next.regions[next.region_count++];
+        r->entry = *e;
+        r->fd = -1;
+
+        if (e->encoding == CHECKPOINT_REGION_RAW) {
+            ret = map_region_data(file, r);
+            continue;
+        }
+
+        /* 增量：接管父检查点中同一区域的内容并应用变化页 */
+        checkpoint_region_image_t *parent = NULL;
+        for (size_t k = 0; k < image->region_count; k++) {
+            if (image->regions[k].data && image->regions[k].entry.id == e->id &&
+                image->regions[k].entry.size == e->size) {
+                parent = &image->regions[k];
+                break;
+            }
+        }
+        if (!parent) {
+            ret = PHYMUTI_ERROR_CHECKPOINT_FORMAT;
+            break;
+        }
+        r->data = parent->data;
+        r->map_size = parent->map_size;
+        r->fd = parent->fd;
+        r->file_offset = parent->file_offset;
+        r->patched = parent->patched;
+        parent->data = NULL;
+        parent->map_size = 0;
+        parent->fd = -1;
+        parent->patched = NULL;
+
+        size_t pages = (e->size + MEMORY_PAGE_SIZE - 1) / MEMORY_PAGE_SIZE;
+        if (r->fd >= 0 && !r->patched && e->page_records > 0) {
+            r->patched = (uint64_t *)calloc((pages + 63) / 64, sizeof(uint64_t));
+            if (!r->patched) {
+                ret = PHYMUTI_ERROR_OUT_OF_MEMORY;
+                break;
+            }
+        }
+
+        size_t pos = 0;
+        const uint8_t *records = base + e->data_offset;
+        for (uint32_t p = 0; ret == PHYMUTI_SUCCESS && p < e->page_records; p++) {
+            checkpoint_page_record_t rec;
+            if (e->data_length - pos < sizeof(rec)) {
+                ret = PHYMUTI_ERROR_CHECKPOINT_FORMAT;
+                break;
+            }
+            memcpy(&rec, records + pos, sizeof(rec));
+            pos += sizeof(rec);
+
+            size_t offset = (size_t)rec.page * MEMORY_PAGE_SIZE;
+            if (offset >= e->size || rec.length > e->data_length - pos) {
+                ret = PHYMUTI_ERROR_CHECKPOINT_FORMAT;
+                break;
+            }
+            size_t len = e->size - offset < MEMORY_PAGE_SIZE ? e->size - offset : MEMORY_PAGE_SIZE;
+            ret = decode_page(r->data + offset, len, records + pos, rec.length);
+            pos += rec.length;
+            if (r->patched) {
+                r->patched[rec.page / 64] |= 1ull << (rec.page % 64);
+            }
+        }
+    }
+
+    for (uint32_t i = 0; ret == PHYMUTI_SUCCESS && i < h->device_count; i++) {
+        const checkpoint_device_entry_t *e = &file->devices[i];
+        checkpoint_device_image_t *d = &next.devices[next.device_count];
+
+        copy_name(d->name, e->name);
+        if (e->present) {
+            d->state = (uint8_t *)malloc(e->data_length ? e->data_length : 1);
+            if (!d->state) {
+                ret = PHYMUTI_ERROR_OUT_OF_MEMORY;
+                break;
+            }
+            memcpy(d->state, base + e->data_offset, e->data_length);
+            d->size = e->data_length;
+        } else {
+            /* 未变化：接管父检查点中同名设备的状态 */
+            checkpoint_device_image_t *parent = NULL;
+            for (size_t k = 0; k < image->device_count; k++) {
+                if (image->devices[k].state && strcmp(image->devices[k].name, d->name) == 0) {
+                    parent = &image->devices[k];
+                    break;
+                }
+            }
+            if (!parent) {
+                ret = PHYMUTI_ERROR_CHECKPOINT_FORMAT;
+                break;
+            }
+            d->state = parent->state;
+            d->size = parent->size;
+            parent->state = NULL;
+        }
+        next.device_count++;
+    }
+
+    if (ret != PHYMUTI_SUCCESS) {
+        free_image(&next);
+        return ret;
+    }
+
+    /* 父检查点中未被接管的内容（已删除的区域和设备）一并释放 */
+    free_image(image);
+    next.id = h->id;
+    next.depth = h->depth;
+    *image = next;
+
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 沿父链加载检查点，得到合并后的完整内容
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+static int load_chain(const char *path, checkpoint_image_t *image) {
+    checkpoint_file_t file;
+    char **chain = NULL;
+    size_t chain_len = 0;
+    int ret;
+
+    memset(image, 0, sizeof(*image));
+
+    /* 从目标检查点向上找到完整检查点，记录路径 */
+    char current[CHECKPOINT_PATH_MAX];
+    snprintf(current, sizeof(current), "%s", path);
+    uint64_t expected_id = 0;
+    uint32_t expected_depth = 0;
+
+    for (;;) {
+        ret = open_checkpoint(current, &file);
+        if (ret != PHYMUTI_SUCCESS) {
+            break;
+        }
+
+        const checkpoint_file_header_t *h = file.header;
+        if (chain_len > 0 && (h->id != expected_id || h->depth != expected_depth)) {
+            close_checkpoint(&file);
+            ret = PHYMUTI_ERROR_CHECKPOINT_FORMAT;
+            break;
+        }
+        if (h->kind == CHECKPOINT_FULL ? h->depth != 0 : h->depth == 0) {
+            close_checkpoint(&file);
+            ret = PHYMUTI_ERROR_CHECKPOINT_FORMAT;
+            break;
+        }
+
+        char **grown = (char **)realloc(chain, (chain_len + 1) * sizeof(char *));
+        if (!grown || !(grown[chain_len] = strdup(current))) {
+            chain = grown ? grown : chain;
+            close_checkpoint(&file);
+            ret = PHYMUTI_ERROR_OUT_OF_MEMORY;
+            break;
+        }
+        chain = grown;
+        chain_len++;
+
+        if (h->kind == CHECKPOINT_FULL) {
+            close_checkpoint(&file);
+            break;
+        }
+
+        expected_id = h->parent_id;
+        expected_depth = h->depth - 1;
+        char parent[CHECKPOINT_PATH_MAX];
+        ret = resolve_parent(current, h->parent_path, parent, sizeof(parent));
+        close_checkpoint(&file);
+        if (ret != PHYMUTI_SUCCESS) {
+            break;
+        }
+        memcpy(current, parent, sizeof(current));
+    }
+
+    /* 从完整检查点开始依次应用 */
+    for (size_t i = chain_len; ret == PHYMUTI_SUCCESS && i > 0; i--) {
+        ret = open_checkpoint(chain[i - 1], &file);
+        if (ret == PHYMUTI_SUCCESS) {
+            ret = apply_checkpoint(image, &file);
+            close_checkpoint(&file);
+        }
+    }
+
+    for (size_t i = 0; i < chain_len; i++) {
+        free(chain[i]);
+    }
+    free(chain);
+
+    if (ret != PHYMUTI_SUCCESS) {
+        free_image(image);
+    }
+    return ret;
+}
+
+/**
+ * @brief 初始化检查点文件头
+ */
+static void init_header(checkpoint_file_header_t *header, checkpoint_kind_t kind) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, CHECKPOINT_FILE_MAGIC, sizeof(CHECKPOINT_FILE_MAGIC));
+    header->version = CHECKPOINT_FILE_VERSION;
+    header->kind = kind;
+    header->id = new_checkpoint_id();
+}
+
+/**
+ * @brief 清理检查点模块资源
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+int checkpoint_cleanup(void) {
+    int ret = pthread_mutex_lock(&checkpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    free_session();
+
+    ret = pthread_mutex_unlock(&checkpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 保存检查点（完整或增量），调用者持有checkpoint_mutex
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+static int save_locked(const char *path, checkpoint_kind_t kind) {
+    checkpoint_region_list_t regions;
+    checkpoint_device_list_t devices;
+    checkpoint_file_header_t header;
+    uint8_t page_buf[CHECKPOINT_RLE_MAX];
+    int ret;
+
+    ret = collect_state(&regions, &devices);
+    if (ret != PHYMUTI_SUCCESS) {
+        return ret;
+    }
+
+    init_header(&header, kind);
+    if (kind == CHECKPOINT_INCREMENTAL) {
+        header.parent_id = parent_id;
+        header.depth = parent_depth + 1;
+        memcpy(header.parent_path, parent_path, sizeof(header.parent_path));
+    }
+
+    checkpoint_region_out_t *rout = (checkpoint_region_out_t *)calloc(regions.count + 1, sizeof(*rout));
+    checkpoint_device_out_t *dout = (checkpoint_device_out_t *)calloc(devices.count + 1, sizeof(*dout));
+    checkpoint_shadow_t *new_shadows = NULL;
+    if (!rout || !dout) {
+        ret = PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+
+    for (size_t i = 0; ret == PHYMUTI_SUCCESS && i < regions.count; i++) {
+        memory_region_t *region = regions.items[i];
+        checkpoint_region_out_t *out = &rout[i];
+        size_t size = memory_region_get_size(region);
+        size_t pages = (size + MEMORY_PAGE_SIZE - 1) / MEMORY_PAGE_SIZE;
+        const uint8_t *data = memory_region_data(region);
+
+        out->entry.id = memory_region_get_id(region);
+        out->entry.flags = memory_region_get_flags(region);
+        out->entry.base_addr = memory_region_get_base_addr(region);
+        out->entry.size = size;
+        copy_name(out->entry.name, memory_region_get_name(region));
+
+        /* 先清除脏页标记再读取内容，期间的写入留给下一个检查点 */
+        uint64_t *dirty = (uint64_t *)malloc(((pages + 63) / 64) * sizeof(uint64_t));
+        if (!dirty) {
+            ret = PHYMUTI_ERROR_OUT_OF_MEMORY;
+            break;
+        }
+        memory_region_take_dirty_pages(region, dirty);
+
+        checkpoint_shadow_t *shadow = find_shadow(out->entry.id, out->entry.base_addr, size);
+        bool is_new = (shadow == NULL);
+        if (shadow) {
+            /* 从旧链表中摘下，保存结束后旧链表中剩余的是已删除区域 */
+            checkpoint_shadow_t **pp = &shadow_list;
+            while (*pp != shadow) {
+                pp = &(*pp)->next;
+            }
+            *pp = shadow->next;
+        } else {
+            shadow = (checkpoint_shadow_t *)calloc(1, sizeof(*shadow));
+            if (shadow) {
+                shadow->data = (uint8_t *)malloc(size);
+            }
+            if (!shadow || !shadow->data) {
+                free(shadow);
+                free(dirty);
+                ret = PHYMUTI_ERROR_OUT_OF_MEMORY;
+                break;
+            }
+            shadow->id = out->entry.id;
+            shadow->base_addr = out->entry.base_addr;
+            shadow->size = size;
+        }
+        shadow->next = new_shadows;
+        new_shadows = shadow;
+
+        /* 完整检查点和新区域保存原始数据，从副本写出以保证二者一致 */
+        if (kind == CHECKPOINT_FULL || is_new) {
+            memcpy(shadow->data, data, size);
+            out->entry.encoding = CHECKPOINT_REGION_RAW;
+            out->entry.data_length = size;
+            out->data = shadow->data;
+            free(dirty);
+            continue;
+        }
+
+        /* 增量：逐个脏页与副本比较，编码后更新副本 */
+        uint8_t *records = NULL;
+        size_t records_len = 0, records_cap = 0;
+        out->entry.encoding = CHECKPOINT_REGION_DELTA;
+        for (size_t page = 0; ret == PHYMUTI_SUCCESS && page < pages; page++) {
+            if (!(dirty[page / 64] & (1ull << (page % 64)))) {
+                continue;
+            }
+
+            size_t offset = page * MEMORY_PAGE_SIZE;
+            size_t len = size - offset < MEMORY_PAGE_SIZE ? size - offset : MEMORY_PAGE_SIZE;
+            size_t enc = encode_page(data + offset, shadow->data + offset, len, page_buf);
+            if (enc == 0) {
+                continue;
+            }
+
+            if (records_len + sizeof(checkpoint_page_record_t) + enc > records_cap) {
+                size_t cap = records_cap ? records_cap * 2 : 4 * MEMORY_PAGE_SIZE;
+                while (cap < records_len + sizeof(checkpoint_page_record_t) + enc) {
+                    cap *= 2;
+                }
+                uint8_t *grown = (uint8_t *)realloc(records, cap);
+                if (!grown) {
+                    ret = PHYMUTI_ERROR_OUT_OF_MEMORY;
+                    break;
+                }
+                records = grown;
+                records_cap = cap;
+            }
+
+            checkpoint_page_record_t rec = { (uint32_t)page, (uint32_t)enc };
+            memcpy(records + records_len, &rec, sizeof(rec));
+            memcpy(records + records_len + sizeof(rec), page_buf, enc);
+            records_len += sizeof(rec) + enc;
+            out->entry.page_records++;
+
+            /* 按编码结果更新副本，与写入文件的内容保持一致 */
+            decode_page(shadow->data + offset, len, page_buf, enc);
+        }
+
+        out->owned = records;
+        out->data = records;
+        out->entry.data_length = records_len;
+        free(dirty);
+    }
+
+    /* 设备：增量检查点只保存与父检查点不同的状态 */
+    checkpoint_device_shadow_t *new_device_shadows = NULL;
+    for (size_t i = 0; ret == PHYMUTI_SUCCESS && i < devices.count; i++) {
+        checkpoint_device_state_t *dev = &devices.items[i];
+        checkpoint_device_out_t *out = &dout[i];
+        bool changed = true;
+
+        if (kind == CHECKPOINT_INCREMENTAL) {
+            for (checkpoint_device_shadow_t *s = device_shadow_list; s; s = s->next) {
+                if (strcmp(s->name, dev->name) == 0) {
+                    changed = s->size != dev->size || memcmp(s->state, dev->state, dev->size) != 0;
+                    break;
+                }
+            }
+        }
+
+        copy_name(out->entry.name, dev->name);
+        out->entry.present = changed ? 1 : 0;
+        out->entry.data_length = changed ? dev->size : 0;
+        out->state = dev->state;
+
+        checkpoint_device_shadow_t *s = (checkpoint_device_shadow_t *)calloc(1, sizeof(*s));
+        if (!s) {
+            ret = PHYMUTI_ERROR_OUT_OF_MEMORY;
+            break;
+        }
+        copy_name(s->name, dev->name);
+        s->state = dev->state;
+        s->size = dev->size;
+        dev->state = NULL;  /* 所有权转给设备副本，out->state仍指向它 */
+        s->next = new_device_shadows;
+        new_device_shadows = s;
+    }
+
+    if (ret == PHYMUTI_SUCCESS) {
+        ret = write_checkpoint(path, &header, rout, regions.count, dout, devices.count);
+    }
+
+    /* 无论成败都以新副本替换旧副本；失败时不再允许增量 */
+    free_session();
+    shadow_list = new_shadows;
+    device_shadow_list = new_device_shadows;
+
+    if (ret == PHYMUTI_SUCCESS) {
+        have_parent = true;
+        parent_id = header.id;
+        parent_depth = header.depth;
+        snprintf(parent_path, sizeof(parent_path), "%s", path);
+    } else {
+        free_session();
+    }
+
+    if (rout) {
+        for (size_t i = 0; i < regions.count; i++) {
+            free(rout[i].owned);
+        }
+    }
+    free(rout);
+    free(dout);
+    free(regions.items);
+    free_device_list(&devices);
+
+    return ret;
+}
+
+/**
+ * @brief 保存完整检查点
+ *
+ * @param path 检查点文件路径
+ * @return int 成功返回0，失败返回错误码
+ */
+int checkpoint_save(const char *path) {
+    if (!path) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+
+    int ret = pthread_mutex_lock(&checkpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    ret = save_locked(path, CHECKPOINT_FULL);
+
+    pthread_mutex_unlock(&checkpoint_mutex);
+    return ret;
+}
+
+/**
+ * @brief 保存增量检查点
+ *
+ * @param path 检查点文件路径
+ * @return int 成功返回0，失败返回错误码
+ */
+int checkpoint_save_incremental(const char *path) {
+    if (!path) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+
+    int ret = pthread_mutex_lock(&checkpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    ret = have_parent ? save_locked(path, CHECKPOINT_INCREMENTAL) : PHYMUTI_ERROR_CHECKPOINT_NO_PARENT;
+
+    pthread_mutex_unlock(&checkpoint_mutex);
+    return ret;
+}
+
+/**
+ * @brief 把合并后的区域内容写入内存区域
+ *
+ * 内容映射自检查点文件时，区域直接改为该文件的私有映射，页在模拟首次访问时才读入，
+ * 只有被增量修改过的页需要复制；共享区域等不能映射的情况复制全部内容。
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+static int restore_region(memory_region_t *region, const checkpoint_region_image_t *r) {
+    size_t size = r->entry.size;
+
+    if (r->fd < 0 || memory_region_map_file(region, r->fd, r->file_offset) != PHYMUTI_SUCCESS) {
+        return memory_region_load(region, 0, r->data, size);
+    }
+
+    if (!r->patched) {
+        return PHYMUTI_SUCCESS;
+    }
+
+    size_t pages = (size + MEMORY_PAGE_SIZE - 1) / MEMORY_PAGE_SIZE;
+    for (size_t page = 0; page < pages; page++) {
+        if (r->patched[page / 64] & (1ull << (page % 64))) {
+            size_t offset = page * MEMORY_PAGE_SIZE;
+            size_t len = size - offset < MEMORY_PAGE_SIZE ? size - offset : MEMORY_PAGE_SIZE;
+            int ret = memory_region_load(region, offset, r->data + offset, len);
+            if (ret != PHYMUTI_SUCCESS) {
+                return ret;
+            }
+        }
+    }
+
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 恢复检查点
+ *
+ * @param path 检查点文件路径
+ * @return int 成功返回0，失败返回错误码
+ */
+int checkpoint_restore(const char *path) {
+    checkpoint_image_t image;
+    int ret;
+
+    if (!path) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+
+    /* 先处理完延迟监视日志，其中的动作不会在恢复期间访问内存区域 */
+    monitor_drain_deferred();
+
+    ret = pthread_mutex_lock(&checkpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    ret = load_chain(path, &image);
+    if (ret != PHYMUTI_SUCCESS) {
+        pthread_mutex_unlock(&checkpoint_mutex);
+        return ret;
+    }
+
+    /* 先确认所有区域和设备都存在，再修改任何状态 */
+    memory_region_t **targets = (memory_region_t **)calloc(image.region_count + 1, sizeof(memory_region_t *));
+    device_handle_t *devices = (device_handle_t *)calloc(image.device_count + 1, sizeof(device_handle_t));
+    if (!targets || !devices) {
+        ret = PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    for (size_t i = 0; ret == PHYMUTI_SUCCESS && i < image.region_count; i++) {
+        const checkpoint_region_entry_t *e = &image.regions[i].entry;
+        targets[i] = memory_region_find_by_id(e->id);
+        if (!targets[i] || memory_region_get_base_addr(targets[i]) != e->base_addr ||
+            memory_region_get_size(targets[i]) != e->size) {
+            ret = PHYMUTI_ERROR_CHECKPOINT_MISMATCH;
+        }
+    }
+    for (size_t i = 0; ret == PHYMUTI_SUCCESS && i < image.device_count; i++) {
+        devices[i] = device_find_by_name(image.devices[i].name);
+        if (!devices[i]) {
+            ret = PHYMUTI_ERROR_CHECKPOINT_MISMATCH;
+        }
+    }
+
+    for (size_t i = 0; ret == PHYMUTI_SUCCESS && i < image.region_count; i++) {
+        ret = restore_region(targets[i], &image.regions[i]);
+    }
+    for (size_t i = 0; ret == PHYMUTI_SUCCESS && i < image.device_count; i++) {
+        ret = device_load_state(devices[i], image.devices[i].state, image.devices[i].size);
+    }
+
+    /* 恢复后的内容成为之后增量检查点的父检查点 */
+    free_session();
+    if (ret == PHYMUTI_SUCCESS) {
+        for (size_t i = 0; i < image.region_count; i++) {
+            checkpoint_shadow_t *shadow = (checkpoint_shadow_t *)calloc(1, sizeof(*shadow));
+            if (!shadow) {
+                ret = PHYMUTI_ERROR_OUT_OF_MEMORY;
+                break;
+            }
+            size_t pages = (image.regions[i].entry.size + MEMORY_PAGE_SIZE - 1) / MEMORY_PAGE_SIZE;
+            uint64_t *dirty = (uint64_t *)malloc(((pages + 63) / 64) * sizeof(uint64_t));
+            if (dirty) {
+                memory_region_take_dirty_pages(targets[i], dirty);
+                free(dirty);
+            }
+            shadow->id = image.regions[i].entry.id;
+            shadow->base_addr = image.regions[i].entry.base_addr;
+            shadow->size = image.regions[i].entry.size;
+            shadow->data = image.regions[i].data;
+            shadow->map_size = image.regions[i].map_size;
+            image.regions[i].data = NULL;
+            image.regions[i].map_size = 0;
+            shadow->next = shadow_list;
+            shadow_list = shadow;
+        }
+        for (size_t i = 0; ret == PHYMUTI_SUCCESS && i < image.device_count; i++) {
+            checkpoint_device_shadow_t *s = (checkpoint_device_shadow_t *)calloc(1, sizeof(*s));
+            if (!s) {
+                ret = PHYMUTI_ERROR_OUT_OF_MEMORY;
+                break;
+            }
+            copy_name(s->name, image.devices[i].name);
+            s->state = image.devices[i].state;
+            s->size = image.devices[i].size;
+            image.devices[i].state = NULL;
+            s->next = device_shadow_list;
+            device_shadow_list = s;
+        }
+
+        if (ret == PHYMUTI_SUCCESS && strlen(path) < CHECKPOINT_PATH_MAX) {
+            have_parent = true;
+            parent_id = image.id;
+            parent_depth = image.depth;
+            snprintf(parent_path, sizeof(parent_path), "%s", path);
+        } else {
+            free_session();
+        }
+    }
+
+    free(targets);
+    free(devices);
+    free_image(&image);
+
+    pthread_mutex_unlock(&checkpoint_mutex);
+    return ret;
+}
+
+/**
+ * @brief 压缩检查点链
+ *
+ * @param path 检查点文件路径
+ * @param out_path 输出的完整检查点路径
+ * @return int 成功返回0，失败返回错误码
+ */
+int checkpoint_compact(const char *path, const char *out_path) {
+    checkpoint_image_t image;
+    checkpoint_file_header_t header;
+    int ret;
+
+    if (!path || !out_path) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+
+    ret = pthread_mutex_lock(&checkpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    ret = load_chain(path, &image);
+    if (ret != PHYMUTI_SUCCESS) {
+        pthread_mutex_unlock(&checkpoint_mutex);
+        return ret;
+    }
+
+    checkpoint_region_out_t *rout = (checkpoint_region_out_t *)calloc(image.region_count + 1, sizeof(*rout));
+    checkpoint_device_out_t *dout = (checkpoint_device_out_t *)calloc(image.device_count + 1, sizeof(*dout));
+    if (!rout || !dout) {
+        ret = PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+
+    if (ret == PHYMUTI_SUCCESS) {
+        for (size_t i = 0; i < image.region_count; i++) {
+            rout[i].entry = image.regions[i].entry;
+            rout[i].entry.encoding = CHECKPOINT_REGION_RAW;
+            rout[i].entry.page_records = 0;
+            rout[i].entry.data_length = image.regions[i].entry.size;
+            rout[i].data = image.regions[i].data;
+        }
+        for (size_t i = 0; i < image.device_count; i++) {
+            copy_name(dout[i].entry.name, image.devices[i].name);
+            dout[i].entry.present = 1;
+            dout[i].entry.data_length = image.devices[i].size;
+            dout[i].state = image.devices[i].state;
+        }
+
+        init_header(&header, CHECKPOINT_FULL);
+        ret = write_checkpoint(out_path, &header, rout, image.region_count, dout, image.device_count);
+    }
+
+    free(rout);
+    free(dout);
+    free_image(&image);
+
+    pthread_mutex_unlock(&checkpoint_mutex);
+    return ret;
+}
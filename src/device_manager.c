@@ -540,6 +540,41 @@ device_handle_t device_find_by_name(const char *name) {
     return device;
 }
 
+/**
+ * @brief 遍历所有设备
+ * 
+ * @param visit 访问函数，返回非0时停止遍历
+ * @param user_data 用户数据
+ * @return int 成功返回0，访问函数返回非0时返回该值，失败返回错误码
+ */
+int device_foreach(device_visit_fn_t visit, void *user_data) {
+    int ret;
+    int visit_ret = 0;
+    
+    if (!visit) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    ret = pthread_mutex_lock(&device_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    for (device_handle_t device = device_list; device; device = device->next) {
+        visit_ret = visit(device, user_data);
+        if (visit_ret != 0) {
+            break;
+        }
+    }
+    
+    ret = pthread_mutex_unlock(&device_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return visit_ret;
+}
+
 /**
  * @brief 重置设备
  * 
@@ -640,6 +675,46 @@ int device_save_state(device_handle_t device, void *buffer, size_t *size) {
     return PHYMUTI_ERROR_NOT_SUPPORTED;
 }
 
+/**
+ * @brief 保存设备状态到新分配的缓冲区
+ * 
+ * @param device 设备句柄
+ * @param buffer 返回状态缓冲区，由调用者free()
+ * @param size 返回状态大小
+ * @return int 成功返回0，失败返回错误码
+ */
+int device_save_state_alloc(device_handle_t device, void **buffer, size_t *size) {
+    size_t needed = 0;
+    int ret;
+    
+    if (!device || !buffer || !size) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 先以空缓冲区查询所需大小 */
+    ret = device_save_state(device, NULL, &needed);
+    if (ret != PHYMUTI_SUCCESS && (ret != PHYMUTI_ERROR_INVALID_PARAM || needed == 0)) {
+        return ret;
+    }
+    
+    void *state = malloc(needed ? needed : 1);
+    if (!state) {
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    if (needed > 0) {
+        ret = device_save_state(device, state, &needed);
+        if (ret != PHYMUTI_SUCCESS) {
+            free(state);
+            return ret;
+        }
+    }
+    
+    *buffer = state;
+    *size = needed;
+    return PHYMUTI_SUCCESS;
+}
+
 /**
  * @brief 加载设备状态
  * 
@@ -0,0 +1,221 @@
+/**
+ * @file epoch.c
+ * @brief 基于纪元的延迟回收实现
+ */
+
+#include "epoch.h"
+#include "phymuti_error.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* 缓存行大小 */
+#define EPOCH_CACHE_LINE 64
+
+/* 每线程纪元槽 */
+typedef struct epoch_record_struct {
+    _Alignas(EPOCH_CACHE_LINE) _Atomic uint64_t epoch;  /* 进入临界区时的全局纪元，0表示不在临界区 */
+    _Atomic bool in_use;                                /* 是否已被某个线程占用 */
+    struct epoch_record_struct *next;                   /* 下一个纪元槽 */
+} epoch_record_t;
+
+/* 待释放的对象 */
+typedef struct retired_struct {
+    void *ptr;                       /* 对象 */
+    void (*destroy)(void *);         /* 释放函数 */
+    uint64_t epoch;                  /* 摘除时的全局纪元 */
+    struct retired_struct *next;     /* 下一个对象 */
+} retired_t;
+
+/* 全局纪元，从1开始 */
+static _Atomic uint64_t global_epoch = 1;
+
+/* 纪元槽链表（只增不减），新节点以原子方式插入表头 */
+static _Atomic(epoch_record_t *) record_list = NULL;
+
+/* 线程使用的纪元槽和嵌套深度 */
+static __thread epoch_record_t *tl_record = NULL;
+static __thread unsigned tl_depth = 0;
+
+/* 线程退出时归还纪元槽 */
+static pthread_key_t epoch_thread_key;
+static pthread_once_t epoch_key_once = PTHREAD_ONCE_INIT;
+
+/* 待释放链表及其互斥锁 */
+static retired_t *retired_list = NULL;
+static pthread_mutex_t retired_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void epoch_thread_exit(void *arg) {
+    epoch_record_t *rec = (epoch_record_t *)arg;
+    atomic_store_explicit(&rec->epoch, 0, memory_order_release);
+    atomic_store_explicit(&rec->in_use, false, memory_order_release);
+}
+
+static void epoch_create_key(void) {
+    pthread_key_create(&epoch_thread_key, epoch_thread_exit);
+}
+
+/**
+ * @brief 为调用线程分配纪元槽
+ *
+ * @return epoch_record_t* 成功返回纪元槽，失败返回NULL
+ */
+static epoch_record_t* epoch_register_thread(void) {
+    epoch_record_t *rec;
+
+    pthread_once(&epoch_key_once, epoch_create_key);
+
+    /* 优先复用已退出线程归还的纪元槽 */
+    for (rec = atomic_load(&record_list); rec; rec = rec->next) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&rec->in_use, &expected, true)) {
+            break;
+        }
+    }
+
+    if (!rec) {
+        rec = (epoch_record_t *)aligned_alloc(EPOCH_CACHE_LINE, sizeof(epoch_record_t));
+        if (!rec) {
+            return NULL;
+        }
+        atomic_init(&rec->epoch, 0);
+        atomic_init(&rec->in_use, true);
+        rec->next = atomic_load(&record_list);
+        while (!atomic_compare_exchange_weak(&record_list, &rec->next, rec)) {
+        }
+    }
+
+    pthread_setspecific(epoch_thread_key, rec);
+    tl_record = rec;
+    return rec;
+}
+
+/**
+ * @brief 进入读侧临界区，可以嵌套
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+int epoch_enter(void) {
+    if (tl_depth++ > 0) {
+        return PHYMUTI_SUCCESS;
+    }
+
+    epoch_record_t *rec = tl_record;
+    if (!rec) {
+        rec = epoch_register_thread();
+        if (!rec) {
+            tl_depth = 0;
+            return PHYMUTI_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    /*
+     * 顺序一致的写入保证：写者在摘除对象之后扫描纪元槽时，
+     * 要么看到本线程的纪元，要么本线程随后读到的是新版本。
+     */
+    atomic_store(&rec->epoch, atomic_load(&global_epoch));
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 离开读侧临界区
+ */
+void epoch_exit(void) {
+    if (tl_depth == 0 || --tl_depth > 0) {
+        return;
+    }
+    atomic_store_explicit(&tl_record->epoch, 0, memory_order_release);
+}
+
+/**
+ * @brief 获取仍在临界区中的读者的最小纪元
+ *
+ * @return uint64_t 最小纪元，没有读者时返回UINT64_MAX
+ */
+static uint64_t epoch_min_active(void) {
+    uint64_t min = UINT64_MAX;
+
+    for (epoch_record_t *rec = atomic_load(&record_list); rec; rec = rec->next) {
+        uint64_t e = atomic_load(&rec->epoch);
+        if (e != 0 && e < min) {
+            min = e;
+        }
+    }
+
+    return min;
+}
+
+/**
+ * @brief 等待当前所有读侧临界区结束，不能在读侧临界区内调用
+ */
+void epoch_synchronize(void) {
+    uint64_t e = atomic_fetch_add(&global_epoch, 1);
+
+    while (epoch_min_active() <= e) {
+        sched_yield();
+    }
+}
+
+/**
+ * @brief 延迟释放已不再发布的对象
+ *
+ * @param ptr 对象
+ * @param destroy 释放函数
+ */
+void epoch_retire(void *ptr, void (*destroy)(void *)) {
+    if (!ptr) {
+        return;
+    }
+
+    retired_t *node = (retired_t *)malloc(sizeof(retired_t));
+    if (!node) {
+        epoch_synchronize();
+        destroy(ptr);
+        return;
+    }
+
+    node->ptr = ptr;
+    node->destroy = destroy;
+
+    pthread_mutex_lock(&retired_mutex);
+    /* 以摘除时的纪元标记对象，之后进入的读者纪元都更大 */
+    node->epoch = atomic_fetch_add(&global_epoch, 1);
+    node->next = retired_list;
+    retired_list = node;
+    pthread_mutex_unlock(&retired_mutex);
+
+    epoch_reclaim();
+}
+
+/**
+ * @brief 释放宽限期已结束的对象
+ */
+void epoch_reclaim(void) {
+    retired_t *ready = NULL;
+
+    pthread_mutex_lock(&retired_mutex);
+    uint64_t min = epoch_min_active();
+    retired_t **link = &retired_list;
+    while (*link) {
+        retired_t *node = *link;
+        if (node->epoch < min) {
+            *link = node->next;
+            node->next = ready;
+            ready = node;
+        } else {
+            link = &node->next;
+        }
+    }
+    pthread_mutex_unlock(&retired_mutex);
+
+    /* 在锁外释放，释放函数可以再次调用epoch_retire() */
+    while (ready) {
+        retired_t *next = ready->next;
+        ready->destroy(ready->ptr);
+        free(ready);
+        ready = next;
+    }
+}
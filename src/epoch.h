@@ -0,0 +1,46 @@
+/**
+ * @file epoch.h
+ * @brief 基于纪元的延迟回收（模块内部使用）
+ *
+ * 读者进入读侧临界区时把全局纪元记录到本线程的纪元槽，不加锁；
+ * 写者以原子方式发布新版本后把旧对象交给epoch_retire()，
+ * 等所有可能看到旧对象的读者都离开临界区后再释放。
+ */
+
+#ifndef EPOCH_H
+#define EPOCH_H
+
+/**
+ * @brief 进入读侧临界区，可以嵌套
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+int epoch_enter(void);
+
+/**
+ * @brief 离开读侧临界区
+ */
+void epoch_exit(void);
+
+/**
+ * @brief 延迟释放已不再发布的对象
+ *
+ * 调用前对象必须已经从所有共享指针上摘除，之后进入临界区的读者不会再看到它。
+ * 分配失败时等待宽限期结束后直接释放，因此不能在读侧临界区内调用。
+ *
+ * @param ptr 对象
+ * @param destroy 释放函数
+ */
+void epoch_retire(void *ptr, void (*destroy)(void *));
+
+/**
+ * @brief 释放宽限期已结束的对象
+ */
+void epoch_reclaim(void);
+
+/**
+ * @brief 等待当前所有读侧临界区结束，不能在读侧临界区内调用
+ */
+void epoch_synchronize(void);
+
+#endif /* EPOCH_H */
@@ -3,31 +3,94 @@
  * @brief 内存管理器模块实现
  */
 
+#define _GNU_SOURCE
 #include "memory_manager.h"
 #include "phymuti_error.h"
 #include "monitor.h"
+#include "memory_simd.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* 热图中一行的计数 */
+typedef struct {
+    _Atomic uint64_t reads;   /* 读次数 */
+    _Atomic uint64_t writes;  /* 写次数 */
+} heatmap_counter_t;
 
 /* 内存区域结构体 */
 struct memory_region_struct {
+    uint32_t id;                 /* 内存区域ID */
     char *name;                  /* 内存区域名称 */
     device_handle_t device;      /* 关联的设备 */
     uint64_t base_addr;          /* 基地址 */
     size_t size;                 /* 大小（字节） */
     uint32_t flags;              /* 标志 */
     uint8_t *data;               /* 内存数据 */
+    size_t data_map_size;        /* 私有区域数据映射大小（按系统页对齐） */
+    char *shm_name;              /* 共享内存对象名称，为NULL时数据为进程私有的匿名映射 */
+    void *shm_map;               /* 共享内存映射起始地址（含头部） */
+    size_t shm_map_size;         /* 共享内存映射大小 */
+    _Atomic uint32_t local_seq;  /* 私有区域的写序列号 */
+    _Atomic uint32_t *seq;       /* 写序列号，共享区域指向对象头部以便其他进程读取 */
+    _Atomic uint32_t watch_flags;  /* 监视状态（MEMORY_WATCH_*），由监视器维护 */
+    size_t page_count;           /* 页数（MEMORY_PAGE_SIZE） */
+    _Atomic uint64_t *hash_dirty;  /* 页哈希失效位图，写入时置位 */
+    _Atomic uint64_t *ckpt_dirty;  /* 检查点脏页位图，写入时置位 */
+    uint64_t *page_hashes;       /* 缓存的页哈希 */
+    pthread_mutex_t hash_mutex;  /* 保护页哈希缓存 */
+    size_t heatmap_line_count;   /* 热图行数（MEMORY_HEATMAP_LINE_SIZE） */
+    _Atomic(heatmap_counter_t *) heatmap_lines;  /* 热图计数数组，首次开启时分配 */
+    _Atomic(heatmap_counter_t *) heatmap;        /* 开启时指向计数数组，关闭时为NULL */
     struct memory_region_struct *next;  /* 下一个内存区域 */
 };
 
 /* 内存区域链表头 */
 static memory_region_t *memory_region_list = NULL;
 
+/* 下一个可用的内存区域ID */
+static uint32_t next_region_id = 1;
+
 /* 内存区域链表的互斥锁 */
 static pthread_mutex_t memory_region_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/**
+ * @brief 释放内存区域及其数据
+ * 
+ * @param region 内存区域指针
+ */
+static void free_memory_region(memory_region_t *region) {
+    if (region->shm_name) {
+        /* 共享数据：解除映射并删除名称，已映射的读者仍可读到最后的内容 */
+        munmap(region->shm_map, region->shm_map_size);
+        shm_unlink(region->shm_name);
+        free(region->shm_name);
+    } else if (region->data) {
+        munmap(region->data, region->data_map_size);
+    }
+    
+    if (region->page_hashes) {
+        pthread_mutex_destroy(&region->hash_mutex);
+    }
+    free((void *)region->hash_dirty);
+    free((void *)region->ckpt_dirty);
+    free(region->page_hashes);
+    free((void *)atomic_load(&region->heatmap_lines));
+    
+    if (region->name) {
+        free(region->name);
+    }
+    
+    free(region);
+}
+
 /**
  * @brief 初始化内存管理器
  * 
@@ -36,6 +99,7 @@ static pthread_mutex_t memory_region_mutex = PTHREAD_MUTEX_INITIALIZER;
 int memory_manager_init(void) {
     /* 初始化内存区域链表 */
     memory_region_list = NULL;
+    next_region_id = 1;
     
     /* 初始化互斥锁只需要在此处检查是否成功，因为是静态初始化，
        如果系统初始化后正常，这里不会返回错误，确保用于同步的操作正确 */
@@ -63,23 +127,14 @@ int memory_manager_cleanup(void) {
     while (region) {
         next_region = region->next;
         
-        /* 释放内存区域数据 */
-        if (region->data) {
-            free(region->data);
-        }
-        
-        /* 释放名称 */
-        if (region->name) {
-            free(region->name);
-        }
-        
-        /* 释放内存区域结构体 */
-        free(region);
+        /* 释放内存区域及其数据 */
+        free_memory_region(region);
         
         region = next_region;
     }
     
     memory_region_list = NULL;
+    next_region_id = 1;
     
     ret = pthread_mutex_unlock(&memory_region_mutex);
     if (ret != 0) {
@@ -89,6 +144,87 @@ int memory_manager_cleanup(void) {
     return PHYMUTI_SUCCESS;
 }
 
+/**
+ * @brief 将新建的内存区域加入链表并分配ID
+ * 
+ * @param region 内存区域指针
+ * @return int 成功返回0，失败返回错误码
+ */
+static int insert_memory_region(memory_region_t *region) {
+    int ret = pthread_mutex_lock(&memory_region_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    /* ID按创建顺序分配，相同的创建流程得到相同的ID */
+    region->id = next_region_id++;
+    region->next = memory_region_list;
+    memory_region_list = region;
+    
+    ret = pthread_mutex_unlock(&memory_region_mutex);
+    if (ret != 0) {
+        /* 解锁失败，但内存区域已经添加到链表中，
+           记录错误但继续返回创建的区域对象 */
+        /* 在实际应用中可以考虑记录错误日志 */
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 分配并初始化内存区域结构体（不含数据）
+ * 
+ * @return memory_region_t* 成功返回内存区域指针，失败返回NULL
+ */
+static memory_region_t* alloc_memory_region(device_handle_t device, const char *name, 
+                                            uint64_t base_addr, size_t size, uint32_t flags) {
+    memory_region_t *region = (memory_region_t *)calloc(1, sizeof(memory_region_t));
+    if (!region) {
+        return NULL;
+    }
+    
+    region->name = strdup(name);
+    if (!region->name) {
+        free(region);
+        return NULL;
+    }
+    
+    region->device = device;
+    region->base_addr = base_addr;
+    region->size = size;
+    region->flags = flags;
+    atomic_init(&region->local_seq, 0);
+    region->seq = &region->local_seq;
+    atomic_init(&region->watch_flags, 0);
+    region->heatmap_line_count = (size + MEMORY_HEATMAP_LINE_SIZE - 1) / MEMORY_HEATMAP_LINE_SIZE;
+    atomic_init(&region->heatmap_lines, NULL);
+    atomic_init(&region->heatmap, NULL);
+    
+    /* 页哈希缓存和检查点脏页，初始时全部页都视为已写 */
+    region->page_count = (size + MEMORY_PAGE_SIZE - 1) / MEMORY_PAGE_SIZE;
+    size_t bitmap_words = (region->page_count + 63) / 64;
+    region->hash_dirty = (_Atomic uint64_t *)malloc(bitmap_words * sizeof(uint64_t));
+    region->ckpt_dirty = (_Atomic uint64_t *)malloc(bitmap_words * sizeof(uint64_t));
+    region->page_hashes = (uint64_t *)calloc(region->page_count, sizeof(uint64_t));
+    if (!region->hash_dirty || !region->ckpt_dirty || !region->page_hashes ||
+        pthread_mutex_init(&region->hash_mutex, NULL) != 0) {
+        free((void *)region->hash_dirty);
+        free((void *)region->ckpt_dirty);
+        free(region->page_hashes);
+        free(region->name);
+        free(region);
+        return NULL;
+    }
+    for (size_t i = 0; i < bitmap_words; i++) {
+        size_t pages = region->page_count - i * 64;
+        uint64_t all = pages >= 64 ? ~0ull : (1ull << pages) - 1;
+        atomic_init(&region->hash_dirty[i], all);
+        atomic_init(&region->ckpt_dirty[i], all);
+    }
+    
+    return region;
+}
+
 /**
  * @brief 创建内存区域
  * 
@@ -102,7 +238,6 @@ int memory_manager_cleanup(void) {
 memory_region_t* memory_region_create(device_handle_t device, const char *name, 
                                       uint64_t base_addr, size_t size, uint32_t flags) {
     memory_region_t *region;
-    int ret;
     
     /* 检查参数 */
     if (!name || size == 0) {
@@ -110,54 +245,219 @@ memory_region_t* memory_region_create(device_handle_t device, const char *name,
     }
     
     /* 分配内存区域结构体 */
-    region = (memory_region_t *)malloc(sizeof(memory_region_t));
+    region = alloc_memory_region(device, name, base_addr, size, flags);
     if (!region) {
         return NULL;
     }
     
-    /* 初始化内存区域结构体 */
-    region->name = strdup(name);
-    if (!region->name) {
-        free(region);
+    /* 分配内存数据：匿名映射，页对齐且初始为0，之后可整体替换为文件映射 */
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    region->data_map_size = (size + page_size - 1) / page_size * page_size;
+    void *map = mmap(NULL, region->data_map_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        free_memory_region(region);
         return NULL;
     }
+    region->data = (uint8_t *)map;
     
-    region->device = device;
-    region->base_addr = base_addr;
-    region->size = size;
-    region->flags = flags;
+    /* 添加到内存区域链表 */
+    if (insert_memory_region(region) != PHYMUTI_SUCCESS) {
+        /* 锁操作失败，需要清理已分配的资源 */
+        free_memory_region(region);
+        return NULL;
+    }
     
-    /* 分配内存数据 */
-    region->data = (uint8_t *)calloc(size, 1);
-    if (!region->data) {
-        free(region->name);
-        free(region);
+    return region;
+}
+
+/**
+ * @brief 规范化共享内存对象名称（补全开头的'/'）
+ * 
+ * @param shm_name 共享内存对象名称
+ * @return char* 成功返回新分配的名称，失败返回NULL
+ */
+static char* normalize_shm_name(const char *shm_name) {
+    size_t len = strlen(shm_name);
+    
+    /* 名称中除开头外不能含有'/' */
+    if (len == 0 || strchr(shm_name + 1, '/') != NULL) {
         return NULL;
     }
     
-    /* 添加到内存区域链表 */
-    ret = pthread_mutex_lock(&memory_region_mutex);
-    if (ret != 0) {
-        /* 锁操作失败，需要清理已分配的资源 */
-        free(region->data);
-        free(region->name);
-        free(region);
+    if (shm_name[0] == '/') {
+        return len > 1 ? strdup(shm_name) : NULL;
+    }
+    
+    char *full = (char *)malloc(len + 2);
+    if (full) {
+        full[0] = '/';
+        memcpy(full + 1, shm_name, len + 1);
+    }
+    return full;
+}
+
+/**
+ * @brief 创建以共享内存为后备存储的内存区域
+ * 
+ * @param device 关联的设备
+ * @param name 内存区域名称
+ * @param base_addr 基地址
+ * @param size 大小（字节）
+ * @param flags 标志
+ * @param shm_name 共享内存对象名称
+ * @return memory_region_t* 成功返回内存区域指针，失败返回NULL
+ */
+memory_region_t* memory_region_create_shared(device_handle_t device, const char *name, 
+                                             uint64_t base_addr, size_t size, uint32_t flags,
+                                             const char *shm_name) {
+    memory_region_t *region;
+    
+    /* 检查参数 */
+    if (!name || size == 0 || !shm_name) {
         return NULL;
     }
     
-    region->next = memory_region_list;
-    memory_region_list = region;
+    region = alloc_memory_region(device, name, base_addr, size, flags);
+    if (!region) {
+        return NULL;
+    }
     
-    ret = pthread_mutex_unlock(&memory_region_mutex);
-    if (ret != 0) {
-        /* 解锁失败，但内存区域已经添加到链表中，
-           记录错误但继续返回创建的区域对象 */
-        /* 在实际应用中可以考虑记录错误日志 */
+    region->shm_name = normalize_shm_name(shm_name);
+    if (!region->shm_name) {
+        free_memory_region(region);
+        return NULL;
+    }
+    
+    /* 名称已存在时失败，避免与其他进程的对象混用 */
+    int fd = shm_open(region->shm_name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        free(region->shm_name);
+        region->shm_name = NULL;
+        free_memory_region(region);
+        return NULL;
+    }
+    
+    size_t map_size = MEMORY_SHARED_DATA_OFFSET + size;
+    void *map = MAP_FAILED;
+    if (ftruncate(fd, (off_t)map_size) == 0) {
+        map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    
+    if (map == MAP_FAILED) {
+        shm_unlink(region->shm_name);
+        free(region->shm_name);
+        region->shm_name = NULL;
+        free_memory_region(region);
+        return NULL;
+    }
+    
+    /* 新建对象内容全零，只需填写头部 */
+    memory_shared_header_t *header = (memory_shared_header_t *)map;
+    memcpy(header->magic, MEMORY_SHARED_MAGIC, sizeof(header->magic));
+    header->version = MEMORY_SHARED_VERSION;
+    header->flags = flags;
+    header->base_addr = base_addr;
+    header->size = size;
+    strncpy(header->name, name, sizeof(header->name) - 1);
+    
+    region->shm_map = map;
+    region->shm_map_size = map_size;
+    region->seq = (_Atomic uint32_t *)&header->sequence;
+    region->data = (uint8_t *)map + MEMORY_SHARED_DATA_OFFSET;
+    
+    if (insert_memory_region(region) != PHYMUTI_SUCCESS) {
+        free_memory_region(region);
+        return NULL;
     }
     
     return region;
 }
 
+/**
+ * @brief 获取内存区域的共享内存对象名称
+ * 
+ * @param region 内存区域指针
+ * @return const char* 共享内存对象名称，未共享时返回NULL
+ */
+const char* memory_region_get_shared_name(const memory_region_t *region) {
+    return region ? region->shm_name : NULL;
+}
+
+/**
+ * @brief 以只读方式映射其他进程导出的内存区域
+ * 
+ * @param shm_name 共享内存对象名称
+ * @param view 映射视图
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_shared_map(const char *shm_name, memory_shared_view_t *view) {
+    struct stat st;
+    
+    if (!shm_name || !view) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    char *full = normalize_shm_name(shm_name);
+    if (!full) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    int fd = shm_open(full, O_RDONLY, 0);
+    free(full);
+    if (fd < 0) {
+        return PHYMUTI_ERROR_NOT_FOUND;
+    }
+    
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < MEMORY_SHARED_DATA_OFFSET) {
+        close(fd);
+        return PHYMUTI_ERROR_IO;
+    }
+    
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return PHYMUTI_ERROR_IO;
+    }
+    
+    const memory_shared_header_t *header = (const memory_shared_header_t *)map;
+    if (memcmp(header->magic, MEMORY_SHARED_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != MEMORY_SHARED_VERSION ||
+        header->size > (uint64_t)st.st_size - MEMORY_SHARED_DATA_OFFSET) {
+        munmap(map, (size_t)st.st_size);
+        return PHYMUTI_ERROR_NOT_SUPPORTED;
+    }
+    
+    view->header = header;
+    view->data = (const uint8_t *)map + MEMORY_SHARED_DATA_OFFSET;
+    view->base_addr = header->base_addr;
+    view->size = (size_t)header->size;
+    view->map = map;
+    view->map_size = (size_t)st.st_size;
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 解除共享内存区域的映射
+ * 
+ * @param view 映射视图
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_shared_unmap(memory_shared_view_t *view) {
+    if (!view || !view->map) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    if (munmap(view->map, view->map_size) != 0) {
+        return PHYMUTI_ERROR_IO;
+    }
+    
+    memset(view, 0, sizeof(*view));
+    return PHYMUTI_SUCCESS;
+}
+
 /**
  * @brief 销毁内存区域
  * 
@@ -173,6 +473,9 @@ int memory_region_destroy(memory_region_t *region) {
         return PHYMUTI_ERROR_INVALID_PARAM;
     }
     
+    /* 先处理完延迟监视日志中对该区域的访问 */
+    monitor_drain_deferred();
+    
     /* 从内存区域链表中移除 */
     ret = pthread_mutex_lock(&memory_region_mutex);
     if (ret != 0) {
@@ -190,18 +493,9 @@ int memory_region_destroy(memory_region_t *region) {
                 memory_region_list = curr->next;
             }
             
-            /* 释放内存区域数据 */
-            if (region->data) {
-                free(region->data);
-            }
-            
-            /* 释放名称 */
-            if (region->name) {
-                free(region->name);
-            }
-            
-            /* 释放内存区域结构体 */
-            free(region);
+            /* 删除区域上的监视点，再释放内存区域及其数据 */
+            monitor_forget_region(region);
+            free_memory_region(region);
             
             ret = pthread_mutex_unlock(&memory_region_mutex);
             if (ret != 0) {
@@ -270,6 +564,84 @@ memory_region_t* memory_region_find(device_handle_t device, const char *name) {
     return NULL;
 }
 
+/**
+ * @brief 通过ID查找内存区域
+ * 
+ * @param id 内存区域ID
+ * @return memory_region_t* 成功返回内存区域指针，失败返回NULL
+ */
+memory_region_t* memory_region_find_by_id(uint32_t id) {
+    memory_region_t *region;
+    int ret;
+    
+    if (id == MEMORY_REGION_INVALID_ID) {
+        return NULL;
+    }
+    
+    ret = pthread_mutex_lock(&memory_region_mutex);
+    if (ret != 0) {
+        return NULL;
+    }
+    
+    region = memory_region_list;
+    while (region && region->id != id) {
+        region = region->next;
+    }
+    
+    ret = pthread_mutex_unlock(&memory_region_mutex);
+    if (ret != 0) {
+        /* 锁释放失败，记录错误但返回查找结果 */
+        /* 在实际应用中可以考虑记录错误日志 */
+    }
+    
+    return region;
+}
+
+/**
+ * @brief 遍历所有内存区域
+ * 
+ * @param visit 访问函数，返回非0时停止遍历
+ * @param user_data 用户数据
+ * @return int 成功返回0，访问函数返回非0时返回该值，失败返回错误码
+ */
+int memory_region_foreach(memory_region_visit_fn_t visit, void *user_data) {
+    int ret;
+    int visit_ret = 0;
+    
+    if (!visit) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    ret = pthread_mutex_lock(&memory_region_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    for (memory_region_t *region = memory_region_list; region; region = region->next) {
+        visit_ret = visit(region, user_data);
+        if (visit_ret != 0) {
+            break;
+        }
+    }
+    
+    ret = pthread_mutex_unlock(&memory_region_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return visit_ret;
+}
+
+/**
+ * @brief 获取内存区域ID
+ * 
+ * @param region 内存区域指针
+ * @return uint32_t 内存区域ID，region为NULL时返回MEMORY_REGION_INVALID_ID
+ */
+uint32_t memory_region_get_id(const memory_region_t *region) {
+    return region ? region->id : MEMORY_REGION_INVALID_ID;
+}
+
 /**
  * @brief 获取内存区域名称
  * 
@@ -311,37 +683,63 @@ uint32_t memory_region_get_flags(const memory_region_t *region) {
 }
 
 /**
- * @brief 获取内存区域关联的设备
+ * @brief 获取内存区域的监视状态
  * 
  * @param region 内存区域指针
- * @return device_handle_t 设备句柄
+ * @return uint32_t MEMORY_WATCH_*标志
  */
-device_handle_t memory_region_get_device(const memory_region_t *region) {
-    return region ? region->device : NULL;
+uint32_t memory_region_get_watch_flags(const memory_region_t *region) {
+    return region ? atomic_load_explicit(&region->watch_flags, memory_order_relaxed) : 0;
 }
 
 /**
- * @brief 检查内存访问权限
+ * @brief 设置内存区域的监视状态
  * 
  * @param region 内存区域指针
- * @param addr 地址
- * @param size 大小（字节）
- * @param access_type 访问类型
+ * @param flags MEMORY_WATCH_*标志
  * @return int 成功返回0，失败返回错误码
  */
-static int check_memory_access(memory_region_t *region, uint64_t addr, 
-                              size_t size, memory_access_type_t access_type) {
+int memory_region_set_watch_flags(memory_region_t *region, uint32_t flags) {
     if (!region) {
         return PHYMUTI_ERROR_INVALID_PARAM;
     }
     
-    /* 检查地址范围 */
-    if (addr < region->base_addr || 
-        addr + size > region->base_addr + region->size) {
-        return PHYMUTI_ERROR_MEMORY_OUT_OF_RANGE;
-    }
-    
-    /* 检查访问权限 */
+    atomic_store_explicit(&region->watch_flags, flags, memory_order_relaxed);
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 获取内存区域关联的设备
+ * 
+ * @param region 内存区域指针
+ * @return device_handle_t 设备句柄
+ */
+device_handle_t memory_region_get_device(const memory_region_t *region) {
+    return region ? region->device : NULL;
+}
+
+/**
+ * @brief 检查内存访问权限
+ * 
+ * @param region 内存区域指针
+ * @param addr 地址
+ * @param size 大小（字节）
+ * @param access_type 访问类型
+ * @return int 成功返回0，失败返回错误码
+ */
+static int check_memory_access(memory_region_t *region, uint64_t addr, 
+                              size_t size, memory_access_type_t access_type) {
+    if (!region) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 检查地址范围 */
+    if (addr < region->base_addr || 
+        addr + size > region->base_addr + region->size) {
+        return PHYMUTI_ERROR_MEMORY_OUT_OF_RANGE;
+    }
+    
+    /* 检查访问权限 */
     switch (access_type) {
         case MEMORY_ACCESS_READ:
             if (!(region->flags & MEMORY_FLAG_READ)) {
@@ -368,6 +766,59 @@ static int check_memory_access(memory_region_t *region, uint64_t addr,
     return PHYMUTI_SUCCESS;
 }
 
+/**
+ * @brief 标记被写入的页：使缓存的页哈希失效，并记录为检查点脏页
+ * 
+ * 必须在写入数据之后调用。已置位时只做一次读取，避免每次写入都执行原子读改写。
+ * 读取前的全序栅栏与取出标记的一方在清除标记之后的栅栏配对：
+ * 要么这里读到已清除的位并重新置位，要么对方清除之后读到本次写入的数据。
+ * 
+ * @param region 内存区域指针
+ * @param offset 偏移量
+ * @param size 大小（字节）
+ */
+static inline void mark_pages_dirty(memory_region_t *region, size_t offset, size_t size) {
+    size_t first = offset / MEMORY_PAGE_SIZE;
+    size_t last = (offset + size - 1) / MEMORY_PAGE_SIZE;
+    
+    atomic_thread_fence(memory_order_seq_cst);
+    for (size_t page = first; page <= last; page++) {
+        _Atomic uint64_t *word = &region->hash_dirty[page / 64];
+        uint64_t bit = 1ull << (page % 64);
+        if (!(atomic_load_explicit(word, memory_order_relaxed) & bit)) {
+            atomic_fetch_or_explicit(word, bit, memory_order_relaxed);
+        }
+        word = &region->ckpt_dirty[page / 64];
+        if (!(atomic_load_explicit(word, memory_order_relaxed) & bit)) {
+            atomic_fetch_or_explicit(word, bit, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief 在访问热图中为访问涉及的每一行计数
+ * 
+ * @param region 内存区域指针
+ * @param offset 相对基地址的偏移
+ * @param size 大小（字节）
+ * @param access_type 访问类型
+ */
+static inline void heatmap_count(memory_region_t *region, size_t offset, size_t size,
+                                 memory_access_type_t access_type) {
+    heatmap_counter_t *lines = atomic_load_explicit(&region->heatmap, memory_order_acquire);
+    if (!lines) {
+        return;
+    }
+    
+    size_t first = offset / MEMORY_HEATMAP_LINE_SIZE;
+    size_t last = (offset + size - 1) / MEMORY_HEATMAP_LINE_SIZE;
+    for (size_t line = first; line <= last; line++) {
+        _Atomic uint64_t *counter = access_type == MEMORY_ACCESS_WRITE ?
+                                    &lines[line].writes : &lines[line].reads;
+        atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
+    }
+}
+
 /**
  * @brief 读取内存字节
  * 
@@ -393,6 +844,9 @@ int memory_read_byte(memory_region_t *region, uint64_t addr, uint8_t *value) {
     /* 读取数据 */
     *value = region->data[offset];
     
+    /* 访问热图 */
+    heatmap_count(region, offset, 1, MEMORY_ACCESS_READ);
+    
     /* 通知监视器 */
     monitor_notify_memory_access(region, addr, 1, *value, MEMORY_ACCESS_READ);
     
@@ -421,11 +875,21 @@ int memory_write_byte(memory_region_t *region, uint64_t addr, uint8_t value) {
     /* 计算偏移量 */
     size_t offset = addr - region->base_addr;
     
-    /* 写入数据 */
+    /* 写入数据，只有监视点需要时才读取写入前的值 */
+    bool capture = (memory_region_get_watch_flags(region) & MEMORY_WATCH_OLD_VALUE) != 0;
+    uint8_t old_value = capture ? region->data[offset] : 0;
     region->data[offset] = value;
+    mark_pages_dirty(region, offset, 1);
+    
+    /* 访问热图 */
+    heatmap_count(region, offset, 1, MEMORY_ACCESS_WRITE);
     
     /* 通知监视器 */
-    monitor_notify_memory_access(region, addr, 1, value, MEMORY_ACCESS_WRITE);
+    if (capture) {
+        monitor_notify_memory_write(region, addr, 1, old_value, value);
+    } else {
+        monitor_notify_memory_access(region, addr, 1, value, MEMORY_ACCESS_WRITE);
+    }
     
     return PHYMUTI_SUCCESS;
 }
@@ -460,6 +924,9 @@ int memory_read_halfword(memory_region_t *region, uint64_t addr, uint16_t *value
     /* 读取数据 */
     *value = *(uint16_t *)(region->data + offset);
     
+    /* 访问热图 */
+    heatmap_count(region, offset, 2, MEMORY_ACCESS_READ);
+    
     /* 通知监视器 */
     monitor_notify_memory_access(region, addr, 2, *value, MEMORY_ACCESS_READ);
     
@@ -493,11 +960,21 @@ int memory_write_halfword(memory_region_t *region, uint64_t addr, uint16_t value
     /* 计算偏移量 */
     size_t offset = addr - region->base_addr;
     
-    /* 写入数据 */
+    /* 写入数据，只有监视点需要时才读取写入前的值 */
+    bool capture = (memory_region_get_watch_flags(region) & MEMORY_WATCH_OLD_VALUE) != 0;
+    uint16_t old_value = capture ? *(uint16_t *)(region->data + offset) : 0;
     *(uint16_t *)(region->data + offset) = value;
+    mark_pages_dirty(region, offset, 2);
+    
+    /* 访问热图 */
+    heatmap_count(region, offset, 2, MEMORY_ACCESS_WRITE);
     
     /* 通知监视器 */
-    monitor_notify_memory_access(region, addr, 2, value, MEMORY_ACCESS_WRITE);
+    if (capture) {
+        monitor_notify_memory_write(region, addr, 2, old_value, value);
+    } else {
+        monitor_notify_memory_access(region, addr, 2, value, MEMORY_ACCESS_WRITE);
+    }
     
     return PHYMUTI_SUCCESS;
 }
@@ -532,6 +1009,9 @@ int memory_read_word(memory_region_t *region, uint64_t addr, uint32_t *value) {
     /* 读取数据 */
     *value = *(uint32_t *)(region->data + offset);
     
+    /* 访问热图 */
+    heatmap_count(region, offset, 4, MEMORY_ACCESS_READ);
+    
     /* 通知监视器 */
     monitor_notify_memory_access(region, addr, 4, *value, MEMORY_ACCESS_READ);
     
@@ -565,11 +1045,21 @@ int memory_write_word(memory_region_t *region, uint64_t addr, uint32_t value) {
     /* 计算偏移量 */
     size_t offset = addr - region->base_addr;
     
-    /* 写入数据 */
+    /* 写入数据，只有监视点需要时才读取写入前的值 */
+    bool capture = (memory_region_get_watch_flags(region) & MEMORY_WATCH_OLD_VALUE) != 0;
+    uint32_t old_value = capture ? *(uint32_t *)(region->data + offset) : 0;
     *(uint32_t *)(region->data + offset) = value;
+    mark_pages_dirty(region, offset, 4);
+    
+    /* 访问热图 */
+    heatmap_count(region, offset, 4, MEMORY_ACCESS_WRITE);
     
     /* 通知监视器 */
-    monitor_notify_memory_access(region, addr, 4, value, MEMORY_ACCESS_WRITE);
+    if (capture) {
+        monitor_notify_memory_write(region, addr, 4, old_value, value);
+    } else {
+        monitor_notify_memory_access(region, addr, 4, value, MEMORY_ACCESS_WRITE);
+    }
     
     return PHYMUTI_SUCCESS;
 }
@@ -604,6 +1094,9 @@ int memory_read_doubleword(memory_region_t *region, uint64_t addr, uint64_t *val
     /* 读取数据 */
     *value = *(uint64_t *)(region->data + offset);
     
+    /* 访问热图 */
+    heatmap_count(region, offset, 8, MEMORY_ACCESS_READ);
+    
     /* 通知监视器 */
     monitor_notify_memory_access(region, addr, 8, *value, MEMORY_ACCESS_READ);
     
@@ -637,11 +1130,21 @@ int memory_write_doubleword(memory_region_t *region, uint64_t addr, uint64_t val
     /* 计算偏移量 */
     size_t offset = addr - region->base_addr;
     
-    /* 写入数据 */
+    /* 写入数据，只有监视点需要时才读取写入前的值 */
+    bool capture = (memory_region_get_watch_flags(region) & MEMORY_WATCH_OLD_VALUE) != 0;
+    uint64_t old_value = capture ? *(uint64_t *)(region->data + offset) : 0;
     *(uint64_t *)(region->data + offset) = value;
+    mark_pages_dirty(region, offset, 8);
+    
+    /* 访问热图 */
+    heatmap_count(region, offset, 8, MEMORY_ACCESS_WRITE);
     
     /* 通知监视器 */
-    monitor_notify_memory_access(region, addr, 8, value, MEMORY_ACCESS_WRITE);
+    if (capture) {
+        monitor_notify_memory_write(region, addr, 8, old_value, value);
+    } else {
+        monitor_notify_memory_access(region, addr, 8, value, MEMORY_ACCESS_WRITE);
+    }
     
     return PHYMUTI_SUCCESS;
 }
@@ -672,6 +1175,9 @@ int memory_read_buffer(memory_region_t *region, uint64_t addr, void *buffer, siz
     /* 读取数据 */
     memcpy(buffer, region->data + offset, size);
     
+    /* 访问热图 */
+    heatmap_count(region, offset, size, MEMORY_ACCESS_READ);
+    
     /* 通知监视器（简化处理，只通知一次） */
     monitor_notify_memory_access(region, addr, size, 0, MEMORY_ACCESS_READ);
     
@@ -703,9 +1209,549 @@ int memory_write_buffer(memory_region_t *region, uint64_t addr, const void *buff
     
     /* 写入数据 */
     memcpy(region->data + offset, buffer, size);
+    mark_pages_dirty(region, offset, size);
+    
+    /* 访问热图 */
+    heatmap_count(region, offset, size, MEMORY_ACCESS_WRITE);
     
     /* 通知监视器（简化处理，只通知一次） */
     monitor_notify_memory_access(region, addr, size, 0, MEMORY_ACCESS_WRITE);
     
     return PHYMUTI_SUCCESS;
-} 
\ No newline at end of file
+} 
+
+/* 快照读取自旋多少次后让出CPU */
+#define SNAPSHOT_SPIN_LIMIT 64
+
+/**
+ * @brief 按序列号重试拷贝，直到拷贝期间没有写者
+ * 
+ * @param seq 写序列号
+ * @param dst 目标缓冲区
+ * @param src 源数据
+ * @param size 大小（字节）
+ */
+static void seqlock_copy(_Atomic uint32_t *seq, void *dst, const uint8_t *src, size_t size) {
+    uint32_t spins = 0;
+    
+    for (;;) {
+        uint32_t begin = atomic_load_explicit(seq, memory_order_acquire);
+        if (!(begin & 1)) {
+            memcpy(dst, src, size);
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(seq, memory_order_relaxed) == begin) {
+                return;
+            }
+        }
+        
+        if (++spins >= SNAPSHOT_SPIN_LIMIT) {
+            spins = 0;
+            sched_yield();
+        }
+    }
+}
+
+/**
+ * @brief 在共享内存映射视图上读取一致的快照
+ * 
+ * @param view 映射视图
+ * @param addr 地址
+ * @param buffer 缓冲区
+ * @param size 大小（字节）
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_shared_read_snapshot(const memory_shared_view_t *view, uint64_t addr,
+                                void *buffer, size_t size) {
+    if (!view || !view->map || !buffer || size == 0) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    if (addr < view->base_addr || addr - view->base_addr > view->size ||
+        size > view->size - (addr - view->base_addr)) {
+        return PHYMUTI_ERROR_MEMORY_OUT_OF_RANGE;
+    }
+    
+    seqlock_copy((_Atomic uint32_t *)&view->header->sequence, buffer,
+                 view->data + (addr - view->base_addr), size);
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 开始一组需要整体可见的写入
+ * 
+ * @param region 内存区域指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_write_begin(memory_region_t *region) {
+    if (!region) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 序列号变为奇数后再写数据 */
+    atomic_fetch_add_explicit(region->seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 结束一组写入
+ * 
+ * @param region 内存区域指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_write_end(memory_region_t *region) {
+    if (!region) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 数据写完后序列号恢复为偶数 */
+    atomic_fetch_add_explicit(region->seq, 1, memory_order_release);
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 无锁读取内存块的一致快照
+ * 
+ * @param region 内存区域指针
+ * @param addr 地址
+ * @param buffer 缓冲区
+ * @param size 大小（字节）
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_read_snapshot(memory_region_t *region, uint64_t addr, void *buffer, size_t size) {
+    if (!region || !buffer || size == 0) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 检查访问权限 */
+    int ret = check_memory_access(region, addr, size, MEMORY_ACCESS_READ);
+    if (ret != PHYMUTI_SUCCESS) {
+        return ret;
+    }
+    
+    /* 读取数据 */
+    seqlock_copy(region->seq, buffer, region->data + (addr - region->base_addr), size);
+    
+    /* 访问热图 */
+    heatmap_count(region, addr - region->base_addr, size, MEMORY_ACCESS_READ);
+    
+    /* 通知监视器（与块读取相同，只通知一次） */
+    monitor_notify_memory_access(region, addr, size, 0, MEMORY_ACCESS_READ);
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 用同一字节填充内存块
+ * 
+ * @param region 内存区域指针
+ * @param addr 起始地址
+ * @param value 填充字节
+ * @param size 大小（字节）
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_fill(memory_region_t *region, uint64_t addr, uint8_t value, size_t size) {
+    if (!region || size == 0) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 检查访问权限 */
+    int ret = check_memory_access(region, addr, size, MEMORY_ACCESS_WRITE);
+    if (ret != PHYMUTI_SUCCESS) {
+        return ret;
+    }
+    
+    /* 计算偏移量 */
+    size_t offset = addr - region->base_addr;
+    
+    /* 写入数据（libc的memset已按CPU选择向量实现） */
+    memset(region->data + offset, value, size);
+    mark_pages_dirty(region, offset, size);
+    
+    /* 访问热图 */
+    heatmap_count(region, offset, size, MEMORY_ACCESS_WRITE);
+    
+    /* 通知监视器（与块写入相同，只通知一次） */
+    monitor_notify_memory_access(region, addr, size, value, MEMORY_ACCESS_WRITE);
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 将内存块与期望内容比较
+ * 
+ * @param region 内存区域指针
+ * @param addr 起始地址
+ * @param expected 期望内容
+ * @param size 大小（字节）
+ * @param equal 返回是否完全相同
+ * @param diff_addr 返回第一个不同字节的地址，可为NULL
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_compare(memory_region_t *region, uint64_t addr, const void *expected, size_t size,
+                   bool *equal, uint64_t *diff_addr) {
+    if (!region || !expected || size == 0 || !equal) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 检查访问权限 */
+    int ret = check_memory_access(region, addr, size, MEMORY_ACCESS_READ);
+    if (ret != PHYMUTI_SUCCESS) {
+        return ret;
+    }
+    
+    size_t pos = memory_simd_mismatch(region->data + (addr - region->base_addr),
+                                      (const uint8_t *)expected, size);
+    *equal = (pos == size);
+    if (!*equal && diff_addr) {
+        *diff_addr = addr + pos;
+    }
+    
+    /* 访问热图 */
+    heatmap_count(region, addr - region->base_addr, size, MEMORY_ACCESS_READ);
+    
+    /* 通知监视器（与块读取相同，只通知一次） */
+    monitor_notify_memory_access(region, addr, size, 0, MEMORY_ACCESS_READ);
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 在内存范围内查找字节序列
+ * 
+ * @param region 内存区域指针
+ * @param addr 搜索起始地址
+ * @param size 搜索范围大小（字节）
+ * @param pattern 字节序列
+ * @param pattern_len 字节序列长度
+ * @param found_addr 返回第一次出现的地址
+ * @return int 成功返回0，未找到返回PHYMUTI_ERROR_NOT_FOUND，失败返回错误码
+ */
+int memory_find_pattern(memory_region_t *region, uint64_t addr, size_t size,
+                        const void *pattern, size_t pattern_len, uint64_t *found_addr) {
+    if (!region || size == 0 || !pattern || pattern_len == 0 || !found_addr) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 检查访问权限 */
+    int ret = check_memory_access(region, addr, size, MEMORY_ACCESS_READ);
+    if (ret != PHYMUTI_SUCCESS) {
+        return ret;
+    }
+    
+    size_t pos = memory_simd_find(region->data + (addr - region->base_addr), size,
+                                  (const uint8_t *)pattern, pattern_len);
+    
+    /* 访问热图 */
+    heatmap_count(region, addr - region->base_addr, size, MEMORY_ACCESS_READ);
+    
+    /* 通知监视器（与块读取相同，只通知一次） */
+    monitor_notify_memory_access(region, addr, size, 0, MEMORY_ACCESS_READ);
+    
+    if (pos == size) {
+        return PHYMUTI_ERROR_NOT_FOUND;
+    }
+    
+    *found_addr = addr + pos;
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 计算内存区域内容的哈希
+ * 
+ * @param region 内存区域指针
+ * @param hash 返回哈希值
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_hash(memory_region_t *region, uint64_t *hash) {
+    int ret;
+    
+    if (!region || !hash) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    ret = pthread_mutex_lock(&region->hash_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    /*
+     * 只重新计算被写过的页，先清除标记再读数据。清除后的栅栏与mark_pages_dirty()中的
+     * 栅栏配对，哈希没有包含的写入一定会重新置位，下次计算时重新哈希该页。
+     */
+    size_t bitmap_words = (region->page_count + 63) / 64;
+    for (size_t w = 0; w < bitmap_words; w++) {
+        uint64_t dirty = atomic_exchange_explicit(&region->hash_dirty[w], 0, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        while (dirty) {
+            size_t page = w * 64 + (size_t)__builtin_ctzll(dirty);
+            size_t offset = page * MEMORY_PAGE_SIZE;
+            size_t len = region->size - offset < MEMORY_PAGE_SIZE ? region->size - offset : MEMORY_PAGE_SIZE;
+            region->page_hashes[page] = memory_simd_hash(region->data + offset, len, page);
+            dirty &= dirty - 1;
+        }
+    }
+    
+    /* 以页哈希数组的哈希作为区域哈希 */
+    *hash = memory_simd_hash((const uint8_t *)region->page_hashes,
+                             region->page_count * sizeof(uint64_t), region->size);
+    
+    ret = pthread_mutex_unlock(&region->hash_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 获取内存区域数据的只读指针
+ * 
+ * @param region 内存区域指针
+ * @return const uint8_t* 数据指针
+ */
+const uint8_t* memory_region_data(const memory_region_t *region) {
+    return region ? region->data : NULL;
+}
+
+/**
+ * @brief 取出并清除检查点脏页位图
+ * 
+ * 清除后的栅栏与mark_pages_dirty()中的栅栏配对：调用者之后读取的页数据
+ * 没有包含的写入一定会重新置位，下一次取出时仍会得到该页。
+ * 
+ * @param region 内存区域指针
+ * @param bitmap 返回位图
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_take_dirty_pages(memory_region_t *region, uint64_t *bitmap) {
+    if (!region || !bitmap) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    size_t bitmap_words = (region->page_count + 63) / 64;
+    for (size_t w = 0; w < bitmap_words; w++) {
+        bitmap[w] = atomic_exchange_explicit(&region->ckpt_dirty[w], 0, memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_seq_cst);
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 开启内存区域的访问热图，清除之前的计数
+ * 
+ * @param region 内存区域指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_enable_heatmap(memory_region_t *region) {
+    if (!region) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 首次开启时分配计数数组，并发开启时只保留一个 */
+    heatmap_counter_t *lines = atomic_load(&region->heatmap_lines);
+    if (!lines) {
+        heatmap_counter_t *fresh = (heatmap_counter_t *)calloc(region->heatmap_line_count,
+                                                               sizeof(heatmap_counter_t));
+        if (!fresh) {
+            return PHYMUTI_ERROR_OUT_OF_MEMORY;
+        }
+        if (atomic_compare_exchange_strong(&region->heatmap_lines, &lines, fresh)) {
+            lines = fresh;
+        } else {
+            free(fresh);
+        }
+    }
+    
+    for (size_t i = 0; i < region->heatmap_line_count; i++) {
+        atomic_store_explicit(&lines[i].reads, 0, memory_order_relaxed);
+        atomic_store_explicit(&lines[i].writes, 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&region->heatmap, lines, memory_order_release);
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 关闭内存区域的访问热图，计数保留以便读取和导出
+ * 
+ * @param region 内存区域指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_disable_heatmap(memory_region_t *region) {
+    if (!region) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    atomic_store_explicit(&region->heatmap, NULL, memory_order_release);
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 读取内存区域的访问热图
+ * 
+ * @param region 内存区域指针
+ * @param lines 输出数组，为NULL时只返回行数
+ * @param max_lines 数组容量
+ * @param count 返回区域的总行数
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_get_heatmap(memory_region_t *region, memory_heatmap_line_t *lines,
+                              size_t max_lines, size_t *count) {
+    if (!region || !count) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    heatmap_counter_t *counters = atomic_load(&region->heatmap_lines);
+    if (!counters) {
+        return PHYMUTI_ERROR_NOT_FOUND;
+    }
+    
+    *count = region->heatmap_line_count;
+    if (lines) {
+        size_t n = max_lines < region->heatmap_line_count ? max_lines : region->heatmap_line_count;
+        for (size_t i = 0; i < n; i++) {
+            lines[i].reads = atomic_load_explicit(&counters[i].reads, memory_order_relaxed);
+            lines[i].writes = atomic_load_explicit(&counters[i].writes, memory_order_relaxed);
+        }
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/* 导出热图时每次写入的行数 */
+#define HEATMAP_DUMP_CHUNK 256
+
+/**
+ * @brief 将内存区域的访问热图导出为二进制文件
+ * 
+ * @param region 内存区域指针
+ * @param path 文件路径
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_dump_heatmap(memory_region_t *region, const char *path) {
+    if (!region || !path) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    heatmap_counter_t *counters = atomic_load(&region->heatmap_lines);
+    if (!counters) {
+        return PHYMUTI_ERROR_NOT_FOUND;
+    }
+    
+    memory_heatmap_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MEMORY_HEATMAP_MAGIC, sizeof(MEMORY_HEATMAP_MAGIC));
+    header.version = MEMORY_HEATMAP_VERSION;
+    header.line_size = MEMORY_HEATMAP_LINE_SIZE;
+    header.region_id = region->id;
+    header.base_addr = region->base_addr;
+    header.size = region->size;
+    header.line_count = region->heatmap_line_count;
+    strncpy(header.name, region->name, sizeof(header.name) - 1);
+    
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        return PHYMUTI_ERROR_IO;
+    }
+    
+    int ret = PHYMUTI_SUCCESS;
+    if (fwrite(&header, sizeof(header), 1, fp) != 1) {
+        ret = PHYMUTI_ERROR_IO;
+    }
+    
+    memory_heatmap_line_t chunk[HEATMAP_DUMP_CHUNK];
+    for (size_t i = 0; ret == PHYMUTI_SUCCESS && i < region->heatmap_line_count; i += HEATMAP_DUMP_CHUNK) {
+        size_t n = region->heatmap_line_count - i;
+        if (n > HEATMAP_DUMP_CHUNK) {
+            n = HEATMAP_DUMP_CHUNK;
+        }
+        for (size_t j = 0; j < n; j++) {
+            chunk[j].reads = atomic_load_explicit(&counters[i + j].reads, memory_order_relaxed);
+            chunk[j].writes = atomic_load_explicit(&counters[i + j].writes, memory_order_relaxed);
+        }
+        if (fwrite(chunk, sizeof(chunk[0]), n, fp) != n) {
+            ret = PHYMUTI_ERROR_IO;
+        }
+    }
+    
+    if (fclose(fp) != 0 && ret == PHYMUTI_SUCCESS) {
+        ret = PHYMUTI_ERROR_IO;
+    }
+    return ret;
+}
+
+/**
+ * @brief 直接装入内存区域数据
+ * 
+ * @param region 内存区域指针
+ * @param offset 相对基地址的偏移
+ * @param data 数据
+ * @param size 大小（字节）
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_load(memory_region_t *region, size_t offset, const void *data, size_t size) {
+    if (!region || !data || size == 0) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    if (offset > region->size || size > region->size - offset) {
+        return PHYMUTI_ERROR_MEMORY_OUT_OF_RANGE;
+    }
+    
+    memory_write_begin(region);
+    memcpy(region->data + offset, data, size);
+    mark_pages_dirty(region, offset, size);
+    memory_write_end(region);
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 把内存区域内容替换为文件的私有映射
+ * 
+ * @param region 内存区域指针
+ * @param fd 文件描述符
+ * @param offset 区域内容在文件中的偏移
+ * @return int 成功返回0，失败返回错误码
+ */
+int memory_region_map_file(memory_region_t *region, int fd, uint64_t offset) {
+    if (!region || fd < 0) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 共享区域的数据必须留在共享内存对象中 */
+    if (region->shm_name || offset % (uint64_t)sysconf(_SC_PAGESIZE) != 0) {
+        return PHYMUTI_ERROR_NOT_SUPPORTED;
+    }
+    
+    /* 先建立新映射再替换，失败时原内容保持不变 */
+    void *map = mmap(NULL, region->data_map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t)offset);
+    if (map == MAP_FAILED) {
+        return PHYMUTI_ERROR_IO;
+    }
+    
+    /*
+     * 访问路径不进入纪元临界区，无法知道何时不再有访问使用旧映射。
+     * 把新映射原子地移动到原地址上替换旧映射，数据指针不变，
+     * 并发的访问看到旧内容或新内容，不会访问到未映射的地址。
+     */
+    memory_write_begin(region);
+    void *moved = mremap(map, region->data_map_size, region->data_map_size,
+                         MREMAP_MAYMOVE | MREMAP_FIXED, region->data);
+    if (moved != MAP_FAILED) {
+        mark_pages_dirty(region, 0, region->size);
+    }
+    memory_write_end(region);
+    
+    if (moved == MAP_FAILED) {
+        munmap(map, region->data_map_size);
+        return PHYMUTI_ERROR_IO;
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
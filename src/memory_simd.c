@@ -0,0 +1,459 @@
+/**
+ * @file memory_simd.c
+ * @brief 内存块比较、搜索、哈希与区间匹配的向量化内核
+ */
+
+#include "memory_simd.h"
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MEMORY_SIMD_X86 1
+#endif
+
+/* 内核函数类型 */
+typedef size_t (*mismatch_fn_t)(const uint8_t *a, const uint8_t *b, size_t size);
+typedef size_t (*find_fn_t)(const uint8_t *data, size_t size, const uint8_t *pattern, size_t pattern_len);
+typedef void (*hash_stripes_fn_t)(uint64_t acc[4], const uint8_t *data, size_t stripes, size_t first);
+typedef uint64_t (*match_ranges_fn_t)(const int32_t *start, const int32_t *end, const uint8_t *access,
+                                      size_t count, int32_t lo, int32_t hi, uint8_t access_bit);
+
+/* 选定的内核 */
+static mismatch_fn_t mismatch_impl;
+static find_fn_t find_impl;
+static hash_stripes_fn_t hash_stripes_impl;
+static match_ranges_fn_t match_ranges_impl;
+
+/*
+ * 哈希按32字节条带累加到4个64位累加器：每个条带与随位置变化的密钥异或后
+ * 做32x32->64乘法，并把原数据加到相邻累加器；每16个条带（512字节）打散一次
+ * 累加器，使块的先后顺序影响结果。只用加法、乘法和移位，向量实现逐位一致。
+ */
+#define HASH_STRIPE_SIZE    32
+#define HASH_BLOCK_STRIPES  16
+#define HASH_PRIME32_1      0x9E3779B1u
+#define HASH_PRIME64_1      0x9E3779B185EBCA87ull
+#define HASH_PRIME64_2      0xC2B2AE3D27D4EB4Full
+#define HASH_PRIME64_3      0x165667B19E3779F9ull
+
+static const uint64_t hash_secret[4] = {
+    0xbe4ba423396cfeb8ull, 0x1cad21f72c81017cull,
+    0xdb979083e96dd4deull, 0x1f67b3b7a4a44072ull,
+};
+
+/* 每个条带位置的密钥，hash_keys[s][j] = hash_secret[j] + s * HASH_PRIME64_2 */
+static uint64_t hash_keys[HASH_BLOCK_STRIPES][4];
+static pthread_once_t simd_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief 标量比较，从start开始
+ */
+static size_t mismatch_scalar_from(const uint8_t *a, const uint8_t *b, size_t start, size_t size) {
+    size_t i = start;
+
+    /* 按8字节比较，不同时再逐字节定位 */
+    while (i + 8 <= size) {
+        uint64_t x, y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        if (x != y) {
+            break;
+        }
+        i += 8;
+    }
+    while (i < size && a[i] == b[i]) {
+        i++;
+    }
+
+    return i;
+}
+
+static size_t mismatch_scalar(const uint8_t *a, const uint8_t *b, size_t size) {
+    return mismatch_scalar_from(a, b, 0, size);
+}
+
+/**
+ * @brief 标量搜索，只检查起始位置不小于start的匹配
+ */
+static size_t find_scalar_from(const uint8_t *data, size_t size, const uint8_t *pattern,
+                               size_t pattern_len, size_t start) {
+    if (pattern_len > size) {
+        return size;
+    }
+
+    size_t last = size - pattern_len;
+    size_t i = start;
+    while (i <= last) {
+        const uint8_t *p = (const uint8_t *)memchr(data + i, pattern[0], last - i + 1);
+        if (!p) {
+            break;
+        }
+        i = (size_t)(p - data);
+        if (memcmp(p + 1, pattern + 1, pattern_len - 1) == 0) {
+            return i;
+        }
+        i++;
+    }
+
+    return size;
+}
+
+static size_t find_scalar(const uint8_t *data, size_t size, const uint8_t *pattern, size_t pattern_len) {
+    return find_scalar_from(data, size, pattern, pattern_len, 0);
+}
+
+/**
+ * @brief 打散累加器
+ */
+static void hash_scramble_scalar(uint64_t acc[4]) {
+    for (int j = 0; j < 4; j++) {
+        uint64_t a = acc[j];
+        a ^= a >> 47;
+        a ^= hash_secret[j];
+        acc[j] = a * HASH_PRIME32_1;
+    }
+}
+
+/**
+ * @brief 标量累加条带
+ *
+ * @param acc 累加器
+ * @param data 数据，长度为stripes个条带
+ * @param stripes 条带数
+ * @param first 第一个条带在块内的位置
+ */
+static void hash_stripes_scalar(uint64_t acc[4], const uint8_t *data, size_t stripes, size_t first) {
+    for (size_t n = 0; n < stripes; n++) {
+        size_t s = (first + n) % HASH_BLOCK_STRIPES;
+        uint64_t d[4];
+        memcpy(d, data + n * HASH_STRIPE_SIZE, sizeof(d));
+
+        for (int j = 0; j < 4; j++) {
+            uint64_t k = d[j] ^ hash_keys[s][j];
+            acc[j] += (k & 0xffffffffull) * (k >> 32) + d[j ^ 1];
+        }
+
+        if (s == HASH_BLOCK_STRIPES - 1) {
+            hash_scramble_scalar(acc);
+        }
+    }
+}
+
+/* 只保留前count位的掩码 */
+static inline uint64_t low_bits(size_t count) {
+    return count >= 64 ? ~0ull : (1ull << count) - 1;
+}
+
+static uint64_t match_ranges_scalar(const int32_t *start, const int32_t *end, const uint8_t *access,
+                                    size_t count, int32_t lo, int32_t hi, uint8_t access_bit) {
+    uint64_t mask = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (start[i] < hi && end[i] > lo && (access[i] & access_bit)) {
+            mask |= 1ull << i;
+        }
+    }
+
+    return mask;
+}
+
+#ifdef MEMORY_SIMD_X86
+
+__attribute__((target("avx2")))
+static void hash_stripes_avx2(uint64_t acc_out[4], const uint8_t *data, size_t stripes, size_t first) {
+    const __m256i prime = _mm256_set1_epi32((int)HASH_PRIME32_1);
+    const __m256i secret = _mm256_loadu_si256((const __m256i *)hash_secret);
+    __m256i acc = _mm256_loadu_si256((const __m256i *)acc_out);
+
+    for (size_t n = 0; n < stripes; n++) {
+        size_t s = (first + n) % HASH_BLOCK_STRIPES;
+        __m256i d = _mm256_loadu_si256((const __m256i *)(data + n * HASH_STRIPE_SIZE));
+        __m256i k = _mm256_xor_si256(d, _mm256_loadu_si256((const __m256i *)hash_keys[s]));
+        __m256i prod = _mm256_mul_epu32(k, _mm256_srli_epi64(k, 32));
+        __m256i swapped = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+        acc = _mm256_add_epi64(acc, _mm256_add_epi64(prod, swapped));
+
+        if (s == HASH_BLOCK_STRIPES - 1) {
+            /* 64位乘以32位常数：低32位和高32位分别相乘后合并 */
+            acc = _mm256_xor_si256(acc, _mm256_srli_epi64(acc, 47));
+            acc = _mm256_xor_si256(acc, secret);
+            __m256i lo = _mm256_mul_epu32(acc, prime);
+            __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(acc, 32), prime);
+            acc = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+        }
+    }
+
+    _mm256_storeu_si256((__m256i *)acc_out, acc);
+}
+
+/* SSE2是x86-64的基本指令集，无需检测 */
+static size_t mismatch_sse2(const uint8_t *a, const uint8_t *b, size_t size) {
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) ^ 0xffffu;
+        if (mask) {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+
+    return mismatch_scalar_from(a, b, i, size);
+}
+
+__attribute__((target("avx2")))
+static size_t mismatch_avx2(const uint8_t *a, const uint8_t *b, size_t size) {
+    size_t i = 0;
+
+    /* 每次比较64字节，合并两个掩码减少分支 */
+    for (; i + 64 <= size; i += 64) {
+        __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i)),
+                                       _mm256_loadu_si256((const __m256i *)(b + i)));
+        __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i + 32)),
+                                       _mm256_loadu_si256((const __m256i *)(b + i + 32)));
+        if ((uint32_t)_mm256_movemask_epi8(_mm256_and_si256(e0, e1)) != 0xffffffffu) {
+            uint32_t m0 = ~(uint32_t)_mm256_movemask_epi8(e0);
+            if (m0) {
+                return i + (size_t)__builtin_ctz(m0);
+            }
+            return i + 32 + (size_t)__builtin_ctz(~(uint32_t)_mm256_movemask_epi8(e1));
+        }
+    }
+    for (; i + 32 <= size; i += 32) {
+        __m256i e = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i)),
+                                      _mm256_loadu_si256((const __m256i *)(b + i)));
+        uint32_t m = ~(uint32_t)_mm256_movemask_epi8(e);
+        if (m) {
+            return i + (size_t)__builtin_ctz(m);
+        }
+    }
+
+    return mismatch_scalar_from(a, b, i, size);
+}
+
+/*
+ * 搜索内核：同时比较序列首字节和末字节，只有两者都匹配的位置才做完整比较，
+ * 对随机数据几乎不产生候选位置。
+ */
+static size_t find_sse2(const uint8_t *data, size_t size, const uint8_t *pattern, size_t pattern_len) {
+    if (pattern_len > size) {
+        return size;
+    }
+
+    const __m128i first = _mm_set1_epi8((char)pattern[0]);
+    const __m128i last = _mm_set1_epi8((char)pattern[pattern_len - 1]);
+    size_t i = 0;
+
+    for (; i + pattern_len - 1 + 16 <= size; i += 16) {
+        __m128i bf = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i bl = _mm_loadu_si128((const __m128i *)(data + i + pattern_len - 1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(bf, first),
+                                                                  _mm_cmpeq_epi8(bl, last)));
+        while (mask) {
+            size_t pos = i + (size_t)__builtin_ctz(mask);
+            if (pattern_len <= 2 || memcmp(data + pos + 1, pattern + 1, pattern_len - 2) == 0) {
+                return pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    return find_scalar_from(data, size, pattern, pattern_len, i);
+}
+
+__attribute__((target("avx2")))
+static size_t find_avx2(const uint8_t *data, size_t size, const uint8_t *pattern, size_t pattern_len) {
+    if (pattern_len > size) {
+        return size;
+    }
+
+    const __m256i first = _mm256_set1_epi8((char)pattern[0]);
+    const __m256i last = _mm256_set1_epi8((char)pattern[pattern_len - 1]);
+    size_t i = 0;
+
+    for (; i + pattern_len - 1 + 32 <= size; i += 32) {
+        __m256i bf = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i bl = _mm256_loadu_si256((const __m256i *)(data + i + pattern_len - 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(bf, first),
+                                                                        _mm256_cmpeq_epi8(bl, last)));
+        while (mask) {
+            size_t pos = i + (size_t)__builtin_ctz(mask);
+            if (pattern_len <= 2 || memcmp(data + pos + 1, pattern + 1, pattern_len - 2) == 0) {
+                return pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    return find_scalar_from(data, size, pattern, pattern_len, i);
+}
+
+/* 每次比较4个区间和16个访问类型字节 */
+static uint64_t match_ranges_sse2(const int32_t *start, const int32_t *end, const uint8_t *access,
+                                  size_t count, int32_t lo, int32_t hi, uint8_t access_bit) {
+    const __m128i vlo = _mm_set1_epi32(lo);
+    const __m128i vhi = _mm_set1_epi32(hi);
+    const __m128i vbit = _mm_set1_epi8((char)access_bit);
+    const __m128i zero = _mm_setzero_si128();
+    uint64_t ranges = 0, types = 0;
+
+    for (size_t i = 0; i < count; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(start + i));
+        __m128i e = _mm_loadu_si128((const __m128i *)(end + i));
+        __m128i m = _mm_and_si128(_mm_cmpgt_epi32(vhi, s), _mm_cmpgt_epi32(e, vlo));
+        ranges |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(m)) << i;
+    }
+    for (size_t i = 0; i < count; i += 16) {
+        __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i *)(access + i)), vbit);
+        types |= (uint64_t)((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(a, zero)) ^ 0xffffu) << i;
+    }
+
+    return ranges & types & low_bits(count);
+}
+
+/* 每次比较8个区间和32个访问类型字节 */
+__attribute__((target("avx2")))
+static uint64_t match_ranges_avx2(const int32_t *start, const int32_t *end, const uint8_t *access,
+                                  size_t count, int32_t lo, int32_t hi, uint8_t access_bit) {
+    const __m256i vlo = _mm256_set1_epi32(lo);
+    const __m256i vhi = _mm256_set1_epi32(hi);
+    const __m256i vbit = _mm256_set1_epi8((char)access_bit);
+    const __m256i zero = _mm256_setzero_si256();
+    uint64_t ranges = 0, types = 0;
+
+    for (size_t i = 0; i < count; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(start + i));
+        __m256i e = _mm256_loadu_si256((const __m256i *)(end + i));
+        __m256i m = _mm256_and_si256(_mm256_cmpgt_epi32(vhi, s), _mm256_cmpgt_epi32(e, vlo));
+        ranges |= (uint64_t)(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(m)) << i;
+    }
+    for (size_t i = 0; i < count; i += 32) {
+        __m256i a = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(access + i)), vbit);
+        types |= (uint64_t)~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, zero)) << i;
+    }
+
+    return ranges & types & low_bits(count);
+}
+
+#endif /* MEMORY_SIMD_X86 */
+
+/**
+ * @brief 按CPU特性选择内核
+ */
+static void memory_simd_select(void) {
+    for (size_t s = 0; s < HASH_BLOCK_STRIPES; s++) {
+        for (int j = 0; j < 4; j++) {
+            hash_keys[s][j] = hash_secret[j] + (uint64_t)s * HASH_PRIME64_2;
+        }
+    }
+
+    mismatch_impl = mismatch_scalar;
+    find_impl = find_scalar;
+    hash_stripes_impl = hash_stripes_scalar;
+    match_ranges_impl = match_ranges_scalar;
+
+#ifdef MEMORY_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        mismatch_impl = mismatch_avx2;
+        find_impl = find_avx2;
+        hash_stripes_impl = hash_stripes_avx2;
+        match_ranges_impl = match_ranges_avx2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        mismatch_impl = mismatch_sse2;
+        find_impl = find_sse2;
+        match_ranges_impl = match_ranges_sse2;
+    }
+#endif
+}
+
+/**
+ * @brief 查找两块内存中第一个不同的字节
+ *
+ * @param a 第一块内存
+ * @param b 第二块内存
+ * @param size 大小（字节）
+ * @return size_t 第一个不同字节的偏移，完全相同时返回size
+ */
+size_t memory_simd_mismatch(const uint8_t *a, const uint8_t *b, size_t size) {
+    pthread_once(&simd_once, memory_simd_select);
+    return mismatch_impl(a, b, size);
+}
+
+/**
+ * @brief 在内存块中查找字节序列
+ *
+ * @param data 被搜索的内存
+ * @param size 内存大小（字节）
+ * @param pattern 字节序列
+ * @param pattern_len 字节序列长度，必须大于0
+ * @return size_t 第一次出现的偏移，未找到时返回size
+ */
+size_t memory_simd_find(const uint8_t *data, size_t size, const uint8_t *pattern, size_t pattern_len) {
+    pthread_once(&simd_once, memory_simd_select);
+    return find_impl(data, size, pattern, pattern_len);
+}
+
+/**
+ * @brief 计算内存块的64位非加密哈希
+ *
+ * @param data 内存块
+ * @param size 大小（字节）
+ * @param seed 种子
+ * @return uint64_t 哈希值
+ */
+uint64_t memory_simd_hash(const uint8_t *data, size_t size, uint64_t seed) {
+    pthread_once(&simd_once, memory_simd_select);
+
+    uint64_t acc[4] = {
+        seed ^ HASH_PRIME64_1, seed ^ HASH_PRIME64_2,
+        seed + HASH_PRIME64_3, seed - HASH_PRIME64_1,
+    };
+    size_t stripes = size / HASH_STRIPE_SIZE;
+    size_t tail = size % HASH_STRIPE_SIZE;
+
+    hash_stripes_impl(acc, data, stripes, 0);
+
+    /* 不足一个条带的尾部补零后按条带处理 */
+    if (tail) {
+        uint8_t last[HASH_STRIPE_SIZE] = {0};
+        memcpy(last, data + stripes * HASH_STRIPE_SIZE, tail);
+        hash_stripes_scalar(acc, last, 1, stripes % HASH_BLOCK_STRIPES);
+    }
+
+    /* 合并累加器并做最终混合 */
+    uint64_t h = (uint64_t)size * HASH_PRIME64_1 ^ seed;
+    for (int j = 0; j < 4; j++) {
+        uint64_t a = acc[j] * HASH_PRIME64_2;
+        a = (a << 31) | (a >> 33);
+        h ^= a * HASH_PRIME64_1;
+        h = ((h << 27) | (h >> 37)) * HASH_PRIME64_1 + HASH_PRIME64_3;
+    }
+    h ^= h >> 33;
+    h *= HASH_PRIME64_2;
+    h ^= h >> 29;
+    h *= HASH_PRIME64_3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+/**
+ * @brief 找出与给定区间重叠且访问类型匹配的区间
+ *
+ * @param start 各区间的起始偏移
+ * @param end 各区间的结束偏移（不含）
+ * @param access 各区间匹配的访问类型位
+ * @param count 区间数量，不超过64
+ * @param lo 给定区间的起始偏移
+ * @param hi 给定区间的结束偏移（不含）
+ * @param access_bit 访问类型位
+ * @return uint64_t 匹配位图，第i位对应第i个区间
+ */
+uint64_t memory_simd_match_ranges(const int32_t *start, const int32_t *end, const uint8_t *access,
+                                  size_t count, int32_t lo, int32_t hi, uint8_t access_bit) {
+    pthread_once(&simd_once, memory_simd_select);
+    return match_ranges_impl(start, end, access, count, lo, hi, access_bit);
+}
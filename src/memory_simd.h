@@ -0,0 +1,66 @@
+/**
+ * @file memory_simd.h
+ * @brief 内存块比较、搜索、哈希与区间匹配的向量化内核（模块内部使用）
+ *
+ * 首次调用时按CPU特性选择AVX2、SSE2或标量实现，之后直接调用选定的内核。
+ */
+
+#ifndef MEMORY_SIMD_H
+#define MEMORY_SIMD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief 查找两块内存中第一个不同的字节
+ *
+ * @param a 第一块内存
+ * @param b 第二块内存
+ * @param size 大小（字节）
+ * @return size_t 第一个不同字节的偏移，完全相同时返回size
+ */
+size_t memory_simd_mismatch(const uint8_t *a, const uint8_t *b, size_t size);
+
+/**
+ * @brief 在内存块中查找字节序列
+ *
+ * @param data 被搜索的内存
+ * @param size 内存大小（字节）
+ * @param pattern 字节序列
+ * @param pattern_len 字节序列长度，必须大于0
+ * @return size_t 第一次出现的偏移，未找到时返回size
+ */
+size_t memory_simd_find(const uint8_t *data, size_t size, const uint8_t *pattern, size_t pattern_len);
+
+/**
+ * @brief 计算内存块的64位非加密哈希
+ *
+ * 向量实现与标量实现的结果完全相同，不同机器上计算的哈希可以直接比较。
+ *
+ * @param data 内存块
+ * @param size 大小（字节）
+ * @param seed 种子
+ * @return uint64_t 哈希值
+ */
+uint64_t memory_simd_hash(const uint8_t *data, size_t size, uint64_t seed);
+
+/**
+ * @brief 找出与给定区间重叠且访问类型匹配的区间
+ *
+ * 区间以有符号32位偏移的结构数组表示，第i个区间匹配当且仅当
+ * start[i] < hi、end[i] > lo且access[i] & access_bit不为0。
+ * 向量实现按整组读取，三个数组都必须至少可读到第count项之后32项。
+ *
+ * @param start 各区间的起始偏移
+ * @param end 各区间的结束偏移（不含）
+ * @param access 各区间匹配的访问类型位
+ * @param count 区间数量，不超过64
+ * @param lo 给定区间的起始偏移
+ * @param hi 给定区间的结束偏移（不含）
+ * @param access_bit 访问类型位
+ * @return uint64_t 匹配位图，第i位对应第i个区间
+ */
+uint64_t memory_simd_match_ranges(const int32_t *start, const int32_t *end, const uint8_t *access,
+                                  size_t count, int32_t lo, int32_t hi, uint8_t access_bit);
+
+#endif /* MEMORY_SIMD_H */
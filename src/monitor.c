@@ -6,10 +6,31 @@
 #include "monitor.h"
 #include "phymuti_error.h"
 #include "action_manager.h"
+#include "trace.h"
+#include "profile.h"
+#include "epoch.h"
+#include "spsc_ring.h"
+#include "memory_simd.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <sched.h>
 #include <pthread.h>
+#include <stdatomic.h>
+
+/* 监视点配置，发布后不再修改，修改时复制一份新的配置替换 */
+typedef struct {
+    watchpoint_type_t type;       /* 类型 */
+    bool enabled;                 /* 是否启用 */
+    uint64_t wpvalue;             /* 要监视的值 */
+    watchpoint_predicate_t predicate;  /* 值谓词 */
+    bool capture_old;             /* 是否捕获写入前的值 */
+    watchpoint_trigger_t trigger; /* 触发方式 */
+    watchpoint_coalesce_t coalesce; /* 触发合并方式 */
+    uint32_t action_count;        /* 动作数量 */
+    uint32_t action_ids[];        /* 动作ID数组 */
+} watchpoint_config_t;
 
 /* 监视点结构体 */
 typedef struct watchpoint_struct {
@@ -17,25 +38,211 @@ typedef struct watchpoint_struct {
     memory_region_t *region;      /* 内存区域 */
     uint64_t addr;                /* 地址 */
     uint32_t size;                /* 大小 */
-    watchpoint_type_t type;       /* 类型 */
-    bool enabled;                 /* 是否启用 */
-    uint64_t wpvalue;             /* 要监视的值 */
-    uint32_t *action_ids;         /* 动作ID数组 */
-    uint32_t action_count;        /* 动作数量 */
-    uint32_t action_capacity;     /* 动作容量 */
+    _Atomic(watchpoint_config_t *) config;  /* 当前配置 */
+    _Atomic uint64_t hits;        /* 命中次数 */
+    _Atomic uint64_t fired;       /* 执行动作的次数 */
+    _Atomic uint64_t trigger_hits;  /* 设置触发方式以来的命中次数（EVERY_NTH） */
+    _Atomic uint64_t window_start;  /* 当前时间窗口的起始时间（THRESHOLD） */
+    _Atomic uint64_t window_hits;   /* 当前时间窗口内的命中次数（THRESHOLD） */
+    pthread_mutex_t coalesce_mutex; /* 保护合并状态，只在启用合并时使用 */
+    uint64_t coalesce_end;        /* 当前合并窗口的结束时间 */
+    uint32_t coalesce_events;     /* 当前窗口内已执行的次数（MAX_RATE） */
+    bool coalesce_pending;        /* 是否有待执行的后沿触发 */
+    monitor_context_t coalesce_context;  /* 待执行的后沿触发的上下文 */
     struct watchpoint_struct *next;  /* 下一个监视点 */
 } watchpoint_t;
 
-/* 监视点链表头 */
+/* 尚未查询的动作优先级 */
+#define PENDING_PRIORITY_UNKNOWN -1
+
+/* 待执行的动作 */
+typedef struct {
+    uint32_t action_id;
+    int priority;               /* 动作优先级，执行前每个动作只查询一次 */
+    monitor_context_t context;
+} pending_action_t;
+
+/* 合并结果 */
+typedef enum {
+    COALESCE_DROP,      /* 不执行 */
+    COALESCE_DISPATCH   /* 立即执行 */
+} coalesce_result_t;
+
+/* 监视区间索引项 */
+typedef struct {
+    memory_region_t *region;      /* 内存区域 */
+    uint64_t start;               /* 起始地址 */
+    uint64_t end;                 /* 结束地址（不含） */
+    uint64_t max_end;             /* 同一区域中到此项为止的最大结束地址 */
+    uint64_t tree_max_end;        /* 以此项为根的子树中的最大结束地址 */
+    watchpoint_t *wp;             /* 监视点 */
+} watch_interval_t;
+
+/* 同一区域的索引项 */
+typedef struct {
+    memory_region_t *region;      /* 内存区域 */
+    size_t first;                 /* 第一项的位置 */
+    size_t count;                 /* 项数 */
+    uint64_t base;                /* 偏移基准，即组内最小的起始地址 */
+    bool packed;                  /* 组内偏移都不超过INT32_MAX，可以向量匹配 */
+} watch_group_t;
+
+/* 索引项匹配的访问类型位，禁用的监视点为0 */
+#define WATCH_ACCESS_READ  (1 << 0)
+#define WATCH_ACCESS_WRITE (1 << 1)
+
+/* 结构数组末尾的填充项数，向量匹配按整组读取 */
+#define WATCH_SOA_PADDING 32
+
+/* 不超过此项数的区域用向量匹配逐项比较，更多时查询区间树 */
+#define WATCH_SIMD_SCAN_MAX 256
+
+/*
+ * 监视区间索引，发布后不再修改。
+ * 每个区域的索引项按起始地址排序，同时看作隐式的平衡二叉搜索树：
+ * 区间[lo, hi)的根是中间项，每项记录子树中的最大结束地址。
+ * 查询只进入可能与访问重叠的子树，一个很宽的监视区间只影响从根到它的一条路径。
+ * 除按(区域, 起始地址)排序的索引项外，按相同顺序以结构数组保存相对组基准的
+ * 起止偏移和访问类型位，密集的寄存器级监视点可以一次比较8个。
+ */
+typedef struct {
+    size_t count;                 /* 索引项数量 */
+    size_t group_count;           /* 区域数量 */
+    watch_group_t *groups;        /* 按区域分组，与索引项顺序相同 */
+    int32_t *start_off;           /* 各项起始地址相对组基准的偏移 */
+    int32_t *end_off;             /* 各项结束地址相对组基准的偏移 */
+    uint8_t *access;              /* 各项匹配的访问类型位（WATCH_ACCESS_*） */
+    watch_interval_t items[];     /* 按(区域, 起始地址)排序的索引项 */
+} watch_index_t;
+
+/* 值监视点索引项 */
+typedef struct {
+    memory_region_t *region;      /* 内存区域 */
+    uint64_t value;               /* 要监视的值 */
+    uint64_t start;               /* 起始地址 */
+    uint64_t end;                 /* 结束地址（不含） */
+    watchpoint_t *wp;             /* 监视点 */
+} watch_value_item_t;
+
+/* 布隆过滤器每个索引项占的位数 */
+#define WATCH_BLOOM_BITS_PER_ITEM 16
+
+/*
+ * 值监视点（WATCHPOINT_VALUE_WRITE）索引，发布后不再修改。
+ * 值监视点不进入区间索引，按(区域, 值)散列：写入先查布隆过滤器，
+ * 多数不是被监视的值的写入只读一个字，其余只检查一个桶，
+ * 与同一地址上监视了多少个值无关。
+ */
+typedef struct {
+    size_t count;                 /* 索引项数量 */
+    size_t bucket_mask;           /* 桶数减1，桶数为2的幂 */
+    size_t bloom_mask;            /* 布隆过滤器位数减1，位数为2的幂 */
+    uint64_t *bloom;              /* 布隆过滤器 */
+    uint32_t *buckets;            /* 第b个桶的项为items[buckets[b]]到items[buckets[b + 1]]之前 */
+    watch_value_item_t items[];   /* 按桶排列的索引项 */
+} watch_value_index_t;
+
+/* 监视点链表头（只由持有watchpoint_mutex的写者访问） */
 static watchpoint_t *watchpoint_list = NULL;
 
+/*
+ * 当前发布的区间索引。通知路径在纪元临界区内无锁读取；
+ * 写者在watchpoint_mutex下复制修改后原子替换，旧索引和删除的监视点
+ * 在宽限期结束后释放。
+ */
+static _Atomic(watch_index_t *) current_index = NULL;
+
+/* 当前发布的值监视点索引，读者在读侧临界区内访问 */
+static _Atomic(watch_value_index_t *) current_value_index = NULL;
+
 /* 下一个可用的监视点ID */
 static monitor_id_t next_watchpoint_id = 1;
 
-/* 监视点链表的互斥锁 */
+/* 写者之间的互斥锁，通知路径不使用 */
 static pthread_mutex_t watchpoint_mutex;
 static pthread_mutexattr_t watchpoint_mutex_attr;
 
+/* 监视器是否已初始化 */
+static bool monitor_initialized = false;
+
+/* 模拟时间（纳秒） */
+static _Atomic uint64_t simulated_time_ns = 0;
+
+/* 访问日志项 */
+typedef struct {
+    memory_region_t *region;      /* 内存区域 */
+    uint64_t addr;                /* 地址 */
+    uint64_t value;               /* 值 */
+    uint64_t old_value;           /* 写入前的值 */
+    uint32_t size;                /* 大小（字节） */
+    uint8_t access_type;          /* 访问类型 */
+    bool has_old;                 /* 是否有写入前的值 */
+} deferred_entry_t;
+
+/* 每线程访问日志 */
+typedef struct deferred_log_struct {
+    spsc_ring_t ring;             /* 日志环形缓冲区 */
+    _Atomic bool in_use;          /* 是否已被某个线程占用 */
+    pthread_t owner;              /* 当前占用线程 */
+    _Atomic uint64_t logged;      /* 已记录数（只由所属线程更新） */
+    _Atomic uint64_t stalls;      /* 等待次数（只由所属线程更新） */
+    struct deferred_log_struct *next;  /* 下一个日志 */
+} deferred_log_t;
+
+/* 是否处于延迟模式 */
+static _Atomic bool deferred_enabled = false;
+
+/* 延迟模式编号，每次进入延迟模式时递增，用于使线程缓存的日志失效 */
+static _Atomic uint32_t deferred_generation = 0;
+
+/* 日志链表（延迟模式期间只增不减），新节点以原子方式插入表头 */
+static _Atomic(deferred_log_t *) deferred_log_list = NULL;
+
+/* 线程缓存的日志，以及线程是否正在处理日志 */
+static __thread deferred_log_t *tl_log = NULL;
+static __thread uint32_t tl_log_generation = 0;
+static __thread bool tl_draining = false;
+
+/* 处理一轮访问日志时收集的待执行动作 */
+typedef struct {
+    pending_action_t *items;      /* 待执行动作 */
+    size_t count;                 /* 数量 */
+    size_t capacity;              /* 容量 */
+    monitor_context_t *contexts;  /* 合批用的临时上下文数组，容量与items相同 */
+} pending_collect_t;
+
+/* 监视线程处理日志期间指向收集器，否则为NULL */
+static __thread pending_collect_t *tl_collect = NULL;
+
+/* 线程退出时归还日志 */
+static pthread_key_t deferred_thread_key;
+static pthread_once_t deferred_key_once = PTHREAD_ONCE_INIT;
+
+/* 保护模式切换的互斥锁 */
+static pthread_mutex_t deferred_mode_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* 保护日志分配和释放的互斥锁 */
+static pthread_mutex_t deferred_log_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* 日志的消费者互斥锁（递归锁，动作中可以再次处理日志） */
+static pthread_mutex_t deferred_drain_mutex;
+
+/* 监视线程 */
+static pthread_t deferred_thread;
+static deferred_entry_t *deferred_thread_batch = NULL;
+static _Atomic bool deferred_stop = false;
+static pthread_mutex_t deferred_wait_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t deferred_wait_cond = PTHREAD_COND_INITIALIZER;
+
+/* 当前延迟模式的配置和统计信息 */
+static monitor_deferred_config_t deferred_cfg;
+static _Atomic uint64_t deferred_dispatched = 0;
+static _Atomic uint64_t deferred_batches = 0;
+static _Atomic uint32_t deferred_thread_count = 0;
+
+/* 上一次延迟模式结束时的统计信息 */
+static monitor_deferred_stats_t deferred_last_stats;
+
 /**
  * @brief 初始化监视器
  * 
@@ -62,13 +269,97 @@ int monitor_init(void) {
         return PHYMUTI_ERROR_MUTEX_INIT_FAILED;
     }
     
+    ret = pthread_mutex_init(&deferred_drain_mutex, &watchpoint_mutex_attr);
+    if (ret != 0) {
+        pthread_mutex_destroy(&watchpoint_mutex);
+        pthread_mutexattr_destroy(&watchpoint_mutex_attr);
+        return PHYMUTI_ERROR_MUTEX_INIT_FAILED;
+    }
+    
     /* 初始化监视点链表 */
     watchpoint_list = NULL;
     next_watchpoint_id = 1;
+    atomic_store(&current_index, NULL);
+    atomic_store(&current_value_index, NULL);
+    monitor_initialized = true;
     
     return PHYMUTI_SUCCESS;
 }
 
+/**
+ * @brief 释放监视点（宽限期结束后调用）
+ * 
+ * @param ptr 监视点
+ */
+static void watchpoint_destroy(void *ptr) {
+    watchpoint_t *wp = (watchpoint_t *)ptr;
+    
+    pthread_mutex_destroy(&wp->coalesce_mutex);
+    free(atomic_load_explicit(&wp->config, memory_order_relaxed));
+    free(wp);
+}
+
+/**
+ * @brief 获取监视点的当前配置（调用者持有锁）
+ * 
+ * @param wp 监视点
+ * @return watchpoint_config_t* 当前配置
+ */
+static watchpoint_config_t* config_of(const watchpoint_t *wp) {
+    return atomic_load_explicit(&((watchpoint_t *)wp)->config, memory_order_relaxed);
+}
+
+/**
+ * @brief 复制监视点的当前配置，用于修改后重新发布（调用者持有锁）
+ * 
+ * @param wp 监视点
+ * @param action_count 新配置的动作数量，超出原配置的部分未初始化
+ * @return watchpoint_config_t* 成功返回新配置，失败返回NULL
+ */
+static watchpoint_config_t* config_copy(const watchpoint_t *wp, uint32_t action_count) {
+    const watchpoint_config_t *old = config_of(wp);
+    watchpoint_config_t *cfg = (watchpoint_config_t *)malloc(sizeof(watchpoint_config_t) +
+                                                             action_count * sizeof(uint32_t));
+    if (!cfg) {
+        return NULL;
+    }
+    
+    *cfg = *old;
+    memcpy(cfg->action_ids, old->action_ids,
+           (action_count < old->action_count ? action_count : old->action_count) * sizeof(uint32_t));
+    cfg->action_count = action_count;
+    
+    return cfg;
+}
+
+/**
+ * @brief 发布监视点的新配置，旧配置在宽限期结束后释放（调用者持有锁）
+ * 
+ * @param wp 监视点
+ * @param cfg 新配置
+ */
+static void config_publish(watchpoint_t *wp, watchpoint_config_t *cfg) {
+    epoch_retire(atomic_exchange(&wp->config, cfg), free);
+}
+
+/**
+ * @brief 发布新的区间索引，旧索引在宽限期结束后释放（调用者持有锁）
+ * 
+ * @param index 新索引，可以为NULL
+ */
+static void index_publish(watch_index_t *index) {
+    epoch_retire(atomic_exchange(&current_index, index), free);
+}
+
+/**
+ * @brief 发布新的值监视点索引，旧索引在宽限期结束后释放（调用者持有锁）
+ * 
+ * @param index 新索引，可以为NULL
+ */
+static void value_index_publish(watch_value_index_t *index) {
+    epoch_retire(atomic_exchange(&current_value_index, index), free);
+}
+
 /**
  * @brief 清理监视器资源
  * 
@@ -77,43 +368,51 @@ int monitor_init(void) {
 int monitor_cleanup(void) {
     int ret;
     
+    /* 停止延迟监视，处理完剩余的访问日志 */
+    monitor_set_deferred(NULL);
+    
     /* 清理所有监视点 */
     ret = pthread_mutex_lock(&watchpoint_mutex);
     if (ret != 0) {
         return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
     }
     
+    index_publish(NULL);
+    value_index_publish(NULL);
+    
     watchpoint_t *wp = watchpoint_list;
     watchpoint_t *next_wp;
     
     while (wp) {
         next_wp = wp->next;
-        
-        /* 释放动作ID数组 */
-        if (wp->action_ids) {
-            free(wp->action_ids);
-        }
-        
-        /* 释放监视点结构体 */
-        free(wp);
-        
+        epoch_retire(wp, watchpoint_destroy);
         wp = next_wp;
     }
     
     watchpoint_list = NULL;
     next_watchpoint_id = 1;
+    monitor_initialized = false;
     
     ret = pthread_mutex_unlock(&watchpoint_mutex);
     if (ret != 0) {
         return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
     }
     
+    /* 等待仍在通知路径中的线程离开后释放所有监视点 */
+    epoch_synchronize();
+    epoch_reclaim();
+    
     /* 销毁互斥锁 */
     ret = pthread_mutex_destroy(&watchpoint_mutex);
     if (ret != 0) {
         return PHYMUTI_ERROR_MUTEX_DESTROY_FAILED;
     }
     
+    ret = pthread_mutex_destroy(&deferred_drain_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_DESTROY_FAILED;
+    }
+    
     ret = pthread_mutexattr_destroy(&watchpoint_mutex_attr);
     if (ret != 0) {
         return PHYMUTI_ERROR_MUTEX_DESTROY_FAILED;
@@ -123,361 +422,2253 @@ int monitor_cleanup(void) {
 }
 
 /**
- * @brief 查找监视点（不会释放锁，调用者必须释放锁）
+ * @brief 比较索引项与(区域, 地址)的先后
  * 
- * @param id 监视点ID
- * @return watchpoint_t* 成功返回监视点指针，失败返回NULL
+ * @return int 索引项在前返回负数，相同返回0，在后返回正数
  */
-static watchpoint_t* find_watchpoint(monitor_id_t id) {
-    watchpoint_t *wp;
-    
-    /* 遍历监视点链表 */
-    wp = watchpoint_list;
-    while (wp) {
-        if (wp->id == id) {
-            return wp;
-        }
-        
-        wp = wp->next;
+static int interval_compare(const watch_interval_t *item, const memory_region_t *region, uint64_t addr) {
+    if (item->region != region) {
+        return (uintptr_t)item->region < (uintptr_t)region ? -1 : 1;
     }
-    
-    return NULL;
+    if (item->start != addr) {
+        return item->start < addr ? -1 : 1;
+    }
+    return 0;
 }
 
 /**
- * @brief 查找监视点（内部加锁版本）
+ * @brief 查找第一个不在(区域, 地址)之前的索引项
  * 
- * @param id 监视点ID
- * @return watchpoint_t* 成功返回监视点指针，失败返回NULL
+ * @param index 区间索引，可以为NULL
+ * @return size_t 索引项位置
  */
-static watchpoint_t* find_watchpoint_locked(monitor_id_t id) {
-    int ret;
-    
-    ret = pthread_mutex_lock(&watchpoint_mutex);
-    if (ret != 0) {
-        /* 锁获取失败，无法访问共享数据 */
-        return NULL;
-    }
+static size_t interval_lower_bound(const watch_index_t *index, const memory_region_t *region, uint64_t addr) {
+    size_t lo = 0, hi = index ? index->count : 0;
     
-    watchpoint_t *wp = find_watchpoint(id);
-    if (!wp) {
-        ret = pthread_mutex_unlock(&watchpoint_mutex);
-        if (ret != 0) {
-            /* 锁释放失败，但已经确定没有找到监视点 */
-            /* 在实际应用中可以考虑记录错误日志 */
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (interval_compare(&index->items[mid], region, addr) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
     
-    return wp;
+    return lo;
 }
 
 /**
- * @brief 添加监视点
+ * @brief 分配能容纳count项的区间索引
  * 
- * @param region 内存区域
- * @param addr 地址
- * @param size 大小
- * @param type 类型
- * @param wpvalue 要监视的值
- * @return monitor_id_t 成功返回监视点ID，失败返回0
+ * @param count 索引项数量
+ * @return watch_index_t* 成功返回索引，失败返回NULL
  */
-monitor_id_t monitor_add_watchpoint(memory_region_t *region, uint64_t addr, 
-                                   uint32_t size, watchpoint_type_t type, uint64_t wpvalue) {
-    watchpoint_t *wp;
-    monitor_id_t id;
-    int ret;
-    
-    /* 检查参数 */
-    if (!region || size == 0 || size > 8) {
-        return 0;
-    }
-    
-    /* 创建监视点 */
-    wp = (watchpoint_t *)malloc(sizeof(watchpoint_t));
-    if (!wp) {
-        return 0;
+static watch_index_t* index_alloc(size_t count) {
+    size_t soa = count + WATCH_SOA_PADDING;
+    watch_index_t *index = (watch_index_t *)malloc(sizeof(watch_index_t) +
+                                                   count * sizeof(watch_interval_t) +
+                                                   count * sizeof(watch_group_t) +
+                                                   soa * (2 * sizeof(int32_t) + sizeof(uint8_t)));
+    if (index) {
+        index->count = count;
+        index->group_count = 0;
+        index->groups = (watch_group_t *)&index->items[count];
+        index->start_off = (int32_t *)&index->groups[count];
+        index->end_off = index->start_off + soa;
+        index->access = (uint8_t *)(index->end_off + soa);
     }
-    
-    /* 初始化监视点 */
-    ret = pthread_mutex_lock(&watchpoint_mutex);
-    if (ret != 0) {
-        /* 锁获取失败，释放已分配的资源 */
-        free(wp);
+    return index;
+}
+
+/**
+ * @brief 监视点匹配的访问类型位
+ * 
+ * @param cfg 监视点配置
+ * @return uint8_t WATCH_ACCESS_*
+ */
+static uint8_t watch_access_bits(const watchpoint_config_t *cfg) {
+    if (!cfg->enabled) {
         return 0;
     }
     
-    id = next_watchpoint_id++;
-    wp->id = id;
-    wp->region = region;
-    wp->addr = addr;
-    wp->size = size;
-    wp->type = type;
-    wp->enabled = true;
-    wp->wpvalue = wpvalue;
-    wp->action_ids = NULL;
-    wp->action_count = 0;
-    wp->action_capacity = 0;
-    
-    /* 添加到监视点链表 */
-    wp->next = watchpoint_list;
-    watchpoint_list = wp;
-    
-    ret = pthread_mutex_unlock(&watchpoint_mutex);
-    if (ret != 0) {
-        /* 锁释放失败，但监视点已创建，
-           记录错误但返回创建的ID */
-        /* 在实际应用中可以考虑记录错误日志 */
+    switch (cfg->type) {
+        case WATCHPOINT_READ:
+            return WATCH_ACCESS_READ;
+        case WATCHPOINT_WRITE:
+        case WATCHPOINT_VALUE_WRITE:
+            return WATCH_ACCESS_WRITE;
+        case WATCHPOINT_ACCESS:
+            return WATCH_ACCESS_READ | WATCH_ACCESS_WRITE;
     }
     
-    return id;
+    return 0;
 }
 
 /**
- * @brief 删除监视点
+ * @brief 计算隐式区间树中各子树的最大结束地址
  * 
- * @param id 监视点ID
- * @return int 成功返回0，失败返回错误码
+ * @param items 索引项
+ * @param lo 子树第一项的位置
+ * @param hi 子树最后一项之后的位置
+ * @return uint64_t 子树中的最大结束地址，空子树返回0
  */
-int monitor_remove_watchpoint(monitor_id_t id) {
-    int ret;
-    
-    if (id == MONITOR_INVALID_ID) {
-        return PHYMUTI_ERROR_INVALID_PARAM;
+static uint64_t index_tree_build(watch_interval_t *items, size_t lo, size_t hi) {
+    if (lo >= hi) {
+        return 0;
     }
     
-    /* 查找监视点 */
-    ret = pthread_mutex_lock(&watchpoint_mutex);
-    if (ret != 0) {
-        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    size_t mid = lo + (hi - lo) / 2;
+    uint64_t max_end = items[mid].end;
+    uint64_t left = index_tree_build(items, lo, mid);
+    uint64_t right = index_tree_build(items, mid + 1, hi);
+    if (left > max_end) {
+        max_end = left;
+    }
+    if (right > max_end) {
+        max_end = right;
     }
+    items[mid].tree_max_end = max_end;
     
-    watchpoint_t *prev = NULL;
-    watchpoint_t *wp = watchpoint_list;
+    return max_end;
+}
+
+/**
+ * @brief 计算各项的最大结束地址、区间树、区域分组和结构数组（调用者持有锁）
+ * 
+ * @param index 尚未发布的区间索引，索引项已排好序
+ */
+static void index_finish(watch_index_t *index) {
+    size_t groups = 0;
     
-    while (wp) {
-        if (wp->id == id) {
-            /* 从链表中移除 */
-            if (prev) {
-                prev->next = wp->next;
-            } else {
-                watchpoint_list = wp->next;
-            }
-            
-            /* 释放动作ID数组 */
-            if (wp->action_ids) {
-                free(wp->action_ids);
-            }
-            
-            /* 释放监视点 */
-            free(wp);
-            
-            ret = pthread_mutex_unlock(&watchpoint_mutex);
-            if (ret != 0) {
-                return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    for (size_t i = 0; i < index->count; ) {
+        watch_group_t *group = &index->groups[groups++];
+        group->region = index->items[i].region;
+        group->first = i;
+        group->base = index->items[i].start;
+        
+        size_t j = i;
+        uint64_t max_end = 0;
+        for (; j < index->count && index->items[j].region == group->region; j++) {
+            if (index->items[j].end > max_end) {
+                max_end = index->items[j].end;
             }
-            
-            return PHYMUTI_SUCCESS;
+            index->items[j].max_end = max_end;
         }
+        group->count = j - i;
+        group->packed = max_end - group->base <= INT32_MAX;
+        index_tree_build(index->items, i, j);
         
-        prev = wp;
-        wp = wp->next;
+        for (size_t k = i; k < j; k++) {
+            const watch_interval_t *item = &index->items[k];
+            index->start_off[k] = group->packed ? (int32_t)(item->start - group->base) : INT32_MAX;
+            index->end_off[k] = group->packed ? (int32_t)(item->end - group->base) : INT32_MIN;
+            index->access[k] = watch_access_bits(config_of(item->wp));
+        }
+        i = j;
     }
+    index->group_count = groups;
     
-    ret = pthread_mutex_unlock(&watchpoint_mutex);
-    if (ret != 0) {
-        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    /* 填充项不与任何访问匹配 */
+    for (size_t k = index->count; k < index->count + WATCH_SOA_PADDING; k++) {
+        index->start_off[k] = INT32_MAX;
+        index->end_off[k] = INT32_MIN;
+        index->access[k] = 0;
     }
-    
-    return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
 }
 
 /**
- * @brief 启用监视点
+ * @brief 复制当前区间索引，用于监视点的启用状态改变后重新发布（调用者持有锁）
  * 
- * @param id 监视点ID
+ * @param index 返回复制的索引，当前没有索引时为NULL
  * @return int 成功返回0，失败返回错误码
  */
-int monitor_enable_watchpoint(monitor_id_t id) {
-    int ret;
+static int index_copy(watch_index_t **index) {
+    const watch_index_t *old = atomic_load_explicit(&current_index, memory_order_relaxed);
     
-    /* 查找监视点 */
-    watchpoint_t *wp = find_watchpoint_locked(id);
-    if (!wp) {
-        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    *index = NULL;
+    if (!old) {
+        return PHYMUTI_SUCCESS;
     }
     
-    wp->enabled = true;
-    
-    ret = pthread_mutex_unlock(&watchpoint_mutex);
-    if (ret != 0) {
-        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    *index = index_alloc(old->count);
+    if (!*index) {
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
     }
+    memcpy((*index)->items, old->items, old->count * sizeof(watch_interval_t));
     
     return PHYMUTI_SUCCESS;
 }
 
 /**
- * @brief 禁用监视点
+ * @brief 查找区域在区间索引中的分组
  * 
- * @param id 监视点ID
- * @return int 成功返回0，失败返回错误码
+ * @param index 区间索引，可以为NULL
+ * @param region 内存区域
+ * @return const watch_group_t* 成功返回分组，区域上没有监视点时返回NULL
  */
-int monitor_disable_watchpoint(monitor_id_t id) {
-    int ret;
+static const watch_group_t* index_find_group(const watch_index_t *index, const memory_region_t *region) {
+    size_t lo = 0, hi = index ? index->group_count : 0;
     
-    /* 查找监视点 */
-    watchpoint_t *wp = find_watchpoint_locked(id);
-    if (!wp) {
-        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const watch_group_t *group = &index->groups[mid];
+        if (group->region == region) {
+            return group;
+        }
+        if ((uintptr_t)group->region < (uintptr_t)region) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
     }
     
-    wp->enabled = false;
-    
-    ret = pthread_mutex_unlock(&watchpoint_mutex);
-    if (ret != 0) {
+    return NULL;
+}
+
+/**
+ * @brief 发布加入了监视点的区间索引（调用者持有锁）
+ * 
+ * @param wp 监视点
+ * @return int 成功返回0，失败返回错误码
+ */
+static int interval_insert(watchpoint_t *wp) {
+    const watch_index_t *old = atomic_load_explicit(&current_index, memory_order_relaxed);
+    size_t count = old ? old->count : 0;
+    watch_index_t *index = index_alloc(count + 1);
+    if (!index) {
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    size_t pos = interval_lower_bound(old, wp->region, wp->addr);
+    if (old) {
+        memcpy(&index->items[0], &old->items[0], pos * sizeof(watch_interval_t));
+        memcpy(&index->items[pos + 1], &old->items[pos], (count - pos) * sizeof(watch_interval_t));
+    }
+    index->items[pos].region = wp->region;
+    index->items[pos].start = wp->addr;
+    index->items[pos].end = wp->addr + wp->size;
+    index->items[pos].wp = wp;
+    
+    index_finish(index);
+    index_publish(index);
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 发布去掉了指定项的区间索引（调用者持有锁）
+ * 
+ * @param region 内存区域
+ * @param wp 要去掉的监视点，为NULL时去掉该区域的所有项
+ * @return int 成功返回0，失败返回错误码
+ */
+static int interval_remove(memory_region_t *region, watchpoint_t *wp) {
+    const watch_index_t *old = atomic_load_explicit(&current_index, memory_order_relaxed);
+    if (!old) {
+        return PHYMUTI_SUCCESS;
+    }
+    
+    watch_index_t *index = index_alloc(old->count);
+    if (!index) {
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    size_t first = interval_lower_bound(old, region, wp ? wp->addr : 0);
+    size_t count = first;
+    memcpy(&index->items[0], &old->items[0], first * sizeof(watch_interval_t));
+    for (size_t i = first; i < old->count; i++) {
+        const watch_interval_t *item = &old->items[i];
+        if (item->region == region && (!wp || item->wp == wp)) {
+            continue;
+        }
+        index->items[count++] = *item;
+    }
+    index->count = count;
+    
+    index_finish(index);
+    index_publish(count > 0 ? index : NULL);
+    if (count == 0) {
+        free(index);
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 计算(区域, 值)的散列
+ * 
+ * @param region 内存区域
+ * @param value 值
+ * @return uint64_t 散列值
+ */
+static inline uint64_t value_hash(const memory_region_t *region, uint64_t value) {
+    uint64_t h = value ^ ((uint64_t)(uintptr_t)region * 0x9E3779B97F4A7C15ull);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+/* 散列在布隆过滤器中的两个位和所在的桶 */
+#define VALUE_BLOOM_BIT1(index, h) ((h) & (index)->bloom_mask)
+#define VALUE_BLOOM_BIT2(index, h) (((h) >> 24) & (index)->bloom_mask)
+#define VALUE_BUCKET(index, h)     (((h) >> 48) & (index)->bucket_mask)
+
+/**
+ * @brief 不小于n的2的幂
+ */
+static size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+/**
+ * @brief 判断值监视点索引项是否保留
+ * 
+ * @param item 索引项
+ * @param region 要去掉的区域，为NULL时全部保留
+ * @param wp 要去掉的监视点，为NULL时去掉该区域的所有项
+ * @return bool 保留返回true
+ */
+static bool value_item_kept(const watch_value_item_t *item, const memory_region_t *region,
+                            const watchpoint_t *wp) {
+    return !region || item->region != region || (wp && item->wp != wp);
+}
+
+/**
+ * @brief 重建并发布值监视点索引（调用者持有锁）
+ * 
+ * 新索引包含当前索引中保留的项，以及extra（如果有）。
+ * 
+ * @param extra 要加入的索引项，可以为NULL
+ * @param region 要去掉的区域，为NULL时不去掉
+ * @param wp 要去掉的监视点，为NULL时去掉该区域的所有项
+ * @return int 成功返回0，失败返回错误码
+ */
+static int value_index_rebuild(const watch_value_item_t *extra, const memory_region_t *region,
+                               const watchpoint_t *wp) {
+    const watch_value_index_t *old = atomic_load_explicit(&current_value_index, memory_order_relaxed);
+    size_t old_count = old ? old->count : 0;
+    size_t count = extra ? 1 : 0;
+    
+    for (size_t i = 0; i < old_count; i++) {
+        if (value_item_kept(&old->items[i], region, wp)) {
+            count++;
+        }
+    }
+    if (count == 0) {
+        value_index_publish(NULL);
+        return PHYMUTI_SUCCESS;
+    }
+    
+    size_t bucket_count = round_up_pow2(count);
+    size_t bloom_bits = round_up_pow2(count * WATCH_BLOOM_BITS_PER_ITEM < 64 ? 64 :
+                                      count * WATCH_BLOOM_BITS_PER_ITEM);
+    watch_value_index_t *index = (watch_value_index_t *)calloc(1, sizeof(watch_value_index_t) +
+                                                               count * sizeof(watch_value_item_t) +
+                                                               bloom_bits / 8 +
+                                                               (bucket_count + 1) * sizeof(uint32_t));
+    watch_value_item_t *items = (watch_value_item_t *)malloc(count * sizeof(watch_value_item_t));
+    if (!index || !items) {
+        free(index);
+        free(items);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    index->count = count;
+    index->bucket_mask = bucket_count - 1;
+    index->bloom_mask = bloom_bits - 1;
+    index->bloom = (uint64_t *)&index->items[count];
+    index->buckets = (uint32_t *)&index->bloom[bloom_bits / 64];
+    
+    /* 收集保留的项，按桶计数 */
+    size_t n = 0;
+    for (size_t i = 0; i < old_count; i++) {
+        if (value_item_kept(&old->items[i], region, wp)) {
+            items[n++] = old->items[i];
+        }
+    }
+    if (extra) {
+        items[n++] = *extra;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint64_t h = value_hash(items[i].region, items[i].value);
+        uint64_t bit1 = VALUE_BLOOM_BIT1(index, h);
+        uint64_t bit2 = VALUE_BLOOM_BIT2(index, h);
+        index->bloom[bit1 / 64] |= 1ull << (bit1 % 64);
+        index->bloom[bit2 / 64] |= 1ull << (bit2 % 64);
+        index->buckets[VALUE_BUCKET(index, h)]++;
+    }
+    
+    /* 计数累加为各桶的结束位置，再从后向前放入索引项，完成后即为起始位置 */
+    for (size_t b = 1; b < bucket_count; b++) {
+        index->buckets[b] += index->buckets[b - 1];
+    }
+    index->buckets[bucket_count] = (uint32_t)count;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t h = value_hash(items[i].region, items[i].value);
+        index->items[--index->buckets[VALUE_BUCKET(index, h)]] = items[i];
+    }
+    free(items);
+    
+    value_index_publish(index);
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 判断监视点是否需要写入前的值
+ * 
+ * @param cfg 监视点配置
+ * @return bool 需要返回true
+ */
+static bool wants_old_value(const watchpoint_config_t *cfg) {
+    if (cfg->type == WATCHPOINT_READ) {
+        return false;
+    }
+    
+    return cfg->capture_old ||
+           cfg->predicate.kind == WATCHPOINT_PRED_BITS_SET ||
+           cfg->predicate.kind == WATCHPOINT_PRED_BITS_CLEARED ||
+           cfg->predicate.kind == WATCHPOINT_PRED_CHANGED;
+}
+
+/**
+ * @brief 根据区间索引和值监视点索引重新计算区域的监视状态（调用者持有锁）
+ * 
+ * @param region 内存区域，为NULL时忽略
+ */
+static void update_region_watch_flags(memory_region_t *region) {
+    uint32_t flags = 0;
+    
+    if (!region) {
+        return;
+    }
+    
+    const watch_index_t *index = atomic_load_explicit(&current_index, memory_order_relaxed);
+    for (size_t pos = interval_lower_bound(index, region, 0);
+         pos < (index ? index->count : 0) && index->items[pos].region == region; pos++) {
+        const watchpoint_config_t *cfg = config_of(index->items[pos].wp);
+        if (!cfg->enabled) {
+            continue;
+        }
+        flags |= MEMORY_WATCH_ACTIVE;
+        if (wants_old_value(cfg)) {
+            flags |= MEMORY_WATCH_OLD_VALUE;
+        }
+    }
+    
+    const watch_value_index_t *values = atomic_load_explicit(&current_value_index, memory_order_relaxed);
+    for (size_t i = 0; i < (values ? values->count : 0); i++) {
+        if (values->items[i].region != region) {
+            continue;
+        }
+        const watchpoint_config_t *cfg = config_of(values->items[i].wp);
+        if (!cfg->enabled) {
+            continue;
+        }
+        flags |= MEMORY_WATCH_ACTIVE;
+        if (wants_old_value(cfg)) {
+            flags |= MEMORY_WATCH_OLD_VALUE;
+        }
+    }
+    
+    memory_region_set_watch_flags(region, flags);
+}
+
+/**
+ * @brief 获取单调时钟时间（纳秒）
+ */
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 读取合并窗口使用的时钟
+ * 
+ * @param clock 时钟
+ * @return uint64_t 时间（纳秒）
+ */
+static uint64_t clock_now(monitor_clock_t clock) {
+    if (clock == MONITOR_CLOCK_SIMULATED) {
+        return atomic_load_explicit(&simulated_time_ns, memory_order_relaxed);
+    }
+    return monotonic_ns();
+}
+
+/**
+ * @brief 把监视点绑定的动作加入待执行列表
+ * 
+ * @param list 待执行列表
+ * @param count 列表中已有的数量
+ * @param capacity 列表容量
+ * @param wp 监视点
+ * @param cfg 监视点配置
+ * @param context 上下文
+ * @return int 加入后的数量
+ */
+static int queue_actions(pending_action_t *list, int count, int capacity,
+                         watchpoint_t *wp, const watchpoint_config_t *cfg,
+                         const monitor_context_t *context) {
+    for (uint32_t i = 0; i < cfg->action_count && count < capacity; i++) {
+        list[count].action_id = cfg->action_ids[i];
+        list[count].priority = PENDING_PRIORITY_UNKNOWN;
+        list[count].context = *context;
+        count++;
+    }
+    atomic_fetch_add_explicit(&wp->fired, 1, memory_order_relaxed);
+    return count;
+}
+
+/**
+ * @brief 按动作执行收集到的动作，同一动作的上下文合成一批
+ * 
+ * 先执行优先级高的动作，同一优先级按动作第一次出现的顺序执行，
+ * 同一动作的上下文保持触发顺序，批量回调动作每批只调用一次。
+ * 执行后列表中的动作ID被清除。
+ * 
+ * @param list 待执行动作列表
+ * @param count 列表中的数量
+ * @param contexts 至少能容纳count个上下文的临时数组
+ */
+static void execute_pending(pending_action_t *list, size_t count, monitor_context_t *contexts) {
+    /* 只有一个动作时（同步分发的常见情况）不需要查询优先级 */
+    bool single = true;
+    for (size_t i = 1; i < count && single; i++) {
+        single = list[i].action_id == list[0].action_id;
+    }
+    
+    /* 每个动作只在第一次出现时查询一次优先级，同一动作的其他项复用结果 */
+    if (!single) {
+        for (size_t i = 0; i < count; i++) {
+            action_id_t action_id = list[i].action_id;
+            if (action_id == ACTION_INVALID_ID || list[i].priority != PENDING_PRIORITY_UNKNOWN) {
+                continue;
+            }
+            
+            action_priority_t p;
+            int priority = action_get_priority(action_id, &p) == PHYMUTI_SUCCESS ? (int)p : ACTION_PRIORITY_LOW;
+            for (size_t j = i; j < count; j++) {
+                if (list[j].action_id == action_id) {
+                    list[j].priority = priority;
+                }
+            }
+        }
+    }
+    
+    for (int priority = ACTION_PRIORITY_HIGH; priority >= ACTION_PRIORITY_LOW; priority--) {
+        for (size_t i = 0; i < count; i++) {
+            action_id_t action_id = list[i].action_id;
+            if (action_id == ACTION_INVALID_ID || (!single && list[i].priority != priority)) {
+                continue;
+            }
+            
+            size_t n = 0;
+            for (size_t j = i; j < count; j++) {
+                if (list[j].action_id == action_id) {
+                    contexts[n++] = list[j].context;
+                    list[j].action_id = ACTION_INVALID_ID;
+                }
+            }
+            action_execute_batch(action_id, contexts, n);
+        }
+    }
+}
+
+/**
+ * @brief 把一次分发匹配到的动作加入收集器
+ * 
+ * @param collect 收集器
+ * @param list 待执行动作
+ * @param count 数量
+ * @return bool 成功返回true，内存不足时返回false，由调用者直接执行
+ */
+static bool collect_append(pending_collect_t *collect, const pending_action_t *list, int count) {
+    if (collect->count + (size_t)count > collect->capacity) {
+        size_t capacity = collect->capacity ? collect->capacity * 2 : 256;
+        while (capacity < collect->count + (size_t)count) {
+            capacity *= 2;
+        }
+        pending_action_t *items = (pending_action_t *)realloc(collect->items, capacity * sizeof(pending_action_t));
+        if (!items) {
+            return false;
+        }
+        collect->items = items;
+        monitor_context_t *contexts = (monitor_context_t *)realloc(collect->contexts,
+                                                                   capacity * sizeof(monitor_context_t));
+        if (!contexts) {
+            return false;
+        }
+        collect->contexts = contexts;
+        collect->capacity = capacity;
+    }
+    
+    memcpy(&collect->items[collect->count], list, (size_t)count * sizeof(pending_action_t));
+    collect->count += (size_t)count;
+    return true;
+}
+
+/**
+ * @brief 按合并方式处理一次触发（调用者持有监视点的合并锁）
+ * 
+ * 后沿合并时，窗口已结束的待执行触发通过expired返回，由调用者先于本次触发执行。
+ * 
+ * @param wp 监视点
+ * @param c 合并设置
+ * @param context 本次触发的上下文
+ * @param expired 返回窗口已结束的待执行触发的上下文
+ * @param has_expired 返回是否有窗口已结束的待执行触发
+ * @return coalesce_result_t 本次触发是否立即执行
+ */
+static coalesce_result_t coalesce_trigger(watchpoint_t *wp, const watchpoint_coalesce_t *c,
+                                          const monitor_context_t *context,
+                                          monitor_context_t *expired, bool *has_expired) {
+    *has_expired = false;
+    
+    if (c->mode == WATCHPOINT_COALESCE_NONE) {
+        return COALESCE_DISPATCH;
+    }
+    
+    uint64_t now = clock_now(c->clock);
+    bool window_over = now >= wp->coalesce_end;
+    
+    /* 上一个窗口结束了，先交出其中合并的后沿触发 */
+    if (window_over && wp->coalesce_pending) {
+        *expired = wp->coalesce_context;
+        *has_expired = true;
+        wp->coalesce_pending = false;
+    }
+    
+    switch (c->mode) {
+        case WATCHPOINT_COALESCE_LEADING:
+            if (window_over) {
+                wp->coalesce_end = now + c->window_ns;
+                return COALESCE_DISPATCH;
+            }
+            return COALESCE_DROP;
+            
+        case WATCHPOINT_COALESCE_TRAILING:
+            if (window_over) {
+                wp->coalesce_end = now + c->window_ns;
+            }
+            wp->coalesce_context = *context;
+            wp->coalesce_pending = true;
+            return COALESCE_DROP;
+            
+        case WATCHPOINT_COALESCE_BOTH:
+            if (window_over) {
+                wp->coalesce_end = now + c->window_ns;
+                return COALESCE_DISPATCH;
+            }
+            wp->coalesce_context = *context;
+            wp->coalesce_pending = true;
+            return COALESCE_DROP;
+            
+        case WATCHPOINT_COALESCE_MAX_RATE:
+            if (window_over) {
+                wp->coalesce_end = now + c->window_ns;
+                wp->coalesce_events = 0;
+            }
+            if (wp->coalesce_events < c->max_events) {
+                wp->coalesce_events++;
+                return COALESCE_DISPATCH;
+            }
+            return COALESCE_DROP;
+            
+        default:
+            return COALESCE_DISPATCH;
+    }
+}
+
+/**
+ * @brief 记录一次命中并判断是否执行动作
+ * 
+ * @param wp 监视点
+ * @param trigger 触发设置
+ * @return bool 需要执行动作返回true
+ */
+static bool count_hit(watchpoint_t *wp, const watchpoint_trigger_t *trigger) {
+    bool fire = true;
+    
+    atomic_fetch_add_explicit(&wp->hits, 1, memory_order_relaxed);
+    
+    switch (trigger->mode) {
+        case WATCHPOINT_TRIGGER_ALWAYS:
+            break;
+            
+        case WATCHPOINT_TRIGGER_EVERY_NTH: {
+            uint64_t n = atomic_fetch_add_explicit(&wp->trigger_hits, 1, memory_order_relaxed) + 1;
+            fire = (n % trigger->count) == 0;
+            break;
+        }
+            
+        case WATCHPOINT_TRIGGER_THRESHOLD: {
+            /* 固定时间窗口，窗口内第count次命中时执行一次 */
+            uint64_t now = monotonic_ns();
+            uint64_t start = atomic_load_explicit(&wp->window_start, memory_order_relaxed);
+            if (now - start >= trigger->window_ns &&
+                atomic_compare_exchange_strong_explicit(&wp->window_start, &start, now,
+                                                        memory_order_relaxed, memory_order_relaxed)) {
+                atomic_store_explicit(&wp->window_hits, 0, memory_order_relaxed);
+            }
+            uint64_t n = atomic_fetch_add_explicit(&wp->window_hits, 1, memory_order_relaxed) + 1;
+            fire = (n == trigger->count);
+            break;
+        }
+    }
+    
+    return fire;
+}
+
+/**
+ * @brief 求值监视点的值谓词
+ * 
+ * @param pred 谓词
+ * @param size 访问大小（字节）
+ * @param value 访问的值
+ * @param old_value 写入前的值
+ * @param has_old 是否有写入前的值
+ * @return bool 满足返回true
+ */
+static bool eval_predicate(const watchpoint_predicate_t *pred, uint32_t size,
+                           uint64_t value, uint64_t old_value, bool has_old) {
+    if (pred->kind == WATCHPOINT_PRED_NONE) {
+        return true;
+    }
+    if (size != 1 && size != 2 && size != 4 && size != 8) {
+        return false;
+    }
+    
+    unsigned bits = size * 8;
+    uint64_t width_mask = bits == 64 ? ~0ULL : (1ULL << bits) - 1;
+    uint64_t mask = pred->mask ? pred->mask & width_mask : width_mask;
+    bool result = false;
+    
+    switch (pred->kind) {
+        case WATCHPOINT_PRED_MASK_EQ:
+            result = (value & mask) == (pred->operand & mask);
+            break;
+            
+        case WATCHPOINT_PRED_RANGE_U:
+            result = value >= pred->lo.u && value <= pred->hi.u;
+            break;
+            
+        case WATCHPOINT_PRED_RANGE_S: {
+            int64_t sv = (int64_t)(value << (64 - bits)) >> (64 - bits);
+            result = sv >= pred->lo.s && sv <= pred->hi.s;
+            break;
+        }
+            
+        case WATCHPOINT_PRED_RANGE_F: {
+            double fv;
+            if (size == 4) {
+                uint32_t raw = (uint32_t)value;
+                float f;
+                memcpy(&f, &raw, sizeof(f));
+                fv = f;
+            } else if (size == 8) {
+                memcpy(&fv, &value, sizeof(fv));
+            } else {
+                return false;
+            }
+            /* NaN不在任何范围内 */
+            result = fv >= pred->lo.f && fv <= pred->hi.f;
+            break;
+        }
+            
+        case WATCHPOINT_PRED_BITS_SET:
+        case WATCHPOINT_PRED_BITS_CLEARED:
+        case WATCHPOINT_PRED_CHANGED:
+            if (!has_old) {
+                return false;
+            }
+            if (pred->kind == WATCHPOINT_PRED_BITS_SET) {
+                result = (~old_value & value & mask) != 0;
+            } else if (pred->kind == WATCHPOINT_PRED_BITS_CLEARED) {
+                result = (old_value & ~value & mask) != 0;
+            } else {
+                result = ((old_value ^ value) & mask) != 0;
+            }
+            break;
+            
+        default:
+            return false;
+    }
+    
+    return pred->negate ? !result : result;
+}
+
+/**
+ * @brief 查找监视点（不会释放锁，调用者必须释放锁）
+ * 
+ * @param id 监视点ID
+ * @return watchpoint_t* 成功返回监视点指针，失败返回NULL
+ */
+static watchpoint_t* find_watchpoint(monitor_id_t id) {
+    watchpoint_t *wp;
+    
+    /* 遍历监视点链表 */
+    wp = watchpoint_list;
+    while (wp) {
+        if (wp->id == id) {
+            return wp;
+        }
+        
+        wp = wp->next;
+    }
+    
+    return NULL;
+}
+
+/**
+ * @brief 查找监视点（内部加锁版本）
+ * 
+ * @param id 监视点ID
+ * @return watchpoint_t* 成功返回监视点指针，失败返回NULL
+ */
+static watchpoint_t* find_watchpoint_locked(monitor_id_t id) {
+    int ret;
+    
+    ret = pthread_mutex_lock(&watchpoint_mutex);
+    if (ret != 0) {
+        /* 锁获取失败，无法访问共享数据 */
+        return NULL;
+    }
+    
+    watchpoint_t *wp = find_watchpoint(id);
+    if (!wp) {
+        ret = pthread_mutex_unlock(&watchpoint_mutex);
+        if (ret != 0) {
+            /* 锁释放失败，但已经确定没有找到监视点 */
+            /* 在实际应用中可以考虑记录错误日志 */
+        }
+    }
+    
+    return wp;
+}
+
+/**
+ * @brief 添加监视点
+ * 
+ * @param region 内存区域
+ * @param addr 地址
+ * @param size 大小
+ * @param type 类型
+ * @param wpvalue 要监视的值
+ * @return monitor_id_t 成功返回监视点ID，失败返回0
+ */
+monitor_id_t monitor_add_watchpoint(memory_region_t *region, uint64_t addr, 
+                                   uint32_t size, watchpoint_type_t type, uint64_t wpvalue) {
+    watchpoint_t *wp;
+    watchpoint_config_t *cfg;
+    monitor_id_t id;
+    int ret;
+    
+    /* 检查参数：监视范围可以是任意长度，但不能越过地址空间末尾 */
+    if (!region || size == 0 || addr + size < addr) {
+        return 0;
+    }
+    
+    /* 创建监视点 */
+    wp = (watchpoint_t *)malloc(sizeof(watchpoint_t));
+    cfg = (watchpoint_config_t *)calloc(1, sizeof(watchpoint_config_t));
+    if (!wp || !cfg || pthread_mutex_init(&wp->coalesce_mutex, NULL) != 0) {
+        free(wp);
+        free(cfg);
+        return 0;
+    }
+    
+    cfg->type = type;
+    cfg->enabled = true;
+    cfg->wpvalue = wpvalue;
+    
+    /* 初始化监视点 */
+    ret = pthread_mutex_lock(&watchpoint_mutex);
+    if (ret != 0) {
+        /* 锁获取失败，释放已分配的资源 */
+        pthread_mutex_destroy(&wp->coalesce_mutex);
+        free(wp);
+        free(cfg);
+        return 0;
+    }
+    
+    id = next_watchpoint_id++;
+    wp->id = id;
+    wp->region = region;
+    wp->addr = addr;
+    wp->size = size;
+    atomic_init(&wp->config, cfg);
+    atomic_init(&wp->hits, 0);
+    atomic_init(&wp->fired, 0);
+    atomic_init(&wp->trigger_hits, 0);
+    atomic_init(&wp->window_start, 0);
+    atomic_init(&wp->window_hits, 0);
+    wp->coalesce_end = 0;
+    wp->coalesce_events = 0;
+    wp->coalesce_pending = false;
+    
+    /* 发布包含新监视点的索引，之后的访问即可匹配到它；值监视点按值索引 */
+    if (type == WATCHPOINT_VALUE_WRITE) {
+        watch_value_item_t item = { region, wpvalue, addr, addr + size, wp };
+        ret = value_index_rebuild(&item, NULL, NULL);
+    } else {
+        ret = interval_insert(wp);
+    }
+    if (ret != PHYMUTI_SUCCESS) {
+        next_watchpoint_id--;
+        pthread_mutex_unlock(&watchpoint_mutex);
+        watchpoint_destroy(wp);
+        return 0;
+    }
+    
+    /* 添加到监视点链表 */
+    wp->next = watchpoint_list;
+    watchpoint_list = wp;
+    update_region_watch_flags(region);
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
+        /* 锁释放失败，但监视点已创建，
+           记录错误但返回创建的ID */
+        /* 在实际应用中可以考虑记录错误日志 */
+    }
+    
+    return id;
+}
+
+/**
+ * @brief 设置监视点的值谓词
+ * 
+ * @param id 监视点ID
+ * @param predicate 谓词，为NULL时清除
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_set_predicate(monitor_id_t id, const watchpoint_predicate_t *predicate) {
+    int ret;
+    
+    if (predicate && ((int)predicate->kind < WATCHPOINT_PRED_NONE ||
+                      predicate->kind > WATCHPOINT_PRED_CHANGED)) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 查找监视点 */
+    watchpoint_t *wp = find_watchpoint_locked(id);
+    if (!wp) {
+        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    }
+    
+    watchpoint_config_t *cfg = config_copy(wp, config_of(wp)->action_count);
+    if (!cfg) {
+        pthread_mutex_unlock(&watchpoint_mutex);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    if (predicate) {
+        cfg->predicate = *predicate;
+    } else {
+        memset(&cfg->predicate, 0, sizeof(cfg->predicate));
+    }
+    config_publish(wp, cfg);
+    update_region_watch_flags(wp->region);
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 设置监视点的触发方式
+ * 
+ * @param id 监视点ID
+ * @param trigger 触发设置，为NULL时恢复为每次命中都执行
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_set_trigger(monitor_id_t id, const watchpoint_trigger_t *trigger) {
+    int ret;
+    
+    if (trigger) {
+        if (trigger->mode != WATCHPOINT_TRIGGER_ALWAYS &&
+            trigger->mode != WATCHPOINT_TRIGGER_EVERY_NTH &&
+            trigger->mode != WATCHPOINT_TRIGGER_THRESHOLD) {
+            return PHYMUTI_ERROR_INVALID_PARAM;
+        }
+        if (trigger->mode != WATCHPOINT_TRIGGER_ALWAYS && trigger->count == 0) {
+            return PHYMUTI_ERROR_INVALID_PARAM;
+        }
+        if (trigger->mode == WATCHPOINT_TRIGGER_THRESHOLD && trigger->window_ns == 0) {
+            return PHYMUTI_ERROR_INVALID_PARAM;
+        }
+    }
+    
+    /* 查找监视点 */
+    watchpoint_t *wp = find_watchpoint_locked(id);
+    if (!wp) {
+        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    }
+    
+    watchpoint_config_t *cfg = config_copy(wp, config_of(wp)->action_count);
+    if (!cfg) {
+        pthread_mutex_unlock(&watchpoint_mutex);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    if (trigger) {
+        cfg->trigger = *trigger;
+    } else {
+        memset(&cfg->trigger, 0, sizeof(cfg->trigger));
+    }
+    config_publish(wp, cfg);
+    atomic_store_explicit(&wp->trigger_hits, 0, memory_order_relaxed);
+    atomic_store_explicit(&wp->window_start, monotonic_ns(), memory_order_relaxed);
+    atomic_store_explicit(&wp->window_hits, 0, memory_order_relaxed);
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 设置监视点的触发合并方式
+ * 
+ * @param id 监视点ID
+ * @param coalesce 合并设置，为NULL时不合并
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_set_coalesce(monitor_id_t id, const watchpoint_coalesce_t *coalesce) {
+    int ret;
+    
+    if (coalesce) {
+        if ((int)coalesce->mode < WATCHPOINT_COALESCE_NONE || coalesce->mode > WATCHPOINT_COALESCE_MAX_RATE ||
+            (coalesce->clock != MONITOR_CLOCK_REAL && coalesce->clock != MONITOR_CLOCK_SIMULATED)) {
+            return PHYMUTI_ERROR_INVALID_PARAM;
+        }
+        if (coalesce->mode != WATCHPOINT_COALESCE_NONE && coalesce->window_ns == 0) {
+            return PHYMUTI_ERROR_INVALID_PARAM;
+        }
+        if (coalesce->mode == WATCHPOINT_COALESCE_MAX_RATE && coalesce->max_events == 0) {
+            return PHYMUTI_ERROR_INVALID_PARAM;
+        }
+    }
+    
+    /* 查找监视点 */
+    watchpoint_t *wp = find_watchpoint_locked(id);
+    if (!wp) {
+        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    }
+    
+    watchpoint_config_t *cfg = config_copy(wp, config_of(wp)->action_count);
+    if (!cfg) {
+        pthread_mutex_unlock(&watchpoint_mutex);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    if (coalesce) {
+        cfg->coalesce = *coalesce;
+    } else {
+        memset(&cfg->coalesce, 0, sizeof(cfg->coalesce));
+    }
+    config_publish(wp, cfg);
+    
+    pthread_mutex_lock(&wp->coalesce_mutex);
+    wp->coalesce_end = 0;
+    wp->coalesce_events = 0;
+    wp->coalesce_pending = false;
+    pthread_mutex_unlock(&wp->coalesce_mutex);
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 执行窗口已结束的后沿合并触发
+ * 
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_flush_coalesced(void) {
+    pending_action_t *actions = NULL;
+    int count = 0, capacity = 0;
+    int ret;
+    
+    ret = pthread_mutex_lock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    for (watchpoint_t *wp = watchpoint_list; wp; wp = wp->next) {
+        const watchpoint_config_t *cfg = config_of(wp);
+        
+        pthread_mutex_lock(&wp->coalesce_mutex);
+        if (!wp->coalesce_pending || clock_now(cfg->coalesce.clock) < wp->coalesce_end) {
+            pthread_mutex_unlock(&wp->coalesce_mutex);
+            continue;
+        }
+        
+        if (count + (int)cfg->action_count > capacity) {
+            int new_capacity = capacity ? capacity * 2 : 32;
+            while (new_capacity < count + (int)cfg->action_count) {
+                new_capacity *= 2;
+            }
+            pending_action_t *grown = (pending_action_t *)realloc(actions, new_capacity * sizeof(pending_action_t));
+            if (!grown) {
+                pthread_mutex_unlock(&wp->coalesce_mutex);
+                ret = PHYMUTI_ERROR_OUT_OF_MEMORY;
+                break;
+            }
+            actions = grown;
+            capacity = new_capacity;
+        }
+        
+        count = queue_actions(actions, count, capacity, wp, cfg, &wp->coalesce_context);
+        wp->coalesce_pending = false;
+        pthread_mutex_unlock(&wp->coalesce_mutex);
+    }
+    
+    pthread_mutex_unlock(&watchpoint_mutex);
+    
+    /* 在锁外执行动作 */
+    if (count > 0) {
+        monitor_context_t *contexts = (monitor_context_t *)malloc(count * sizeof(monitor_context_t));
+        if (contexts) {
+            execute_pending(actions, count, contexts);
+        } else {
+            for (int i = 0; i < count; i++) {
+                action_execute(actions[i].action_id, &actions[i].context);
+            }
+        }
+        free(contexts);
+    }
+    free(actions);
+    
+    return ret == 0 ? PHYMUTI_SUCCESS : ret;
+}
+
+/**
+ * @brief 设置模拟时间
+ * 
+ * @param time_ns 模拟时间（纳秒）
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_set_simulated_time(uint64_t time_ns) {
+    atomic_store_explicit(&simulated_time_ns, time_ns, memory_order_relaxed);
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 获取模拟时间
+ * 
+ * @return uint64_t 模拟时间（纳秒）
+ */
+uint64_t monitor_get_simulated_time(void) {
+    return atomic_load_explicit(&simulated_time_ns, memory_order_relaxed);
+}
+
+/**
+ * @brief 一次读取所有监视点的计数器
+ * 
+ * @param counters 输出数组，可以为NULL
+ * @param capacity 数组容量
+ * @param count 返回监视点总数
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_get_counters(monitor_counter_t *counters, size_t capacity, size_t *count) {
+    int ret;
+    size_t total = 0;
+    
+    if (!count || (!counters && capacity > 0)) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    ret = pthread_mutex_lock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    for (watchpoint_t *wp = watchpoint_list; wp; wp = wp->next) {
+        if (total < capacity) {
+            counters[total].id = wp->id;
+            counters[total].hits = atomic_load_explicit(&wp->hits, memory_order_relaxed);
+            counters[total].fired = atomic_load_explicit(&wp->fired, memory_order_relaxed);
+        }
+        total++;
+    }
+    *count = total;
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 把所有监视点的计数器清零
+ * 
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_reset_counters(void) {
+    int ret;
+    
+    ret = pthread_mutex_lock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    for (watchpoint_t *wp = watchpoint_list; wp; wp = wp->next) {
+        atomic_store_explicit(&wp->hits, 0, memory_order_relaxed);
+        atomic_store_explicit(&wp->fired, 0, memory_order_relaxed);
+    }
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 设置是否为监视点捕获写入前的值
+ * 
+ * @param id 监视点ID
+ * @param enable 是否启用
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_set_capture_old_value(monitor_id_t id, bool enable) {
+    int ret;
+    
+    /* 查找监视点 */
+    watchpoint_t *wp = find_watchpoint_locked(id);
+    if (!wp) {
+        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    }
+    
+    watchpoint_config_t *cfg = config_copy(wp, config_of(wp)->action_count);
+    if (!cfg) {
+        pthread_mutex_unlock(&watchpoint_mutex);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    cfg->capture_old = enable;
+    config_publish(wp, cfg);
+    update_region_watch_flags(wp->region);
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 内存区域销毁时删除其上的监视点
+ * 
+ * @param region 内存区域
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_forget_region(memory_region_t *region) {
+    int ret;
+    
+    if (!region) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 监视器已清理时没有监视点 */
+    if (!monitor_initialized) {
+        return PHYMUTI_SUCCESS;
+    }
+    
+    ret = pthread_mutex_lock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    ret = interval_remove(region, NULL);
+    if (ret == PHYMUTI_SUCCESS) {
+        ret = value_index_rebuild(NULL, region, NULL);
+    }
+    if (ret != PHYMUTI_SUCCESS) {
+        pthread_mutex_unlock(&watchpoint_mutex);
+        return ret;
+    }
+    
+    for (watchpoint_t *wp = watchpoint_list; wp; wp = wp->next) {
+        if (wp->region == region) {
+            wp->region = NULL;
+        }
+    }
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 删除监视点
+ * 
+ * @param id 监视点ID
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_remove_watchpoint(monitor_id_t id) {
+    int ret;
+    
+    if (id == MONITOR_INVALID_ID) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    /* 查找监视点 */
+    ret = pthread_mutex_lock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    watchpoint_t *prev = NULL;
+    watchpoint_t *wp = watchpoint_list;
+    
+    while (wp) {
+        if (wp->id == id) {
+            /* 发布不含该监视点的索引 */
+            if (wp->region) {
+                if (config_of(wp)->type == WATCHPOINT_VALUE_WRITE) {
+                    ret = value_index_rebuild(NULL, wp->region, wp);
+                } else {
+                    ret = interval_remove(wp->region, wp);
+                }
+                if (ret != PHYMUTI_SUCCESS) {
+                    pthread_mutex_unlock(&watchpoint_mutex);
+                    return ret;
+                }
+                update_region_watch_flags(wp->region);
+            }
+            
+            /* 从链表中移除 */
+            if (prev) {
+                prev->next = wp->next;
+            } else {
+                watchpoint_list = wp->next;
+            }
+            
+            /* 仍在通知路径中的线程可能持有该监视点，宽限期结束后再释放 */
+            epoch_retire(wp, watchpoint_destroy);
+            
+            ret = pthread_mutex_unlock(&watchpoint_mutex);
+            if (ret != 0) {
+                return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+            }
+            
+            return PHYMUTI_SUCCESS;
+        }
+        
+        prev = wp;
+        wp = wp->next;
+    }
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+}
+
+/**
+ * @brief 启用监视点
+ * 
+ * @param id 监视点ID
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_enable_watchpoint(monitor_id_t id) {
+    int ret;
+    
+    /* 查找监视点 */
+    watchpoint_t *wp = find_watchpoint_locked(id);
+    if (!wp) {
+        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    }
+    
+    /* 启用状态也保存在索引的结构数组中，需要一并重新发布 */
+    watch_index_t *index;
+    watchpoint_config_t *cfg = config_copy(wp, config_of(wp)->action_count);
+    if (!cfg || index_copy(&index) != PHYMUTI_SUCCESS) {
+        pthread_mutex_unlock(&watchpoint_mutex);
+        free(cfg);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    cfg->enabled = true;
+    config_publish(wp, cfg);
+    if (index) {
+        index_finish(index);
+        index_publish(index);
+    }
+    update_region_watch_flags(wp->region);
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 禁用监视点
+ * 
+ * @param id 监视点ID
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_disable_watchpoint(monitor_id_t id) {
+    int ret;
+    
+    /* 查找监视点 */
+    watchpoint_t *wp = find_watchpoint_locked(id);
+    if (!wp) {
+        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    }
+    
+    /* 启用状态也保存在索引的结构数组中，需要一并重新发布 */
+    watch_index_t *index;
+    watchpoint_config_t *cfg = config_copy(wp, config_of(wp)->action_count);
+    if (!cfg || index_copy(&index) != PHYMUTI_SUCCESS) {
+        pthread_mutex_unlock(&watchpoint_mutex);
+        free(cfg);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    cfg->enabled = false;
+    config_publish(wp, cfg);
+    if (index) {
+        index_finish(index);
+        index_publish(index);
+    }
+    update_region_watch_flags(wp->region);
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 绑定动作到监视点
+ * 
+ * @param id 监视点ID
+ * @param action_id 动作ID
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_bind_action(monitor_id_t id, uint32_t action_id) {
+    int ret;
+    
+    /* 查找监视点 */
+    watchpoint_t *wp = find_watchpoint_locked(id);
+    if (!wp) {
+        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    }
+    
+    /* 检查动作是否已绑定 */
+    const watchpoint_config_t *old = config_of(wp);
+    for (uint32_t i = 0; i < old->action_count; i++) {
+        if (old->action_ids[i] == action_id) {
+            ret = pthread_mutex_unlock(&watchpoint_mutex);
+            if (ret != 0) {
+                return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+            }
+            return PHYMUTI_SUCCESS;  /* 已绑定 */
+        }
+    }
+    
+    /* 复制配置并添加动作ID */
+    watchpoint_config_t *cfg = config_copy(wp, old->action_count + 1);
+    if (!cfg) {
+        ret = pthread_mutex_unlock(&watchpoint_mutex);
+        if (ret != 0) {
+            /* 锁释放失败，但内存分配已经失败 */
+            /* 在实际应用中可以考虑记录错误日志 */
+        }
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    cfg->action_ids[old->action_count] = action_id;
+    config_publish(wp, cfg);
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 解绑动作
+ * 
+ * @param id 监视点ID
+ * @param action_id 动作ID
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_unbind_action(monitor_id_t id, uint32_t action_id) {
+    int ret;
+    
+    /* 查找监视点 */
+    watchpoint_t *wp = find_watchpoint_locked(id);
+    if (!wp) {
+        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    }
+    
+    /* 查找动作ID */
+    const watchpoint_config_t *old = config_of(wp);
+    for (uint32_t i = 0; i < old->action_count; i++) {
+        if (old->action_ids[i] == action_id) {
+            /* 复制配置并移除动作ID */
+            watchpoint_config_t *cfg = config_copy(wp, old->action_count - 1);
+            if (!cfg) {
+                pthread_mutex_unlock(&watchpoint_mutex);
+                return PHYMUTI_ERROR_OUT_OF_MEMORY;
+            }
+            memcpy(&cfg->action_ids[i], &old->action_ids[i + 1],
+                   (old->action_count - i - 1) * sizeof(uint32_t));
+            config_publish(wp, cfg);
+            
+            ret = pthread_mutex_unlock(&watchpoint_mutex);
+            if (ret != 0) {
+                return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+            }
+            
+            return PHYMUTI_SUCCESS;
+        }
+    }
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+    
+    return PHYMUTI_ERROR_NOT_FOUND;
+}
+
+/**
+ * @brief 获取监视点信息
+ * 
+ * @param id 监视点ID
+ * @param region 内存区域指针的指针
+ * @param addr 地址指针
+ * @param size 大小指针
+ * @param type 类型指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_get_watchpoint_info(monitor_id_t id, memory_region_t **region, 
+                               uint64_t *addr, uint32_t *size, watchpoint_type_t *type) {
+    int ret;
+    
+    /* 查找监视点 */
+    watchpoint_t *wp = find_watchpoint_locked(id);
+    if (!wp) {
+        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    }
+    
+    /* 返回信息 */
+    if (region) {
+        *region = wp->region;
+    }
+    if (addr) {
+        *addr = wp->addr;
+    }
+    if (size) {
+        *size = wp->size;
+    }
+    if (type) {
+        *type = config_of(wp)->type;
+    }
+    
+    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    if (ret != 0) {
         return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
     }
     
-    return PHYMUTI_SUCCESS;
+    return PHYMUTI_SUCCESS;
+}
+
+/* 一次访问最多收集的待执行动作数 */
+#define MAX_MATCHES 32
+
+/**
+ * @brief 检查地址范围已重叠的监视点是否匹配，匹配时收集要执行的动作（在读侧临界区内调用）
+ * 
+ * @param wp 监视点
+ * @param context 访问上下文
+ * @param list 待执行动作列表
+ * @param count 列表中已有的数量
+ * @return int 加入后的数量
+ */
+static int match_watchpoint(watchpoint_t *wp, const monitor_context_t *context,
+                            pending_action_t *list, int count) {
+    const watchpoint_config_t *cfg = atomic_load_explicit(&wp->config, memory_order_acquire);
+    
+    /* 检查监视点是否启用 */
+    if (!cfg->enabled) {
+        return count;
+    }
+    
+    /* 检查访问类型是否匹配 */
+    memory_access_type_t access_type = context->access_type;
+    bool match = false;
+    switch (cfg->type) {
+        case WATCHPOINT_READ:
+            match = (access_type == MEMORY_ACCESS_READ);
+            break;
+            
+        case WATCHPOINT_WRITE:
+            match = (access_type == MEMORY_ACCESS_WRITE);
+            break;
+            
+        case WATCHPOINT_ACCESS:
+            match = (access_type == MEMORY_ACCESS_READ || 
+                     access_type == MEMORY_ACCESS_WRITE);
+            break;
+            
+        case WATCHPOINT_VALUE_WRITE:
+            /* 只有在写入操作且值等于wpvalue时才匹配 */
+            match = (access_type == MEMORY_ACCESS_WRITE && context->value == cfg->wpvalue);
+            break;
+    }
+    
+    /* 在分发动作之前过滤不满足值谓词的访问 */
+    if (!match || !eval_predicate(&cfg->predicate, context->size, context->value,
+                                  context->old_value, context->has_old_value)) {
+        return count;
+    }
+    
+    /* 计数，按触发方式决定是否执行动作 */
+    if (!count_hit(wp, &cfg->trigger)) {
+        return count;
+    }
+    
+    if (cfg->coalesce.mode == WATCHPOINT_COALESCE_NONE) {
+        return queue_actions(list, count, MAX_MATCHES, wp, cfg, context);
+    }
+    
+    /* 合并高频触发，窗口已结束的后沿触发先于本次执行 */
+    monitor_context_t expired;
+    bool has_expired;
+    pthread_mutex_lock(&wp->coalesce_mutex);
+    coalesce_result_t result = coalesce_trigger(wp, &cfg->coalesce, context, &expired, &has_expired);
+    pthread_mutex_unlock(&wp->coalesce_mutex);
+    if (has_expired) {
+        count = queue_actions(list, count, MAX_MATCHES, wp, cfg, &expired);
+    }
+    if (result == COALESCE_DISPATCH) {
+        count = queue_actions(list, count, MAX_MATCHES, wp, cfg, context);
+    }
+    
+    return count;
+}
+
+/**
+ * @brief 用向量比较匹配一个区域中的全部监视点（在读侧临界区内调用）
+ * 
+ * 按64项分块，先用块内最小起始地址和最大结束地址跳过不可能重叠的块，
+ * 再一次比较整块得到匹配位图，按起始地址从大到小处理，与扫描索引的顺序相同。
+ * 
+ * @param index 区间索引
+ * @param group 区域分组，必须可以向量匹配
+ * @param context 访问上下文
+ * @param end 访问结束地址（不含）
+ * @param list 待执行动作列表
+ * @param count 列表中已有的数量
+ * @return int 加入后的数量
+ */
+static int match_packed(const watch_index_t *index, const watch_group_t *group,
+                        const monitor_context_t *context, uint64_t end,
+                        pending_action_t *list, int count) {
+    uint8_t access_bit = context->access_type == MEMORY_ACCESS_READ ? WATCH_ACCESS_READ :
+                         context->access_type == MEMORY_ACCESS_WRITE ? WATCH_ACCESS_WRITE : 0;
+    if (!access_bit || end <= group->base) {
+        return count;
+    }
+    
+    /* 超出范围的偏移截断到INT32_MAX，组内偏移都不超过它，比较结果不变 */
+    uint64_t addr = context->address;
+    uint64_t lo = addr > group->base ? addr - group->base : 0;
+    uint64_t hi = end - group->base;
+    int32_t lo32 = lo > INT32_MAX ? INT32_MAX : (int32_t)lo;
+    int32_t hi32 = hi > INT32_MAX ? INT32_MAX : (int32_t)hi;
+    
+    for (size_t chunk = (group->count + 63) / 64; chunk-- > 0; ) {
+        size_t first = group->first + chunk * 64;
+        size_t n = group->count - chunk * 64 < 64 ? group->count - chunk * 64 : 64;
+        
+        /* 整块都在访问之后时跳过；块及之前各项的最大结束地址不超过访问起始地址时结束 */
+        if (index->items[first].start >= end) {
+            continue;
+        }
+        if (index->items[first + n - 1].max_end <= addr) {
+            break;
+        }
+        
+        uint64_t mask = memory_simd_match_ranges(&index->start_off[first], &index->end_off[first],
+                                                 &index->access[first], n, lo32, hi32, access_bit);
+        while (mask) {
+            unsigned bit = 63 - (unsigned)__builtin_clzll(mask);
+            mask &= ~(1ull << bit);
+            count = match_watchpoint(index->items[first + bit].wp, context, list, count);
+        }
+    }
+    
+    return count;
+}
+
+/**
+ * @brief 在隐式区间树中匹配与访问重叠的监视点（在读侧临界区内调用）
+ * 
+ * 按起始地址从大到小处理，与向量匹配的顺序相同。跳过最大结束地址不超过
+ * 访问起始地址的子树，以及起始地址不小于访问结束地址的项和它的右子树，
+ * 开销为O((匹配数 + 1) * log n)。
+ * 
+ * @param index 区间索引
+ * @param lo 子树第一项的位置
+ * @param hi 子树最后一项之后的位置
+ * @param context 访问上下文
+ * @param end 访问结束地址（不含）
+ * @param list 待执行动作列表
+ * @param count 列表中已有的数量
+ * @return int 加入后的数量
+ */
+static int match_tree(const watch_index_t *index, size_t lo, size_t hi,
+                      const monitor_context_t *context, uint64_t end,
+                      pending_action_t *list, int count) {
+    uint64_t addr = context->address;
+    
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const watch_interval_t *item = &index->items[mid];
+        if (item->tree_max_end <= addr) {
+            break;
+        }
+        
+        if (item->start < end) {
+            count = match_tree(index, mid + 1, hi, context, end, list, count);
+            if (item->end > addr) {
+                count = match_watchpoint(item->wp, context, list, count);
+            }
+        }
+        hi = mid;
+    }
+    
+    return count;
+}
+
+/**
+ * @brief 在值监视点索引中匹配一次写入（在读侧临界区内调用）
+ * 
+ * @param index 值监视点索引
+ * @param context 访问上下文
+ * @param end 访问结束地址（不含）
+ * @param list 待执行动作列表
+ * @param count 列表中已有的数量
+ * @return int 加入后的数量
+ */
+static int match_values(const watch_value_index_t *index, const monitor_context_t *context,
+                        uint64_t end, pending_action_t *list, int count) {
+    uint64_t h = value_hash(context->region, context->value);
+    uint64_t bit1 = VALUE_BLOOM_BIT1(index, h);
+    uint64_t bit2 = VALUE_BLOOM_BIT2(index, h);
+    
+    /* 布隆过滤器排除绝大多数不是被监视的值的写入 */
+    if (!(index->bloom[bit1 / 64] & (1ull << (bit1 % 64))) ||
+        !(index->bloom[bit2 / 64] & (1ull << (bit2 % 64)))) {
+        return count;
+    }
+    
+    size_t b = VALUE_BUCKET(index, h);
+    for (uint32_t i = index->buckets[b]; i < index->buckets[b + 1]; i++) {
+        const watch_value_item_t *item = &index->items[i];
+        if (item->value == context->value && item->region == context->region &&
+            item->start < end && item->end > context->address) {
+            count = match_watchpoint(item->wp, context, list, count);
+        }
+    }
+    
+    return count;
 }
 
 /**
- * @brief 绑定动作到监视点
+ * @brief 匹配监视点并执行动作
  * 
- * @param id 监视点ID
- * @param action_id 动作ID
+ * @param region 内存区域
+ * @param addr 地址
+ * @param size 大小（字节）
+ * @param value 值
+ * @param old_value 写入前的值
+ * @param has_old 是否有写入前的值
+ * @param access_type 访问类型
  * @return int 成功返回0，失败返回错误码
  */
-int monitor_bind_action(monitor_id_t id, uint32_t action_id) {
+static int dispatch_access(memory_region_t *region, uint64_t addr, uint32_t size,
+                           uint64_t value, uint64_t old_value, bool has_old,
+                           memory_access_type_t access_type) {
     int ret;
     
-    /* 查找监视点 */
-    watchpoint_t *wp = find_watchpoint_locked(id);
-    if (!wp) {
-        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    /* 进入读侧临界区，不加锁；写者发布的新版本对之后的访问可见 */
+    ret = epoch_enter();
+    if (ret != PHYMUTI_SUCCESS) {
+        return ret;
     }
     
-    /* 检查动作是否已绑定 */
-    for (uint32_t i = 0; i < wp->action_count; i++) {
-        if (wp->action_ids[i] == action_id) {
-            ret = pthread_mutex_unlock(&watchpoint_mutex);
-            if (ret != 0) {
-                return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
-            }
-            return PHYMUTI_SUCCESS;  /* 已绑定 */
-        }
+    /* 收集需要执行的动作，避免在临界区内调用外部函数 */
+    pending_action_t matched_actions[MAX_MATCHES];
+    int match_count = 0;
+    
+    /* 创建监视点上下文 */
+    monitor_context_t context;
+    context.region = region;
+    context.address = addr;
+    context.size = size;
+    context.value = value;
+    context.access_type = access_type;
+    context.old_value = has_old ? old_value : 0;
+    context.has_old_value = has_old;
+    
+    const watch_index_t *index = atomic_load_explicit(&current_index, memory_order_acquire);
+    const watch_group_t *group = index_find_group(index, region);
+    uint64_t end = addr + size < addr ? UINT64_MAX : addr + size;
+    
+    if (group && group->packed && group->count <= WATCH_SIMD_SCAN_MAX) {
+        match_count = match_packed(index, group, &context, end, matched_actions, match_count);
+    } else if (group) {
+        match_count = match_tree(index, group->first, group->first + group->count,
+                                 &context, end, matched_actions, match_count);
     }
     
-    /* 检查是否需要扩容 */
-    if (wp->action_count >= wp->action_capacity) {
-        uint32_t new_capacity = wp->action_capacity == 0 ? 4 : wp->action_capacity * 2;
-        uint32_t *new_action_ids = (uint32_t *)realloc(wp->action_ids, new_capacity * sizeof(uint32_t));
-        if (!new_action_ids) {
-            ret = pthread_mutex_unlock(&watchpoint_mutex);
-            if (ret != 0) {
-                /* 锁释放失败，但内存分配已经失败 */
-                /* 在实际应用中可以考虑记录错误日志 */
-            }
-            return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    /* 值监视点只匹配写入 */
+    if (access_type == MEMORY_ACCESS_WRITE) {
+        const watch_value_index_t *values = atomic_load_explicit(&current_value_index, memory_order_acquire);
+        if (values) {
+            match_count = match_values(values, &context, end, matched_actions, match_count);
         }
-        
-        wp->action_ids = new_action_ids;
-        wp->action_capacity = new_capacity;
     }
     
-    /* 添加动作ID */
-    wp->action_ids[wp->action_count++] = action_id;
+    epoch_exit();
     
-    ret = pthread_mutex_unlock(&watchpoint_mutex);
-    if (ret != 0) {
-        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    /* 监视线程处理日志时先收集，一轮结束后按动作合批执行 */
+    if (match_count > 0 && tl_collect && collect_append(tl_collect, matched_actions, match_count)) {
+        return PHYMUTI_SUCCESS;
     }
     
+    /* 执行所有匹配的动作 */
+    monitor_context_t contexts[MAX_MATCHES];
+    execute_pending(matched_actions, (size_t)match_count, contexts);
+    
     return PHYMUTI_SUCCESS;
+} 
+
+/**
+ * @brief 线程退出时归还日志，剩余的日志项仍由监视线程处理
+ *
+ * 日志可能已在切换回同步模式时释放，因此只在链表中仍能找到
+ * 且仍归本线程所有时才归还。
+ */
+static void deferred_thread_exit(void *arg) {
+    if (pthread_mutex_lock(&deferred_log_mutex) != 0) {
+        return;
+    }
+    
+    for (deferred_log_t *log = atomic_load(&deferred_log_list); log; log = log->next) {
+        if (log == arg && pthread_equal(log->owner, pthread_self())) {
+            atomic_store_explicit(&log->in_use, false, memory_order_release);
+            break;
+        }
+    }
+    
+    pthread_mutex_unlock(&deferred_log_mutex);
+}
+
+static void deferred_create_key(void) {
+    pthread_key_create(&deferred_thread_key, deferred_thread_exit);
 }
 
 /**
- * @brief 解绑动作
+ * @brief 为调用线程分配访问日志（在纪元临界区内调用）
+ * 
+ * @param generation 当前延迟模式编号
+ * @return deferred_log_t* 成功返回日志，失败返回NULL
+ */
+static deferred_log_t* deferred_register_thread(uint32_t generation) {
+    deferred_log_t *log;
+    
+    pthread_once(&deferred_key_once, deferred_create_key);
+    
+    if (pthread_mutex_lock(&deferred_log_mutex) != 0) {
+        return NULL;
+    }
+    
+    if (atomic_load(&deferred_generation) != generation) {
+        pthread_mutex_unlock(&deferred_log_mutex);
+        return NULL;
+    }
+    
+    /* 优先复用已退出线程归还的日志 */
+    for (log = atomic_load(&deferred_log_list); log; log = log->next) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&log->in_use, &expected, true)) {
+            break;
+        }
+    }
+    
+    if (!log) {
+        log = (deferred_log_t *)calloc(1, sizeof(deferred_log_t));
+        if (!log) {
+            pthread_mutex_unlock(&deferred_log_mutex);
+            return NULL;
+        }
+        
+        if (spsc_ring_init(&log->ring, deferred_cfg.log_entries, sizeof(deferred_entry_t)) != 0) {
+            free(log);
+            pthread_mutex_unlock(&deferred_log_mutex);
+            return NULL;
+        }
+        
+        atomic_init(&log->in_use, true);
+        log->next = atomic_load(&deferred_log_list);
+        atomic_store(&deferred_log_list, log);
+        atomic_fetch_add(&deferred_thread_count, 1);
+    }
+    
+    log->owner = pthread_self();
+    
+    pthread_mutex_unlock(&deferred_log_mutex);
+    
+    pthread_setspecific(deferred_thread_key, log);
+    tl_log = log;
+    tl_log_generation = generation;
+    
+    return log;
+}
+
+/**
+ * @brief 把一次访问追加到本线程的访问日志
+ * 
+ * 不能使用日志时退化为同步匹配。
  * 
- * @param id 监视点ID
- * @param action_id 动作ID
  * @return int 成功返回0，失败返回错误码
  */
-int monitor_unbind_action(monitor_id_t id, uint32_t action_id) {
-    int ret;
+static int defer_access(memory_region_t *region, uint64_t addr, uint32_t size,
+                        uint64_t value, uint64_t old_value, bool has_old,
+                        memory_access_type_t access_type) {
+    /*
+     * 在纪元临界区内确认仍处于延迟模式：切换回同步模式时
+     * 先等待所有临界区结束，再处理剩余日志并释放日志。
+     */
+    if (epoch_enter() != PHYMUTI_SUCCESS) {
+        return dispatch_access(region, addr, size, value, old_value, has_old, access_type);
+    }
     
-    /* 查找监视点 */
-    watchpoint_t *wp = find_watchpoint_locked(id);
-    if (!wp) {
-        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    uint32_t generation = atomic_load_explicit(&deferred_generation, memory_order_acquire);
+    deferred_log_t *log = tl_log;
+    if (atomic_load(&deferred_enabled) && (!log || tl_log_generation != generation)) {
+        log = deferred_register_thread(generation);
+    }
+    if (!atomic_load(&deferred_enabled) || !log) {
+        epoch_exit();
+        return dispatch_access(region, addr, size, value, old_value, has_old, access_type);
     }
     
-    /* 查找动作ID */
-    for (uint32_t i = 0; i < wp->action_count; i++) {
-        if (wp->action_ids[i] == action_id) {
-            /* 移除动作ID */
-            if (i < wp->action_count - 1) {
-                memmove(&wp->action_ids[i], &wp->action_ids[i + 1], 
-                       (wp->action_count - i - 1) * sizeof(uint32_t));
+    deferred_entry_t entry;
+    entry.region = region;
+    entry.addr = addr;
+    entry.value = value;
+    entry.old_value = old_value;
+    entry.size = size;
+    entry.access_type = (uint8_t)access_type;
+    entry.has_old = has_old;
+    
+    /* 日志已满时唤醒监视线程并等待，不丢弃访问 */
+    while (!spsc_ring_push(&log->ring, &entry)) {
+        atomic_store_explicit(&log->stalls,
+            atomic_load_explicit(&log->stalls, memory_order_relaxed) + 1, memory_order_relaxed);
+        pthread_cond_signal(&deferred_wait_cond);
+        sched_yield();
+    }
+    atomic_store_explicit(&log->logged,
+        atomic_load_explicit(&log->logged, memory_order_relaxed) + 1, memory_order_relaxed);
+    
+    epoch_exit();
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 按批处理所有访问日志（调用者持有消费者锁）
+ * 
+ * 每轮从每个日志最多取一批，直到所有日志都为空，避免单个线程的日志占满处理时间。
+ * 
+ * @param batch 临时缓冲区，至少能容纳deferred_cfg.batch_size项
+ * @return size_t 处理的条数
+ */
+static size_t deferred_drain(deferred_entry_t *batch) {
+    size_t total = 0;
+    size_t round;
+    bool was_draining = tl_draining;
+    pending_collect_t *was_collect = tl_collect;
+    pending_collect_t collect = { NULL, 0, 0, NULL };
+    
+    /* 动作中的内存访问直接同步匹配，避免等待自己处理日志 */
+    tl_draining = true;
+    
+    do {
+        round = 0;
+        tl_collect = &collect;
+        for (deferred_log_t *log = atomic_load(&deferred_log_list); log; log = log->next) {
+            size_t n = spsc_ring_pop_batch(&log->ring, batch, deferred_cfg.batch_size);
+            for (size_t i = 0; i < n; i++) {
+                dispatch_access(batch[i].region, batch[i].addr, batch[i].size, batch[i].value,
+                                batch[i].old_value, batch[i].has_old,
+                                (memory_access_type_t)batch[i].access_type);
             }
-            wp->action_count--;
-            
-            ret = pthread_mutex_unlock(&watchpoint_mutex);
-            if (ret != 0) {
-                return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+            if (n > 0) {
+                atomic_fetch_add_explicit(&deferred_dispatched, n, memory_order_relaxed);
+                atomic_fetch_add_explicit(&deferred_batches, 1, memory_order_relaxed);
+                round += n;
             }
-            
-            return PHYMUTI_SUCCESS;
         }
+        total += round;
+        
+        /* 一轮中触发同一动作的上下文合成一批执行，动作中的访问同步处理 */
+        tl_collect = NULL;
+        execute_pending(collect.items, collect.count, collect.contexts);
+        collect.count = 0;
+    } while (round > 0);
+    
+    free(collect.items);
+    free(collect.contexts);
+    tl_draining = was_draining;
+    tl_collect = was_collect;
+    return total;
+}
+
+/**
+ * @brief 监视线程
+ */
+static void* deferred_thread_main(void *arg) {
+    deferred_entry_t *batch = (deferred_entry_t *)arg;
+    
+    while (!atomic_load(&deferred_stop)) {
+        pthread_mutex_lock(&deferred_drain_mutex);
+        size_t n = deferred_drain(batch);
+        pthread_mutex_unlock(&deferred_drain_mutex);
+        
+        if (n > 0) {
+            continue;
+        }
+        
+        /* 没有日志时等待一个处理间隔，访问线程等待时会提前唤醒 */
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        uint64_t nsec = (uint64_t)deadline.tv_nsec + (uint64_t)deferred_cfg.max_latency_us * 1000ULL;
+        deadline.tv_sec += (time_t)(nsec / 1000000000ULL);
+        deadline.tv_nsec = (long)(nsec % 1000000000ULL);
+        
+        pthread_mutex_lock(&deferred_wait_mutex);
+        if (!atomic_load(&deferred_stop)) {
+            pthread_cond_timedwait(&deferred_wait_cond, &deferred_wait_mutex, &deadline);
+        }
+        pthread_mutex_unlock(&deferred_wait_mutex);
     }
     
-    ret = pthread_mutex_unlock(&watchpoint_mutex);
-    if (ret != 0) {
-        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    return NULL;
+}
+
+/**
+ * @brief 汇总当前延迟模式的统计信息
+ */
+static void deferred_collect_stats(monitor_deferred_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    
+    for (deferred_log_t *log = atomic_load(&deferred_log_list); log; log = log->next) {
+        stats->logged += atomic_load_explicit(&log->logged, memory_order_relaxed);
+        stats->stalls += atomic_load_explicit(&log->stalls, memory_order_relaxed);
     }
     
-    return PHYMUTI_ERROR_NOT_FOUND;
+    stats->dispatched = atomic_load(&deferred_dispatched);
+    stats->batches = atomic_load(&deferred_batches);
+    stats->threads = atomic_load(&deferred_thread_count);
 }
 
 /**
- * @brief 获取监视点信息
+ * @brief 退出延迟模式：停止监视线程，处理剩余日志后释放日志（调用者持有模式锁）
+ */
+static void deferred_stop_locked(void) {
+    if (!atomic_load(&deferred_enabled)) {
+        return;
+    }
+    
+    /* 之后的访问同步匹配；等待正在追加日志的访问结束 */
+    atomic_store(&deferred_enabled, false);
+    epoch_synchronize();
+    
+    pthread_mutex_lock(&deferred_wait_mutex);
+    atomic_store(&deferred_stop, true);
+    pthread_cond_signal(&deferred_wait_cond);
+    pthread_mutex_unlock(&deferred_wait_mutex);
+    
+    /* 监视线程退出后用它的缓冲区处理剩余日志 */
+    pthread_join(deferred_thread, NULL);
+    deferred_entry_t *batch = deferred_thread_batch;
+    deferred_thread_batch = NULL;
+    
+    pthread_mutex_lock(&deferred_drain_mutex);
+    deferred_drain(batch);
+    
+    pthread_mutex_lock(&deferred_log_mutex);
+    deferred_collect_stats(&deferred_last_stats);
+    deferred_log_t *log = atomic_exchange(&deferred_log_list, NULL);
+    while (log) {
+        deferred_log_t *next = log->next;
+        spsc_ring_destroy(&log->ring);
+        free(log);
+        log = next;
+    }
+    /* 使线程缓存的日志失效 */
+    atomic_fetch_add(&deferred_generation, 1);
+    pthread_mutex_unlock(&deferred_log_mutex);
+    
+    pthread_mutex_unlock(&deferred_drain_mutex);
+    free(batch);
+}
+
+/**
+ * @brief 切换同步或延迟监视模式
  * 
- * @param id 监视点ID
- * @param region 内存区域指针的指针
- * @param addr 地址指针
- * @param size 大小指针
- * @param type 类型指针
+ * @param config 延迟监视配置，为NULL时切换回同步模式
  * @return int 成功返回0，失败返回错误码
  */
-int monitor_get_watchpoint_info(monitor_id_t id, memory_region_t **region, 
-                               uint64_t *addr, uint32_t *size, watchpoint_type_t *type) {
+int monitor_set_deferred(const monitor_deferred_config_t *config) {
     int ret;
     
-    /* 查找监视点 */
-    watchpoint_t *wp = find_watchpoint_locked(id);
-    if (!wp) {
-        return PHYMUTI_ERROR_WATCHPOINT_NOT_FOUND;
+    if (config && (config->log_entries == 0 || config->batch_size == 0 || config->max_latency_us == 0)) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
     }
     
-    /* 返回信息 */
-    if (region) {
-        *region = wp->region;
+    /* 监视器已清理时处于同步模式 */
+    if (config && !monitor_initialized) {
+        return PHYMUTI_ERROR_NOT_SUPPORTED;
     }
-    if (addr) {
-        *addr = wp->addr;
+    
+    ret = pthread_mutex_lock(&deferred_mode_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
     }
-    if (size) {
-        *size = wp->size;
+    
+    /* 已处于延迟模式时先处理完旧日志，再按新配置重新开始 */
+    deferred_stop_locked();
+    
+    if (!config) {
+        pthread_mutex_unlock(&deferred_mode_mutex);
+        return PHYMUTI_SUCCESS;
     }
-    if (type) {
-        *type = wp->type;
+    
+    deferred_entry_t *batch = (deferred_entry_t *)malloc(config->batch_size * sizeof(deferred_entry_t));
+    if (!batch) {
+        pthread_mutex_unlock(&deferred_mode_mutex);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
     }
     
-    ret = pthread_mutex_unlock(&watchpoint_mutex);
+    deferred_cfg = *config;
+    atomic_store(&deferred_dispatched, 0);
+    atomic_store(&deferred_batches, 0);
+    atomic_store(&deferred_thread_count, 0);
+    atomic_store(&deferred_stop, false);
+    
+    if (pthread_create(&deferred_thread, NULL, deferred_thread_main, batch) != 0) {
+        free(batch);
+        pthread_mutex_unlock(&deferred_mode_mutex);
+        return PHYMUTI_ERROR_INTERNAL;
+    }
+    deferred_thread_batch = batch;
+    
+    atomic_store(&deferred_enabled, true);
+    
+    pthread_mutex_unlock(&deferred_mode_mutex);
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 立即处理所有访问日志
+ * 
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_drain_deferred(void) {
+    int ret;
+    
+    if (!atomic_load(&deferred_enabled)) {
+        return PHYMUTI_SUCCESS;
+    }
+    
+    /* 每次调用使用自己的缓冲区，动作中可以再次调用 */
+    deferred_entry_t *batch = (deferred_entry_t *)malloc(deferred_cfg.batch_size * sizeof(deferred_entry_t));
+    if (!batch) {
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    ret = pthread_mutex_lock(&deferred_drain_mutex);
     if (ret != 0) {
-        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+        free(batch);
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    deferred_drain(batch);
+    
+    pthread_mutex_unlock(&deferred_drain_mutex);
+    free(batch);
+    
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 获取延迟监视统计信息
+ * 
+ * @param stats 统计信息
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_get_deferred_stats(monitor_deferred_stats_t *stats) {
+    int ret;
+    
+    if (!stats) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    ret = pthread_mutex_lock(&deferred_log_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+    
+    if (atomic_load(&deferred_enabled)) {
+        deferred_collect_stats(stats);
+    } else {
+        *stats = deferred_last_stats;
     }
     
+    pthread_mutex_unlock(&deferred_log_mutex);
+    
     return PHYMUTI_SUCCESS;
 }
 
@@ -494,102 +2685,54 @@ int monitor_get_watchpoint_info(monitor_id_t id, memory_region_t **region,
 int monitor_notify_memory_access(memory_region_t *region, uint64_t addr, 
                                 uint32_t size, uint64_t value, 
                                 memory_access_type_t access_type) {
-    int ret;
-    
     if (!region) {
         return PHYMUTI_ERROR_INVALID_PARAM;
     }
     
-    /* 遍历所有监视点 */
-    ret = pthread_mutex_lock(&watchpoint_mutex);
-    if (ret != 0) {
-        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
-    }
+    /* 记录访问跟踪和采样（未开始时各只有一次原子读） */
+    trace_record_access(region, addr, size, value, access_type);
+    profile_record_access(region, addr, access_type);
     
-    watchpoint_t *wp = watchpoint_list;
+    /* 区域上没有启用的监视点时直接返回 */
+    if (!(memory_region_get_watch_flags(region) & MEMORY_WATCH_ACTIVE)) {
+        return PHYMUTI_SUCCESS;
+    }
     
-    /* 收集需要执行的动作，避免在持有锁时调用外部函数 */
-    #define MAX_MATCHES 32
-    struct {
-        uint32_t action_id;
-        monitor_context_t context;
-    } matched_actions[MAX_MATCHES];
-    int match_count = 0;
+    /* 延迟模式下只追加日志，处理日志的线程中直接匹配 */
+    if (atomic_load_explicit(&deferred_enabled, memory_order_relaxed) && !tl_draining) {
+        return defer_access(region, addr, size, value, 0, false, access_type);
+    }
     
-    while (wp) {
-        /* 检查监视点是否启用 */
-        if (!wp->enabled) {
-            wp = wp->next;
-            continue;
-        }
-        
-        /* 检查内存区域是否匹配 */
-        if (wp->region != region) {
-            wp = wp->next;
-            continue;
-        }
-        
-        /* 检查地址范围是否重叠 */
-        if (addr + size <= wp->addr || addr >= wp->addr + wp->size) {
-            wp = wp->next;
-            continue;
-        }
-        
-        /* 检查访问类型是否匹配 */
-        bool match = false;
-        switch (wp->type) {
-            case WATCHPOINT_READ:
-                match = (access_type == MEMORY_ACCESS_READ);
-                break;
-                
-            case WATCHPOINT_WRITE:
-                match = (access_type == MEMORY_ACCESS_WRITE);
-                break;
-                
-            case WATCHPOINT_ACCESS:
-                match = (access_type == MEMORY_ACCESS_READ || 
-                         access_type == MEMORY_ACCESS_WRITE);
-                break;
-                
-            case WATCHPOINT_VALUE_WRITE:
-                /* 只有在写入操作且值等于wpvalue时才匹配 */
-                match = (access_type == MEMORY_ACCESS_WRITE && value == wp->wpvalue);
-                break;
-        }
-        
-        if (!match) {
-            wp = wp->next;
-            continue;
-        }
-        
-        /* 创建监视点上下文 */
-        monitor_context_t context;
-        context.region = region;
-        context.address = addr;
-        context.size = size;
-        context.value = value;
-        context.access_type = access_type;
-        
-        /* 添加所有绑定的动作到待执行列表 */
-        for (uint32_t i = 0; i < wp->action_count && match_count < MAX_MATCHES; i++) {
-            matched_actions[match_count].action_id = wp->action_ids[i];
-            matched_actions[match_count].context = context;
-            match_count++;
-        }
-        
-        wp = wp->next;
+    return dispatch_access(region, addr, size, value, 0, false, access_type);
+}
+
+/**
+ * @brief 通知内存写入（带写入前的值）
+ * 
+ * @param region 内存区域
+ * @param addr 地址
+ * @param size 大小（字节）
+ * @param old_value 写入前的值
+ * @param value 写入的值
+ * @return int 成功返回0，失败返回错误码
+ */
+int monitor_notify_memory_write(memory_region_t *region, uint64_t addr, 
+                               uint32_t size, uint64_t old_value, uint64_t value) {
+    if (!region) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
     }
     
-    ret = pthread_mutex_unlock(&watchpoint_mutex);
-    if (ret != 0) {
-        /* 锁释放失败，但仍需要执行匹配的动作 */
-        /* 在实际应用中可以考虑记录错误日志 */
+    /* 记录访问跟踪和采样（未开始时各只有一次原子读） */
+    trace_record_access(region, addr, size, value, MEMORY_ACCESS_WRITE);
+    profile_record_access(region, addr, MEMORY_ACCESS_WRITE);
+    
+    if (!(memory_region_get_watch_flags(region) & MEMORY_WATCH_ACTIVE)) {
+        return PHYMUTI_SUCCESS;
     }
     
-    /* 执行所有匹配的动作 */
-    for (int i = 0; i < match_count; i++) {
-        action_execute(matched_actions[i].action_id, &matched_actions[i].context);
+    if (atomic_load_explicit(&deferred_enabled, memory_order_relaxed) && !tl_draining) {
+        return defer_access(region, addr, size, value, old_value, true, MEMORY_ACCESS_WRITE);
     }
     
-    return PHYMUTI_SUCCESS;
-} 
\ No newline at end of file
+    return dispatch_access(region, addr, size, value, old_value, true, MEMORY_ACCESS_WRITE);
+}
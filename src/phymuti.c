@@ -4,6 +4,7 @@
  */
 
 #include "phymuti.h"
+#include "memory_simd.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -70,9 +71,8 @@ int phymuti_init(void) {
  * @return int 成功返回0，失败返回错误码
  */
 int phymuti_process_events(void) {
-    /* 这里可以实现事件处理循环 */
-    /* 在实际实现中，可能需要从事件队列中获取事件并处理 */
-    return PHYMUTI_SUCCESS;
+    /* 执行窗口已结束的后沿合并触发 */
+    return monitor_flush_coalesced();
 }
 
 /**
@@ -83,6 +83,27 @@ int phymuti_process_events(void) {
 int phymuti_cleanup(void) {
     int ret;
     
+    /* 停止跟踪，写出剩余记录 */
+    ret = trace_cleanup();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "Failed to cleanup trace: %s\n", phymuti_error_string(ret));
+        /* 继续清理其他模块 */
+    }
+    
+    /* 停止采样，释放直方图 */
+    ret = profile_cleanup();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "Failed to cleanup profile: %s\n", phymuti_error_string(ret));
+        /* 继续清理其他模块 */
+    }
+    
+    /* 释放检查点副本 */
+    ret = checkpoint_cleanup();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "Failed to cleanup checkpoint: %s\n", phymuti_error_string(ret));
+        /* 继续清理其他模块 */
+    }
+    
     /* 清理规则引擎 */
     ret = rule_engine_cleanup();
     if (ret != PHYMUTI_SUCCESS) {
@@ -122,6 +143,129 @@ int phymuti_cleanup(void) {
     return PHYMUTI_SUCCESS;
 }
 
+/* 状态指纹计算上下文 */
+typedef struct {
+    uint64_t *entries;  /* 每个内存区域和设备的哈希 */
+    size_t count;
+    size_t capacity;
+} fingerprint_ctx_t;
+
+/**
+ * @brief 计算字符串哈希
+ */
+static uint64_t fingerprint_string(const char *str) {
+    return str ? memory_simd_hash((const uint8_t *)str, strlen(str), 0) : 0;
+}
+
+/**
+ * @brief 添加一项哈希
+ * 
+ * @return int 成功返回0，失败返回错误码
+ */
+static int fingerprint_add(fingerprint_ctx_t *ctx, const uint64_t *fields, size_t nfields) {
+    if (ctx->count == ctx->capacity) {
+        size_t capacity = ctx->capacity ? ctx->capacity * 2 : 16;
+        uint64_t *entries = (uint64_t *)realloc(ctx->entries, capacity * sizeof(uint64_t));
+        if (!entries) {
+            return PHYMUTI_ERROR_OUT_OF_MEMORY;
+        }
+        ctx->entries = entries;
+        ctx->capacity = capacity;
+    }
+    
+    ctx->entries[ctx->count++] = memory_simd_hash((const uint8_t *)fields, nfields * sizeof(uint64_t), 0);
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 内存区域指纹：名称、地址范围、标志和内容哈希
+ * 
+ * 遍历时持有内存区域链表锁，这里不调用设备管理器，避免与设备遍历的加锁顺序相反。
+ */
+static int fingerprint_region(memory_region_t *region, void *user_data) {
+    uint64_t content;
+    int ret = memory_region_hash(region, &content);
+    if (ret != PHYMUTI_SUCCESS) {
+        return ret;
+    }
+    
+    uint64_t fields[] = {
+        fingerprint_string(memory_region_get_name(region)),
+        memory_region_get_base_addr(region),
+        memory_region_get_size(region),
+        memory_region_get_flags(region),
+        content,
+    };
+    return fingerprint_add((fingerprint_ctx_t *)user_data, fields, sizeof(fields) / sizeof(fields[0]));
+}
+
+/**
+ * @brief 设备指纹：名称、类型和save_state保存的状态
+ */
+static int fingerprint_device(device_handle_t device, void *user_data) {
+    void *state = NULL;
+    size_t size = 0;
+    uint64_t state_hash = 0;
+    
+    int ret = device_save_state_alloc(device, &state, &size);
+    if (ret == PHYMUTI_SUCCESS) {
+        state_hash = memory_simd_hash((const uint8_t *)state, size, 1);
+        free(state);
+    } else if (ret != PHYMUTI_ERROR_NOT_SUPPORTED) {
+        return ret;
+    }
+    
+    uint64_t fields[] = {
+        fingerprint_string(device_get_name(device)),
+        fingerprint_string(device_get_type_name(device)),
+        size,
+        state_hash,
+    };
+    return fingerprint_add((fingerprint_ctx_t *)user_data, fields, sizeof(fields) / sizeof(fields[0]));
+}
+
+/**
+ * @brief 比较两个64位整数（qsort使用）
+ */
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief 计算整个模拟系统的状态指纹
+ * 
+ * @param fingerprint 返回指纹
+ * @return int 成功返回0，失败返回错误码
+ */
+int phymuti_state_fingerprint(uint64_t *fingerprint) {
+    fingerprint_ctx_t ctx = { NULL, 0, 0 };
+    int ret;
+    
+    if (!fingerprint) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    
+    ret = memory_region_foreach(fingerprint_region, &ctx);
+    if (ret == PHYMUTI_SUCCESS) {
+        ret = device_foreach(fingerprint_device, &ctx);
+    }
+    if (ret != PHYMUTI_SUCCESS) {
+        free(ctx.entries);
+        return ret;
+    }
+    
+    /* 排序后合并，结果与区域和设备的创建顺序无关 */
+    if (ctx.count > 1) {
+        qsort(ctx.entries, ctx.count, sizeof(uint64_t), compare_u64);
+    }
+    *fingerprint = memory_simd_hash((const uint8_t *)ctx.entries, ctx.count * sizeof(uint64_t), ctx.count);
+    
+    free(ctx.entries);
+    return PHYMUTI_SUCCESS;
+}
+
 /**
  * @brief 获取PhyMuTi版本信息
  * 
@@ -86,6 +86,12 @@ const char* phymuti_error_string(int error_code) {
             return "Action execution failed";
         case PHYMUTI_ERROR_ACTION_INVALID_TYPE:
             return "Invalid action type";
+        case PHYMUTI_ERROR_ACTION_THROTTLED:
+            return "Action throttled by rate limit";
+        case PHYMUTI_ERROR_ACTION_TIMEOUT:
+            return "Action timed out and was killed";
+        case PHYMUTI_ERROR_ACTION_CANCELLED:
+            return "Action cancelled";
             
         /* 规则引擎错误码 */
         case PHYMUTI_ERROR_RULE_NOT_FOUND:
@@ -95,6 +101,28 @@ const char* phymuti_error_string(int error_code) {
         case PHYMUTI_ERROR_RULE_ACTION_FAILED:
             return "Rule action execution failed";
             
+        /* 跟踪模块错误码 */
+        case PHYMUTI_ERROR_TRACE_ACTIVE:
+            return "Trace already active";
+        case PHYMUTI_ERROR_TRACE_NOT_ACTIVE:
+            return "Trace not active";
+        case PHYMUTI_ERROR_TRACE_FORMAT:
+            return "Invalid trace file format";
+            
+        /* 检查点模块错误码 */
+        case PHYMUTI_ERROR_CHECKPOINT_FORMAT:
+            return "Invalid checkpoint file format";
+        case PHYMUTI_ERROR_CHECKPOINT_NO_PARENT:
+            return "No parent checkpoint";
+        case PHYMUTI_ERROR_CHECKPOINT_MISMATCH:
+            return "Checkpoint does not match the simulation";
+            
+        /* 采样分析模块错误码 */
+        case PHYMUTI_ERROR_PROFILE_ACTIVE:
+            return "Profiling already active";
+        case PHYMUTI_ERROR_PROFILE_NOT_ACTIVE:
+            return "Profiling not active";
+            
         default:
             return "Unknown error";
     }
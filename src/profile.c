@@ -0,0 +1,520 @@
+/**
+ * @file profile.c
+ * @brief 内存访问采样分析模块实现
+ */
+
+#include "profile.h"
+#include "phymuti_error.h"
+#include "epoch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* 插入直方图时最多探测的槽数 */
+#define PROFILE_MAX_PROBE 64
+
+/* 直方图槽 */
+typedef struct {
+    _Atomic uint64_t key;      /* 地址加1，0表示空槽 */
+    _Atomic uint64_t reads;    /* 采样到的读次数 */
+    _Atomic uint64_t writes;   /* 采样到的写次数 */
+} profile_slot_t;
+
+/* 区域直方图 */
+typedef struct profile_hist_struct {
+    uint32_t region_id;                  /* 内存区域ID */
+    char name[PROFILE_NAME_MAX];         /* 内存区域名称 */
+    unsigned shift;                      /* 哈希右移位数（64 - log2(槽数)） */
+    size_t mask;                         /* 槽数-1 */
+    _Atomic uint64_t samples;            /* 采样数 */
+    _Atomic uint64_t dropped;            /* 直方图已满而未计入的采样数 */
+    profile_slot_t *slots;               /* 槽数组 */
+    struct profile_hist_struct *next;    /* 下一个直方图 */
+} profile_hist_t;
+
+/* 是否正在采样 */
+static _Atomic bool profile_active = false;
+
+/* 当前采样配置，开始采样前设置 */
+static _Atomic uint32_t profile_period = PROFILE_DEFAULT_SAMPLE_PERIOD;
+static size_t profile_slots = PROFILE_DEFAULT_REGION_SLOTS;
+
+/* 直方图链表（采样期间只增不减），新节点以原子方式插入表头 */
+static _Atomic(profile_hist_t *) profile_hist_list = NULL;
+
+/* 线程的采样倒计数和随机数状态 */
+static __thread uint32_t tl_countdown = 0;
+static __thread uint64_t tl_rng = 0;
+
+/* 保护开始/停止、查询和释放的互斥锁 */
+static pthread_mutex_t profile_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief 生成下一个采样间隔，均匀分布在[1, 2*period-1]，平均为period
+ *
+ * @return uint32_t 采样间隔
+ */
+static uint32_t profile_next_interval(void) {
+    uint32_t period = atomic_load_explicit(&profile_period, memory_order_relaxed);
+    if (period <= 1) {
+        return 1;
+    }
+
+    if (tl_rng == 0) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        tl_rng = ((uint64_t)(uintptr_t)&tl_rng ^ (uint64_t)ts.tv_nsec) | 1;
+    }
+
+    /* xorshift64 */
+    tl_rng ^= tl_rng << 13;
+    tl_rng ^= tl_rng >> 7;
+    tl_rng ^= tl_rng << 17;
+
+    return 1 + (uint32_t)(tl_rng % (2ULL * period - 1));
+}
+
+/**
+ * @brief 释放直方图
+ */
+static void profile_free_hist(profile_hist_t *hist) {
+    free(hist->slots);
+    free(hist);
+}
+
+/**
+ * @brief 释放所有直方图（调用者持有锁，且没有线程正在采样）
+ */
+static void profile_free_all(void) {
+    profile_hist_t *hist = atomic_exchange(&profile_hist_list, NULL);
+    while (hist) {
+        profile_hist_t *next = hist->next;
+        profile_free_hist(hist);
+        hist = next;
+    }
+}
+
+/**
+ * @brief 查找或创建区域的直方图（在纪元临界区内调用）
+ *
+ * @param region 内存区域
+ * @return profile_hist_t* 成功返回直方图，失败返回NULL
+ */
+static profile_hist_t* profile_get_hist(memory_region_t *region) {
+    uint32_t id = memory_region_get_id(region);
+    profile_hist_t *head = atomic_load_explicit(&profile_hist_list, memory_order_acquire);
+
+    for (profile_hist_t *hist = head; hist; hist = hist->next) {
+        if (hist->region_id == id) {
+            return hist;
+        }
+    }
+
+    profile_hist_t *hist = (profile_hist_t *)calloc(1, sizeof(profile_hist_t));
+    if (!hist) {
+        return NULL;
+    }
+
+    size_t slots = 2;
+    unsigned bits = 1;
+    while (slots < profile_slots) {
+        slots <<= 1;
+        bits++;
+    }
+    hist->slots = (profile_slot_t *)calloc(slots, sizeof(profile_slot_t));
+    if (!hist->slots) {
+        free(hist);
+        return NULL;
+    }
+
+    const char *name = memory_region_get_name(region);
+    hist->region_id = id;
+    strncpy(hist->name, name ? name : "", PROFILE_NAME_MAX - 1);
+    hist->shift = 64 - bits;
+    hist->mask = slots - 1;
+
+    /* 插入表头；其他线程抢先插入时检查它是否就是同一区域 */
+    hist->next = head;
+    while (!atomic_compare_exchange_weak(&profile_hist_list, &hist->next, hist)) {
+        for (profile_hist_t *other = hist->next; other != head; other = other->next) {
+            if (other->region_id == id) {
+                profile_free_hist(hist);
+                return other;
+            }
+        }
+        head = hist->next;
+    }
+
+    return hist;
+}
+
+/**
+ * @brief 把一次采样计入区域直方图
+ */
+static void profile_sample(memory_region_t *region, uint64_t addr, memory_access_type_t access_type) {
+    if (epoch_enter() != PHYMUTI_SUCCESS) {
+        return;
+    }
+
+    /* 在临界区内再次确认，停止采样后直方图不再被修改 */
+    profile_hist_t *hist = atomic_load(&profile_active) ? profile_get_hist(region) : NULL;
+    if (!hist) {
+        epoch_exit();
+        return;
+    }
+
+    atomic_fetch_add_explicit(&hist->samples, 1, memory_order_relaxed);
+
+    uint64_t key = addr + 1;
+    size_t pos = (size_t)((addr * 0x9e3779b97f4a7c15ULL) >> hist->shift);
+    for (int probe = 0; key != 0 && probe < PROFILE_MAX_PROBE; probe++, pos = (pos + 1) & hist->mask) {
+        profile_slot_t *slot = &hist->slots[pos];
+        uint64_t current = atomic_load_explicit(&slot->key, memory_order_relaxed);
+        if (current == 0) {
+            if (atomic_compare_exchange_strong_explicit(&slot->key, &current, key,
+                                                        memory_order_relaxed, memory_order_relaxed)) {
+                current = key;
+            }
+        }
+        if (current != key) {
+            continue;
+        }
+
+        if (access_type == MEMORY_ACCESS_WRITE) {
+            atomic_fetch_add_explicit(&slot->writes, 1, memory_order_relaxed);
+        } else {
+            atomic_fetch_add_explicit(&slot->reads, 1, memory_order_relaxed);
+        }
+        epoch_exit();
+        return;
+    }
+
+    atomic_fetch_add_explicit(&hist->dropped, 1, memory_order_relaxed);
+    epoch_exit();
+}
+
+/**
+ * @brief 对一次内存访问计数，到达采样间隔时记录
+ */
+void profile_record_access(memory_region_t *region, uint64_t addr, memory_access_type_t access_type) {
+    if (!atomic_load_explicit(&profile_active, memory_order_relaxed)) {
+        return;
+    }
+
+    /* 未到采样点时只递减本线程的计数器 */
+    if (tl_countdown > 1) {
+        tl_countdown--;
+        return;
+    }
+    tl_countdown = profile_next_interval();
+
+    profile_sample(region, addr, access_type);
+}
+
+/**
+ * @brief 开始采样
+ *
+ * @param config 采样配置
+ * @return int 成功返回0，失败返回错误码
+ */
+int profile_start(const profile_config_t *config) {
+    int ret;
+
+    ret = pthread_mutex_lock(&profile_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    if (atomic_load(&profile_active)) {
+        pthread_mutex_unlock(&profile_mutex);
+        return PHYMUTI_ERROR_PROFILE_ACTIVE;
+    }
+
+    /* 上一次停止时已等待所有采样结束 */
+    profile_free_all();
+
+    atomic_store(&profile_period, PROFILE_DEFAULT_SAMPLE_PERIOD);
+    profile_slots = PROFILE_DEFAULT_REGION_SLOTS;
+    if (config) {
+        if (config->sample_period > 0) {
+            atomic_store(&profile_period, config->sample_period);
+        }
+        if (config->region_slots > 0) {
+            profile_slots = config->region_slots;
+        }
+    }
+
+    atomic_store(&profile_active, true);
+
+    ret = pthread_mutex_unlock(&profile_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 停止采样
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+int profile_stop(void) {
+    int ret;
+
+    ret = pthread_mutex_lock(&profile_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    if (!atomic_load(&profile_active)) {
+        pthread_mutex_unlock(&profile_mutex);
+        return PHYMUTI_ERROR_PROFILE_NOT_ACTIVE;
+    }
+
+    /* 等待正在记录采样的线程完成，之后直方图不再变化 */
+    atomic_store(&profile_active, false);
+    epoch_synchronize();
+
+    ret = pthread_mutex_unlock(&profile_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 查询是否正在采样
+ *
+ * @return bool 正在采样返回true
+ */
+bool profile_is_active(void) {
+    return atomic_load(&profile_active);
+}
+
+/* 热点候选 */
+typedef struct {
+    const profile_hist_t *hist;  /* 所在直方图 */
+    const profile_slot_t *slot;  /* 槽 */
+    uint64_t reads;              /* 读采样数 */
+    uint64_t writes;             /* 写采样数 */
+} profile_candidate_t;
+
+static uint64_t candidate_total(const profile_candidate_t *c) {
+    return c->reads + c->writes;
+}
+
+/**
+ * @brief 在以heap[0]为最小值的堆中从pos开始下沉
+ */
+static void heap_sift_down(profile_candidate_t *heap, size_t count, size_t pos) {
+    for (;;) {
+        size_t smallest = pos;
+        size_t left = 2 * pos + 1, right = 2 * pos + 2;
+        if (left < count && candidate_total(&heap[left]) < candidate_total(&heap[smallest])) {
+            smallest = left;
+        }
+        if (right < count && candidate_total(&heap[right]) < candidate_total(&heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            return;
+        }
+        profile_candidate_t tmp = heap[pos];
+        heap[pos] = heap[smallest];
+        heap[smallest] = tmp;
+        pos = smallest;
+    }
+}
+
+/**
+ * @brief 获取采样次数最多的k个地址
+ *
+ * @param entries 输出数组
+ * @param k 数组容量
+ * @param count 返回实际输出的个数
+ * @return int 成功返回0，失败返回错误码
+ */
+int profile_get_top(profile_entry_t *entries, size_t k, size_t *count) {
+    int ret;
+
+    if (!count || (!entries && k > 0)) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+
+    *count = 0;
+    if (k == 0) {
+        return PHYMUTI_SUCCESS;
+    }
+
+    profile_candidate_t *heap = (profile_candidate_t *)malloc(k * sizeof(profile_candidate_t));
+    if (!heap) {
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+
+    ret = pthread_mutex_lock(&profile_mutex);
+    if (ret != 0) {
+        free(heap);
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    /* 用大小为k的最小堆保留采样最多的地址 */
+    size_t used = 0;
+    for (const profile_hist_t *hist = atomic_load(&profile_hist_list); hist; hist = hist->next) {
+        for (size_t i = 0; i <= hist->mask; i++) {
+            const profile_slot_t *slot = &hist->slots[i];
+            if (atomic_load_explicit(&slot->key, memory_order_relaxed) == 0) {
+                continue;
+            }
+
+            profile_candidate_t c;
+            c.hist = hist;
+            c.slot = slot;
+            c.reads = atomic_load_explicit(&slot->reads, memory_order_relaxed);
+            c.writes = atomic_load_explicit(&slot->writes, memory_order_relaxed);
+
+            if (used < k) {
+                heap[used++] = c;
+                if (used == k) {
+                    for (size_t j = k / 2; j-- > 0;) {
+                        heap_sift_down(heap, k, j);
+                    }
+                }
+            } else if (candidate_total(&c) > candidate_total(&heap[0])) {
+                heap[0] = c;
+                heap_sift_down(heap, k, 0);
+            }
+        }
+    }
+
+    /* 按采样次数从多到少输出 */
+    uint32_t period = atomic_load(&profile_period);
+    for (size_t n = 0; n < used; n++) {
+        size_t best = n;
+        for (size_t j = n + 1; j < used; j++) {
+            if (candidate_total(&heap[j]) > candidate_total(&heap[best])) {
+                best = j;
+            }
+        }
+        profile_candidate_t tmp = heap[n];
+        heap[n] = heap[best];
+        heap[best] = tmp;
+
+        profile_entry_t *e = &entries[n];
+        memset(e, 0, sizeof(*e));
+        e->region_id = heap[n].hist->region_id;
+        memcpy(e->region_name, heap[n].hist->name, PROFILE_NAME_MAX);
+        e->address = atomic_load_explicit(&heap[n].slot->key, memory_order_relaxed) - 1;
+        e->read_samples = heap[n].reads;
+        e->write_samples = heap[n].writes;
+        e->estimated_accesses = candidate_total(&heap[n]) * period;
+    }
+    *count = used;
+
+    pthread_mutex_unlock(&profile_mutex);
+    free(heap);
+
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 以文本形式输出采样次数最多的k个地址
+ *
+ * @param out 输出文件
+ * @param k 输出的个数
+ * @return int 成功返回0，失败返回错误码
+ */
+int profile_dump_top(FILE *out, size_t k) {
+    int ret;
+    size_t count;
+
+    if (!out) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+
+    profile_entry_t *entries = (profile_entry_t *)malloc((k ? k : 1) * sizeof(profile_entry_t));
+    if (!entries) {
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+
+    ret = profile_get_top(entries, k, &count);
+    if (ret == PHYMUTI_SUCCESS) {
+        fprintf(out, "%-4s %-16s %-18s %10s %10s %14s\n", "序号", "区域", "地址", "读采样", "写采样", "估计访问次数");
+        for (size_t i = 0; i < count; i++) {
+            char region[PROFILE_NAME_MAX + 16];
+            snprintf(region, sizeof(region), "%s(%u)", entries[i].region_name, entries[i].region_id);
+            fprintf(out, "%-4zu %-16s 0x%016llx %10llu %10llu %14llu\n", i + 1, region,
+                    (unsigned long long)entries[i].address,
+                    (unsigned long long)entries[i].read_samples,
+                    (unsigned long long)entries[i].write_samples,
+                    (unsigned long long)entries[i].estimated_accesses);
+        }
+        if (ferror(out)) {
+            ret = PHYMUTI_ERROR_IO;
+        }
+    }
+
+    free(entries);
+    return ret;
+}
+
+/**
+ * @brief 获取采样统计信息
+ *
+ * @param stats 统计信息指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int profile_get_stats(profile_stats_t *stats) {
+    int ret;
+
+    if (!stats) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+
+    ret = pthread_mutex_lock(&profile_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    for (const profile_hist_t *hist = atomic_load(&profile_hist_list); hist; hist = hist->next) {
+        stats->samples += atomic_load_explicit(&hist->samples, memory_order_relaxed);
+        stats->dropped += atomic_load_explicit(&hist->dropped, memory_order_relaxed);
+        stats->regions++;
+    }
+
+    ret = pthread_mutex_unlock(&profile_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 清理采样分析模块资源
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+int profile_cleanup(void) {
+    int ret = PHYMUTI_SUCCESS;
+
+    if (atomic_load(&profile_active)) {
+        ret = profile_stop();
+    }
+
+    if (pthread_mutex_lock(&profile_mutex) != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    profile_free_all();
+
+    if (pthread_mutex_unlock(&profile_mutex) != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+
+    return ret;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file spsc_ring.h
+ * @brief 单生产者单消费者无锁环形缓冲区（模块内部使用）
+ *
+ * 生产者只写head，消费者只写tail，两端各自独占一条缓存行，
+ * 入队和出队都不需要加锁。元素大小在初始化时固定，容量向上取2的幂。
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+/* 缓存行大小 */
+#define SPSC_RING_CACHE_LINE 64
+
+/* 环形缓冲区 */
+typedef struct {
+    _Alignas(SPSC_RING_CACHE_LINE) _Atomic size_t head;  /* 下一个写入位置（生产者） */
+    size_t tail_cache;                                   /* 生产者看到的读取位置 */
+    _Alignas(SPSC_RING_CACHE_LINE) _Atomic size_t tail;  /* 下一个读取位置（消费者） */
+    size_t head_cache;                                   /* 消费者看到的写入位置 */
+    _Alignas(SPSC_RING_CACHE_LINE) size_t mask;          /* 容量-1 */
+    size_t elem_size;                                    /* 元素大小 */
+    uint8_t *slots;                                      /* 元素存储 */
+} spsc_ring_t;
+
+/**
+ * @brief 初始化环形缓冲区
+ *
+ * @param ring 环形缓冲区
+ * @param capacity 最小容量（元素个数）
+ * @param elem_size 元素大小
+ * @return int 成功返回0，内存不足返回-1
+ */
+static inline int spsc_ring_init(spsc_ring_t *ring, size_t capacity, size_t elem_size) {
+    size_t cap = 2;
+
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+
+    ring->slots = (uint8_t *)malloc(cap * elem_size);
+    if (!ring->slots) {
+        return -1;
+    }
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->tail_cache = 0;
+    ring->head_cache = 0;
+    ring->mask = cap - 1;
+    ring->elem_size = elem_size;
+    return 0;
+}
+
+/**
+ * @brief 释放环形缓冲区
+ *
+ * @param ring 环形缓冲区
+ */
+static inline void spsc_ring_destroy(spsc_ring_t *ring) {
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+/**
+ * @brief 写入一个元素（仅限生产者线程）
+ *
+ * @param ring 环形缓冲区
+ * @param elem 元素
+ * @return bool 成功返回true，缓冲区已满返回false
+ */
+static inline bool spsc_ring_push(spsc_ring_t *ring, const void *elem) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    /* 只有看起来已满时才重新读取消费者的位置，减少缓存行在两端之间往返 */
+    if (head - ring->tail_cache > ring->mask) {
+        ring->tail_cache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head - ring->tail_cache > ring->mask) {
+            return false;
+        }
+    }
+
+    memcpy(ring->slots + (head & ring->mask) * ring->elem_size, elem, ring->elem_size);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief 批量读取元素（仅限消费者线程）
+ *
+ * @param ring 环形缓冲区
+ * @param out 输出缓冲区
+ * @param max 最多读取的元素个数
+ * @return size_t 实际读取的元素个数
+ */
+static inline size_t spsc_ring_pop_batch(spsc_ring_t *ring, void *out, size_t max) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (ring->head_cache - tail < max) {
+        ring->head_cache = atomic_load_explicit(&ring->head, memory_order_acquire);
+    }
+    size_t count = ring->head_cache - tail;
+
+    if (count > max) {
+        count = max;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        memcpy((uint8_t *)out + i * ring->elem_size,
+               ring->slots + ((tail + i) & ring->mask) * ring->elem_size,
+               ring->elem_size);
+    }
+
+    atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+    return count;
+}
+
+/**
+ * @brief 获取当前元素个数（近似值）
+ *
+ * @param ring 环形缓冲区
+ * @return size_t 元素个数
+ */
+static inline size_t spsc_ring_count(spsc_ring_t *ring) {
+    return atomic_load_explicit(&ring->head, memory_order_acquire) -
+           atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+#endif /* SPSC_RING_H */
@@ -0,0 +1,532 @@
+/**
+ * @file trace.c
+ * @brief 内存访问跟踪模块实现
+ */
+
+#include "trace.h"
+#include "phymuti_error.h"
+#include "spsc_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* 后台线程每批写入的记录数 */
+#define TRACE_WRITE_BATCH 1024
+
+/* 每线程跟踪缓冲区 */
+typedef struct trace_buffer_struct {
+    spsc_ring_t ring;                    /* 记录环形缓冲区 */
+    _Atomic bool in_use;                 /* 是否已被某个线程占用 */
+    _Atomic bool busy;                   /* 所属线程是否正在写入 */
+    pthread_t owner;                     /* 当前占用线程 */
+    uint16_t thread_id;                  /* 当前占用线程的编号 */
+    _Atomic uint64_t recorded;           /* 已记录数（只由所属线程更新） */
+    _Atomic uint64_t dropped;            /* 丢弃数（只由所属线程更新） */
+    struct trace_buffer_struct *next;    /* 下一个缓冲区 */
+} trace_buffer_t;
+
+/* 是否正在记录 */
+static _Atomic bool trace_active = false;
+
+/* 跟踪会话编号，每次trace_start()递增，用于使线程缓存的缓冲区失效 */
+static _Atomic uint32_t trace_generation = 0;
+
+/* 缓冲区链表（只增不减，trace_cleanup()时释放），新节点以原子方式插入表头 */
+static _Atomic(trace_buffer_t *) trace_buffer_list = NULL;
+
+/* 线程缓存的缓冲区 */
+static __thread trace_buffer_t *tl_buffer = NULL;
+static __thread uint32_t tl_generation = 0;
+
+/* 线程退出时归还缓冲区 */
+static pthread_key_t trace_thread_key;
+static pthread_once_t trace_key_once = PTHREAD_ONCE_INIT;
+
+/* 保护开始/停止和缓冲区分配的互斥锁 */
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* 当前会话状态，由trace_mutex保护 */
+static FILE *trace_file = NULL;
+static pthread_t trace_writer;
+static _Atomic bool trace_writer_stop = false;
+static trace_config_t trace_cfg;
+static _Atomic uint32_t trace_thread_count = 0;
+static _Atomic uint64_t trace_written = 0;
+static bool trace_write_failed = false;
+
+/* 上一次会话结束时的统计信息 */
+static trace_stats_t trace_last_stats;
+
+/* 时间基准：记录时只取原始计数，写入文件时再换算为纳秒 */
+static uint64_t trace_tick_base = 0;
+static double trace_ns_per_tick = 1.0;
+
+/**
+ * @brief 读取单调时钟（纳秒）
+ */
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 读取原始时间计数
+ *
+ * x86上直接读TSC，只需几个时钟周期；其他平台退化为单调时钟。
+ */
+static inline uint64_t trace_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return monotonic_ns();
+#endif
+}
+
+/**
+ * @brief 校准时间计数与纳秒的换算比例
+ */
+static void trace_calibrate(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    struct timespec delay = { 0, 5000000 };  /* 5毫秒 */
+    uint64_t ns0 = monotonic_ns();
+    uint64_t tick0 = trace_ticks();
+    nanosleep(&delay, NULL);
+    uint64_t ns1 = monotonic_ns();
+    uint64_t tick1 = trace_ticks();
+
+    trace_ns_per_tick = (tick1 > tick0) ? (double)(ns1 - ns0) / (double)(tick1 - tick0) : 1.0;
+    trace_tick_base = tick1;
+#else
+    trace_ns_per_tick = 1.0;
+    trace_tick_base = trace_ticks();
+#endif
+}
+
+/**
+ * @brief 线程退出时归还缓冲区，已记录的数据仍由后台线程写出
+ *
+ * 缓冲区可能已被trace_cleanup()释放，因此只在链表中仍能找到
+ * 且仍归本线程所有时才归还。
+ */
+static void trace_thread_exit(void *arg) {
+    if (pthread_mutex_lock(&trace_mutex) != 0) {
+        return;
+    }
+
+    for (trace_buffer_t *buf = atomic_load(&trace_buffer_list); buf; buf = buf->next) {
+        if (buf == arg && pthread_equal(buf->owner, pthread_self())) {
+            atomic_store_explicit(&buf->in_use, false, memory_order_release);
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&trace_mutex);
+}
+
+static void trace_create_key(void) {
+    pthread_key_create(&trace_thread_key, trace_thread_exit);
+}
+
+/**
+ * @brief 为调用线程分配缓冲区
+ *
+ * @param generation 当前会话编号
+ * @return trace_buffer_t* 成功返回缓冲区，失败返回NULL
+ */
+static trace_buffer_t* trace_register_thread(uint32_t generation) {
+    trace_buffer_t *buf;
+
+    pthread_once(&trace_key_once, trace_create_key);
+
+    if (pthread_mutex_lock(&trace_mutex) != 0) {
+        return NULL;
+    }
+
+    /* 会话可能刚刚结束 */
+    if (!atomic_load(&trace_active) || atomic_load(&trace_generation) != generation) {
+        pthread_mutex_unlock(&trace_mutex);
+        return NULL;
+    }
+
+    /* 优先复用已退出线程归还的缓冲区 */
+    for (buf = atomic_load(&trace_buffer_list); buf; buf = buf->next) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&buf->in_use, &expected, true)) {
+            break;
+        }
+    }
+
+    if (!buf) {
+        buf = (trace_buffer_t *)calloc(1, sizeof(trace_buffer_t));
+        if (!buf) {
+            pthread_mutex_unlock(&trace_mutex);
+            return NULL;
+        }
+
+        if (spsc_ring_init(&buf->ring, trace_cfg.buffer_records, sizeof(trace_record_t)) != 0) {
+            free(buf);
+            pthread_mutex_unlock(&trace_mutex);
+            return NULL;
+        }
+
+        atomic_init(&buf->in_use, true);
+        atomic_init(&buf->busy, false);
+        buf->next = atomic_load(&trace_buffer_list);
+        atomic_store(&trace_buffer_list, buf);
+    }
+
+    buf->owner = pthread_self();
+    buf->thread_id = (uint16_t)atomic_fetch_add(&trace_thread_count, 1);
+
+    pthread_mutex_unlock(&trace_mutex);
+
+    pthread_setspecific(trace_thread_key, buf);
+    tl_buffer = buf;
+    tl_generation = generation;
+
+    return buf;
+}
+
+/**
+ * @brief 记录一次内存访问
+ */
+void trace_record_access(memory_region_t *region, uint64_t addr, uint32_t size,
+                         uint64_t value, memory_access_type_t access_type) {
+    if (!atomic_load_explicit(&trace_active, memory_order_relaxed)) {
+        return;
+    }
+
+    uint32_t generation = atomic_load_explicit(&trace_generation, memory_order_acquire);
+    trace_buffer_t *buf = tl_buffer;
+    if (!buf || tl_generation != generation) {
+        buf = trace_register_thread(generation);
+        if (!buf) {
+            return;
+        }
+    }
+
+    trace_record_t rec;
+    rec.timestamp = trace_ticks();
+    rec.address = addr;
+    rec.value = value;
+    rec.region_id = memory_region_get_id(region);
+    rec.size = size;
+    rec.thread_id = buf->thread_id;
+    rec.access_type = (uint8_t)access_type;
+    memset(rec.reserved, 0, sizeof(rec.reserved));
+
+    /* 与trace_stop()握手：先声明正在写入，再确认会话仍然有效 */
+    atomic_store(&buf->busy, true);
+    if (atomic_load(&trace_active) && atomic_load(&trace_generation) == generation) {
+        if (spsc_ring_push(&buf->ring, &rec)) {
+            atomic_store_explicit(&buf->recorded,
+                atomic_load_explicit(&buf->recorded, memory_order_relaxed) + 1,
+                memory_order_relaxed);
+        } else {
+            atomic_store_explicit(&buf->dropped,
+                atomic_load_explicit(&buf->dropped, memory_order_relaxed) + 1,
+                memory_order_relaxed);
+        }
+    }
+    atomic_store_explicit(&buf->busy, false, memory_order_release);
+}
+
+/**
+ * @brief 将所有缓冲区中的记录写入文件
+ *
+ * @param batch 临时缓冲区
+ * @return size_t 写出的记录数
+ */
+static size_t trace_drain(trace_record_t *batch) {
+    size_t total = 0;
+
+    for (trace_buffer_t *buf = atomic_load(&trace_buffer_list); buf; buf = buf->next) {
+        size_t n;
+        while ((n = spsc_ring_pop_batch(&buf->ring, batch, TRACE_WRITE_BATCH)) > 0) {
+            /* 换算为相对跟踪开始的纳秒数 */
+            for (size_t i = 0; i < n; i++) {
+                uint64_t ticks = batch[i].timestamp;
+                batch[i].timestamp = ticks > trace_tick_base ?
+                    (uint64_t)((double)(ticks - trace_tick_base) * trace_ns_per_tick) : 0;
+            }
+
+            if (fwrite(batch, sizeof(trace_record_t), n, trace_file) != n) {
+                trace_write_failed = true;
+            }
+            atomic_fetch_add_explicit(&trace_written, n, memory_order_relaxed);
+            total += n;
+        }
+    }
+
+    return total;
+}
+
+/**
+ * @brief 后台写入线程
+ */
+static void* trace_writer_main(void *arg) {
+    (void)arg;
+
+    trace_record_t *batch = (trace_record_t *)malloc(TRACE_WRITE_BATCH * sizeof(trace_record_t));
+    if (!batch) {
+        trace_write_failed = true;
+        return NULL;
+    }
+
+    while (!atomic_load(&trace_writer_stop)) {
+        if (trace_drain(batch) == 0) {
+            usleep(trace_cfg.flush_interval_us);
+        }
+    }
+
+    free(batch);
+    return NULL;
+}
+
+/**
+ * @brief 汇总当前会话的统计信息
+ */
+static void trace_collect_stats(trace_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    for (trace_buffer_t *buf = atomic_load(&trace_buffer_list); buf; buf = buf->next) {
+        stats->recorded += atomic_load_explicit(&buf->recorded, memory_order_relaxed);
+        stats->dropped += atomic_load_explicit(&buf->dropped, memory_order_relaxed);
+    }
+
+    stats->written = atomic_load(&trace_written);
+    stats->threads = atomic_load(&trace_thread_count);
+}
+
+/**
+ * @brief 开始记录内存访问
+ *
+ * @param path 跟踪文件路径
+ * @param config 跟踪配置
+ * @return int 成功返回0，失败返回错误码
+ */
+int trace_start(const char *path, const trace_config_t *config) {
+    int ret;
+
+    if (!path) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+
+    ret = pthread_mutex_lock(&trace_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    if (atomic_load(&trace_active)) {
+        pthread_mutex_unlock(&trace_mutex);
+        return PHYMUTI_ERROR_TRACE_ACTIVE;
+    }
+
+    trace_cfg.buffer_records = TRACE_DEFAULT_BUFFER_RECORDS;
+    trace_cfg.flush_interval_us = TRACE_DEFAULT_FLUSH_INTERVAL_US;
+    if (config) {
+        if (config->buffer_records > 0) {
+            trace_cfg.buffer_records = config->buffer_records;
+        }
+        if (config->flush_interval_us > 0) {
+            trace_cfg.flush_interval_us = config->flush_interval_us;
+        }
+    }
+
+    trace_file = fopen(path, "wb");
+    if (!trace_file) {
+        pthread_mutex_unlock(&trace_mutex);
+        return PHYMUTI_ERROR_IO;
+    }
+
+    trace_calibrate();
+
+    trace_file_header_t header;
+    struct timespec now;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_FILE_VERSION;
+    header.record_size = sizeof(trace_record_t);
+    clock_gettime(CLOCK_REALTIME, &now);
+    header.start_realtime = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+
+    if (fwrite(&header, sizeof(header), 1, trace_file) != 1) {
+        fclose(trace_file);
+        trace_file = NULL;
+        pthread_mutex_unlock(&trace_mutex);
+        return PHYMUTI_ERROR_IO;
+    }
+
+    /* 丢弃上一次会话的缓冲区归属，所有线程在首次访问时重新登记。
+       缓冲区容量以首次分配时为准 */
+    for (trace_buffer_t *buf = atomic_load(&trace_buffer_list); buf; buf = buf->next) {
+        atomic_store(&buf->in_use, false);
+        atomic_store(&buf->recorded, 0);
+        atomic_store(&buf->dropped, 0);
+    }
+    atomic_store(&trace_thread_count, 0);
+    atomic_store(&trace_written, 0);
+    trace_write_failed = false;
+
+    atomic_store(&trace_writer_stop, false);
+    ret = pthread_create(&trace_writer, NULL, trace_writer_main, NULL);
+    if (ret != 0) {
+        fclose(trace_file);
+        trace_file = NULL;
+        pthread_mutex_unlock(&trace_mutex);
+        return PHYMUTI_ERROR_INTERNAL;
+    }
+
+    atomic_fetch_add(&trace_generation, 1);
+    atomic_store(&trace_active, true);
+
+    ret = pthread_mutex_unlock(&trace_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 停止记录
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+int trace_stop(void) {
+    int ret;
+    int result = PHYMUTI_SUCCESS;
+
+    ret = pthread_mutex_lock(&trace_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    if (!atomic_load(&trace_active)) {
+        pthread_mutex_unlock(&trace_mutex);
+        return PHYMUTI_ERROR_TRACE_NOT_ACTIVE;
+    }
+
+    atomic_store(&trace_active, false);
+
+    /* 等待正在写入的线程完成，之后不会再有新记录进入缓冲区 */
+    for (trace_buffer_t *buf = atomic_load(&trace_buffer_list); buf; buf = buf->next) {
+        while (atomic_load(&buf->busy)) {
+            sched_yield();
+        }
+    }
+
+    atomic_store(&trace_writer_stop, true);
+    pthread_join(trace_writer, NULL);
+
+    /* 写出剩余记录 */
+    trace_record_t *batch = (trace_record_t *)malloc(TRACE_WRITE_BATCH * sizeof(trace_record_t));
+    if (batch) {
+        trace_drain(batch);
+        free(batch);
+    } else {
+        result = PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+
+    if (fclose(trace_file) != 0 || trace_write_failed) {
+        result = PHYMUTI_ERROR_IO;
+    }
+    trace_file = NULL;
+
+    trace_collect_stats(&trace_last_stats);
+
+    ret = pthread_mutex_unlock(&trace_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+
+    return result;
+}
+
+/**
+ * @brief 查询是否正在记录
+ *
+ * @return bool 正在记录返回true
+ */
+bool trace_is_active(void) {
+    return atomic_load(&trace_active);
+}
+
+/**
+ * @brief 获取跟踪统计信息
+ *
+ * 记录期间返回当前会话的实时统计，停止后返回最近一次会话的统计。
+ *
+ * @param stats 统计信息指针
+ * @return int 成功返回0，失败返回错误码
+ */
+int trace_get_stats(trace_stats_t *stats) {
+    int ret;
+
+    if (!stats) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+
+    ret = pthread_mutex_lock(&trace_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    if (atomic_load(&trace_active)) {
+        trace_collect_stats(stats);
+    } else {
+        *stats = trace_last_stats;
+    }
+
+    ret = pthread_mutex_unlock(&trace_mutex);
+    if (ret != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 清理跟踪模块资源
+ *
+ * 调用时不应再有线程访问内存区域。
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+int trace_cleanup(void) {
+    int ret = PHYMUTI_SUCCESS;
+
+    if (atomic_load(&trace_active)) {
+        ret = trace_stop();
+    }
+
+    if (pthread_mutex_lock(&trace_mutex) != 0) {
+        return PHYMUTI_ERROR_MUTEX_LOCK_FAILED;
+    }
+
+    trace_buffer_t *buf = atomic_exchange(&trace_buffer_list, NULL);
+    while (buf) {
+        trace_buffer_t *next = buf->next;
+        spsc_ring_destroy(&buf->ring);
+        free(buf);
+        buf = next;
+    }
+
+    /* 使所有线程缓存的缓冲区指针失效 */
+    atomic_fetch_add(&trace_generation, 1);
+
+    if (pthread_mutex_unlock(&trace_mutex) != 0) {
+        return PHYMUTI_ERROR_MUTEX_UNLOCK_FAILED;
+    }
+
+    return ret;
+}
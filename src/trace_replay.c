@@ -0,0 +1,393 @@
+/**
+ * @file trace_replay.c
+ * @brief 访问跟踪回放模块实现
+ */
+
+#include "trace_replay.h"
+#include "phymuti_error.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* 区域ID上限，超过视为文件损坏 */
+#define TRACE_REPLAY_MAX_REGION_ID (1u << 20)
+
+/* 按时间戳回放时，超前多少纳秒以上才睡眠等待 */
+#define TRACE_REPLAY_SLEEP_THRESHOLD_NS 20000
+
+/* 回放线程上下文 */
+typedef struct {
+    const trace_record_t *records;   /* 全部记录 */
+    const uint32_t *indices;         /* 本线程负责的记录下标，为NULL时回放全部记录 */
+    size_t count;                    /* 本线程负责的记录数 */
+    memory_region_t **regions;       /* 区域ID到内存区域的映射表 */
+    uint32_t region_count;           /* 映射表大小 */
+    const trace_replay_config_t *config;
+    uint64_t start_ns;               /* 回放开始时间，多线程时所有线程等到此时刻同时开始 */
+    atomic_bool *abort;              /* 启动失败时通知已创建的线程退出 */
+    uint64_t replayed;
+    uint64_t skipped;
+    uint64_t failed;
+} trace_replay_worker_t;
+
+/**
+ * @brief 读取单调时钟（纳秒）
+ */
+static uint64_t replay_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 等待直到指定时刻
+ */
+static void replay_wait_until(uint64_t deadline_ns) {
+    uint64_t now = replay_now_ns();
+
+    if (deadline_ns > now + TRACE_REPLAY_SLEEP_THRESHOLD_NS) {
+        struct timespec ts;
+        ts.tv_sec = (time_t)(deadline_ns / 1000000000ULL);
+        ts.tv_nsec = (long)(deadline_ns % 1000000000ULL);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        }
+    }
+}
+
+/**
+ * @brief 重新发起一次访问
+ *
+ * @param region 内存区域
+ * @param rec 跟踪记录
+ * @param scratch 块访问临时缓冲区
+ * @param scratch_size 临时缓冲区大小
+ * @return int 成功返回0，失败返回错误码
+ */
+static int replay_access(memory_region_t *region, const trace_record_t *rec,
+                         uint8_t **scratch, size_t *scratch_size) {
+    bool write = (rec->access_type == MEMORY_ACCESS_WRITE);
+
+    switch (rec->size) {
+        case 1:
+            if (write) {
+                return memory_write_byte(region, rec->address, (uint8_t)rec->value);
+            } else {
+                uint8_t v;
+                return memory_read_byte(region, rec->address, &v);
+            }
+
+        case 2:
+            if (write) {
+                return memory_write_halfword(region, rec->address, (uint16_t)rec->value);
+            } else {
+                uint16_t v;
+                return memory_read_halfword(region, rec->address, &v);
+            }
+
+        case 4:
+            if (write) {
+                return memory_write_word(region, rec->address, (uint32_t)rec->value);
+            } else {
+                uint32_t v;
+                return memory_read_word(region, rec->address, &v);
+            }
+
+        case 8:
+            if (write) {
+                return memory_write_doubleword(region, rec->address, rec->value);
+            } else {
+                uint64_t v;
+                return memory_read_doubleword(region, rec->address, &v);
+            }
+
+        default:
+            break;
+    }
+
+    /* 块访问：数据内容未被记录，使用全零临时缓冲区 */
+    if (*scratch_size < rec->size) {
+        uint8_t *buf = (uint8_t *)calloc(rec->size, 1);
+        if (!buf) {
+            return PHYMUTI_ERROR_OUT_OF_MEMORY;
+        }
+        free(*scratch);
+        *scratch = buf;
+        *scratch_size = rec->size;
+    }
+
+    if (write) {
+        memset(*scratch, 0, rec->size);
+        return memory_write_buffer(region, rec->address, *scratch, rec->size);
+    }
+    return memory_read_buffer(region, rec->address, *scratch, rec->size);
+}
+
+/**
+ * @brief 回放线程
+ */
+static void* replay_worker_main(void *arg) {
+    trace_replay_worker_t *w = (trace_replay_worker_t *)arg;
+    bool paced = (w->config->pacing == TRACE_REPLAY_PACED);
+    double speed = w->config->speed > 0 ? w->config->speed : 1.0;
+    uint8_t *scratch = NULL;
+    size_t scratch_size = 0;
+
+    if (w->abort) {
+        replay_wait_until(w->start_ns);
+        if (atomic_load(w->abort)) {
+            return NULL;
+        }
+    }
+
+    for (size_t i = 0; i < w->count; i++) {
+        const trace_record_t *rec = &w->records[w->indices ? w->indices[i] : i];
+
+        memory_region_t *region = rec->region_id < w->region_count ? w->regions[rec->region_id] : NULL;
+        if (!region || (rec->access_type != MEMORY_ACCESS_READ &&
+                        rec->access_type != MEMORY_ACCESS_WRITE)) {
+            w->skipped++;
+            continue;
+        }
+
+        if (paced) {
+            replay_wait_until(w->start_ns + (uint64_t)((double)rec->timestamp / speed));
+        }
+
+        if (replay_access(region, rec, &scratch, &scratch_size) == PHYMUTI_SUCCESS) {
+            w->replayed++;
+        } else {
+            w->failed++;
+        }
+    }
+
+    free(scratch);
+    return NULL;
+}
+
+/**
+ * @brief 建立区域ID到内存区域的映射表，回放期间不再查找
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+static int replay_build_region_table(const trace_record_t *records, size_t count,
+                                     const trace_replay_config_t *config,
+                                     memory_region_t ***table, uint32_t *table_size) {
+    uint32_t max_id = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (records[i].region_id > max_id) {
+            max_id = records[i].region_id;
+        }
+    }
+
+    if (max_id >= TRACE_REPLAY_MAX_REGION_ID) {
+        return PHYMUTI_ERROR_TRACE_FORMAT;
+    }
+
+    memory_region_t **regions = (memory_region_t **)calloc(max_id + 1, sizeof(memory_region_t *));
+    bool *resolved = (bool *)calloc(max_id + 1, sizeof(bool));
+    if (!regions || !resolved) {
+        free(regions);
+        free(resolved);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t id = records[i].region_id;
+        if (resolved[id]) {
+            continue;
+        }
+        regions[id] = config->resolver ? config->resolver(id, config->resolver_data)
+                                       : memory_region_find_by_id(id);
+        resolved[id] = true;
+    }
+
+    free(resolved);
+    *table = regions;
+    *table_size = max_id + 1;
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 按记录线程编号把记录分配给回放线程
+ *
+ * @return int 成功返回0，失败返回错误码
+ */
+static int replay_partition(const trace_record_t *records, size_t count,
+                            trace_replay_worker_t *workers, uint32_t nworkers,
+                            uint32_t **index_storage) {
+    uint32_t *storage = (uint32_t *)malloc(count * sizeof(uint32_t));
+    size_t *offsets = (size_t *)calloc(nworkers + 1, sizeof(size_t));
+    if (!storage || !offsets) {
+        free(storage);
+        free(offsets);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* 先计数再填充，保持每个回放线程内的原始顺序 */
+    for (size_t i = 0; i < count; i++) {
+        offsets[records[i].thread_id % nworkers + 1]++;
+    }
+    for (uint32_t w = 0; w < nworkers; w++) {
+        offsets[w + 1] += offsets[w];
+        workers[w].indices = storage + offsets[w];
+        workers[w].count = 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        trace_replay_worker_t *w = &workers[records[i].thread_id % nworkers];
+        storage[(w->indices - storage) + w->count++] = (uint32_t)i;
+    }
+
+    free(offsets);
+    *index_storage = storage;
+    return PHYMUTI_SUCCESS;
+}
+
+/**
+ * @brief 回放跟踪文件
+ *
+ * @param path 跟踪文件路径
+ * @param config 回放配置
+ * @param stats 回放统计信息
+ * @return int 成功返回0，失败返回错误码
+ */
+int trace_replay_file(const char *path, const trace_replay_config_t *config,
+                      trace_replay_stats_t *stats) {
+    trace_replay_config_t default_config = { .pacing = TRACE_REPLAY_MAX_SPEED, .speed = 1.0 };
+    struct stat st;
+    int ret;
+
+    if (!path) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    if (!config) {
+        config = &default_config;
+    }
+
+    /* 映射整个文件，回放时直接读取记录 */
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return PHYMUTI_ERROR_IO;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(trace_file_header_t)) {
+        close(fd);
+        return PHYMUTI_ERROR_TRACE_FORMAT;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return PHYMUTI_ERROR_IO;
+    }
+
+    const trace_file_header_t *header = (const trace_file_header_t *)map;
+    size_t payload = (size_t)st.st_size - sizeof(trace_file_header_t);
+    if (memcmp(header->magic, TRACE_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != TRACE_FILE_VERSION ||
+        header->record_size != sizeof(trace_record_t) ||
+        payload % sizeof(trace_record_t) != 0) {
+        munmap(map, (size_t)st.st_size);
+        return PHYMUTI_ERROR_TRACE_FORMAT;
+    }
+
+    const trace_record_t *records = (const trace_record_t *)(header + 1);
+    size_t count = payload / sizeof(trace_record_t);
+    uint32_t nworkers = config->threads > 1 ? config->threads : 1;
+
+    memory_region_t **regions = NULL;
+    uint32_t region_count = 0;
+    ret = replay_build_region_table(records, count, config, &regions, &region_count);
+    if (ret != PHYMUTI_SUCCESS) {
+        munmap(map, (size_t)st.st_size);
+        return ret;
+    }
+
+    trace_replay_worker_t *workers = (trace_replay_worker_t *)calloc(nworkers, sizeof(trace_replay_worker_t));
+    if (!workers) {
+        free(regions);
+        munmap(map, (size_t)st.st_size);
+        return PHYMUTI_ERROR_OUT_OF_MEMORY;
+    }
+
+    for (uint32_t w = 0; w < nworkers; w++) {
+        workers[w].records = records;
+        workers[w].indices = NULL;
+        workers[w].count = count;
+        workers[w].regions = regions;
+        workers[w].region_count = region_count;
+        workers[w].config = config;
+    }
+
+    uint32_t *index_storage = NULL;
+    atomic_bool abort_flag = false;
+    uint64_t start_ns, end_ns;
+
+    if (nworkers == 1) {
+        start_ns = replay_now_ns();
+        workers[0].start_ns = start_ns;
+        replay_worker_main(&workers[0]);
+        end_ns = replay_now_ns();
+    } else {
+        pthread_t *threads = (pthread_t *)calloc(nworkers, sizeof(pthread_t));
+        ret = threads ? replay_partition(records, count, workers, nworkers, &index_storage)
+                      : PHYMUTI_ERROR_OUT_OF_MEMORY;
+        if (ret != PHYMUTI_SUCCESS) {
+            free(threads);
+            free(workers);
+            free(regions);
+            munmap(map, (size_t)st.st_size);
+            return ret;
+        }
+
+        /* 所有线程等到同一时刻开始，计时不包含线程创建 */
+        start_ns = replay_now_ns() + 1000000;  /* 留出1毫秒启动余量 */
+        uint32_t created = 0;
+        for (uint32_t w = 0; w < nworkers; w++) {
+            workers[w].start_ns = start_ns;
+            workers[w].abort = &abort_flag;
+            if (pthread_create(&threads[w], NULL, replay_worker_main, &workers[w]) != 0) {
+                atomic_store(&abort_flag, true);
+                ret = PHYMUTI_ERROR_INTERNAL;
+                break;
+            }
+            created++;
+        }
+
+        for (uint32_t w = 0; w < created; w++) {
+            pthread_join(threads[w], NULL);
+        }
+        end_ns = replay_now_ns();
+        if (end_ns < start_ns) {
+            end_ns = start_ns;
+        }
+        free(threads);
+    }
+
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+        stats->records = count;
+        for (uint32_t w = 0; w < nworkers; w++) {
+            stats->replayed += workers[w].replayed;
+            stats->skipped += workers[w].skipped;
+            stats->failed += workers[w].failed;
+        }
+        stats->elapsed_ns = end_ns - start_ns;
+        stats->accesses_per_sec = stats->elapsed_ns > 0 ?
+            (double)stats->replayed * 1e9 / (double)stats->elapsed_ns : 0.0;
+    }
+
+    free(index_storage);
+    free(workers);
+    free(regions);
+    munmap(map, (size_t)st.st_size);
+
+    return ret;
+}
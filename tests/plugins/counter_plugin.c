@@ -0,0 +1,66 @@
+/**
+ * @file counter_plugin.c
+ * @brief 测试用计数插件：统计上下文个数和值的和
+ */
+
+#include "action_plugin.h"
+#include "counter_plugin.h"
+#include <stdio.h>
+#include <time.h>
+
+static int counter_init(const char *args, void **state) {
+    void *result = NULL;
+
+    /* 没有参数时拒绝创建，用于测试init()失败的处理 */
+    if (!args || sscanf(args, "%p", &result) != 1 || !result) {
+        return -1;
+    }
+    *state = result;
+    return 0;
+}
+
+static int counter_execute(void *state, const monitor_context_t *context) {
+    counter_plugin_result_t *result = (counter_plugin_result_t *)state;
+
+    __atomic_fetch_add(&result->events, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&result->value_sum, context->value, __ATOMIC_RELAXED);
+
+    if (context->address == COUNTER_PLUGIN_SLOW_ADDRESS) {
+        struct timespec ts = { 0, 100000000 };
+        __atomic_fetch_add(&result->in_flight, 1, __ATOMIC_SEQ_CST);
+        nanosleep(&ts, NULL);
+        /* teardown()不能早于本次调用结束 */
+        if (__atomic_load_n(&result->torn_down, __ATOMIC_SEQ_CST)) {
+            return -1;
+        }
+        __atomic_fetch_sub(&result->in_flight, 1, __ATOMIC_SEQ_CST);
+    }
+    return 0;
+}
+
+static int counter_execute_batch(void *state, const monitor_context_t *contexts, size_t count) {
+    counter_plugin_result_t *result = (counter_plugin_result_t *)state;
+
+    __atomic_fetch_add(&result->batches, 1, __ATOMIC_RELAXED);
+    for (size_t i = 0; i < count; i++) {
+        counter_execute(state, &contexts[i]);
+    }
+    return 0;
+}
+
+static void counter_teardown(void *state) {
+    __atomic_store_n(&((counter_plugin_result_t *)state)->torn_down, 1, __ATOMIC_SEQ_CST);
+}
+
+static const action_plugin_t counter_plugin = {
+    .abi_version = ACTION_PLUGIN_ABI_VERSION,
+    .name = "counter",
+    .init = counter_init,
+    .execute = counter_execute,
+    .execute_batch = counter_execute_batch,
+    .teardown = counter_teardown,
+};
+
+const action_plugin_t *phymuti_action_plugin(void) {
+    return &counter_plugin;
+}
@@ -0,0 +1,23 @@
+/**
+ * @file counter_plugin.h
+ * @brief 测试用计数插件与测试程序共享的结果结构
+ */
+
+#ifndef COUNTER_PLUGIN_H
+#define COUNTER_PLUGIN_H
+
+#include <stdint.h>
+
+/* 上下文地址为该值时execute()在返回前等待约100毫秒，用于测试执行中销毁 */
+#define COUNTER_PLUGIN_SLOW_ADDRESS 0xdead0000ULL
+
+/* 计数结果，测试程序把它的地址以"%p"格式作为插件参数传入 */
+typedef struct {
+    uint64_t events;      /* 处理的上下文数 */
+    uint64_t batches;     /* execute_batch()调用次数 */
+    uint64_t value_sum;   /* 上下文中值的和 */
+    int torn_down;        /* teardown()是否已调用 */
+    int in_flight;        /* 正在执行的慢调用数 */
+} counter_plugin_result_t;
+
+#endif /* COUNTER_PLUGIN_H */
@@ -0,0 +1,569 @@
+/**
+ * @file test_action.c
+ * @brief PhyMuTi动作管理测试程序
+ */
+
+#include "phymuti.h"
+#include "plugins/counter_plugin.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <libgen.h>
+#include <pthread.h>
+#include <signal.h>
+
+/* 测试内存区域 */
+#define TEST_BASE 0x40000000ULL
+#define TEST_SIZE 0x10000
+
+/* 测试插件相对于测试程序所在目录的路径 */
+#define TEST_PLUGIN_PATH "../plugins/counter_plugin.so"
+
+/* 测试程序所在目录 */
+static char test_dir[512];
+
+/* 获取单调时间（纳秒） */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* 执行中销毁测试的执行线程参数 */
+typedef struct {
+    action_id_t action;
+    int result;
+} slow_execute_t;
+
+/* 执行线程：执行一次慢调用 */
+static void* slow_execute_thread(void *arg) {
+    slow_execute_t *slow = (slow_execute_t *)arg;
+    monitor_context_t context;
+    memset(&context, 0, sizeof(context));
+    context.address = COUNTER_PLUGIN_SLOW_ADDRESS;
+    slow->result = action_execute(slow->action, &context);
+    return NULL;
+}
+
+/* 另一个线程正在执行插件时销毁动作，插件在调用结束后才卸载 */
+static int test_plugin_destroy_during_execute(const char *path) {
+    char args[64];
+    counter_plugin_result_t result;
+
+    memset(&result, 0, sizeof(result));
+    snprintf(args, sizeof(args), "%p", (void *)&result);
+    slow_execute_t slow = { .action = action_create_plugin(path, args), .result = -1 };
+    if (slow.action == ACTION_INVALID_ID) {
+        fprintf(stderr, "创建插件动作失败\n");
+        return 1;
+    }
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, slow_execute_thread, &slow);
+    while (__atomic_load_n(&result.in_flight, __ATOMIC_SEQ_CST) == 0) {
+        struct timespec ts = { 0, 1000000 };
+        nanosleep(&ts, NULL);
+    }
+
+    int destroy_ret = action_destroy(slow.action);
+    int torn_down_early = __atomic_load_n(&result.torn_down, __ATOMIC_SEQ_CST);
+    pthread_join(thread, NULL);
+
+    if (destroy_ret != PHYMUTI_SUCCESS || torn_down_early || slow.result != PHYMUTI_SUCCESS ||
+        !result.torn_down || result.in_flight != 0) {
+        fprintf(stderr, "执行中销毁插件动作错误\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* 插件动作：加载、按监视点执行、批量执行、销毁时卸载 */
+static int test_plugin(memory_region_t *region) {
+    char path[1024];
+    char args[64];
+    counter_plugin_result_t result;
+
+    snprintf(path, sizeof(path), "%s/%s", test_dir, TEST_PLUGIN_PATH);
+    memset(&result, 0, sizeof(result));
+    snprintf(args, sizeof(args), "%p", (void *)&result);
+
+    /* 共享库不存在、init()失败时创建失败，错误码说明原因 */
+    action_id_t bad_id;
+    if (action_create_plugin("no_such_plugin.so", args) != ACTION_INVALID_ID ||
+        action_create_plugin(path, NULL) != ACTION_INVALID_ID ||
+        action_load_plugin("no_such_plugin.so", args, &bad_id) != PHYMUTI_ERROR_IO ||
+        action_load_plugin(path, NULL, &bad_id) != PHYMUTI_ERROR_ACTION_EXECUTE_FAILED) {
+        fprintf(stderr, "无效插件未被拒绝\n");
+        return 1;
+    }
+
+    action_id_t action = action_create_plugin(path, args);
+    action_type_t type;
+    if (action == ACTION_INVALID_ID || action_get_type(action, &type) != PHYMUTI_SUCCESS ||
+        type != ACTION_TYPE_PLUGIN) {
+        fprintf(stderr, "创建插件动作失败\n");
+        return 1;
+    }
+
+    monitor_id_t id = monitor_add_watchpoint(region, TEST_BASE + 0x100, 4, WATCHPOINT_WRITE, 0);
+    if (id == MONITOR_INVALID_ID || monitor_bind_action(id, action) != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "绑定插件动作失败\n");
+        return 1;
+    }
+    for (uint32_t i = 1; i <= 10; i++) {
+        memory_write_word(region, TEST_BASE + 0x100, i);
+    }
+    if (result.events != 10 || result.value_sum != 55) {
+        fprintf(stderr, "插件动作执行错误: %llu 次，和 %llu\n",
+                (unsigned long long)result.events, (unsigned long long)result.value_sum);
+        return 1;
+    }
+
+    /* 批量执行只调用一次插件的execute_batch() */
+    uint64_t batches = result.batches;
+    monitor_context_t contexts[5];
+    memset(contexts, 0, sizeof(contexts));
+    for (int i = 0; i < 5; i++) {
+        contexts[i].value = 100;
+    }
+    if (action_execute_batch(action, contexts, 5) != PHYMUTI_SUCCESS ||
+        result.batches != batches + 1 || result.events != 15 || result.value_sum != 555) {
+        fprintf(stderr, "插件批量执行错误\n");
+        return 1;
+    }
+
+    /* 每次受监视写入的耗时 */
+    const int iterations = 100000;
+    uint64_t start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        memory_write_word(region, TEST_BASE + 0x100, (uint32_t)i);
+    }
+    double write_ns = (double)(now_ns() - start) / iterations;
+
+    monitor_remove_watchpoint(id);
+    if (action_destroy(action) != PHYMUTI_SUCCESS || !result.torn_down ||
+        result.events != 15 + (uint64_t)iterations) {
+        fprintf(stderr, "销毁插件动作错误\n");
+        return 1;
+    }
+
+    if (test_plugin_destroy_during_execute(path) != 0) {
+        return 1;
+    }
+
+    printf("插件动作测试通过：每次受监视写入耗时 %.1f 纳秒\n", write_ns);
+    return 0;
+}
+
+/* 执行顺序记录 */
+#define ORDER_MAX 16
+static action_id_t order[ORDER_MAX];
+static int order_count;
+
+/* 记录执行顺序的回调，用户数据为动作ID */
+static int order_callback(const monitor_context_t *context, void *user_data) {
+    (void)context;
+    if (order_count < ORDER_MAX) {
+        order[order_count] = (action_id_t)(uintptr_t)user_data;
+    }
+    order_count++;
+    return PHYMUTI_SUCCESS;
+}
+
+/* 批量回调：累计收到的上下文数 */
+static size_t batch_contexts;
+static int batch_callback(const monitor_context_t *contexts, size_t count, void *user_data) {
+    (void)contexts;
+    (void)user_data;
+    batch_contexts += count;
+    return PHYMUTI_SUCCESS;
+}
+
+/* 速率限制测试的写入次数 */
+#define FLOOD_WRITES 2000
+
+/* 优先级和速率限制：洪泛时高优先级动作全部执行，低优先级动作限流并计数 */
+static int test_rate_limit(memory_region_t *region) {
+    const uint64_t addr = TEST_BASE + 0x200;
+    action_id_t low = action_create_callback(order_callback, NULL);
+    action_id_t normal = action_create_callback(order_callback, NULL);
+    action_id_t high = action_create_callback(order_callback, NULL);
+    action_id_t command = action_create_command("true");
+    action_set_user_data(low, (void *)(uintptr_t)low);
+    action_set_user_data(normal, (void *)(uintptr_t)normal);
+    action_set_user_data(high, (void *)(uintptr_t)high);
+
+    action_rate_limit_t limit = { .rate = 10, .burst = 5 };
+    action_rate_limit_t one = { .rate = 1, .burst = 1 };
+    if (action_set_priority(low, ACTION_PRIORITY_LOW) != PHYMUTI_SUCCESS ||
+        action_set_priority(high, ACTION_PRIORITY_HIGH) != PHYMUTI_SUCCESS ||
+        action_set_priority(command, ACTION_PRIORITY_LOW) != PHYMUTI_SUCCESS ||
+        action_set_rate_limit(low, &limit) != PHYMUTI_SUCCESS ||
+        action_set_rate_limit(high, &one) != PHYMUTI_SUCCESS ||
+        action_set_rate_limit(command, &one) != PHYMUTI_SUCCESS ||
+        action_set_priority(high, (action_priority_t)7) != PHYMUTI_ERROR_INVALID_PARAM) {
+        fprintf(stderr, "设置优先级或速率限制失败\n");
+        return 1;
+    }
+
+    /* 按低、普通、高的顺序绑定，执行时应按高、普通、低的顺序 */
+    monitor_id_t id = monitor_add_watchpoint(region, addr, 4, WATCHPOINT_WRITE, 0);
+    if (id == MONITOR_INVALID_ID || monitor_bind_action(id, low) != PHYMUTI_SUCCESS ||
+        monitor_bind_action(id, normal) != PHYMUTI_SUCCESS || monitor_bind_action(id, high) != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "绑定动作失败\n");
+        return 1;
+    }
+    order_count = 0;
+    memory_write_word(region, addr, 1);
+    if (order_count != 3 || order[0] != high || order[1] != normal || order[2] != low) {
+        fprintf(stderr, "动作未按优先级执行\n");
+        return 1;
+    }
+
+    /* 延迟模式下一轮中的多次触发也是先执行完高优先级动作 */
+    monitor_deferred_config_t config = { .log_entries = 64, .batch_size = 64, .max_latency_us = 1000000 };
+    monitor_set_deferred(&config);
+    order_count = 0;
+    for (uint32_t i = 0; i < 3; i++) {
+        memory_write_word(region, addr, i);
+    }
+    monitor_drain_deferred();
+    monitor_set_deferred(NULL);
+    if (order_count != 9 || order[0] != high || order[2] != high || order[3] != normal ||
+        order[5] != normal || order[6] != low || order[8] != low) {
+        fprintf(stderr, "延迟模式下动作未按优先级执行\n");
+        return 1;
+    }
+
+    /* 洪泛：命令动作每次都要创建子进程，限流后写入耗时仍然很短 */
+    if (monitor_bind_action(id, command) != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "绑定命令动作失败\n");
+        return 1;
+    }
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < FLOOD_WRITES; i++) {
+        memory_write_word(region, addr, i);
+    }
+    double elapsed_ms = (double)(now_ns() - start) / 1e6;
+    monitor_remove_watchpoint(id);
+
+    action_rate_stats_t low_stats, high_stats, command_stats;
+    action_get_rate_stats(low, &low_stats);
+    action_get_rate_stats(high, &high_stats);
+    action_get_rate_stats(command, &command_stats);
+
+    /* 桶容量5，洪泛持续时间内最多再补充少量令牌 */
+    uint64_t low_budget = 5 + (uint64_t)(elapsed_ms * 10 / 1000) + 1;
+    if (high_stats.executed != FLOOD_WRITES + 4 || high_stats.throttled != 0 ||
+        low_stats.executed + low_stats.throttled != FLOOD_WRITES + 4 || low_stats.executed > low_budget ||
+        command_stats.executed + command_stats.throttled != FLOOD_WRITES || command_stats.executed < 1) {
+        fprintf(stderr, "速率限制错误: 高 %llu/%llu，低 %llu/%llu\n",
+                (unsigned long long)high_stats.executed, (unsigned long long)high_stats.throttled,
+                (unsigned long long)low_stats.executed, (unsigned long long)low_stats.throttled);
+        return 1;
+    }
+
+    /* 桶空时直接执行返回限流错误 */
+    monitor_context_t context;
+    memset(&context, 0, sizeof(context));
+    if (action_execute(low, &context) != PHYMUTI_ERROR_ACTION_THROTTLED) {
+        fprintf(stderr, "限流时执行未被拒绝\n");
+        return 1;
+    }
+
+    /* 批量动作只收到有令牌的前若干个上下文 */
+    action_id_t batch = action_create_batch_callback(batch_callback, NULL);
+    monitor_context_t contexts[8];
+    memset(contexts, 0, sizeof(contexts));
+    limit.burst = 3;
+    batch_contexts = 0;
+    action_rate_stats_t batch_stats;
+    if (action_set_rate_limit(batch, &limit) != PHYMUTI_SUCCESS ||
+        action_execute_batch(batch, contexts, 8) != PHYMUTI_SUCCESS || batch_contexts != 3 ||
+        action_get_rate_stats(batch, &batch_stats) != PHYMUTI_SUCCESS ||
+        batch_stats.executed != 3 || batch_stats.throttled != 5) {
+        fprintf(stderr, "批量动作限流错误\n");
+        return 1;
+    }
+
+    /* 取消限制后不再丢弃 */
+    action_set_rate_limit(low, NULL);
+    if (action_execute(low, &context) != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "取消速率限制失败\n");
+        return 1;
+    }
+
+    action_destroy(low);
+    action_destroy(normal);
+    action_destroy(high);
+    action_destroy(command);
+    action_destroy(batch);
+
+    printf("速率限制测试通过：%d 次写入用时 %.1f 毫秒，低优先级执行 %llu 次、丢弃 %llu 次\n",
+           FLOOD_WRITES, elapsed_ms, (unsigned long long)low_stats.executed,
+           (unsigned long long)low_stats.throttled);
+    return 0;
+}
+
+/* 计数回调 */
+static int callback_count;
+static int count_callback(const monitor_context_t *context, void *user_data) {
+    (void)context;
+    (void)user_data;
+    __atomic_fetch_add(&callback_count, 1, __ATOMIC_RELAXED);
+    return PHYMUTI_SUCCESS;
+}
+
+/* 异步执行：等待、查询、超时终止、取消 */
+static int test_futures(void) {
+    monitor_context_t context;
+    memset(&context, 0, sizeof(context));
+    int result = 0;
+    bool done;
+
+    /* 回调动作在工作线程中执行 */
+    action_id_t callback = action_create_callback(count_callback, NULL);
+    callback_count = 0;
+    action_future_t *future = action_submit(callback, &context, 0);
+    if (!future || action_future_wait(future, ACTION_WAIT_FOREVER, &result) != PHYMUTI_SUCCESS ||
+        result != PHYMUTI_SUCCESS || callback_count != 1 ||
+        action_future_poll(future, &done, NULL) != PHYMUTI_SUCCESS || !done ||
+        action_future_cancel(future) != PHYMUTI_ERROR_BUSY) {
+        fprintf(stderr, "异步执行回调动作失败\n");
+        return 1;
+    }
+    action_future_destroy(future);
+
+    /* 脚本的参数是上下文，命令以退出码判断成败 */
+    action_id_t script = action_create_script("true");
+    action_id_t failing = action_create_command("exit 3");
+    action_future_t *ok = action_submit(script, &context, 0);
+    action_future_t *bad = action_submit(failing, &context, 0);
+    int ok_result = -1, bad_result = 0;
+    action_future_wait(ok, ACTION_WAIT_FOREVER, &ok_result);
+    action_future_wait(bad, ACTION_WAIT_FOREVER, &bad_result);
+    action_future_destroy(ok);
+    action_future_destroy(bad);
+    if (ok_result != PHYMUTI_SUCCESS || bad_result != PHYMUTI_ERROR_ACTION_EXECUTE_FAILED) {
+        fprintf(stderr, "异步执行脚本或命令的结果错误: %d %d\n", ok_result, bad_result);
+        return 1;
+    }
+
+    /* 挂起的命令超时后被终止（包括sh启动的子进程） */
+    action_id_t hung = action_create_command("sleep 30; true");
+    uint64_t start = now_ns();
+    future = action_submit(hung, &context, 100);
+    if (action_future_wait(future, ACTION_WAIT_FOREVER, &result) != PHYMUTI_SUCCESS ||
+        result != PHYMUTI_ERROR_ACTION_TIMEOUT) {
+        fprintf(stderr, "超时的命令未被终止\n");
+        return 1;
+    }
+    double timeout_ms = (double)(now_ns() - start) / 1e6;
+    action_future_destroy(future);
+
+    /* 等待者的期限到了只返回超时，动作继续运行，之后可以取消 */
+    future = action_submit(hung, &context, 0);
+    if (action_future_wait(future, 50, &result) != PHYMUTI_ERROR_TIMEOUT ||
+        action_future_poll(future, &done, NULL) != PHYMUTI_SUCCESS || done ||
+        action_future_cancel(future) != PHYMUTI_SUCCESS ||
+        action_future_wait(future, 5000, &result) != PHYMUTI_SUCCESS ||
+        result != PHYMUTI_ERROR_ACTION_CANCELLED) {
+        fprintf(stderr, "取消正在运行的命令失败\n");
+        return 1;
+    }
+    action_future_destroy(future);
+
+    /* 工作线程都被占用时，排队的句柄取消后不再执行 */
+    action_future_t *futures[8];
+    for (int i = 0; i < 8; i++) {
+        futures[i] = action_submit(i < 6 ? hung : callback, &context, 0);
+    }
+    callback_count = 0;
+    if (action_future_cancel(futures[7]) != PHYMUTI_SUCCESS ||
+        action_future_wait(futures[7], 0, &result) != PHYMUTI_SUCCESS ||
+        result != PHYMUTI_ERROR_ACTION_CANCELLED) {
+        fprintf(stderr, "取消排队的句柄失败\n");
+        return 1;
+    }
+
+    /* 释放未完成的句柄会取消动作 */
+    start = now_ns();
+    for (int i = 0; i < 8; i++) {
+        action_future_destroy(futures[i]);
+    }
+    future = action_submit(callback, &context, 0);
+    action_future_wait(future, ACTION_WAIT_FOREVER, &result);
+    action_future_destroy(future);
+    double cancel_ms = (double)(now_ns() - start) / 1e6;
+    if (result != PHYMUTI_SUCCESS || callback_count != 1 || cancel_ms > 5000) {
+        fprintf(stderr, "释放未完成的句柄错误\n");
+        return 1;
+    }
+
+    /* SIGCHLD被忽略时子进程被自动回收，取不到退出状态按失败处理 */
+    signal(SIGCHLD, SIG_IGN);
+    future = action_submit(script, &context, 0);
+    action_future_wait(future, ACTION_WAIT_FOREVER, &result);
+    action_future_destroy(future);
+    signal(SIGCHLD, SIG_DFL);
+    if (result != PHYMUTI_ERROR_ACTION_EXECUTE_FAILED) {
+        fprintf(stderr, "无法回收子进程时结果错误: %d\n", result);
+        return 1;
+    }
+
+    action_destroy(callback);
+    action_destroy(script);
+    action_destroy(failing);
+    action_destroy(hung);
+
+    printf("异步执行测试通过：超时终止用时 %.1f 毫秒，取消全部挂起命令用时 %.1f 毫秒\n",
+           timeout_ms, cancel_ms);
+    return 0;
+}
+
+/* 延迟统计测试：每个线程的执行次数和线程数 */
+#define LATENCY_CALLS   10000
+#define LATENCY_THREADS 4
+
+/* 睡眠约1毫秒的回调 */
+static int slow_callback(const monitor_context_t *context, void *user_data) {
+    (void)context;
+    (void)user_data;
+    struct timespec ts = { 0, 1000000 };
+    nanosleep(&ts, NULL);
+    return PHYMUTI_SUCCESS;
+}
+
+/* 值为奇数时失败的回调 */
+static int odd_fails_callback(const monitor_context_t *context, void *user_data) {
+    (void)user_data;
+    return (context->value & 1) ? PHYMUTI_ERROR_ACTION_EXECUTE_FAILED : PHYMUTI_SUCCESS;
+}
+
+/* 执行线程：反复执行同一个动作 */
+static void* latency_thread(void *arg) {
+    action_id_t action = (action_id_t)(uintptr_t)arg;
+    monitor_context_t context;
+    memset(&context, 0, sizeof(context));
+
+    for (uint64_t i = 0; i < LATENCY_CALLS; i++) {
+        context.value = i;
+        action_execute(action, &context);
+    }
+    return NULL;
+}
+
+/* 执行延迟：多线程分片合并、失败计数、百分位、找出慢动作 */
+static int test_latency(void) {
+    action_id_t fast = action_create_callback(odd_fails_callback, NULL);
+    action_id_t slow = action_create_callback(slow_callback, NULL);
+    action_id_t command = action_create_command("true");
+    monitor_context_t context;
+    memset(&context, 0, sizeof(context));
+
+    action_latency_stats_t *stats = (action_latency_stats_t *)malloc(sizeof(action_latency_stats_t));
+    if (!stats || action_get_latency_stats(fast, stats) != PHYMUTI_SUCCESS || stats->invocations != 0 ||
+        action_latency_percentile(stats, 99.0) != 0) {
+        fprintf(stderr, "未执行的动作延迟统计错误\n");
+        free(stats);
+        return 1;
+    }
+
+    pthread_t threads[LATENCY_THREADS];
+    for (int i = 0; i < LATENCY_THREADS; i++) {
+        pthread_create(&threads[i], NULL, latency_thread, (void *)(uintptr_t)fast);
+    }
+    for (int i = 0; i < LATENCY_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < 20; i++) {
+        action_execute(slow, &context);
+    }
+    action_execute(command, &context);
+
+    /* 各线程的分片合并后次数准确 */
+    int failed = 0;
+    uint64_t fast_p99;
+    action_get_latency_stats(fast, stats);
+    uint64_t bucket_sum = 0;
+    for (size_t b = 0; b < ACTION_LATENCY_BUCKETS; b++) {
+        bucket_sum += stats->buckets[b];
+    }
+    failed |= stats->invocations != LATENCY_CALLS * LATENCY_THREADS || bucket_sum != stats->invocations ||
+              stats->failures != LATENCY_CALLS * LATENCY_THREADS / 2;
+    fast_p99 = action_latency_percentile(stats, 99.0);
+
+    /* 百分位是所在桶的上界，相对误差不超过12.5% */
+    action_get_latency_stats(slow, stats);
+    uint64_t slow_p50 = action_latency_percentile(stats, 50.0);
+    failed |= stats->invocations != 20 || stats->failures != 0 ||
+              slow_p50 < 1000000 || slow_p50 > stats->max_ns || slow_p50 < fast_p99;
+    failed |= action_latency_percentile(stats, 100.0) != stats->max_ns;
+
+    /* 批量动作每批记录一次 */
+    action_id_t batch = action_create_batch_callback(batch_callback, NULL);
+    monitor_context_t contexts[4];
+    memset(contexts, 0, sizeof(contexts));
+    action_execute_batch(batch, contexts, 4);
+    action_get_latency_stats(batch, stats);
+    failed |= stats->invocations != 1;
+
+    if (failed) {
+        fprintf(stderr, "延迟统计错误\n");
+        free(stats);
+        return 1;
+    }
+
+    action_dump_latency_stats(stdout);
+
+    action_destroy(fast);
+    action_destroy(slow);
+    action_destroy(command);
+    action_destroy(batch);
+    free(stats);
+
+    printf("延迟统计测试通过：快动作P99 %llu 纳秒，慢动作P50 %llu 纳秒\n",
+           (unsigned long long)fast_p99, (unsigned long long)slow_p50);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int ret;
+
+    (void)argc;
+    printf("PhyMuTi动作管理测试\n");
+
+    char self[sizeof(test_dir)];
+    snprintf(self, sizeof(self), "%s", argv[0]);
+    snprintf(test_dir, sizeof(test_dir), "%s", dirname(self));
+
+    ret = phymuti_init();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "初始化PhyMuTi系统失败: %s\n", phymuti_error_string(ret));
+        return 1;
+    }
+
+    memory_region_t *region = memory_region_create(NULL, "regs", TEST_BASE, TEST_SIZE, MEMORY_FLAG_RW);
+    if (!region) {
+        fprintf(stderr, "创建内存区域失败\n");
+        phymuti_cleanup();
+        return 1;
+    }
+
+    int failed = test_plugin(region) || test_rate_limit(region) || test_futures() ||
+                 test_latency();
+
+    ret = phymuti_cleanup();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "清理PhyMuTi系统失败: %s\n", phymuti_error_string(ret));
+        failed = 1;
+    }
+
+    if (failed) {
+        return 1;
+    }
+
+    printf("测试完成\n");
+    return 0;
+}
@@ -0,0 +1,388 @@
+/**
+ * @file test_checkpoint.c
+ * @brief PhyMuTi检查点测试程序
+ */
+
+#include "phymuti.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+
+/* 测试内存区域大小：64页 */
+#define TEST_REGION_SIZE (64 * MEMORY_PAGE_SIZE)
+#define TEST_REGION_BASE 0x80000000ULL
+
+/* 延迟恢复测试区域：64MiB */
+#define TEST_LARGE_SIZE (64ULL << 20)
+#define TEST_LARGE_BASE 0x100000000ULL
+
+/* 并发写入测试区域：64页，保存期间写入的增量检查点个数 */
+#define TEST_CONCURRENT_SIZE  (64 * MEMORY_PAGE_SIZE)
+#define TEST_CONCURRENT_BASE  0xc0000000ULL
+#define TEST_CONCURRENT_SAVES 16
+
+/* 测试设备状态 */
+typedef struct {
+    uint32_t counter;
+} test_device_state_t;
+
+static int test_device_create(device_handle_t device, const char *name, const device_config_t *config) {
+    (void)name;
+    (void)config;
+    return device_set_user_data(device, calloc(1, sizeof(test_device_state_t)));
+}
+
+static void test_device_destroy(device_handle_t device) {
+    free(device_get_user_data(device));
+}
+
+static int test_device_save_state(device_handle_t device, void *buffer, size_t *size) {
+    if (*size < sizeof(test_device_state_t) || !buffer) {
+        *size = sizeof(test_device_state_t);
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    memcpy(buffer, device_get_user_data(device), sizeof(test_device_state_t));
+    *size = sizeof(test_device_state_t);
+    return PHYMUTI_SUCCESS;
+}
+
+static int test_device_load_state(device_handle_t device, const void *buffer, size_t size) {
+    if (size != sizeof(test_device_state_t)) {
+        return PHYMUTI_ERROR_INVALID_PARAM;
+    }
+    memcpy(device_get_user_data(device), buffer, size);
+    return PHYMUTI_SUCCESS;
+}
+
+static const device_ops_t test_device_ops = {
+    .create = test_device_create,
+    .destroy = test_device_destroy,
+    .save_state = test_device_save_state,
+    .load_state = test_device_load_state,
+};
+
+/* 获取文件大小 */
+static long file_size(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+/* 检查函数返回值 */
+#define CHECK(expr) do { \
+    int _ret = (expr); \
+    if (_ret != PHYMUTI_SUCCESS) { \
+        fprintf(stderr, "%s 失败: %s\n", #expr, phymuti_error_string(_ret)); \
+        return 1; \
+    } \
+} while (0)
+
+static int run_test(void) {
+    CHECK(device_type_register("ckpt_dev", &test_device_ops, NULL));
+    device_config_t config = {0};
+    device_handle_t device = device_create("ckpt_dev", "dev0", &config);
+    memory_region_t *region = memory_region_create(device, "ram", TEST_REGION_BASE,
+                                                   TEST_REGION_SIZE, MEMORY_FLAG_RW);
+    if (!device || !region) {
+        fprintf(stderr, "创建设备或内存区域失败\n");
+        return 1;
+    }
+    test_device_state_t *state = (test_device_state_t *)device_get_user_data(device);
+
+    /* 没有父检查点时不能保存增量 */
+    if (checkpoint_save_incremental("ckpt_1.bin") != PHYMUTI_ERROR_CHECKPOINT_NO_PARENT) {
+        fprintf(stderr, "没有父检查点时保存增量未被拒绝\n");
+        return 1;
+    }
+
+    for (uint64_t off = 0; off < TEST_REGION_SIZE; off += 8) {
+        memory_write_doubleword(region, TEST_REGION_BASE + off, off * 0x9e3779b97f4a7c15ULL);
+    }
+    state->counter = 1;
+    CHECK(checkpoint_save("ckpt_0.bin"));
+
+    /* 第一个增量：改动两页中的少量字节，设备状态不变 */
+    memory_write_word(region, TEST_REGION_BASE + 0x10, 0x11111111);
+    memory_write_word(region, TEST_REGION_BASE + 5 * MEMORY_PAGE_SIZE + 0x100, 0x22222222);
+    memory_write_word(region, TEST_REGION_BASE + 9 * MEMORY_PAGE_SIZE, 0);
+    memory_write_word(region, TEST_REGION_BASE + 9 * MEMORY_PAGE_SIZE, 0);
+    CHECK(checkpoint_save_incremental("ckpt_1.bin"));
+    uint64_t fp1;
+    CHECK(phymuti_state_fingerprint(&fp1));
+
+    /* 第二个增量：再改一页，设备状态变化 */
+    memory_fill(region, TEST_REGION_BASE + 20 * MEMORY_PAGE_SIZE, 0xee, 64);
+    state->counter = 2;
+    CHECK(checkpoint_save_incremental("ckpt_2.bin"));
+    uint64_t fp2;
+    CHECK(phymuti_state_fingerprint(&fp2));
+
+    long full_size = file_size("ckpt_0.bin");
+    long delta_size = file_size("ckpt_1.bin");
+    printf("完整检查点 %ld 字节，增量检查点 %ld 字节\n", full_size, delta_size);
+    if (delta_size <= 0 || delta_size * 20 > full_size) {
+        fprintf(stderr, "增量检查点过大\n");
+        return 1;
+    }
+
+    /* 破坏状态后恢复到第二个增量 */
+    memory_fill(region, TEST_REGION_BASE, 0, TEST_REGION_SIZE);
+    state->counter = 99;
+    CHECK(checkpoint_restore("ckpt_2.bin"));
+    uint64_t fp;
+    CHECK(phymuti_state_fingerprint(&fp));
+    if (fp != fp2 || state->counter != 2) {
+        fprintf(stderr, "恢复第二个增量后状态不一致\n");
+        return 1;
+    }
+
+    /* 恢复到第一个增量 */
+    CHECK(checkpoint_restore("ckpt_1.bin"));
+    CHECK(phymuti_state_fingerprint(&fp));
+    uint32_t value;
+    memory_read_word(region, TEST_REGION_BASE + 5 * MEMORY_PAGE_SIZE + 0x100, &value);
+    if (fp != fp1 || state->counter != 1 || value != 0x22222222) {
+        fprintf(stderr, "恢复第一个增量后状态不一致\n");
+        return 1;
+    }
+
+    /* 从恢复点继续保存增量，形成分支 */
+    memory_write_byte(region, TEST_REGION_BASE + 3, 0x33);
+    CHECK(checkpoint_save_incremental("ckpt_1b.bin"));
+    uint64_t fp1b;
+    CHECK(phymuti_state_fingerprint(&fp1b));
+
+    /* 压缩链后得到等价的完整检查点 */
+    CHECK(checkpoint_compact("ckpt_2.bin", "ckpt_2_full.bin"));
+    CHECK(checkpoint_restore("ckpt_2_full.bin"));
+    CHECK(phymuti_state_fingerprint(&fp));
+    if (fp != fp2) {
+        fprintf(stderr, "压缩后的检查点状态不一致\n");
+        return 1;
+    }
+
+    CHECK(checkpoint_restore("ckpt_1b.bin"));
+    CHECK(phymuti_state_fingerprint(&fp));
+    if (fp != fp1b) {
+        fprintf(stderr, "分支检查点状态不一致\n");
+        return 1;
+    }
+
+    memory_region_destroy(region);
+    device_destroy(device);
+
+    printf("检查点测试通过\n");
+    return 0;
+}
+
+/* 恢复期间读者是否应当结束，以及读到的错误值个数 */
+static atomic_bool restore_reader_stop;
+static atomic_int restore_reader_errors;
+
+/* 读者：恢复期间不断整块读取，块末尾是两个检查点中相同的值 */
+static void* restore_reader_thread(void *arg) {
+    memory_region_t *region = (memory_region_t *)arg;
+    uint8_t *buffer = (uint8_t *)malloc(4 << 20);
+    if (!buffer) {
+        atomic_fetch_add(&restore_reader_errors, 1);
+        return NULL;
+    }
+
+    while (!atomic_load(&restore_reader_stop)) {
+        uint64_t value;
+        memory_read_buffer(region, TEST_LARGE_BASE + (1 << 20) + 8, buffer, 4 << 20);
+        memcpy(&value, buffer + (4 << 20) - 8, sizeof(value));
+        if (value != (5 << 20) + 1) {
+            atomic_fetch_add(&restore_reader_errors, 1);
+        }
+    }
+    free(buffer);
+    return NULL;
+}
+
+/* 延迟恢复测试：大区域恢复不读入全部内容，恢复后的写入不影响检查点文件 */
+static int run_lazy_test(void) {
+    memory_region_t *region = memory_region_create(NULL, "large", TEST_LARGE_BASE,
+                                                   TEST_LARGE_SIZE, MEMORY_FLAG_RW);
+    if (!region) {
+        fprintf(stderr, "创建内存区域失败\n");
+        return 1;
+    }
+
+    for (uint64_t off = 0; off < TEST_LARGE_SIZE; off += 1 << 20) {
+        memory_write_doubleword(region, TEST_LARGE_BASE + off, off + 1);
+    }
+    CHECK(checkpoint_save("ckpt_large.bin"));
+    memory_write_doubleword(region, TEST_LARGE_BASE + (3 << 20), 0x5555);
+    CHECK(checkpoint_save_incremental("ckpt_large_1.bin"));
+
+    memory_fill(region, TEST_LARGE_BASE, 0xff, TEST_LARGE_SIZE);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    CHECK(checkpoint_restore("ckpt_large_1.bin"));
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double ms = (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+
+    uint64_t value;
+    memory_read_doubleword(region, TEST_LARGE_BASE + (3 << 20), &value);
+    if (value != 0x5555) {
+        fprintf(stderr, "增量修改的页未恢复\n");
+        return 1;
+    }
+    memory_read_doubleword(region, TEST_LARGE_BASE + (5 << 20), &value);
+    if (value != (5 << 20) + 1) {
+        fprintf(stderr, "映射的页内容错误\n");
+        return 1;
+    }
+
+    /* 写入只修改私有副本，再次恢复得到原内容 */
+    memory_write_doubleword(region, TEST_LARGE_BASE + (5 << 20), 0);
+    CHECK(checkpoint_restore("ckpt_large.bin"));
+    memory_read_doubleword(region, TEST_LARGE_BASE + (5 << 20), &value);
+    uint64_t changed;
+    memory_read_doubleword(region, TEST_LARGE_BASE + (3 << 20), &changed);
+    if (value != (5 << 20) + 1 || changed != (3 << 20) + 1) {
+        fprintf(stderr, "恢复后的写入影响了检查点文件\n");
+        return 1;
+    }
+
+    /* 恢复替换映射时，并发的读取不会访问已解除映射的内存 */
+    pthread_t reader;
+    atomic_store(&restore_reader_stop, false);
+    atomic_store(&restore_reader_errors, 0);
+    pthread_create(&reader, NULL, restore_reader_thread, region);
+    int ret = PHYMUTI_SUCCESS;
+    for (int i = 0; ret == PHYMUTI_SUCCESS && i < 32; i++) {
+        ret = checkpoint_restore(i % 2 ? "ckpt_large.bin" : "ckpt_large_1.bin");
+    }
+    atomic_store(&restore_reader_stop, true);
+    pthread_join(reader, NULL);
+    CHECK(ret);
+    if (atomic_load(&restore_reader_errors) != 0) {
+        fprintf(stderr, "恢复期间读到错误的值\n");
+        return 1;
+    }
+
+    memory_region_destroy(region);
+
+    printf("延迟恢复测试通过，恢复64MiB区域用时 %.2f 毫秒\n", ms);
+    return 0;
+}
+
+/* 并发写入测试写者是否应当结束 */
+static atomic_bool concurrent_writer_stop;
+
+/* 写者：不断向各页的不同位置写入递增的值 */
+static void* concurrent_writer_thread(void *arg) {
+    memory_region_t *region = (memory_region_t *)arg;
+    uint64_t value = 1;
+
+    while (!atomic_load(&concurrent_writer_stop)) {
+        uint64_t page = (value * 37) % (TEST_CONCURRENT_SIZE / MEMORY_PAGE_SIZE);
+        uint64_t slot = (value * 13) % (MEMORY_PAGE_SIZE / 8);
+        memory_write_doubleword(region, TEST_CONCURRENT_BASE + page * MEMORY_PAGE_SIZE + slot * 8, value);
+        value++;
+    }
+    return NULL;
+}
+
+/* 获取并发写入测试的检查点文件名 */
+static void concurrent_path(char *path, size_t size, int index) {
+    snprintf(path, size, "ckpt_w_%d.bin", index);
+}
+
+/*
+ * 并发写入测试：增量保存期间不断写入，保存期间写入的页不能被遗漏。
+ * 写者停止后再保存一个增量，恢复它得到的内容必须与停止时的内存一致。
+ */
+static int run_concurrent_test(void) {
+    memory_region_t *region = memory_region_create(NULL, "busy", TEST_CONCURRENT_BASE,
+                                                   TEST_CONCURRENT_SIZE, MEMORY_FLAG_RW);
+    uint8_t *expected = (uint8_t *)malloc(TEST_CONCURRENT_SIZE);
+    if (!region || !expected) {
+        fprintf(stderr, "创建内存区域失败\n");
+        free(expected);
+        return 1;
+    }
+
+    char path[64];
+    concurrent_path(path, sizeof(path), 0);
+    CHECK(checkpoint_save(path));
+
+    pthread_t writer;
+    atomic_store(&concurrent_writer_stop, false);
+    pthread_create(&writer, NULL, concurrent_writer_thread, region);
+
+    int ret = PHYMUTI_SUCCESS;
+    for (int i = 1; ret == PHYMUTI_SUCCESS && i <= TEST_CONCURRENT_SAVES; i++) {
+        concurrent_path(path, sizeof(path), i);
+        ret = checkpoint_save_incremental(path);
+    }
+
+    atomic_store(&concurrent_writer_stop, true);
+    pthread_join(writer, NULL);
+    CHECK(ret);
+
+    concurrent_path(path, sizeof(path), TEST_CONCURRENT_SAVES + 1);
+    CHECK(checkpoint_save_incremental(path));
+    CHECK(memory_read_buffer(region, TEST_CONCURRENT_BASE, expected, TEST_CONCURRENT_SIZE));
+
+    memory_fill(region, TEST_CONCURRENT_BASE, 0, TEST_CONCURRENT_SIZE);
+    CHECK(checkpoint_restore(path));
+    int mismatch = memcmp(memory_region_data(region), expected, TEST_CONCURRENT_SIZE) != 0;
+
+    free(expected);
+    memory_region_destroy(region);
+
+    if (mismatch) {
+        fprintf(stderr, "保存期间写入的页在恢复后丢失\n");
+        return 1;
+    }
+
+    printf("并发写入检查点测试通过\n");
+    return 0;
+}
+
+int main(void) {
+    int ret;
+
+    printf("PhyMuTi检查点测试\n");
+
+    ret = phymuti_init();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "初始化PhyMuTi系统失败: %s\n", phymuti_error_string(ret));
+        return 1;
+    }
+
+    int failed = run_test() || run_lazy_test() || run_concurrent_test();
+
+    ret = phymuti_cleanup();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "清理PhyMuTi系统失败: %s\n", phymuti_error_string(ret));
+        failed = 1;
+    }
+
+    remove("ckpt_0.bin");
+    remove("ckpt_1.bin");
+    remove("ckpt_2.bin");
+    remove("ckpt_1b.bin");
+    remove("ckpt_2_full.bin");
+    remove("ckpt_large.bin");
+    remove("ckpt_large_1.bin");
+    for (int i = 0; i <= TEST_CONCURRENT_SAVES + 1; i++) {
+        char path[64];
+        concurrent_path(path, sizeof(path), i);
+        remove(path);
+    }
+
+    if (failed) {
+        return 1;
+    }
+
+    printf("测试完成\n");
+    return 0;
+}
@@ -0,0 +1,385 @@
+/**
+ * @file test_memory.c
+ * @brief PhyMuTi内存管理测试程序
+ */
+
+#include "phymuti.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/wait.h>
+
+/* 测试用共享内存对象名称 */
+#define TEST_SHM_NAME "phymuti_test_memory"
+
+/* 热图导出文件路径 */
+#define TEST_HEATMAP_PATH "test_heatmap.bin"
+
+/* 热图测试的并发线程数和每线程写入次数 */
+#define TEST_HEATMAP_THREADS 4
+#define TEST_HEATMAP_WRITES  10000
+
+/* 快照测试的更新次数 */
+#define TEST_SNAPSHOT_UPDATES 20000
+
+/* 快照测试写者是否结束 */
+static atomic_bool snapshot_writer_done;
+
+/* 写者：每次把4个相关寄存器更新为同一个值 */
+static void* snapshot_writer_thread(void *arg) {
+    memory_region_t *region = (memory_region_t *)arg;
+
+    for (uint32_t i = 1; i <= TEST_SNAPSHOT_UPDATES; i++) {
+        memory_write_begin(region);
+        for (uint64_t r = 0; r < 4; r++) {
+            memory_write_word(region, 0x4000 + r * 4, i);
+        }
+        memory_write_end(region);
+    }
+
+    atomic_store(&snapshot_writer_done, true);
+    return NULL;
+}
+
+/* 快照读取测试：读者不应看到部分更新的寄存器组 */
+static int test_snapshot(void) {
+    memory_region_t *region = memory_region_create(NULL, "regs", 0x4000, 16, MEMORY_FLAG_RW);
+    if (!region) {
+        fprintf(stderr, "创建内存区域失败\n");
+        return 1;
+    }
+
+    pthread_t writer;
+    atomic_store(&snapshot_writer_done, false);
+    pthread_create(&writer, NULL, snapshot_writer_thread, region);
+
+    uint32_t regs[4];
+    uint32_t reads = 0, last = 0;
+    int torn = 0;
+    do {
+        memory_read_snapshot(region, 0x4000, regs, sizeof(regs));
+        if (regs[0] != regs[1] || regs[0] != regs[2] || regs[0] != regs[3] || regs[0] < last) {
+            torn = 1;
+        }
+        last = regs[0];
+        reads++;
+    } while (!atomic_load(&snapshot_writer_done));
+
+    pthread_join(writer, NULL);
+    memory_region_destroy(region);
+
+    if (torn || last > TEST_SNAPSHOT_UPDATES) {
+        fprintf(stderr, "快照读取到不一致的寄存器组\n");
+        return 1;
+    }
+
+    printf("快照读取测试通过，共读取 %u 次\n", reads);
+    return 0;
+}
+
+/* 块操作测试：填充、比较和搜索覆盖向量循环和尾部 */
+static int test_bulk_ops(void) {
+    const size_t size = 4096 + 77;
+    memory_region_t *region = memory_region_create(NULL, "bulk", 0x10000, size, MEMORY_FLAG_RW);
+    uint8_t *golden = (uint8_t *)malloc(size);
+    if (!region || !golden) {
+        fprintf(stderr, "创建内存区域失败\n");
+        free(golden);
+        return 1;
+    }
+
+    memory_fill(region, 0x10000, 0xa5, size);
+    memset(golden, 0xa5, size);
+
+    bool equal = false;
+    uint64_t diff = 0;
+    memory_compare(region, 0x10000, golden, size, &equal, &diff);
+    if (!equal) {
+        fprintf(stderr, "填充后比较不相同\n");
+        free(golden);
+        return 1;
+    }
+
+    /* 在不同位置制造差异，检查报告第一个不同的地址 */
+    const size_t diffs[] = { 0, 15, 31, 63, 64, 1000, size - 1 };
+    for (size_t i = 0; i < sizeof(diffs) / sizeof(diffs[0]); i++) {
+        memory_write_byte(region, 0x10000 + diffs[i], 0x00);
+        memory_compare(region, 0x10000, golden, size, &equal, &diff);
+        memory_write_byte(region, 0x10000 + diffs[i], 0xa5);
+        if (equal || diff != 0x10000 + diffs[i]) {
+            fprintf(stderr, "比较结果错误: 偏移%zu\n", diffs[i]);
+            free(golden);
+            return 1;
+        }
+    }
+
+    /* 搜索：首尾字节相同的干扰项不应误报 */
+    const uint8_t magic[] = { 0xde, 0xad, 0xbe, 0xef };
+    const uint8_t decoy[] = { 0xde, 0x00, 0x00, 0xef };
+    uint64_t found = 0;
+    if (memory_find_pattern(region, 0x10000, size, magic, sizeof(magic), &found) != PHYMUTI_ERROR_NOT_FOUND) {
+        fprintf(stderr, "搜索误报\n");
+        free(golden);
+        return 1;
+    }
+    memory_write_buffer(region, 0x10000 + 100, decoy, sizeof(decoy));
+    memory_write_buffer(region, 0x10000 + 2000, magic, sizeof(magic));
+    memory_write_buffer(region, 0x10000 + size - 4, magic, sizeof(magic));
+    if (memory_find_pattern(region, 0x10000, size, magic, sizeof(magic), &found) != PHYMUTI_SUCCESS ||
+        found != 0x10000 + 2000) {
+        fprintf(stderr, "搜索结果错误\n");
+        free(golden);
+        return 1;
+    }
+    if (memory_find_pattern(region, 0x10000 + 2001, size - 2001, magic, sizeof(magic), &found) != PHYMUTI_SUCCESS ||
+        found != 0x10000 + size - 4) {
+        fprintf(stderr, "尾部搜索结果错误\n");
+        free(golden);
+        return 1;
+    }
+
+    free(golden);
+    memory_region_destroy(region);
+
+    printf("块操作测试通过\n");
+    return 0;
+}
+
+/* 内容哈希测试：页哈希缓存随写入失效，相同内容得到相同哈希 */
+static int test_hash(void) {
+    const size_t size = MEMORY_PAGE_SIZE * 3 + 100;
+    memory_region_t *a = memory_region_create(NULL, "hash_a", 0x100000, size, MEMORY_FLAG_RW);
+    memory_region_t *b = memory_region_create(NULL, "hash_b", 0x200000, size, MEMORY_FLAG_RW);
+    if (!a || !b) {
+        fprintf(stderr, "创建内存区域失败\n");
+        return 1;
+    }
+
+    uint64_t ha0, hb0, ha1, ha2, fp0, fp1, fp2;
+    memory_region_hash(a, &ha0);
+    memory_region_hash(b, &hb0);
+    phymuti_state_fingerprint(&fp0);
+
+    /* 修改最后一页，缓存的其余页哈希保持有效 */
+    memory_write_byte(a, 0x100000 + size - 1, 0x5a);
+    memory_region_hash(a, &ha1);
+    phymuti_state_fingerprint(&fp1);
+
+    memory_fill(a, 0x100000 + size - 1, 0x00, 1);
+    memory_region_hash(a, &ha2);
+    phymuti_state_fingerprint(&fp2);
+
+    memory_region_destroy(a);
+    memory_region_destroy(b);
+
+    if (ha0 != hb0 || ha1 == ha0 || ha2 != ha0) {
+        fprintf(stderr, "内存区域哈希错误\n");
+        return 1;
+    }
+    if (fp1 == fp0 || fp2 != fp0) {
+        fprintf(stderr, "状态指纹错误\n");
+        return 1;
+    }
+
+    printf("内容哈希测试通过\n");
+    return 0;
+}
+
+/* 热图写者：反复写同一个寄存器 */
+static void* heatmap_writer_thread(void *arg) {
+    memory_region_t *region = (memory_region_t *)arg;
+    for (uint32_t i = 0; i < TEST_HEATMAP_WRITES; i++) {
+        memory_write_word(region, 0x300044, i);
+    }
+    return NULL;
+}
+
+/* 访问热图测试：按缓存行精确计数，块访问计入涉及的每一行，可导出 */
+static int test_heatmap(void) {
+    const size_t size = 0x1000 + 8;
+    memory_region_t *region = memory_region_create(NULL, "heat", 0x300000, size, MEMORY_FLAG_RW);
+    if (!region) {
+        fprintf(stderr, "创建内存区域失败\n");
+        return 1;
+    }
+
+    size_t count;
+    uint8_t buffer[0x20] = {0};
+    uint32_t value;
+    if (memory_region_get_heatmap(region, NULL, 0, &count) != PHYMUTI_ERROR_NOT_FOUND ||
+        memory_region_enable_heatmap(region) != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "开启访问热图失败\n");
+        memory_region_destroy(region);
+        return 1;
+    }
+
+    pthread_t threads[TEST_HEATMAP_THREADS];
+    for (int i = 0; i < TEST_HEATMAP_THREADS; i++) {
+        pthread_create(&threads[i], NULL, heatmap_writer_thread, region);
+    }
+    for (int i = 0; i < TEST_HEATMAP_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < 3; i++) {
+        memory_read_word(region, 0x300080, &value);
+    }
+    memory_write_buffer(region, 0x300030, buffer, sizeof(buffer));
+    memory_read_byte(region, 0x301007, buffer);
+
+    /* 关闭后的访问不计数 */
+    memory_region_disable_heatmap(region);
+    memory_write_word(region, 0x300044, 0);
+
+    memory_heatmap_line_t lines[0x41];
+    int ret = memory_region_get_heatmap(region, lines, 0x41, &count);
+    int dump_ret = memory_region_dump_heatmap(region, TEST_HEATMAP_PATH);
+    memory_region_destroy(region);
+
+    if (ret != PHYMUTI_SUCCESS || count != 0x41) {
+        fprintf(stderr, "读取访问热图失败\n");
+        return 1;
+    }
+    if (lines[0].writes != 1 || lines[0].reads != 0 ||
+        lines[1].writes != TEST_HEATMAP_THREADS * TEST_HEATMAP_WRITES + 1 ||
+        lines[2].reads != 3 || lines[2].writes != 0 ||
+        lines[0x40].reads != 1 || lines[3].reads != 0 || lines[3].writes != 0) {
+        fprintf(stderr, "访问热图计数错误\n");
+        return 1;
+    }
+
+    /* 检查导出文件 */
+    memory_heatmap_header_t header;
+    memory_heatmap_line_t line1;
+    FILE *fp = fopen(TEST_HEATMAP_PATH, "rb");
+    if (dump_ret != PHYMUTI_SUCCESS || !fp) {
+        fprintf(stderr, "导出访问热图失败\n");
+        return 1;
+    }
+    size_t got = fread(&header, sizeof(header), 1, fp);
+    fseek(fp, (long)(sizeof(header) + sizeof(line1)), SEEK_SET);
+    got += fread(&line1, sizeof(line1), 1, fp);
+    fseek(fp, 0, SEEK_END);
+    long file_size = ftell(fp);
+    fclose(fp);
+    remove(TEST_HEATMAP_PATH);
+
+    if (got != 2 || memcmp(header.magic, MEMORY_HEATMAP_MAGIC, sizeof(MEMORY_HEATMAP_MAGIC)) != 0 ||
+        header.version != MEMORY_HEATMAP_VERSION || header.line_count != 0x41 ||
+        header.base_addr != 0x300000 || strcmp(header.name, "heat") != 0 ||
+        line1.writes != lines[1].writes ||
+        file_size != (long)(sizeof(header) + 0x41 * sizeof(memory_heatmap_line_t))) {
+        fprintf(stderr, "访问热图导出文件错误\n");
+        return 1;
+    }
+
+    printf("访问热图测试通过\n");
+    return 0;
+}
+
+/* 在子进程中映射导出的区域并检查内容 */
+static int check_shared_in_child(uint32_t expected) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        fprintf(stderr, "fork失败\n");
+        return 1;
+    }
+
+    if (pid == 0) {
+        memory_shared_view_t view;
+        if (memory_shared_map(TEST_SHM_NAME, &view) != PHYMUTI_SUCCESS) {
+            _exit(2);
+        }
+        uint32_t value;
+        memcpy(&value, view.data + (0x2004 - view.base_addr), sizeof(value));
+        int rc = (value == expected && view.size == 256 && view.base_addr == 0x2000 &&
+                  strcmp(view.header->name, "shared_ram") == 0) ? 0 : 3;
+        memory_shared_unmap(&view);
+        _exit(rc);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "子进程读取共享内存失败\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/* 共享内存区域测试 */
+static int test_shared_region(void) {
+    memory_region_t *region = memory_region_create_shared(NULL, "shared_ram", 0x2000, 256,
+                                                          MEMORY_FLAG_RW, TEST_SHM_NAME);
+    if (!region) {
+        fprintf(stderr, "创建共享内存区域失败\n");
+        return 1;
+    }
+
+    if (memory_region_create_shared(NULL, "dup", 0x3000, 16, MEMORY_FLAG_RW, TEST_SHM_NAME)) {
+        fprintf(stderr, "重复的共享内存名称未被拒绝\n");
+        return 1;
+    }
+
+    memory_write_word(region, 0x2004, 0x12345678);
+    if (check_shared_in_child(0x12345678) != 0) {
+        return 1;
+    }
+
+    /* 映射视图随写入实时更新 */
+    memory_shared_view_t view;
+    if (memory_shared_map("/" TEST_SHM_NAME, &view) != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "映射共享内存失败\n");
+        return 1;
+    }
+    memory_write_begin(region);
+    memory_write_word(region, 0x2004, 0xcafef00d);
+    memory_write_end(region);
+    uint32_t value = 0;
+    memory_shared_read_snapshot(&view, 0x2004, &value, sizeof(value));
+    memory_shared_unmap(&view);
+    if (value != 0xcafef00d) {
+        fprintf(stderr, "共享内存内容未更新: 0x%08x\n", value);
+        return 1;
+    }
+
+    /* 销毁后对象被删除 */
+    memory_region_destroy(region);
+    if (memory_shared_map(TEST_SHM_NAME, &view) != PHYMUTI_ERROR_NOT_FOUND) {
+        fprintf(stderr, "共享内存对象未删除\n");
+        return 1;
+    }
+
+    printf("共享内存区域测试通过\n");
+    return 0;
+}
+
+int main(void) {
+    int ret;
+
+    printf("PhyMuTi内存管理测试\n");
+
+    ret = phymuti_init();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "初始化PhyMuTi系统失败: %s\n", phymuti_error_string(ret));
+        return 1;
+    }
+
+    if (test_shared_region() != 0 || test_snapshot() != 0 ||
+        test_bulk_ops() != 0 || test_hash() != 0 || test_heatmap() != 0) {
+        phymuti_cleanup();
+        return 1;
+    }
+
+    ret = phymuti_cleanup();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "清理PhyMuTi系统失败: %s\n", phymuti_error_string(ret));
+        return 1;
+    }
+
+    printf("测试完成\n");
+    return 0;
+}
@@ -0,0 +1,975 @@
+/**
+ * @file test_monitor.c
+ * @brief PhyMuTi监视器测试程序
+ */
+
+#include "phymuti.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* 测试内存区域 */
+#define TEST_BASE 0x10000ULL
+#define TEST_SIZE 0x40000
+
+/* 监视点触发次数 */
+static int hit_count = 0;
+
+/* 计数回调 */
+static int count_callback(const monitor_context_t *context, void *user_data) {
+    (void)context;
+    (void)user_data;
+    hit_count++;
+    return PHYMUTI_SUCCESS;
+}
+
+/* 最近一次触发的上下文 */
+static monitor_context_t last_context;
+
+/* 记录上下文的回调 */
+static int record_callback(const monitor_context_t *context, void *user_data) {
+    (void)user_data;
+    last_context = *context;
+    hit_count++;
+    return PHYMUTI_SUCCESS;
+}
+
+/* 获取单调时间（纳秒） */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* 测量每次写访问的平均耗时（纳秒） */
+static double measure_write_ns(memory_region_t *region, uint64_t addr) {
+    const int iterations = 200000;
+    uint64_t start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        memory_write_word(region, addr, (uint32_t)i);
+    }
+    return (double)(now_ns() - start) / iterations;
+}
+
+/* 范围监视点测试 */
+static int test_range_watchpoint(memory_region_t *region, action_id_t action) {
+    /* 监视一个4KiB的描述符环 */
+    monitor_id_t ring = monitor_add_watchpoint(region, TEST_BASE + 0x1000, 0x1000, WATCHPOINT_WRITE, 0);
+    if (ring == MONITOR_INVALID_ID || monitor_bind_action(ring, action) != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "添加范围监视点失败\n");
+        return 1;
+    }
+
+    static const struct {
+        uint64_t addr;
+        int hits;
+    } cases[] = {
+        { TEST_BASE + 0x1000, 1 },   /* 起始处 */
+        { TEST_BASE + 0x1800, 1 },   /* 中间 */
+        { TEST_BASE + 0x1ffc, 1 },   /* 末尾 */
+        { TEST_BASE + 0x0ffe, 1 },   /* 跨越起始边界 */
+        { TEST_BASE + 0x0ffc, 0 },   /* 紧挨在前 */
+        { TEST_BASE + 0x2000, 0 },   /* 紧挨在后 */
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        uint32_t value = 0x1234;
+        hit_count = 0;
+        memory_write_buffer(region, cases[i].addr, &value, sizeof(value));
+        if (hit_count != cases[i].hits) {
+            fprintf(stderr, "写入0x%llx触发%d次，期望%d次\n",
+                    (unsigned long long)cases[i].addr, hit_count, cases[i].hits);
+            return 1;
+        }
+    }
+
+    /* 覆盖整个监视范围的块写入只触发一次 */
+    static uint8_t block[0x3000];
+    hit_count = 0;
+    memory_write_buffer(region, TEST_BASE + 0x800, block, sizeof(block));
+    if (hit_count != 1) {
+        fprintf(stderr, "块写入触发%d次，期望1次\n", hit_count);
+        return 1;
+    }
+
+    monitor_remove_watchpoint(ring);
+    hit_count = 0;
+    memory_write_word(region, TEST_BASE + 0x1800, 0);
+    if (hit_count != 0) {
+        fprintf(stderr, "删除后监视点仍被触发\n");
+        return 1;
+    }
+
+    printf("范围监视点测试通过\n");
+    return 0;
+}
+
+/* 嵌套和重叠的监视点都应被找到，与添加顺序无关 */
+static int test_overlapping(memory_region_t *region, action_id_t action) {
+    monitor_id_t ids[4];
+    ids[0] = monitor_add_watchpoint(region, TEST_BASE + 0x8000, 0x8000, WATCHPOINT_WRITE, 0);
+    ids[1] = monitor_add_watchpoint(region, TEST_BASE + 0x9000, 4, WATCHPOINT_WRITE, 0);
+    ids[2] = monitor_add_watchpoint(region, TEST_BASE + 0xa000, 4, WATCHPOINT_WRITE, 0);
+    ids[3] = monitor_add_watchpoint(region, TEST_BASE + 0x9000, 0x100, WATCHPOINT_READ, 0);
+    for (int i = 0; i < 4; i++) {
+        monitor_bind_action(ids[i], action);
+    }
+
+    hit_count = 0;
+    memory_write_word(region, TEST_BASE + 0x9000, 1);
+    int nested = hit_count;
+    hit_count = 0;
+    memory_write_word(region, TEST_BASE + 0xf000, 1);
+    int outer = hit_count;
+
+    for (int i = 0; i < 4; i++) {
+        monitor_remove_watchpoint(ids[i]);
+    }
+
+    if (nested != 2 || outer != 1) {
+        fprintf(stderr, "重叠监视点触发次数错误: %d %d\n", nested, outer);
+        return 1;
+    }
+
+    printf("重叠监视点测试通过\n");
+    return 0;
+}
+
+/* 设置谓词后依次写入，返回触发次数 */
+static int count_hits(memory_region_t *region, monitor_id_t id, const watchpoint_predicate_t *pred,
+                      const uint32_t *values, int count) {
+    monitor_set_predicate(id, pred);
+    hit_count = 0;
+    for (int i = 0; i < count; i++) {
+        memory_write_word(region, TEST_BASE + 0x3000, values[i]);
+    }
+    return hit_count;
+}
+
+/* 值谓词测试：不满足谓词的写入不执行动作 */
+static int test_predicates(memory_region_t *region, action_id_t action) {
+    monitor_id_t id = monitor_add_watchpoint(region, TEST_BASE + 0x3000, 4, WATCHPOINT_WRITE, 0);
+    monitor_bind_action(id, action);
+    memory_write_word(region, TEST_BASE + 0x3000, 0);
+
+    static const uint32_t values[] = { 0x01, 0x03, 0x03, 0x02, 0xfffffff0, 0x80, 0x00 };
+    const int n = (int)(sizeof(values) / sizeof(values[0]));
+    watchpoint_predicate_t pred;
+    int failed = 0;
+
+    /* 掩码相等：最低位为1 */
+    memset(&pred, 0, sizeof(pred));
+    pred.kind = WATCHPOINT_PRED_MASK_EQ;
+    pred.mask = 0x1;
+    pred.operand = 0x1;
+    failed |= count_hits(region, id, &pred, values, n) != 3;
+
+    /* 无符号范围及其取反 */
+    memset(&pred, 0, sizeof(pred));
+    pred.kind = WATCHPOINT_PRED_RANGE_U;
+    pred.lo.u = 0x02;
+    pred.hi.u = 0x80;
+    failed |= count_hits(region, id, &pred, values, n) != 4;
+    pred.negate = true;
+    failed |= count_hits(region, id, &pred, values, n) != 3;
+
+    /* 有符号范围：0xfffffff0按4字节解释为-16 */
+    memset(&pred, 0, sizeof(pred));
+    pred.kind = WATCHPOINT_PRED_RANGE_S;
+    pred.lo.s = -100;
+    pred.hi.s = -1;
+    failed |= count_hits(region, id, &pred, values, n) != 1;
+
+    /* 位0由0变1：只有0x00->0x01 */
+    memset(&pred, 0, sizeof(pred));
+    pred.kind = WATCHPOINT_PRED_BITS_SET;
+    pred.mask = 0x1;
+    failed |= count_hits(region, id, &pred, values, n) != 1;
+
+    /* 位1由1变0：只有0x02->0xfffffff0 */
+    pred.kind = WATCHPOINT_PRED_BITS_CLEARED;
+    pred.mask = 0x2;
+    failed |= count_hits(region, id, &pred, values, n) != 1;
+
+    /* 值变化：重复写入0x03不触发 */
+    memset(&pred, 0, sizeof(pred));
+    pred.kind = WATCHPOINT_PRED_CHANGED;
+    failed |= count_hits(region, id, &pred, values, n) != 6;
+
+    /* 浮点范围 */
+    float f = 2.5f;
+    uint32_t raw;
+    memcpy(&raw, &f, sizeof(raw));
+    const uint32_t floats[] = { raw, 0x7fc00000 /* NaN */, 0 };
+    memset(&pred, 0, sizeof(pred));
+    pred.kind = WATCHPOINT_PRED_RANGE_F;
+    pred.lo.f = 1.0;
+    pred.hi.f = 3.0;
+    failed |= count_hits(region, id, &pred, floats, 3) != 1;
+
+    /* 清除谓词后每次写入都触发 */
+    failed |= count_hits(region, id, NULL, values, n) != n;
+
+    monitor_remove_watchpoint(id);
+
+    if (failed) {
+        fprintf(stderr, "值谓词过滤结果错误\n");
+        return 1;
+    }
+
+    printf("值谓词测试通过\n");
+    return 0;
+}
+
+/* 写入前的值只在有监视点需要时捕获 */
+static int test_old_value(void) {
+    memory_region_t *region = memory_region_create(NULL, "old", 0x900000, 0x100, MEMORY_FLAG_RW);
+    action_id_t action = action_create_callback(record_callback, NULL);
+    if (!region || action == ACTION_INVALID_ID) {
+        fprintf(stderr, "创建内存区域或动作失败\n");
+        return 1;
+    }
+
+    if (memory_region_get_watch_flags(region) != 0) {
+        fprintf(stderr, "没有监视点的区域状态错误\n");
+        return 1;
+    }
+
+    monitor_id_t id = monitor_add_watchpoint(region, 0x900010, 8, WATCHPOINT_WRITE, 0);
+    monitor_bind_action(id, action);
+    memory_write_doubleword(region, 0x900010, 0x1111);
+    if (memory_region_get_watch_flags(region) != MEMORY_WATCH_ACTIVE || last_context.has_old_value) {
+        fprintf(stderr, "未请求时捕获了写入前的值\n");
+        return 1;
+    }
+
+    monitor_set_capture_old_value(id, true);
+    memory_write_doubleword(region, 0x900010, 0x2222);
+    if (!(memory_region_get_watch_flags(region) & MEMORY_WATCH_OLD_VALUE) ||
+        !last_context.has_old_value || last_context.old_value != 0x1111 || last_context.value != 0x2222) {
+        fprintf(stderr, "写入前的值错误\n");
+        return 1;
+    }
+
+    /* 禁用后区域不再有启用的监视点 */
+    monitor_disable_watchpoint(id);
+    if (memory_region_get_watch_flags(region) != 0) {
+        fprintf(stderr, "禁用后区域状态错误\n");
+        return 1;
+    }
+    monitor_enable_watchpoint(id);
+
+    /* 区域销毁后监视点不再引用它 */
+    memory_region_destroy(region);
+    memory_region_t *wp_region = region;
+    monitor_get_watchpoint_info(id, &wp_region, NULL, NULL, NULL);
+    if (wp_region != NULL || monitor_remove_watchpoint(id) != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "销毁区域后监视点状态错误\n");
+        return 1;
+    }
+
+    printf("写入前的值测试通过\n");
+    return 0;
+}
+
+/* 命中计数和触发方式测试 */
+static int test_counters(memory_region_t *region, action_id_t action) {
+    monitor_id_t nth = monitor_add_watchpoint(region, TEST_BASE + 0x4000, 4, WATCHPOINT_WRITE, 0);
+    monitor_id_t burst = monitor_add_watchpoint(region, TEST_BASE + 0x4000, 4, WATCHPOINT_WRITE, 0);
+    monitor_id_t reads = monitor_add_watchpoint(region, TEST_BASE + 0x4000, 0x100, WATCHPOINT_READ, 0);
+    monitor_bind_action(nth, action);
+    monitor_bind_action(burst, action);
+
+    watchpoint_trigger_t trigger = { WATCHPOINT_TRIGGER_EVERY_NTH, 4, 0 };
+    monitor_set_trigger(nth, &trigger);
+    trigger.mode = WATCHPOINT_TRIGGER_THRESHOLD;
+    trigger.count = 5;
+    trigger.window_ns = 60ULL * 1000000000ULL;
+    monitor_set_trigger(burst, &trigger);
+
+    hit_count = 0;
+    uint32_t value;
+    for (int i = 0; i < 10; i++) {
+        memory_write_word(region, TEST_BASE + 0x4000, (uint32_t)i);
+        memory_read_word(region, TEST_BASE + 0x4010, &value);
+    }
+
+    /* 每第4次执行2次，窗口内达到5次执行1次 */
+    int dispatched = hit_count;
+
+    monitor_counter_t counters[64];
+    size_t count = 0;
+    monitor_get_counters(counters, 64, &count);
+    uint64_t nth_fired = 0, burst_fired = 0, read_hits = 0, nth_hits = 0;
+    for (size_t i = 0; i < count && i < 64; i++) {
+        if (counters[i].id == nth) {
+            nth_hits = counters[i].hits;
+            nth_fired = counters[i].fired;
+        } else if (counters[i].id == burst) {
+            burst_fired = counters[i].fired;
+        } else if (counters[i].id == reads) {
+            read_hits = counters[i].hits;
+        }
+    }
+
+    /* 容量不足时仍返回总数 */
+    size_t total = 0;
+    monitor_get_counters(NULL, 0, &total);
+
+    monitor_reset_counters();
+    monitor_counter_t after;
+    size_t one = 0;
+    monitor_get_counters(&after, 1, &one);
+
+    monitor_remove_watchpoint(nth);
+    monitor_remove_watchpoint(burst);
+    monitor_remove_watchpoint(reads);
+
+    if (dispatched != 3 || nth_hits != 10 || nth_fired != 2 || burst_fired != 1 ||
+        read_hits != 10 || total != count || after.hits != 0) {
+        fprintf(stderr, "计数器错误: %d %llu %llu %llu %llu\n", dispatched,
+                (unsigned long long)nth_hits, (unsigned long long)nth_fired,
+                (unsigned long long)burst_fired, (unsigned long long)read_hits);
+        return 1;
+    }
+
+    printf("计数器测试通过\n");
+    return 0;
+}
+
+/* 在模拟时间time_ns写入一组值 */
+static void write_at(memory_region_t *region, uint64_t time_ns, const uint32_t *values, int count) {
+    monitor_set_simulated_time(time_ns);
+    for (int i = 0; i < count; i++) {
+        memory_write_word(region, TEST_BASE + 0x5000, values[i]);
+    }
+}
+
+/* 触发合并测试（模拟时间，窗口100纳秒） */
+static int test_coalesce(memory_region_t *region) {
+    action_id_t action = action_create_callback(record_callback, NULL);
+    monitor_id_t id = monitor_add_watchpoint(region, TEST_BASE + 0x5000, 4, WATCHPOINT_WRITE, 0);
+    monitor_bind_action(id, action);
+
+    static const uint32_t burst[] = { 1, 2, 3, 4, 5 };
+    watchpoint_coalesce_t coalesce = { WATCHPOINT_COALESCE_LEADING, 100, 0, MONITOR_CLOCK_SIMULATED };
+    int failed = 0;
+
+    /* 前沿：每个窗口只执行第一次 */
+    monitor_set_coalesce(id, &coalesce);
+    hit_count = 0;
+    write_at(region, 1000, burst, 5);
+    failed |= hit_count != 1 || last_context.value != 1;
+    write_at(region, 1050, burst, 5);
+    failed |= hit_count != 1;
+    write_at(region, 1100, burst, 5);
+    failed |= hit_count != 2;
+
+    /* 后沿：窗口结束后以最后一次的值执行一次 */
+    coalesce.mode = WATCHPOINT_COALESCE_TRAILING;
+    monitor_set_coalesce(id, &coalesce);
+    hit_count = 0;
+    write_at(region, 2000, burst, 5);
+    failed |= hit_count != 0;
+    phymuti_process_events();
+    failed |= hit_count != 0;
+    monitor_set_simulated_time(2100);
+    phymuti_process_events();
+    failed |= hit_count != 1 || last_context.value != 5;
+    phymuti_process_events();
+    failed |= hit_count != 1;
+
+    /* 窗口结束后的下一次触发也会交出上一个窗口的后沿触发 */
+    write_at(region, 3000, burst, 2);
+    write_at(region, 3200, burst + 4, 1);
+    failed |= hit_count != 2 || last_context.value != 2;
+
+    /* 双沿：第一次立即执行，窗口内的最后一次在窗口结束后执行 */
+    coalesce.mode = WATCHPOINT_COALESCE_BOTH;
+    monitor_set_coalesce(id, &coalesce);
+    hit_count = 0;
+    write_at(region, 4000, burst, 5);
+    failed |= hit_count != 1 || last_context.value != 1;
+    monitor_set_simulated_time(4100);
+    monitor_flush_coalesced();
+    failed |= hit_count != 2 || last_context.value != 5;
+
+    /* 限速：每个窗口最多执行2次 */
+    coalesce.mode = WATCHPOINT_COALESCE_MAX_RATE;
+    coalesce.max_events = 2;
+    monitor_set_coalesce(id, &coalesce);
+    hit_count = 0;
+    write_at(region, 5000, burst, 5);
+    write_at(region, 5100, burst, 5);
+    failed |= hit_count != 4;
+
+    monitor_remove_watchpoint(id);
+
+    if (failed) {
+        fprintf(stderr, "触发合并结果错误\n");
+        return 1;
+    }
+
+    printf("触发合并测试通过\n");
+    return 0;
+}
+
+/* 匹配开销不随监视点数量线性增长 */
+static int test_scaling(memory_region_t *region) {
+    const int count = 8192;
+    monitor_id_t *ids = (monitor_id_t *)calloc(count, sizeof(monitor_id_t));
+    if (!ids) {
+        return 1;
+    }
+
+    double few = measure_write_ns(region, TEST_BASE + 0x100);
+    for (int i = 0; i < count; i++) {
+        ids[i] = monitor_add_watchpoint(region, TEST_BASE + 0x20000 + (uint64_t)i * 8, 4, WATCHPOINT_WRITE, 0);
+        if (ids[i] == MONITOR_INVALID_ID) {
+            fprintf(stderr, "添加监视点失败\n");
+            free(ids);
+            return 1;
+        }
+    }
+    double many = measure_write_ns(region, TEST_BASE + 0x100);
+
+    for (int i = 0; i < count; i++) {
+        monitor_remove_watchpoint(ids[i]);
+    }
+    free(ids);
+
+    printf("每次写入耗时：无监视点 %.1f 纳秒，%d个监视点 %.1f 纳秒\n", few, count, many);
+    return 0;
+}
+
+/* 查找监视点的命中次数 */
+static uint64_t hits_of(const monitor_counter_t *counters, size_t count, monitor_id_t id) {
+    for (size_t i = 0; i < count; i++) {
+        if (counters[i].id == id) {
+            return counters[i].hits;
+        }
+    }
+    return UINT64_MAX;
+}
+
+/* 宽范围测试中宽范围内的小监视点数，超过向量匹配的项数上限 */
+#define WIDE_SMALL_COUNT 4096
+
+/* 一个覆盖整个区域的监视点加大量小监视点：宽范围内的访问也不扫描全部监视点 */
+static int test_wide_range(memory_region_t *region) {
+    monitor_id_t *ids = (monitor_id_t *)calloc(WIDE_SMALL_COUNT, sizeof(monitor_id_t));
+    monitor_counter_t *counters = (monitor_counter_t *)calloc(WIDE_SMALL_COUNT + 1, sizeof(monitor_counter_t));
+    if (!ids || !counters) {
+        free(ids);
+        free(counters);
+        return 1;
+    }
+
+    const uint64_t small_base = TEST_BASE + 0x8000;
+    monitor_id_t wide = monitor_add_watchpoint(region, TEST_BASE, TEST_SIZE, WATCHPOINT_WRITE, 0);
+    double few = measure_write_ns(region, small_base + (WIDE_SMALL_COUNT / 2) * 8 + 4);
+    for (int i = 0; i < WIDE_SMALL_COUNT; i++) {
+        ids[i] = monitor_add_watchpoint(region, small_base + (uint64_t)i * 8, 4, WATCHPOINT_WRITE, 0);
+    }
+
+    /* 每个小监视点命中一次；间隙中的写入只命中宽范围 */
+    monitor_reset_counters();
+    for (int i = 0; i < WIDE_SMALL_COUNT; i++) {
+        memory_write_word(region, small_base + (uint64_t)i * 8, (uint32_t)i);
+        memory_write_word(region, small_base + (uint64_t)i * 8 + 4, (uint32_t)i);
+    }
+    size_t count;
+    monitor_get_counters(counters, WIDE_SMALL_COUNT + 1, &count);
+    int failed = hits_of(counters, count, wide) != 2 * WIDE_SMALL_COUNT;
+    for (int i = 0; !failed && i < WIDE_SMALL_COUNT; i++) {
+        failed = hits_of(counters, count, ids[i]) != 1;
+    }
+
+    double many = measure_write_ns(region, small_base + (WIDE_SMALL_COUNT / 2) * 8 + 4);
+
+    for (int i = 0; i < WIDE_SMALL_COUNT; i++) {
+        monitor_remove_watchpoint(ids[i]);
+    }
+    monitor_remove_watchpoint(wide);
+    free(ids);
+    free(counters);
+
+    if (failed) {
+        fprintf(stderr, "宽范围内的监视点命中次数错误\n");
+        return 1;
+    }
+    /* 逐项扫描时每次写入要比较一半的小监视点，耗时会高出一个数量级 */
+    if (many > few * 4 + 100) {
+        fprintf(stderr, "宽范围内的写入耗时随监视点数增长：%.1f 纳秒，只有宽范围时 %.1f 纳秒\n", many, few);
+        return 1;
+    }
+
+    printf("宽范围测试通过，每次写入耗时：只有宽范围 %.1f 纳秒，另有%d个小监视点 %.1f 纳秒\n",
+           few, WIDE_SMALL_COUNT, many);
+    return 0;
+}
+
+/* 密集寄存器测试的寄存器数 */
+#define DENSE_REGS 200
+
+/* 测量按伪随机顺序写各寄存器的平均耗时（纳秒），分支预测无法记住访问模式 */
+static double measure_scattered_write_ns(memory_region_t *regs, uint64_t base) {
+    const int iterations = 200000;
+    uint32_t state = 12345;
+    uint64_t start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        state = state * 1103515245u + 12345u;
+        memory_write_word(regs, base + (uint64_t)((state >> 16) % DENSE_REGS) * 4, (uint32_t)i);
+    }
+    return (double)(now_ns() - start) / iterations;
+}
+
+/* 删除密集寄存器测试的监视点和区域 */
+static void dense_cleanup(memory_region_t *regs, const monitor_id_t *ids, monitor_id_t span, monitor_id_t far) {
+    for (int i = 0; i < DENSE_REGS; i++) {
+        monitor_remove_watchpoint(ids[i]);
+    }
+    monitor_remove_watchpoint(span);
+    monitor_remove_watchpoint(far);
+    memory_region_destroy(regs);
+}
+
+/* 密集的寄存器级监视点：向量匹配与区间树查询结果相同 */
+static int test_dense_registers(void) {
+    const uint64_t base = 0x90000000ULL;
+    memory_region_t *regs = memory_region_create(NULL, "dense", base, 0x1000, MEMORY_FLAG_RW);
+    monitor_id_t ids[DENSE_REGS];
+    if (!regs) {
+        fprintf(stderr, "创建内存区域失败\n");
+        return 1;
+    }
+
+    /* 每个寄存器一个监视点，每3个中1个监视读；再加一个覆盖寄存器10~19的访问监视点 */
+    for (int i = 0; i < DENSE_REGS; i++) {
+        ids[i] = monitor_add_watchpoint(regs, base + (uint64_t)i * 4, 4,
+                                        i % 3 == 0 ? WATCHPOINT_READ : WATCHPOINT_WRITE, 0);
+    }
+    monitor_id_t span = monitor_add_watchpoint(regs, base + 40, 40, WATCHPOINT_ACCESS, 0);
+    monitor_disable_watchpoint(ids[7]);
+
+    /* 两轮：第一轮所有项都可以向量匹配，第二轮加入远处的监视点后退回区间树查询 */
+    double write_ns[2];
+    monitor_id_t far = MONITOR_INVALID_ID;
+    for (int round = 0; round < 2; round++) {
+        uint32_t value;
+        uint8_t pair[8];
+        monitor_reset_counters();
+        for (int i = 0; i < DENSE_REGS; i++) {
+            memory_write_word(regs, base + (uint64_t)i * 4, (uint32_t)i);
+            memory_read_word(regs, base + (uint64_t)i * 4, &value);
+        }
+        /* 跨两个寄存器的块访问 */
+        memory_read_buffer(regs, base + 4 * 99, pair, sizeof(pair));
+
+        monitor_counter_t counters[DENSE_REGS + 2];
+        size_t count;
+        monitor_get_counters(counters, DENSE_REGS + 2, &count);
+        for (int i = 0; i < DENSE_REGS; i++) {
+            uint64_t expected = i == 7 ? 0 : i == 99 ? 2 : 1;
+            if (hits_of(counters, count, ids[i]) != expected) {
+                fprintf(stderr, "第%d轮寄存器%d的命中次数错误\n", round, i);
+                dense_cleanup(regs, ids, span, far);
+                return 1;
+            }
+        }
+        if (hits_of(counters, count, span) != 20) {
+            fprintf(stderr, "第%d轮范围监视点的命中次数错误\n", round);
+            dense_cleanup(regs, ids, span, far);
+            return 1;
+        }
+
+        write_ns[round] = measure_scattered_write_ns(regs, base);
+        if (round == 0) {
+            far = monitor_add_watchpoint(regs, base + 0x100000000ULL, 4, WATCHPOINT_WRITE, 0);
+        }
+    }
+
+    dense_cleanup(regs, ids, span, far);
+
+    printf("密集寄存器测试通过：%d个监视点，每次写入耗时：向量匹配 %.1f 纳秒，区间树查询 %.1f 纳秒\n",
+           DENSE_REGS + 1, write_ns[0], write_ns[1]);
+    return 0;
+}
+
+/* 值索引测试中同一地址上监视的值的个数 */
+#define MAGIC_VALUES 500
+
+/* 同一地址上的大量值监视点：每次写入只匹配等于写入值的监视点 */
+static int test_value_index(memory_region_t *region) {
+    const uint64_t addr = TEST_BASE + 0x5000;
+    monitor_id_t ids[MAGIC_VALUES];
+    monitor_counter_t counters[MAGIC_VALUES + 2];
+    size_t count;
+    int failed = 0;
+
+    double before = measure_write_ns(region, addr);
+    for (int i = 0; i < MAGIC_VALUES; i++) {
+        ids[i] = monitor_add_watchpoint(region, addr, 4, WATCHPOINT_VALUE_WRITE, 0xdead0000u + (uint32_t)i);
+    }
+    /* 覆盖两个字的值监视点，写第二个字也匹配 */
+    monitor_id_t wide = monitor_add_watchpoint(region, addr + 0x10, 8, WATCHPOINT_VALUE_WRITE, 0xdead0003u);
+    monitor_id_t plain = monitor_add_watchpoint(region, addr, 4, WATCHPOINT_WRITE, 0);
+
+    monitor_reset_counters();
+    for (int i = 0; i < MAGIC_VALUES; i += 2) {
+        memory_write_word(region, addr, 0xdead0000u + (uint32_t)i);
+    }
+    memory_write_word(region, addr, 12345);
+    memory_write_word(region, addr + 0x14, 0xdead0003u);
+    memory_write_word(region, addr + 0x18, 0xdead0003u);
+
+    monitor_get_counters(counters, MAGIC_VALUES + 2, &count);
+    for (int i = 0; i < MAGIC_VALUES; i++) {
+        if (hits_of(counters, count, ids[i]) != (i % 2 == 0 ? 1u : 0u)) {
+            fprintf(stderr, "值监视点%d的命中次数错误\n", i);
+            failed = 1;
+            break;
+        }
+    }
+    if (hits_of(counters, count, wide) != 1 ||
+        hits_of(counters, count, plain) != MAGIC_VALUES / 2 + 1) {
+        fprintf(stderr, "值监视点索引匹配错误\n");
+        failed = 1;
+    }
+
+    /* 写入不被监视的值时的开销与值监视点数量无关 */
+    monitor_remove_watchpoint(plain);
+    double unwatched = measure_write_ns(region, addr);
+
+    /* 删除一半后其余仍能匹配 */
+    for (int i = 0; i < MAGIC_VALUES; i += 2) {
+        monitor_remove_watchpoint(ids[i]);
+    }
+    monitor_reset_counters();
+    memory_write_word(region, addr, 0xdead0000u + 1);
+    memory_write_word(region, addr, 0xdead0000u);
+    monitor_get_counters(counters, MAGIC_VALUES + 2, &count);
+    if (count != MAGIC_VALUES / 2 + 1 || hits_of(counters, count, ids[1]) != 1) {
+        fprintf(stderr, "删除值监视点后匹配错误\n");
+        failed = 1;
+    }
+
+    for (int i = 1; i < MAGIC_VALUES; i += 2) {
+        monitor_remove_watchpoint(ids[i]);
+    }
+    monitor_remove_watchpoint(wide);
+    if (failed) {
+        return 1;
+    }
+
+    printf("值索引测试通过：同一地址%d个值监视点，每次写入耗时：无监视点 %.1f 纳秒，写入未监视的值 %.1f 纳秒\n",
+           MAGIC_VALUES, before, unwatched);
+    return 0;
+}
+
+/* 批量动作测试的写入次数 */
+#define BATCH_WRITES 10000
+
+/* 批量回调的调用次数、收到的上下文总数和上下文是否保持写入顺序 */
+static int batch_calls;
+static size_t batch_contexts;
+static bool batch_ordered;
+
+static int batch_callback(const monitor_context_t *contexts, size_t count, void *user_data) {
+    (void)user_data;
+    for (size_t i = 0; i < count; i++) {
+        if (contexts[i].value != batch_contexts + i) {
+            batch_ordered = false;
+        }
+    }
+    batch_calls++;
+    batch_contexts += count;
+    return 0;
+}
+
+/* 批量回调动作：同步模式每次触发调用一次，延迟模式一轮日志只调用一次 */
+static int test_batch_actions(memory_region_t *region) {
+    const uint64_t fifo = TEST_BASE + 0x6000;
+    action_id_t batch = action_create_batch_callback(batch_callback, NULL);
+    action_id_t single = action_create_callback(count_callback, NULL);
+    monitor_id_t id = monitor_add_watchpoint(region, fifo, 4, WATCHPOINT_WRITE, 0);
+    if (batch == ACTION_INVALID_ID || single == ACTION_INVALID_ID || id == MONITOR_INVALID_ID ||
+        monitor_bind_action(id, batch) != PHYMUTI_SUCCESS || monitor_bind_action(id, single) != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "创建批量动作失败\n");
+        return 1;
+    }
+
+    batch_calls = 0;
+    batch_contexts = 0;
+    batch_ordered = true;
+    hit_count = 0;
+    for (uint32_t i = 0; i < 100; i++) {
+        memory_write_word(region, fifo, i);
+    }
+    int sync_calls = batch_calls;
+
+    /* 延迟模式：监视线程间隔足够长，写入都在同一轮中处理 */
+    monitor_deferred_config_t config = { .log_entries = BATCH_WRITES * 2, .batch_size = BATCH_WRITES * 2,
+                                         .max_latency_us = 1000000 };
+    monitor_set_deferred(&config);
+    for (uint32_t i = 100; i < BATCH_WRITES; i++) {
+        memory_write_word(region, fifo, i);
+    }
+    monitor_drain_deferred();
+    monitor_set_deferred(NULL);
+    int deferred_calls = batch_calls - sync_calls;
+
+    monitor_remove_watchpoint(id);
+    action_destroy(batch);
+    action_destroy(single);
+
+    if (sync_calls != 100 || batch_contexts != BATCH_WRITES || !batch_ordered ||
+        hit_count != BATCH_WRITES || deferred_calls < 1 || deferred_calls > 4) {
+        fprintf(stderr, "批量动作错误: 同步调用 %d 次，延迟调用 %d 次，共 %zu 个上下文\n",
+                sync_calls, deferred_calls, batch_contexts);
+        return 1;
+    }
+
+    printf("批量动作测试通过：延迟模式下 %d 个上下文合成 %d 次调用\n",
+           BATCH_WRITES - 100, deferred_calls);
+    return 0;
+}
+
+/* 并发更新测试的写线程数 */
+#define CONCURRENT_WRITERS 4
+
+/* 并发更新测试的共享状态 */
+static memory_region_t *concurrent_region;
+static atomic_bool concurrent_stop;
+static atomic_ullong concurrent_writes;
+static atomic_ullong concurrent_hits;
+
+/* 线程安全的计数回调 */
+static int atomic_count_callback(const monitor_context_t *context, void *user_data) {
+    (void)context;
+    (void)user_data;
+    atomic_fetch_add(&concurrent_hits, 1);
+    return PHYMUTI_SUCCESS;
+}
+
+/* 写线程：不断写监视范围内的字 */
+static void *concurrent_writer(void *arg) {
+    uint64_t addr = TEST_BASE + 0x3000 + (uint64_t)(uintptr_t)arg * 4;
+    unsigned long long writes = 0;
+
+    while (!atomic_load(&concurrent_stop)) {
+        memory_write_word(concurrent_region, addr, (uint32_t)writes);
+        writes++;
+    }
+    atomic_fetch_add(&concurrent_writes, writes);
+    return NULL;
+}
+
+/* 写线程运行时反复增删监视点，已有监视点不能漏掉任何一次写入 */
+static int test_concurrent_update(memory_region_t *region) {
+    action_id_t action = action_create_callback(atomic_count_callback, NULL);
+    monitor_id_t stable = monitor_add_watchpoint(region, TEST_BASE + 0x3000, 0x100, WATCHPOINT_WRITE, 0);
+    if (action == ACTION_INVALID_ID || stable == MONITOR_INVALID_ID ||
+        monitor_bind_action(stable, action) != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "创建监视点或动作失败\n");
+        return 1;
+    }
+
+    concurrent_region = region;
+    atomic_store(&concurrent_stop, false);
+    atomic_store(&concurrent_writes, 0);
+    atomic_store(&concurrent_hits, 0);
+
+    pthread_t threads[CONCURRENT_WRITERS];
+    for (int i = 0; i < CONCURRENT_WRITERS; i++) {
+        pthread_create(&threads[i], NULL, concurrent_writer, (void *)(uintptr_t)i);
+    }
+
+    /* 与写线程并发增删、修改监视点 */
+    const int rounds = 2000;
+    watchpoint_predicate_t pred = { .kind = WATCHPOINT_PRED_RANGE_U, .lo.u = 0, .hi.u = 1000 };
+    uint64_t start = now_ns();
+    for (int i = 0; i < rounds; i++) {
+        monitor_id_t id = monitor_add_watchpoint(region, TEST_BASE + 0x3000 + (uint64_t)(i % CONCURRENT_WRITERS) * 4,
+                                                 4, WATCHPOINT_WRITE, 0);
+        if (id == MONITOR_INVALID_ID || monitor_bind_action(id, action) != PHYMUTI_SUCCESS ||
+            monitor_set_predicate(id, &pred) != PHYMUTI_SUCCESS ||
+            monitor_remove_watchpoint(id) != PHYMUTI_SUCCESS) {
+            fprintf(stderr, "并发增删监视点失败\n");
+            atomic_store(&concurrent_stop, true);
+            for (int j = 0; j < CONCURRENT_WRITERS; j++) {
+                pthread_join(threads[j], NULL);
+            }
+            return 1;
+        }
+    }
+    double update_us = (double)(now_ns() - start) / rounds / 1000.0;
+
+    atomic_store(&concurrent_stop, true);
+    for (int i = 0; i < CONCURRENT_WRITERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* 常驻监视点的命中次数必须等于写入次数 */
+    monitor_counter_t counters[8];
+    size_t count;
+    uint64_t stable_hits = 0;
+    monitor_get_counters(counters, 8, &count);
+    for (size_t i = 0; i < count && i < 8; i++) {
+        if (counters[i].id == stable) {
+            stable_hits = counters[i].hits;
+        }
+    }
+    unsigned long long writes = atomic_load(&concurrent_writes);
+    if (count != 1 || stable_hits != writes || atomic_load(&concurrent_hits) < writes) {
+        fprintf(stderr, "并发更新时监视点计数错误: 写入 %llu 次，命中 %llu 次\n",
+                writes, (unsigned long long)stable_hits);
+        return 1;
+    }
+
+    monitor_remove_watchpoint(stable);
+    action_destroy(action);
+
+    printf("并发更新测试通过：%d个写线程共写入 %llu 次，每轮增删耗时 %.1f 微秒\n",
+           CONCURRENT_WRITERS, writes, update_us);
+    return 0;
+}
+
+/* 延迟监视测试的写线程 */
+static void *deferred_writer(void *arg) {
+    uint64_t addr = TEST_BASE + 0x3000 + (uint64_t)(uintptr_t)arg * 4;
+
+    for (uint32_t i = 0; i < 20000; i++) {
+        memory_write_word(concurrent_region, addr, i);
+    }
+    atomic_fetch_add(&concurrent_writes, 20000);
+    return NULL;
+}
+
+/* 延迟监视：访问只追加日志，由监视线程按批匹配，不丢失任何访问 */
+static int test_deferred(memory_region_t *region) {
+    action_id_t action = action_create_callback(atomic_count_callback, NULL);
+    monitor_id_t id = monitor_add_watchpoint(region, TEST_BASE + 0x3000, 0x100, WATCHPOINT_WRITE, 0);
+    if (action == ACTION_INVALID_ID || id == MONITOR_INVALID_ID ||
+        monitor_bind_action(id, action) != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "创建监视点或动作失败\n");
+        return 1;
+    }
+
+    double sync_ns = measure_write_ns(region, TEST_BASE + 0x3000);
+
+    /* 日志很小，保证访问线程需要等待监视线程 */
+    monitor_deferred_config_t config = { .log_entries = 64, .batch_size = 16, .max_latency_us = 200 };
+    if (monitor_set_deferred(&config) != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "进入延迟模式失败\n");
+        return 1;
+    }
+
+    concurrent_region = region;
+    atomic_store(&concurrent_writes, 0);
+    atomic_store(&concurrent_hits, 0);
+
+    pthread_t threads[CONCURRENT_WRITERS];
+    for (int i = 0; i < CONCURRENT_WRITERS; i++) {
+        pthread_create(&threads[i], NULL, deferred_writer, (void *)(uintptr_t)i);
+    }
+    for (int i = 0; i < CONCURRENT_WRITERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    monitor_drain_deferred();
+
+    monitor_deferred_stats_t stats;
+    monitor_get_deferred_stats(&stats);
+    unsigned long long writes = atomic_load(&concurrent_writes);
+    if (atomic_load(&concurrent_hits) != writes || stats.logged != writes || stats.dispatched != writes) {
+        fprintf(stderr, "延迟模式丢失了访问: 写入 %llu 次，触发 %llu 次\n",
+                writes, (unsigned long long)atomic_load(&concurrent_hits));
+        return 1;
+    }
+
+    /* 不主动处理时，监视线程在处理间隔内执行动作 */
+    atomic_store(&concurrent_hits, 0);
+    memory_write_word(region, TEST_BASE + 0x3000, 1);
+    uint64_t start = now_ns();
+    while (atomic_load(&concurrent_hits) == 0 && now_ns() - start < 1000000000ULL) {
+        sched_yield();
+    }
+    double latency_us = (double)(now_ns() - start) / 1000.0;
+    if (atomic_load(&concurrent_hits) != 1) {
+        fprintf(stderr, "监视线程没有处理访问日志\n");
+        return 1;
+    }
+
+    /* 单线程时日志容量以内的突发写入，每次写入只追加一条日志 */
+    monitor_deferred_config_t large = { MONITOR_DEFAULT_LOG_ENTRIES, MONITOR_DEFAULT_BATCH_SIZE,
+                                        MONITOR_DEFAULT_MAX_LATENCY_US };
+    monitor_set_deferred(&large);
+    atomic_store(&concurrent_hits, 0);
+    const int burst = MONITOR_DEFAULT_LOG_ENTRIES / 2;
+    start = now_ns();
+    for (int i = 0; i < burst; i++) {
+        memory_write_word(region, TEST_BASE + 0x3000, (uint32_t)i);
+    }
+    double deferred_ns = (double)(now_ns() - start) / burst;
+
+    /* 切换回同步模式时处理完剩余日志，之后的访问立即匹配 */
+    monitor_set_deferred(NULL);
+    uint64_t pending = atomic_load(&concurrent_hits);
+    memory_write_word(region, TEST_BASE + 0x3000, 2);
+    if (pending != (uint64_t)burst || atomic_load(&concurrent_hits) != pending + 1) {
+        fprintf(stderr, "切换回同步模式后触发次数错误\n");
+        return 1;
+    }
+
+    monitor_remove_watchpoint(id);
+    action_destroy(action);
+
+    printf("延迟监视测试通过：%llu 次写入等待 %llu 次，动作延迟 %.0f 微秒，"
+           "每次写入耗时：同步 %.1f 纳秒，延迟 %.1f 纳秒\n",
+           writes, (unsigned long long)stats.stalls, latency_us, sync_ns, deferred_ns);
+    return 0;
+}
+
+int main(void) {
+    int ret;
+
+    printf("PhyMuTi监视器测试\n");
+
+    ret = phymuti_init();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "初始化PhyMuTi系统失败: %s\n", phymuti_error_string(ret));
+        return 1;
+    }
+
+    memory_region_t *region = memory_region_create(NULL, "ram", TEST_BASE, TEST_SIZE, MEMORY_FLAG_RW);
+    action_id_t action = action_create_callback(count_callback, NULL);
+    if (!region || action == ACTION_INVALID_ID) {
+        fprintf(stderr, "创建内存区域或动作失败\n");
+        phymuti_cleanup();
+        return 1;
+    }
+
+    if (test_range_watchpoint(region, action) != 0 || test_overlapping(region, action) != 0 ||
+        test_predicates(region, action) != 0 || test_old_value() != 0 ||
+        test_counters(region, action) != 0 || test_coalesce(region) != 0 ||
+        test_scaling(region) != 0 || test_wide_range(region) != 0 ||
+        test_dense_registers() != 0 ||
+        test_value_index(region) != 0 || test_batch_actions(region) != 0 ||
+        test_concurrent_update(region) != 0 ||
+        test_deferred(region) != 0) {
+        phymuti_cleanup();
+        return 1;
+    }
+
+    ret = phymuti_cleanup();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "清理PhyMuTi系统失败: %s\n", phymuti_error_string(ret));
+        return 1;
+    }
+
+    printf("测试完成\n");
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file test_profile.c
+ * @brief PhyMuTi内存访问采样分析测试程序
+ */
+
+#include "phymuti.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/* 测试内存区域 */
+#define TEST_BASE 0x40000000ULL
+#define TEST_SIZE 0x10000
+
+/* 各地址的写入次数 */
+#define TEST_HOT_WRITES  200000
+#define TEST_WARM_WRITES 50000
+#define TEST_COLD_WRITES 20
+
+/* 测试线程数 */
+#define TEST_THREADS 4
+
+/* 获取单调时间（纳秒） */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* 测试线程：热点寄存器由所有线程读写，温点只由本线程写，冷点各写少量几次 */
+static void* test_access_thread(void *arg) {
+    memory_region_t *region = (memory_region_t *)arg;
+    uint32_t value;
+
+    for (uint32_t i = 0; i < TEST_HOT_WRITES / TEST_THREADS; i++) {
+        memory_write_word(region, TEST_BASE + 0x10, i);
+        memory_read_word(region, TEST_BASE + 0x10, &value);
+    }
+    for (uint32_t i = 0; i < TEST_WARM_WRITES / TEST_THREADS; i++) {
+        memory_write_word(region, TEST_BASE + 0x800, i);
+    }
+    for (uint64_t addr = 0x1000; addr < 0x2000; addr += 4) {
+        for (int i = 0; i < TEST_COLD_WRITES / TEST_THREADS; i++) {
+            memory_write_word(region, TEST_BASE + addr, (uint32_t)i);
+        }
+    }
+
+    return NULL;
+}
+
+/* 测量每次写访问的平均耗时（纳秒） */
+static double measure_write_ns(memory_region_t *region) {
+    const int iterations = 1000000;
+    uint64_t start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        memory_write_word(region, TEST_BASE + 0x3000 + (uint64_t)(i & 0xff) * 4, (uint32_t)i);
+    }
+    return (double)(now_ns() - start) / iterations;
+}
+
+static int run_test(memory_region_t *region) {
+    if (profile_stop() != PHYMUTI_ERROR_PROFILE_NOT_ACTIVE) {
+        fprintf(stderr, "未开始时停止采样未被拒绝\n");
+        return 1;
+    }
+
+    profile_config_t config = { .sample_period = 64, .region_slots = 1024 };
+    if (profile_start(&config) != PHYMUTI_SUCCESS ||
+        profile_start(&config) != PHYMUTI_ERROR_PROFILE_ACTIVE) {
+        fprintf(stderr, "开始采样失败\n");
+        return 1;
+    }
+
+    pthread_t threads[TEST_THREADS];
+    for (int i = 0; i < TEST_THREADS; i++) {
+        pthread_create(&threads[i], NULL, test_access_thread, region);
+    }
+    for (int i = 0; i < TEST_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    if (profile_stop() != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "停止采样失败\n");
+        return 1;
+    }
+
+    /* 最热的是热点寄存器（读写各一半），其次是温点 */
+    profile_entry_t top[3];
+    size_t count;
+    if (profile_get_top(top, 3, &count) != PHYMUTI_SUCCESS || count != 3) {
+        fprintf(stderr, "获取热点地址失败\n");
+        return 1;
+    }
+    if (top[0].address != TEST_BASE + 0x10 || top[1].address != TEST_BASE + 0x800 ||
+        strcmp(top[0].region_name, "regs") != 0) {
+        fprintf(stderr, "热点地址排序错误\n");
+        return 1;
+    }
+
+    /* 估计次数与实际次数相差不超过20% */
+    double hot_error = (double)top[0].estimated_accesses / (2.0 * TEST_HOT_WRITES) - 1.0;
+    double warm_error = (double)top[1].estimated_accesses / TEST_WARM_WRITES - 1.0;
+    if (hot_error > 0.2 || hot_error < -0.2 || warm_error > 0.2 || warm_error < -0.2 ||
+        top[0].read_samples == 0 || top[0].write_samples == 0) {
+        fprintf(stderr, "估计访问次数偏差过大: 热点 %.2f，温点 %.2f\n", hot_error, warm_error);
+        return 1;
+    }
+
+    profile_stats_t stats;
+    profile_get_stats(&stats);
+    if (stats.regions != 1 || stats.samples == 0) {
+        fprintf(stderr, "采样统计信息错误\n");
+        return 1;
+    }
+
+    profile_dump_top(stdout, 5);
+
+    /* 开销：不采样、按默认周期采样 */
+    double off_ns = measure_write_ns(region);
+    profile_start(NULL);
+    double on_ns = measure_write_ns(region);
+    profile_stop();
+
+    printf("采样测试通过：%llu 次采样，每次写入耗时：不采样 %.1f 纳秒，采样 %.1f 纳秒\n",
+           (unsigned long long)stats.samples, off_ns, on_ns);
+    return 0;
+}
+
+int main(void) {
+    int ret;
+
+    printf("PhyMuTi采样分析测试\n");
+
+    ret = phymuti_init();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "初始化PhyMuTi系统失败: %s\n", phymuti_error_string(ret));
+        return 1;
+    }
+
+    memory_region_t *region = memory_region_create(NULL, "regs", TEST_BASE, TEST_SIZE, MEMORY_FLAG_RW);
+    if (!region) {
+        fprintf(stderr, "创建内存区域失败\n");
+        phymuti_cleanup();
+        return 1;
+    }
+
+    int failed = run_test(region);
+
+    ret = phymuti_cleanup();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "清理PhyMuTi系统失败: %s\n", phymuti_error_string(ret));
+        failed = 1;
+    }
+
+    if (failed) {
+        return 1;
+    }
+
+    printf("测试完成\n");
+    return 0;
+}
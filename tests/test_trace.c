@@ -0,0 +1,224 @@
+/**
+ * @file test_trace.c
+ * @brief PhyMuTi内存访问跟踪测试程序
+ */
+
+#include "phymuti.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* 跟踪文件路径 */
+#define TEST_TRACE_PATH "test_trace.bin"
+
+/* 每个线程写入次数 */
+#define TEST_WRITES_PER_THREAD 1000
+
+/* 测试线程数 */
+#define TEST_THREADS 2
+
+/* 测试线程参数 */
+typedef struct {
+    memory_region_t *region;  /* 写入的内存区域 */
+    uint64_t addr;            /* 写入地址 */
+} test_thread_arg_t;
+
+/* 测试线程：向同一地址写入递增的值 */
+static void* test_writer_thread(void *arg) {
+    test_thread_arg_t *targ = (test_thread_arg_t *)arg;
+
+    for (uint32_t i = 0; i < TEST_WRITES_PER_THREAD; i++) {
+        memory_write_word(targ->region, targ->addr, i);
+    }
+
+    return NULL;
+}
+
+/* 检查跟踪文件：记录总数正确，且每个线程的记录保持写入顺序 */
+static int check_trace_file(uint32_t region_id) {
+    FILE *fp = fopen(TEST_TRACE_PATH, "rb");
+    if (!fp) {
+        fprintf(stderr, "无法打开跟踪文件\n");
+        return 1;
+    }
+
+    trace_file_header_t header;
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        memcmp(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.record_size != sizeof(trace_record_t)) {
+        fprintf(stderr, "跟踪文件头无效\n");
+        fclose(fp);
+        return 1;
+    }
+
+    /* 每个线程期望的下一个值，按地址区分线程 */
+    uint64_t expected[TEST_THREADS] = {0};
+    uint32_t total = 0;
+    trace_record_t rec;
+
+    while (fread(&rec, sizeof(rec), 1, fp) == 1) {
+        if (rec.region_id != region_id || rec.access_type != MEMORY_ACCESS_WRITE ||
+            rec.size != 4) {
+            fprintf(stderr, "跟踪记录内容错误\n");
+            fclose(fp);
+            return 1;
+        }
+
+        uint32_t t = (uint32_t)((rec.address - 0x1000) / 4);
+        if (t >= TEST_THREADS || rec.value != expected[t]) {
+            fprintf(stderr, "跟踪记录顺序错误: 线程%u 期望%llu 实际%llu\n", t,
+                    (unsigned long long)expected[t], (unsigned long long)rec.value);
+            fclose(fp);
+            return 1;
+        }
+
+        expected[t]++;
+        total++;
+    }
+
+    fclose(fp);
+
+    if (total != TEST_THREADS * TEST_WRITES_PER_THREAD) {
+        fprintf(stderr, "跟踪记录数错误: %u\n", total);
+        return 1;
+    }
+
+    printf("跟踪文件检查通过，共 %u 条记录\n", total);
+    return 0;
+}
+
+/* 在新的模拟系统中回放跟踪文件，检查统计和最终内存内容 */
+static int check_replay(uint32_t threads) {
+    int ret = phymuti_init();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "初始化PhyMuTi系统失败: %s\n", phymuti_error_string(ret));
+        return 1;
+    }
+
+    /* 重新初始化后区域ID从头分配，与跟踪时一致 */
+    memory_region_t *region = memory_region_create(NULL, "ram", 0x1000, 64, MEMORY_FLAG_RW);
+    if (!region) {
+        fprintf(stderr, "创建内存区域失败\n");
+        phymuti_cleanup();
+        return 1;
+    }
+
+    trace_replay_config_t config = { .pacing = TRACE_REPLAY_MAX_SPEED, .threads = threads };
+    trace_replay_stats_t stats;
+    ret = trace_replay_file(TEST_TRACE_PATH, &config, &stats);
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "回放失败: %s\n", phymuti_error_string(ret));
+        phymuti_cleanup();
+        return 1;
+    }
+
+    printf("回放(%u线程) %llu 条，跳过 %llu 条，失败 %llu 条，%.0f 次/秒\n", threads,
+           (unsigned long long)stats.replayed, (unsigned long long)stats.skipped,
+           (unsigned long long)stats.failed, stats.accesses_per_sec);
+
+    if (stats.records != TEST_THREADS * TEST_WRITES_PER_THREAD ||
+        stats.replayed != stats.records || stats.skipped != 0 || stats.failed != 0) {
+        fprintf(stderr, "回放统计错误\n");
+        phymuti_cleanup();
+        return 1;
+    }
+
+    for (int i = 0; i < TEST_THREADS; i++) {
+        uint32_t value = 0;
+        memory_read_word(region, 0x1000 + (uint64_t)i * 4, &value);
+        if (value != TEST_WRITES_PER_THREAD - 1) {
+            fprintf(stderr, "回放后内存内容错误: %u\n", value);
+            phymuti_cleanup();
+            return 1;
+        }
+    }
+
+    return phymuti_cleanup() == PHYMUTI_SUCCESS ? 0 : 1;
+}
+
+int main(void) {
+    int ret;
+
+    printf("PhyMuTi内存访问跟踪测试\n");
+
+    ret = phymuti_init();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "初始化PhyMuTi系统失败: %s\n", phymuti_error_string(ret));
+        return 1;
+    }
+
+    memory_region_t *region = memory_region_create(NULL, "ram", 0x1000, 64, MEMORY_FLAG_RW);
+    if (!region) {
+        fprintf(stderr, "创建内存区域失败\n");
+        phymuti_cleanup();
+        return 1;
+    }
+
+    /* 开始跟踪，缓冲区足够容纳全部记录 */
+    trace_config_t config = { .buffer_records = 4096, .flush_interval_us = 100 };
+    ret = trace_start(TEST_TRACE_PATH, &config);
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "开始跟踪失败: %s\n", phymuti_error_string(ret));
+        phymuti_cleanup();
+        return 1;
+    }
+
+    if (trace_start(TEST_TRACE_PATH, &config) != PHYMUTI_ERROR_TRACE_ACTIVE) {
+        fprintf(stderr, "重复开始跟踪未被拒绝\n");
+        phymuti_cleanup();
+        return 1;
+    }
+
+    /* 多线程写入 */
+    pthread_t threads[TEST_THREADS];
+    test_thread_arg_t args[TEST_THREADS];
+    for (int i = 0; i < TEST_THREADS; i++) {
+        args[i].region = region;
+        args[i].addr = 0x1000 + (uint64_t)i * 4;
+        pthread_create(&threads[i], NULL, test_writer_thread, &args[i]);
+    }
+    for (int i = 0; i < TEST_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    ret = trace_stop();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "停止跟踪失败: %s\n", phymuti_error_string(ret));
+        phymuti_cleanup();
+        return 1;
+    }
+
+    trace_stats_t stats;
+    trace_get_stats(&stats);
+    printf("记录 %llu 条，丢弃 %llu 条，写入 %llu 条，线程 %u 个\n",
+           (unsigned long long)stats.recorded, (unsigned long long)stats.dropped,
+           (unsigned long long)stats.written, stats.threads);
+
+    if (stats.dropped != 0 || stats.written != TEST_THREADS * TEST_WRITES_PER_THREAD) {
+        fprintf(stderr, "跟踪统计错误\n");
+        phymuti_cleanup();
+        return 1;
+    }
+
+    if (check_trace_file(memory_region_get_id(region)) != 0) {
+        phymuti_cleanup();
+        return 1;
+    }
+
+    ret = phymuti_cleanup();
+    if (ret != PHYMUTI_SUCCESS) {
+        fprintf(stderr, "清理PhyMuTi系统失败: %s\n", phymuti_error_string(ret));
+        return 1;
+    }
+
+    if (check_replay(1) != 0 || check_replay(TEST_THREADS) != 0) {
+        remove(TEST_TRACE_PATH);
+        return 1;
+    }
+
+    remove(TEST_TRACE_PATH);
+
+    printf("测试完成\n");
+    return 0;
+}
@@ -0,0 +1,669 @@
+/**
+ * @file regmap_gen.c
+ * @brief 寄存器映射代码生成器
+ *
+ * 读取寄存器映射描述文件（.regmap），生成包含类型化 static inline 访问函数、
+ * 位域掩码以及预计算复位镜像的头文件。
+ *
+ * 描述文件为按行解析的文本格式，'#' 之后为注释：
+ *
+ *   device   <设备前缀>
+ *   base     <区域基地址>
+ *   size     <区域大小（字节）>
+ *   register <寄存器名> <偏移> <宽度(8/16/32/64)> <权限(ro/wo/rw)> <复位值>
+ *   field    <寄存器名> <字段名> <起始位> <位宽> <权限(ro/wo/rw)>
+ *
+ * 用法: regmap_gen <输入.regmap> <输出.h>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <errno.h>
+
+/* 名称最大长度 */
+#define REGMAP_NAME_MAX 64
+
+/* 寄存器和字段数量上限 */
+#define REGMAP_MAX_REGISTERS 256
+#define REGMAP_MAX_FIELDS    1024
+
+/* 单行最大长度 */
+#define REGMAP_LINE_MAX 512
+
+/* 访问权限 */
+#define REGMAP_ACCESS_READ  (1 << 0)  /* 可读 */
+#define REGMAP_ACCESS_WRITE (1 << 1)  /* 可写 */
+
+/* 寄存器描述 */
+typedef struct {
+    char name[REGMAP_NAME_MAX];  /* 寄存器名 */
+    uint64_t offset;             /* 相对基地址的偏移 */
+    uint32_t width;              /* 宽度（位） */
+    uint32_t access;             /* 访问权限 */
+    uint64_t reset;              /* 复位值 */
+} regmap_register_t;
+
+/* 位域描述 */
+typedef struct {
+    char name[REGMAP_NAME_MAX];  /* 字段名 */
+    int reg_index;               /* 所属寄存器下标 */
+    uint32_t shift;              /* 起始位 */
+    uint32_t bits;               /* 位宽 */
+    uint32_t access;             /* 访问权限 */
+} regmap_field_t;
+
+/* 寄存器映射 */
+typedef struct {
+    char device[REGMAP_NAME_MAX];  /* 设备前缀 */
+    uint64_t base;                 /* 区域基地址 */
+    uint64_t size;                 /* 区域大小 */
+    bool has_base;                 /* 是否指定了基地址 */
+    bool has_size;                 /* 是否指定了大小 */
+    regmap_register_t regs[REGMAP_MAX_REGISTERS];
+    uint32_t reg_count;
+    regmap_field_t fields[REGMAP_MAX_FIELDS];
+    uint32_t field_count;
+} regmap_t;
+
+/* 当前解析位置，用于错误提示 */
+static const char *input_path = NULL;
+static int line_no = 0;
+
+/**
+ * @brief 输出解析错误
+ *
+ * @param msg 错误信息
+ * @return int 总是返回-1
+ */
+static int parse_error(const char *msg) {
+    fprintf(stderr, "%s:%d: %s\n", input_path, line_no, msg);
+    return -1;
+}
+
+/**
+ * @brief 检查名称是否为合法的C标识符
+ *
+ * @param name 名称
+ * @return bool 合法返回true
+ */
+static bool is_identifier(const char *name) {
+    if (!name || !(isalpha((unsigned char)name[0]) || name[0] == '_')) {
+        return false;
+    }
+
+    for (const char *p = name + 1; *p; p++) {
+        if (!isalnum((unsigned char)*p) && *p != '_') {
+            return false;
+        }
+    }
+
+    return strlen(name) < REGMAP_NAME_MAX;
+}
+
+/**
+ * @brief 解析无符号整数（支持十进制和0x前缀的十六进制）
+ *
+ * @param text 文本
+ * @param value 值指针
+ * @return int 成功返回0，失败返回-1
+ */
+static int parse_u64(const char *text, uint64_t *value) {
+    char *end;
+
+    if (!text || !*text || *text == '-') {
+        return -1;
+    }
+
+    errno = 0;
+    unsigned long long v = strtoull(text, &end, 0);
+    if (errno != 0 || *end != '\0') {
+        return -1;
+    }
+
+    *value = (uint64_t)v;
+    return 0;
+}
+
+/**
+ * @brief 解析访问权限
+ *
+ * @param text 文本（ro/wo/rw）
+ * @param access 访问权限指针
+ * @return int 成功返回0，失败返回-1
+ */
+static int parse_access(const char *text, uint32_t *access) {
+    if (strcmp(text, "ro") == 0) {
+        *access = REGMAP_ACCESS_READ;
+    } else if (strcmp(text, "wo") == 0) {
+        *access = REGMAP_ACCESS_WRITE;
+    } else if (strcmp(text, "rw") == 0) {
+        *access = REGMAP_ACCESS_READ | REGMAP_ACCESS_WRITE;
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 按名称查找寄存器
+ *
+ * @param map 寄存器映射
+ * @param name 寄存器名
+ * @return int 成功返回下标，失败返回-1
+ */
+static int find_register(const regmap_t *map, const char *name) {
+    for (uint32_t i = 0; i < map->reg_count; i++) {
+        if (strcmp(map->regs[i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief 生成指定位宽的掩码
+ *
+ * @param bits 位宽
+ * @return uint64_t 掩码
+ */
+static uint64_t width_mask(uint32_t bits) {
+    return bits >= 64 ? ~0ULL : ((1ULL << bits) - 1);
+}
+
+/**
+ * @brief 解析register行
+ */
+static int parse_register(regmap_t *map, char **tokens, int count) {
+    regmap_register_t *reg;
+
+    if (count != 6) {
+        return parse_error("register 需要5个参数: <名称> <偏移> <宽度> <权限> <复位值>");
+    }
+
+    if (map->reg_count >= REGMAP_MAX_REGISTERS) {
+        return parse_error("寄存器数量超过上限");
+    }
+
+    if (!is_identifier(tokens[1])) {
+        return parse_error("寄存器名不是合法的标识符");
+    }
+
+    if (find_register(map, tokens[1]) >= 0) {
+        return parse_error("寄存器名重复");
+    }
+
+    reg = &map->regs[map->reg_count];
+    strcpy(reg->name, tokens[1]);
+
+    uint64_t width;
+    if (parse_u64(tokens[2], &reg->offset) != 0) {
+        return parse_error("无效的寄存器偏移");
+    }
+    if (parse_u64(tokens[3], &width) != 0 ||
+        (width != 8 && width != 16 && width != 32 && width != 64)) {
+        return parse_error("寄存器宽度必须为8、16、32或64");
+    }
+    reg->width = (uint32_t)width;
+
+    if (parse_access(tokens[4], &reg->access) != 0) {
+        return parse_error("访问权限必须为ro、wo或rw");
+    }
+    if (parse_u64(tokens[5], &reg->reset) != 0 ||
+        (reg->reset & ~width_mask(reg->width)) != 0) {
+        return parse_error("复位值无效或超出寄存器宽度");
+    }
+
+    /* 检查对齐，与memory_read_*的对齐要求一致 */
+    if (reg->offset % (reg->width / 8) != 0) {
+        return parse_error("寄存器偏移未按宽度对齐");
+    }
+
+    /* 检查与已有寄存器是否重叠 */
+    for (uint32_t i = 0; i < map->reg_count; i++) {
+        const regmap_register_t *other = &map->regs[i];
+        if (reg->offset < other->offset + other->width / 8 &&
+            other->offset < reg->offset + reg->width / 8) {
+            return parse_error("寄存器地址与已有寄存器重叠");
+        }
+    }
+
+    map->reg_count++;
+    return 0;
+}
+
+/**
+ * @brief 解析field行
+ */
+static int parse_field(regmap_t *map, char **tokens, int count) {
+    regmap_field_t *field;
+    uint64_t shift, bits;
+
+    if (count != 6) {
+        return parse_error("field 需要5个参数: <寄存器> <字段名> <起始位> <位宽> <权限>");
+    }
+
+    if (map->field_count >= REGMAP_MAX_FIELDS) {
+        return parse_error("字段数量超过上限");
+    }
+
+    int reg_index = find_register(map, tokens[1]);
+    if (reg_index < 0) {
+        return parse_error("字段引用了未定义的寄存器");
+    }
+
+    if (!is_identifier(tokens[2])) {
+        return parse_error("字段名不是合法的标识符");
+    }
+
+    const regmap_register_t *reg = &map->regs[reg_index];
+    if (parse_u64(tokens[3], &shift) != 0 || parse_u64(tokens[4], &bits) != 0 ||
+        bits == 0 || shift + bits > reg->width) {
+        return parse_error("字段位置超出寄存器宽度");
+    }
+
+    field = &map->fields[map->field_count];
+    strcpy(field->name, tokens[2]);
+    field->reg_index = reg_index;
+    field->shift = (uint32_t)shift;
+    field->bits = (uint32_t)bits;
+
+    if (parse_access(tokens[5], &field->access) != 0) {
+        return parse_error("访问权限必须为ro、wo或rw");
+    }
+    if ((field->access & ~reg->access) != 0) {
+        return parse_error("字段权限超出所属寄存器的权限");
+    }
+
+    /* 检查同一寄存器内字段是否重名或重叠 */
+    uint64_t mask = width_mask(field->bits) << field->shift;
+    for (uint32_t i = 0; i < map->field_count; i++) {
+        const regmap_field_t *other = &map->fields[i];
+        if (other->reg_index != reg_index) {
+            continue;
+        }
+        if (strcmp(other->name, field->name) == 0) {
+            return parse_error("字段名重复");
+        }
+        if ((width_mask(other->bits) << other->shift) & mask) {
+            return parse_error("字段与已有字段重叠");
+        }
+    }
+
+    map->field_count++;
+    return 0;
+}
+
+/**
+ * @brief 解析寄存器映射描述文件
+ *
+ * @param fp 输入文件
+ * @param map 寄存器映射
+ * @return int 成功返回0，失败返回-1
+ */
+static int parse_regmap(FILE *fp, regmap_t *map) {
+    char line[REGMAP_LINE_MAX];
+
+    while (fgets(line, sizeof(line), fp)) {
+        char *tokens[8];
+        int count = 0;
+
+        line_no++;
+
+        /* 去掉注释 */
+        char *comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+
+        /* 按空白切分 */
+        for (char *tok = strtok(line, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n")) {
+            if (count >= (int)(sizeof(tokens) / sizeof(tokens[0]))) {
+                return parse_error("参数过多");
+            }
+            tokens[count++] = tok;
+        }
+
+        if (count == 0) {
+            continue;
+        }
+
+        int ret;
+        if (strcmp(tokens[0], "device") == 0) {
+            if (count != 2 || !is_identifier(tokens[1])) {
+                return parse_error("device 需要一个合法的标识符");
+            }
+            strcpy(map->device, tokens[1]);
+            ret = 0;
+        } else if (strcmp(tokens[0], "base") == 0) {
+            if (count != 2 || parse_u64(tokens[1], &map->base) != 0) {
+                return parse_error("无效的基地址");
+            }
+            map->has_base = true;
+            ret = 0;
+        } else if (strcmp(tokens[0], "size") == 0) {
+            if (count != 2 || parse_u64(tokens[1], &map->size) != 0 || map->size == 0) {
+                return parse_error("无效的区域大小");
+            }
+            map->has_size = true;
+            ret = 0;
+        } else if (strcmp(tokens[0], "register") == 0) {
+            ret = parse_register(map, tokens, count);
+        } else if (strcmp(tokens[0], "field") == 0) {
+            ret = parse_field(map, tokens, count);
+        } else {
+            return parse_error("未知的关键字");
+        }
+
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    if (map->device[0] == '\0' || !map->has_base || !map->has_size) {
+        line_no = 0;
+        return parse_error("缺少 device、base 或 size 定义");
+    }
+
+    for (uint32_t i = 0; i < map->reg_count; i++) {
+        if (map->regs[i].offset + map->regs[i].width / 8 > map->size) {
+            line_no = 0;
+            return parse_error("寄存器超出区域大小");
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 将名称转换为大写或小写
+ */
+static void convert_case(char *dst, const char *src, bool upper) {
+    while (*src) {
+        *dst++ = (char)(upper ? toupper((unsigned char)*src) : tolower((unsigned char)*src));
+        src++;
+    }
+    *dst = '\0';
+}
+
+/**
+ * @brief 获取寄存器宽度对应的C类型
+ */
+static const char* width_type(uint32_t width) {
+    switch (width) {
+        case 8:  return "uint8_t";
+        case 16: return "uint16_t";
+        case 32: return "uint32_t";
+        default: return "uint64_t";
+    }
+}
+
+/**
+ * @brief 获取寄存器宽度对应的memory_read_xxx/memory_write_xxx后缀
+ */
+static const char* width_accessor(uint32_t width) {
+    switch (width) {
+        case 8:  return "byte";
+        case 16: return "halfword";
+        case 32: return "word";
+        default: return "doubleword";
+    }
+}
+
+/**
+ * @brief 获取寄存器宽度对应的整数常量后缀
+ */
+static const char* width_suffix(uint32_t width) {
+    return width == 64 ? "ULL" : "U";
+}
+
+/**
+ * @brief 生成头文件
+ *
+ * @param fp 输出文件
+ * @param file_name 输出文件名（不含目录）
+ * @param map 寄存器映射
+ * @return int 成功返回0，失败返回-1
+ */
+static int emit_header(FILE *fp, const char *file_name, const regmap_t *map) {
+    char up[REGMAP_NAME_MAX];
+    char lo[REGMAP_NAME_MAX];
+
+    convert_case(up, map->device, true);
+    convert_case(lo, map->device, false);
+
+    fprintf(fp, "/**\n");
+    fprintf(fp, " * @file %s\n", file_name);
+    fprintf(fp, " * @brief %s 寄存器访问函数\n", lo);
+    fprintf(fp, " *\n");
+    fprintf(fp, " * 由 regmap_gen 根据 %s 生成，请勿手工修改。\n", input_path);
+    fprintf(fp, " */\n\n");
+    fprintf(fp, "#ifndef %s_REGS_H\n", up);
+    fprintf(fp, "#define %s_REGS_H\n\n", up);
+    fprintf(fp, "#include <stdint.h>\n");
+    fprintf(fp, "#include \"memory_manager.h\"\n");
+    fprintf(fp, "#include \"phymuti_error.h\"\n\n");
+
+    /* 区域和寄存器地址 */
+    fprintf(fp, "/* 寄存器区域 */\n");
+    fprintf(fp, "#define %s_REG_BASE 0x%llxULL\n", up, (unsigned long long)map->base);
+    fprintf(fp, "#define %s_REG_SIZE %lluU\n\n", up, (unsigned long long)map->size);
+
+    fprintf(fp, "/* 寄存器地址、偏移和复位值 */\n");
+    for (uint32_t i = 0; i < map->reg_count; i++) {
+        const regmap_register_t *reg = &map->regs[i];
+        char rup[REGMAP_NAME_MAX];
+        convert_case(rup, reg->name, true);
+
+        fprintf(fp, "#define %s_REG_%s 0x%llxULL\n", up, rup,
+                (unsigned long long)(map->base + reg->offset));
+        fprintf(fp, "#define %s_REG_%s_OFFSET 0x%llxU\n", up, rup,
+                (unsigned long long)reg->offset);
+        fprintf(fp, "#define %s_REG_%s_RESET 0x%llx%s\n", up, rup,
+                (unsigned long long)reg->reset, width_suffix(reg->width));
+    }
+    fprintf(fp, "\n");
+
+    /* 位域掩码 */
+    if (map->field_count > 0) {
+        fprintf(fp, "/* 位域位置和掩码 */\n");
+        for (uint32_t i = 0; i < map->field_count; i++) {
+            const regmap_field_t *field = &map->fields[i];
+            const regmap_register_t *reg = &map->regs[field->reg_index];
+            char rup[REGMAP_NAME_MAX], fup[REGMAP_NAME_MAX];
+            convert_case(rup, reg->name, true);
+            convert_case(fup, field->name, true);
+
+            fprintf(fp, "#define %s_%s_%s_SHIFT %u\n", up, rup, fup, field->shift);
+            fprintf(fp, "#define %s_%s_%s_MASK 0x%llx%s\n", up, rup, fup,
+                    (unsigned long long)(width_mask(field->bits) << field->shift),
+                    width_suffix(reg->width));
+        }
+        fprintf(fp, "\n");
+    }
+
+    /* 复位镜像：按主机字节序预先排布好，复位只需一次整块写入 */
+    uint8_t *image = (uint8_t *)calloc(map->size, 1);
+    if (!image) {
+        fprintf(stderr, "regmap_gen: 内存不足\n");
+        return -1;
+    }
+    for (uint32_t i = 0; i < map->reg_count; i++) {
+        const regmap_register_t *reg = &map->regs[i];
+        uint8_t *dst = image + reg->offset;
+        switch (reg->width) {
+            case 8:  { uint8_t v = (uint8_t)reg->reset;   memcpy(dst, &v, sizeof(v)); break; }
+            case 16: { uint16_t v = (uint16_t)reg->reset; memcpy(dst, &v, sizeof(v)); break; }
+            case 32: { uint32_t v = (uint32_t)reg->reset; memcpy(dst, &v, sizeof(v)); break; }
+            default: { uint64_t v = reg->reset;           memcpy(dst, &v, sizeof(v)); break; }
+        }
+    }
+
+    fprintf(fp, "/* 复位镜像 */\n");
+    fprintf(fp, "static const uint8_t %s_regs_reset_image[%s_REG_SIZE] = {", lo, up);
+    for (uint64_t i = 0; i < map->size; i++) {
+        fprintf(fp, "%s0x%02x%s", (i % 12 == 0) ? "\n    " : " ", image[i],
+                (i + 1 < map->size) ? "," : "");
+    }
+    fprintf(fp, "\n};\n\n");
+    free(image);
+
+    fprintf(fp, "/**\n");
+    fprintf(fp, " * @brief 将整个寄存器区域恢复为复位值\n");
+    fprintf(fp, " *\n");
+    fprintf(fp, " * @param region 内存区域指针\n");
+    fprintf(fp, " * @return int 成功返回0，失败返回错误码\n");
+    fprintf(fp, " */\n");
+    fprintf(fp, "static inline int %s_regs_reset(memory_region_t *region) {\n", lo);
+    fprintf(fp, "    return memory_write_buffer(region, %s_REG_BASE, %s_regs_reset_image,\n", up, lo);
+    fprintf(fp, "                               sizeof(%s_regs_reset_image));\n", lo);
+    fprintf(fp, "}\n\n");
+
+    /* 寄存器访问函数 */
+    for (uint32_t i = 0; i < map->reg_count; i++) {
+        const regmap_register_t *reg = &map->regs[i];
+        const char *type = width_type(reg->width);
+        const char *acc = width_accessor(reg->width);
+        char rup[REGMAP_NAME_MAX], rlo[REGMAP_NAME_MAX];
+        convert_case(rup, reg->name, true);
+        convert_case(rlo, reg->name, false);
+
+        if (reg->access & REGMAP_ACCESS_READ) {
+            fprintf(fp, "/* 读取%s寄存器 */\n", rup);
+            fprintf(fp, "static inline int %s_read_%s(memory_region_t *region, %s *value) {\n",
+                    lo, rlo, type);
+            fprintf(fp, "    return memory_read_%s(region, %s_REG_%s, value);\n", acc, up, rup);
+            fprintf(fp, "}\n\n");
+        }
+
+        if (reg->access & REGMAP_ACCESS_WRITE) {
+            fprintf(fp, "/* 写入%s寄存器 */\n", rup);
+            fprintf(fp, "static inline int %s_write_%s(memory_region_t *region, %s value) {\n",
+                    lo, rlo, type);
+            fprintf(fp, "    return memory_write_%s(region, %s_REG_%s, value);\n", acc, up, rup);
+            fprintf(fp, "}\n\n");
+        }
+    }
+
+    /* 位域访问函数 */
+    for (uint32_t i = 0; i < map->field_count; i++) {
+        const regmap_field_t *field = &map->fields[i];
+        const regmap_register_t *reg = &map->regs[field->reg_index];
+        const char *type = width_type(reg->width);
+        const char *acc = width_accessor(reg->width);
+        char rup[REGMAP_NAME_MAX], rlo[REGMAP_NAME_MAX];
+        char fup[REGMAP_NAME_MAX], flo[REGMAP_NAME_MAX];
+        char macro[3 * REGMAP_NAME_MAX + 8];
+        convert_case(rup, reg->name, true);
+        convert_case(rlo, reg->name, false);
+        convert_case(fup, field->name, true);
+        convert_case(flo, field->name, false);
+        snprintf(macro, sizeof(macro), "%s_%s_%s", up, rup, fup);
+
+        /* 纯函数形式，便于把多个字段的修改合并成一次写入 */
+        fprintf(fp, "/* 从%s寄存器值中提取%s字段 */\n", rup, fup);
+        fprintf(fp, "static inline %s %s_%s_%s_extract(%s reg) {\n", type, lo, rlo, flo, type);
+        fprintf(fp, "    return (%s)((reg & %s_MASK) >> %s_SHIFT);\n", type, macro, macro);
+        fprintf(fp, "}\n\n");
+
+        fprintf(fp, "/* 将%s字段插入%s寄存器值 */\n", fup, rup);
+        fprintf(fp, "static inline %s %s_%s_%s_insert(%s reg, %s value) {\n",
+                type, lo, rlo, flo, type, type);
+        fprintf(fp, "    return (%s)((reg & ~%s_MASK) | (((%s)value << %s_SHIFT) & %s_MASK));\n",
+                type, macro, type, macro, macro);
+        fprintf(fp, "}\n\n");
+
+        if ((field->access & REGMAP_ACCESS_READ) && (reg->access & REGMAP_ACCESS_READ)) {
+            fprintf(fp, "/* 读取%s.%s字段 */\n", rup, fup);
+            fprintf(fp, "static inline int %s_get_%s_%s(memory_region_t *region, %s *value) {\n",
+                    lo, rlo, flo, type);
+            fprintf(fp, "    %s reg;\n", type);
+            fprintf(fp, "    int ret = memory_read_%s(region, %s_REG_%s, &reg);\n", acc, up, rup);
+            fprintf(fp, "    if (ret != PHYMUTI_SUCCESS) {\n");
+            fprintf(fp, "        return ret;\n");
+            fprintf(fp, "    }\n");
+            fprintf(fp, "    *value = %s_%s_%s_extract(reg);\n", lo, rlo, flo);
+            fprintf(fp, "    return PHYMUTI_SUCCESS;\n");
+            fprintf(fp, "}\n\n");
+        }
+
+        if (field->access & REGMAP_ACCESS_WRITE) {
+            fprintf(fp, "/* 修改%s.%s字段（读-改-写，只产生一次写入） */\n", rup, fup);
+            fprintf(fp, "static inline int %s_set_%s_%s(memory_region_t *region, %s value) {\n",
+                    lo, rlo, flo, type);
+            if (reg->access & REGMAP_ACCESS_READ) {
+                fprintf(fp, "    %s reg;\n", type);
+                fprintf(fp, "    int ret = memory_read_%s(region, %s_REG_%s, &reg);\n", acc, up, rup);
+                fprintf(fp, "    if (ret != PHYMUTI_SUCCESS) {\n");
+                fprintf(fp, "        return ret;\n");
+                fprintf(fp, "    }\n");
+            } else {
+                /* 只写寄存器无法回读，其余位按复位值写入 */
+                fprintf(fp, "    %s reg = %s_REG_%s_RESET;\n", type, up, rup);
+            }
+            fprintf(fp, "    return memory_write_%s(region, %s_REG_%s, %s_%s_%s_insert(reg, value));\n",
+                    acc, up, rup, lo, rlo, flo);
+            fprintf(fp, "}\n\n");
+        }
+    }
+
+    fprintf(fp, "#endif /* %s_REGS_H */\n", up);
+
+    return ferror(fp) ? -1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "用法: %s <输入.regmap> <输出.h>\n", argv[0]);
+        return 1;
+    }
+
+    input_path = argv[1];
+
+    FILE *in = fopen(argv[1], "r");
+    if (!in) {
+        fprintf(stderr, "regmap_gen: 无法打开 %s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+
+    regmap_t *map = (regmap_t *)calloc(1, sizeof(regmap_t));
+    if (!map) {
+        fclose(in);
+        fprintf(stderr, "regmap_gen: 内存不足\n");
+        return 1;
+    }
+
+    int ret = parse_regmap(in, map);
+    fclose(in);
+    if (ret != 0) {
+        free(map);
+        return 1;
+    }
+
+    FILE *out = fopen(argv[2], "w");
+    if (!out) {
+        fprintf(stderr, "regmap_gen: 无法创建 %s: %s\n", argv[2], strerror(errno));
+        free(map);
+        return 1;
+    }
+
+    const char *file_name = strrchr(argv[2], '/');
+    ret = emit_header(out, file_name ? file_name + 1 : argv[2], map);
+    if (fclose(out) != 0) {
+        ret = -1;
+    }
+    free(map);
+
+    if (ret != 0) {
+        /* 不留下不完整的头文件 */
+        remove(argv[2]);
+        return 1;
+    }
+
+    return 0;
+}